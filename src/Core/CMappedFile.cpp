@@ -0,0 +1,124 @@
+#include "CMappedFile.h"
+#include <Common/Common.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CMappedFile::CMappedFile()
+    : mpData(nullptr)
+    , mSize(0)
+    , mIsOpen(false)
+#ifdef _WIN32
+    , mFileHandle(INVALID_HANDLE_VALUE)
+    , mMappingHandle(nullptr)
+#endif
+{
+}
+
+CMappedFile::CMappedFile(const TString& rkPath)
+    : CMappedFile()
+{
+    Open(rkPath);
+}
+
+CMappedFile::~CMappedFile()
+{
+    Close();
+}
+
+bool CMappedFile::Open(const TString& rkPath)
+{
+    Close();
+
+#ifdef _WIN32
+    mFileHandle = CreateFileW((LPCWSTR) *rkPath.ToUTF16(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+    {
+        errorf("Failed to open file for mapping: %s", *rkPath);
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+    GetFileSizeEx(mFileHandle, &FileSize);
+    mSize = (uint64) FileSize.QuadPart;
+
+    // Zero-length files can't be mapped; treat them as valid empty files
+    if (mSize > 0)
+    {
+        mMappingHandle = CreateFileMappingW(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        mpData = (mMappingHandle ? (const uint8*) MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr);
+
+        if (!mpData)
+        {
+            errorf("Failed to map file: %s", *rkPath);
+            Close();
+            return false;
+        }
+    }
+#else
+    int FileDesc = open(*rkPath, O_RDONLY);
+
+    if (FileDesc == -1)
+    {
+        errorf("Failed to open file for mapping: %s", *rkPath);
+        return false;
+    }
+
+    struct stat FileStat;
+    fstat(FileDesc, &FileStat);
+    mSize = (uint64) FileStat.st_size;
+
+    // Zero-length files can't be mapped; treat them as valid empty files
+    if (mSize > 0)
+    {
+        void *pMapping = mmap(nullptr, (size_t) mSize, PROT_READ, MAP_PRIVATE, FileDesc, 0);
+        mpData = (pMapping != MAP_FAILED ? (const uint8*) pMapping : nullptr);
+    }
+
+    // The mapping stays valid after the file descriptor is closed
+    close(FileDesc);
+
+    if (mSize > 0 && !mpData)
+    {
+        errorf("Failed to map file: %s", *rkPath);
+        mSize = 0;
+        return false;
+    }
+#endif
+
+    mIsOpen = true;
+    return true;
+}
+
+void CMappedFile::Close()
+{
+#ifdef _WIN32
+    if (mpData)
+        UnmapViewOfFile(mpData);
+
+    if (mMappingHandle)
+        CloseHandle(mMappingHandle);
+
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(mFileHandle);
+
+    mMappingHandle = nullptr;
+    mFileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (mpData)
+        munmap((void*) mpData, (size_t) mSize);
+#endif
+
+    mpData = nullptr;
+    mSize = 0;
+    mIsOpen = false;
+}
@@ -0,0 +1,45 @@
+#ifndef CMAPPEDFILE_H
+#define CMAPPEDFILE_H
+
+#include <Common/BasicTypes.h>
+#include <Common/TString.h>
+
+/* Read-only memory mapping of a file on disk. Data handed out by this class points straight into the
+ * mapped view; it's only valid for as long as the CMappedFile is open, and must never be written to. */
+class CMappedFile
+{
+    const uint8 *mpData;
+    uint64 mSize;
+    bool mIsOpen;
+
+#ifdef _WIN32
+    void *mFileHandle;
+    void *mMappingHandle;
+#endif
+
+public:
+    CMappedFile();
+    CMappedFile(const TString& rkPath);
+    ~CMappedFile();
+
+    bool Open(const TString& rkPath);
+    void Close();
+
+    // Returns a pointer to the given range of the file, or nullptr if the range is out of bounds
+    inline const uint8* DataAt(uint64 Offset, uint64 Size) const
+    {
+        if (!mIsOpen || Offset > mSize || Size > mSize - Offset) return nullptr;
+        return mpData + Offset;
+    }
+
+    // Accessors
+    inline bool IsValid() const         { return mIsOpen; }
+    inline const uint8* Data() const    { return mpData; }
+    inline uint64 Size() const          { return mSize; }
+
+    // Mappings can't be copied
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+};
+
+#endif // CMAPPEDFILE_H
@@ -0,0 +1,148 @@
+#include "CRC32Util.h"
+#include <Common/Hash/CCRC32.h>
+#include <cstring>
+
+namespace CRC32Util
+{
+    const uint32 gkPolynomial = 0xEDB88320;
+
+    // Table N gives the effect of a byte followed by N zero bytes
+    struct SSlicingTables
+    {
+        uint32 Table[8][256];
+
+        SSlicingTables()
+        {
+            for (uint32 Byte = 0; Byte < 256; Byte++)
+            {
+                uint32 CRC = Byte;
+
+                for (uint32 iBit = 0; iBit < 8; iBit++)
+                    CRC = (CRC >> 1) ^ ((CRC & 1) ? gkPolynomial : 0);
+
+                Table[0][Byte] = CRC;
+            }
+
+            for (uint32 Byte = 0; Byte < 256; Byte++)
+            {
+                for (uint32 iSlice = 1; iSlice < 8; iSlice++)
+                {
+                    uint32 Prev = Table[iSlice - 1][Byte];
+                    Table[iSlice][Byte] = (Prev >> 8) ^ Table[0][Prev & 0xFF];
+                }
+            }
+        }
+    };
+
+    const SSlicingTables& Tables()
+    {
+        static const SSlicingTables skTables;
+        return skTables;
+    }
+
+    uint32 Hash(uint32 State, const void *pkData, uint32 Size)
+    {
+        const SSlicingTables& rkTables = Tables();
+        const uint8 *pkBytes = static_cast<const uint8*>(pkData);
+
+        while (Size >= 8)
+        {
+            // Assembled byte by byte so this works regardless of host endianness
+            uint32 Lo = State ^ ((uint32) pkBytes[0] | ((uint32) pkBytes[1] << 8) | ((uint32) pkBytes[2] << 16) | ((uint32) pkBytes[3] << 24));
+            uint32 Hi = ((uint32) pkBytes[4] | ((uint32) pkBytes[5] << 8) | ((uint32) pkBytes[6] << 16) | ((uint32) pkBytes[7] << 24));
+
+            State = rkTables.Table[7][Lo & 0xFF] ^
+                    rkTables.Table[6][(Lo >> 8) & 0xFF] ^
+                    rkTables.Table[5][(Lo >> 16) & 0xFF] ^
+                    rkTables.Table[4][Lo >> 24] ^
+                    rkTables.Table[3][Hi & 0xFF] ^
+                    rkTables.Table[2][(Hi >> 8) & 0xFF] ^
+                    rkTables.Table[1][(Hi >> 16) & 0xFF] ^
+                    rkTables.Table[0][Hi >> 24];
+
+            pkBytes += 8;
+            Size -= 8;
+        }
+
+        while (Size-- > 0)
+            State = (State >> 8) ^ rkTables.Table[0][(State ^ *pkBytes++) & 0xFF];
+
+        return State;
+    }
+
+    uint32 Hash(uint32 State, const char *pkString)
+    {
+        return Hash(State, pkString, strlen(pkString));
+    }
+
+    CAdvanceTable::CAdvanceTable(uint32 NumBytes /*= 0*/, bool Inverse /*= false*/)
+    {
+        Init(NumBytes, Inverse);
+    }
+
+    void CAdvanceTable::Init(uint32 NumBytes, bool Inverse /*= false*/)
+    {
+        const SSlicingTables& rkTables = Tables();
+
+        // Hashing a zero byte shifts the low byte of the state out and XORs in its table entry. The top byte of
+        // the result comes only from the table entry, and every entry has a different top byte, so the shifted
+        // out byte can be recovered from it to step backwards.
+        uint8 InverseTop[256];
+
+        for (uint32 Byte = 0; Byte < 256; Byte++)
+            InverseTop[ rkTables.Table[0][Byte] >> 24 ] = (uint8) Byte;
+
+        // Advance each single-bit state, then build the byte tables out of those
+        uint32 Bits[32];
+
+        for (uint32 iBit = 0; iBit < 32; iBit++)
+        {
+            uint32 State = 1u << iBit;
+
+            for (uint32 iByte = 0; iByte < NumBytes; iByte++)
+            {
+                if (Inverse)
+                {
+                    uint8 Low = InverseTop[State >> 24];
+                    State = ((State ^ rkTables.Table[0][Low]) << 8) | Low;
+                }
+                else
+                    State = (State >> 8) ^ rkTables.Table[0][State & 0xFF];
+            }
+
+            Bits[iBit] = State;
+        }
+
+        for (uint32 iTable = 0; iTable < 4; iTable++)
+        {
+            for (uint32 Byte = 0; Byte < 256; Byte++)
+            {
+                uint32 Value = 0;
+
+                for (uint32 iBit = 0; iBit < 8; iBit++)
+                {
+                    if (Byte & (1 << iBit))
+                        Value ^= Bits[iTable * 8 + iBit];
+                }
+
+                mTable[iTable][Byte] = Value;
+            }
+        }
+    }
+
+    bool MatchesCCRC32()
+    {
+        const char *kTestStrings[] = { "", "a", "Int", "ActivationTime", "UnknownStruct42_Vector", "The quick brown fox jumps over the lazy dog" };
+
+        for (const char *pkString : kTestStrings)
+        {
+            CCRC32 CRC;
+            CRC.Hash(pkString);
+
+            if (CRC.Digest() != HashString(pkString))
+                return false;
+        }
+
+        return true;
+    }
+}
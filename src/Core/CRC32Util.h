@@ -0,0 +1,52 @@
+#ifndef CRC32UTIL_H
+#define CRC32UTIL_H
+
+#include <Common/BasicTypes.h>
+
+// Fast implementation of the CRC-32 that CCRC32 computes (used for property IDs and type name hashes): the
+// standard reflected polynomial, starting from 0xFFFFFFFF, with no final XOR. A hash can be continued by
+// passing the result of a previous call back in as the state.
+namespace CRC32Util
+{
+    const uint32 gkInitialState = 0xFFFFFFFF;
+
+    // Slicing-by-8; processes 8 bytes per step instead of one. Hardware CRC32 instructions on x86 (SSE4.2)
+    // compute CRC-32C, which uses a different polynomial, so they can't be used here.
+    uint32 Hash(uint32 State, const void *pkData, uint32 Size);
+    uint32 Hash(uint32 State, const char *pkString);
+
+    inline uint32 HashString(const char *pkString)
+    {
+        return Hash(gkInitialState, pkString);
+    }
+
+    // CRC-32 is linear, so hashing data onto a state can be split into two independent parts:
+    //     Hash(State, Data) == Advance(State, Size(Data)) ^ Hash(0, Data)
+    // where Advance(State, N) is the state after hashing N zero bytes. Advance is itself linear in the state,
+    // so for a fixed N it can be applied with four table lookups regardless of N. This lets code that hashes
+    // the same strings onto many different states (like brute forcing names) precompute Hash(0, Data) once,
+    // then combine it with any state in constant time.
+    // Advancing is also invertible; an inverse table gives the state from before hashing NumBytes zero bytes,
+    // which lets you work backwards from a known hash to the state needed to produce it.
+    class CAdvanceTable
+    {
+        uint32 mTable[4][256];
+
+    public:
+        explicit CAdvanceTable(uint32 NumBytes = 0, bool Inverse = false);
+        void Init(uint32 NumBytes, bool Inverse = false);
+
+        inline uint32 Apply(uint32 State) const
+        {
+            return mTable[0][State & 0xFF] ^
+                   mTable[1][(State >> 8) & 0xFF] ^
+                   mTable[2][(State >> 16) & 0xFF] ^
+                   mTable[3][State >> 24];
+        }
+    };
+
+    // Checks the tables against CCRC32. Should always pass; used as a sanity check by code that mixes the two.
+    bool MatchesCCRC32();
+}
+
+#endif // CRC32UTIL_H
@@ -0,0 +1,514 @@
+#include "CTriangleBVH.h"
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define BVH_USE_SSE 1
+    #include <emmintrin.h>
+#else
+    #define BVH_USE_SSE 0
+#endif
+
+// Build parameters
+static const uint32 gkNumSAHBins = 12;
+static const uint32 gkMaxLeafTriangles = 8;
+static const uint32 gkMaxTraversalDepth = 64;
+static const uint32 gkMaxSAHDepth = 40; // Deeper than this, only median splits are used, so the tree can't outgrow the traversal stack
+static const float gkTraversalCost = 1.f;
+static const float gkPacketCost = 1.f;
+static const float gkEpsilon = 0.000001f;
+
+// ************ HELPERS ************
+static float SurfaceArea(const CVector3f& rkMin, const CVector3f& rkMax)
+{
+    CVector3f Extent = rkMax - rkMin;
+    if (Extent.X < 0.f || Extent.Y < 0.f || Extent.Z < 0.f) return 0.f;
+    return 2.f * (Extent.X * Extent.Y + Extent.Y * Extent.Z + Extent.Z * Extent.X);
+}
+
+static inline float Component(const CVector3f& rkVec, uint32 Axis)
+{
+    return (Axis == 0 ? rkVec.X : (Axis == 1 ? rkVec.Y : rkVec.Z));
+}
+
+static inline CVector3f ComponentMin(const CVector3f& rkA, const CVector3f& rkB)
+{
+    return CVector3f(Math::Min(rkA.X, rkB.X), Math::Min(rkA.Y, rkB.Y), Math::Min(rkA.Z, rkB.Z));
+}
+
+static inline CVector3f ComponentMax(const CVector3f& rkA, const CVector3f& rkB)
+{
+    return CVector3f(Math::Max(rkA.X, rkB.X), Math::Max(rkA.Y, rkB.Y), Math::Max(rkA.Z, rkB.Z));
+}
+
+// Slab test; returns the distance the ray enters the box at, or infinity if it misses
+static inline float RayBoxEntry(const float *pkMin, const float *pkMax, const float *pkOrigin, const float *pkInvDir, float MaxDist)
+{
+    float Near = 0.f;
+    float Far = MaxDist;
+
+    for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+    {
+        float T0 = (pkMin[iAxis] - pkOrigin[iAxis]) * pkInvDir[iAxis];
+        float T1 = (pkMax[iAxis] - pkOrigin[iAxis]) * pkInvDir[iAxis];
+        if (T0 > T1) std::swap(T0, T1);
+
+        // Written so a NaN (from 0 * inf on an axis-parallel ray) leaves the interval unchanged
+        Near = (T0 > Near ? T0 : Near);
+        Far = (T1 < Far ? T1 : Far);
+    }
+
+    return (Near <= Far ? Near : std::numeric_limits<float>::infinity());
+}
+
+// ************ PACKET INTERSECTION ************
+struct CTriangleBVH::SRayData
+{
+    float Origin[3];
+    float Dir[3];
+    float InvDir[3];
+    bool AllowBackfaces;
+};
+
+#if BVH_USE_SSE
+struct SVec4 { __m128 X, Y, Z; };
+
+static inline SVec4 LoadVec4(const float (&rkArray)[3][4])
+{
+    return SVec4 { _mm_loadu_ps(rkArray[0]), _mm_loadu_ps(rkArray[1]), _mm_loadu_ps(rkArray[2]) };
+}
+
+static inline SVec4 Cross4(const SVec4& rkA, const SVec4& rkB)
+{
+    return SVec4 {
+        _mm_sub_ps(_mm_mul_ps(rkA.Y, rkB.Z), _mm_mul_ps(rkA.Z, rkB.Y)),
+        _mm_sub_ps(_mm_mul_ps(rkA.Z, rkB.X), _mm_mul_ps(rkA.X, rkB.Z)),
+        _mm_sub_ps(_mm_mul_ps(rkA.X, rkB.Y), _mm_mul_ps(rkA.Y, rkB.X))
+    };
+}
+
+static inline __m128 Dot4(const SVec4& rkA, const SVec4& rkB)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(rkA.X, rkB.X), _mm_mul_ps(rkA.Y, rkB.Y)), _mm_mul_ps(rkA.Z, rkB.Z));
+}
+#endif
+
+// Möller-Trumbore against four triangles at once. Updates rBestDist/rBestID if a closer hit is found.
+bool CTriangleBVH::IntersectPacket(const STrianglePacket& rkPacket, const SRayData& rkRay, float& rBestDist, uint32& rBestID)
+{
+#if BVH_USE_SSE
+    const __m128 kZero = _mm_setzero_ps();
+    const __m128 kOne = _mm_set1_ps(1.f);
+    const __m128 kEpsilon = _mm_set1_ps(gkEpsilon);
+
+    SVec4 Dir { _mm_set1_ps(rkRay.Dir[0]), _mm_set1_ps(rkRay.Dir[1]), _mm_set1_ps(rkRay.Dir[2]) };
+    SVec4 Vtx = LoadVec4(rkPacket.Vtx);
+    SVec4 Edge1 = LoadVec4(rkPacket.Edge1);
+    SVec4 Edge2 = LoadVec4(rkPacket.Edge2);
+
+    SVec4 P = Cross4(Dir, Edge2);
+    __m128 Det = Dot4(Edge1, P);
+
+    // Without backfaces only positive determinants count; otherwise anything not parallel to the ray
+    __m128 Valid;
+
+    if (rkRay.AllowBackfaces)
+    {
+        __m128 AbsDet = _mm_andnot_ps(_mm_set1_ps(-0.f), Det);
+        Valid = _mm_cmpgt_ps(AbsDet, kEpsilon);
+    }
+    else
+        Valid = _mm_cmpgt_ps(Det, kEpsilon);
+
+    if (_mm_movemask_ps(Valid) == 0) return false;
+
+    __m128 InvDet = _mm_div_ps(kOne, Det);
+    SVec4 T {
+        _mm_sub_ps(_mm_set1_ps(rkRay.Origin[0]), Vtx.X),
+        _mm_sub_ps(_mm_set1_ps(rkRay.Origin[1]), Vtx.Y),
+        _mm_sub_ps(_mm_set1_ps(rkRay.Origin[2]), Vtx.Z)
+    };
+
+    __m128 U = _mm_mul_ps(Dot4(T, P), InvDet);
+    Valid = _mm_and_ps(Valid, _mm_cmpge_ps(U, kZero));
+    Valid = _mm_and_ps(Valid, _mm_cmple_ps(U, kOne));
+
+    SVec4 Q = Cross4(T, Edge1);
+    __m128 V = _mm_mul_ps(Dot4(Dir, Q), InvDet);
+    Valid = _mm_and_ps(Valid, _mm_cmpge_ps(V, kZero));
+    Valid = _mm_and_ps(Valid, _mm_cmple_ps(_mm_add_ps(U, V), kOne));
+
+    __m128 Dist = _mm_mul_ps(Dot4(Edge2, Q), InvDet);
+    Valid = _mm_and_ps(Valid, _mm_cmpgt_ps(Dist, kEpsilon));
+    Valid = _mm_and_ps(Valid, _mm_cmplt_ps(Dist, _mm_set1_ps(rBestDist)));
+
+    int Mask = _mm_movemask_ps(Valid);
+    if (Mask == 0) return false;
+
+    alignas(16) float Dists[4];
+    _mm_store_ps(Dists, Dist);
+
+    for (uint32 iLane = 0; iLane < 4; iLane++)
+    {
+        if ((Mask & (1 << iLane)) && Dists[iLane] < rBestDist)
+        {
+            rBestDist = Dists[iLane];
+            rBestID = rkPacket.IDs[iLane];
+        }
+    }
+    return true;
+
+#else
+    bool Hit = false;
+
+    for (uint32 iLane = 0; iLane < 4; iLane++)
+    {
+        CVector3f Dir(rkRay.Dir[0], rkRay.Dir[1], rkRay.Dir[2]);
+        CVector3f Edge1(rkPacket.Edge1[0][iLane], rkPacket.Edge1[1][iLane], rkPacket.Edge1[2][iLane]);
+        CVector3f Edge2(rkPacket.Edge2[0][iLane], rkPacket.Edge2[1][iLane], rkPacket.Edge2[2][iLane]);
+
+        CVector3f P = Dir.Cross(Edge2);
+        float Det = Edge1.Dot(P);
+
+        if (rkRay.AllowBackfaces ? (fabsf(Det) <= gkEpsilon) : (Det <= gkEpsilon))
+            continue;
+
+        float InvDet = 1.f / Det;
+        CVector3f T(rkRay.Origin[0] - rkPacket.Vtx[0][iLane], rkRay.Origin[1] - rkPacket.Vtx[1][iLane], rkRay.Origin[2] - rkPacket.Vtx[2][iLane]);
+        float U = T.Dot(P) * InvDet;
+        if (U < 0.f || U > 1.f) continue;
+
+        CVector3f Q = T.Cross(Edge1);
+        float V = Dir.Dot(Q) * InvDet;
+        if (V < 0.f || U + V > 1.f) continue;
+
+        float Dist = Edge2.Dot(Q) * InvDet;
+
+        if (Dist > gkEpsilon && Dist < rBestDist)
+        {
+            rBestDist = Dist;
+            rBestID = rkPacket.IDs[iLane];
+            Hit = true;
+        }
+    }
+
+    return Hit;
+#endif
+}
+
+// ************ CTriangleBVH ************
+CTriangleBVH::CTriangleBVH()
+    : mNumTriangles(0)
+{
+}
+
+void CTriangleBVH::Reserve(uint32 NumTriangles)
+{
+    mBuildTriangles.reserve(NumTriangles);
+}
+
+void CTriangleBVH::AddTriangle(const CVector3f& rkA, const CVector3f& rkB, const CVector3f& rkC, uint32 ID /*= 0*/)
+{
+    ASSERT(mNodes.empty());
+
+    SBuildTriangle Tri;
+    Tri.Vtx[0] = rkA;
+    Tri.Vtx[1] = rkB;
+    Tri.Vtx[2] = rkC;
+    Tri.Min = ComponentMin(ComponentMin(rkA, rkB), rkC);
+    Tri.Max = ComponentMax(ComponentMax(rkA, rkB), rkC);
+    Tri.Center = (Tri.Min + Tri.Max) * 0.5f;
+    Tri.ID = ID;
+    mBuildTriangles.push_back(Tri);
+    mNumTriangles++;
+}
+
+void CTriangleBVH::Build()
+{
+    mNodes.clear();
+    mPackets.clear();
+
+    if (mBuildTriangles.empty())
+        return;
+
+    // A binary tree with N leaves has 2N-1 nodes; leaves hold at least one triangle
+    mNodes.reserve(mBuildTriangles.size() * 2);
+    mPackets.reserve((mBuildTriangles.size() + 3) / 4 * 2);
+
+    mNodes.emplace_back();
+    uint32 Depth = BuildRecursive(0, 0, mBuildTriangles.size(), 1);
+    ASSERT(Depth <= gkMaxTraversalDepth);
+
+    // Build data isn't needed anymore
+    mBuildTriangles.clear();
+    mBuildTriangles.shrink_to_fit();
+    mNodes.shrink_to_fit();
+    mPackets.shrink_to_fit();
+}
+
+void CTriangleBVH::Clear()
+{
+    mBuildTriangles.clear();
+    mNodes.clear();
+    mPackets.clear();
+    mNumTriangles = 0;
+}
+
+uint32 CTriangleBVH::BuildRecursive(uint32 NodeIdx, uint32 Start, uint32 End, uint32 Depth)
+{
+    // Compute bounds
+    CVector3f BoundsMin = mBuildTriangles[Start].Min, BoundsMax = mBuildTriangles[Start].Max;
+    CVector3f CenterMin = mBuildTriangles[Start].Center, CenterMax = CenterMin;
+
+    for (uint32 iTri = Start + 1; iTri < End; iTri++)
+    {
+        const SBuildTriangle& rkTri = mBuildTriangles[iTri];
+        BoundsMin = ComponentMin(BoundsMin, rkTri.Min);
+        BoundsMax = ComponentMax(BoundsMax, rkTri.Max);
+        CenterMin = ComponentMin(CenterMin, rkTri.Center);
+        CenterMax = ComponentMax(CenterMax, rkTri.Center);
+    }
+
+    SNode& rNode = mNodes[NodeIdx];
+    rNode.BoundsMin[0] = BoundsMin.X; rNode.BoundsMin[1] = BoundsMin.Y; rNode.BoundsMin[2] = BoundsMin.Z;
+    rNode.BoundsMax[0] = BoundsMax.X; rNode.BoundsMax[1] = BoundsMax.Y; rNode.BoundsMax[2] = BoundsMax.Z;
+
+    uint32 Count = End - Start;
+    uint32 Mid = Start;
+
+    if (Count > 4 && Depth < gkMaxSAHDepth)
+    {
+        // Binned SAH split. Costs are counted in packets since that's what a leaf is tested in.
+        float BestCost = std::numeric_limits<float>::max();
+        uint32 BestAxis = 0, BestBin = 0;
+
+        for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+        {
+            float AxisMin = Component(CenterMin, iAxis);
+            float AxisExtent = Component(CenterMax, iAxis) - AxisMin;
+            if (AxisExtent <= 0.f) continue;
+
+            struct SBin { CVector3f Min, Max; uint32 Count = 0; };
+            SBin Bins[gkNumSAHBins];
+            float BinScale = gkNumSAHBins / AxisExtent;
+
+            for (uint32 iTri = Start; iTri < End; iTri++)
+            {
+                const SBuildTriangle& rkTri = mBuildTriangles[iTri];
+                uint32 Bin = Math::Min<uint32>((uint32) ((Component(rkTri.Center, iAxis) - AxisMin) * BinScale), gkNumSAHBins - 1);
+                SBin& rBin = Bins[Bin];
+
+                rBin.Min = (rBin.Count == 0 ? rkTri.Min : ComponentMin(rBin.Min, rkTri.Min));
+                rBin.Max = (rBin.Count == 0 ? rkTri.Max : ComponentMax(rBin.Max, rkTri.Max));
+                rBin.Count++;
+            }
+
+            // Sweep from the right to get the area/count of everything past each split plane
+            float RightArea[gkNumSAHBins];
+            uint32 RightCount[gkNumSAHBins];
+            CVector3f AccumMin, AccumMax;
+            uint32 AccumCount = 0;
+
+            for (uint32 iBin = gkNumSAHBins - 1; iBin > 0; iBin--)
+            {
+                const SBin& rkBin = Bins[iBin];
+
+                if (rkBin.Count > 0)
+                {
+                    AccumMin = (AccumCount == 0 ? rkBin.Min : ComponentMin(AccumMin, rkBin.Min));
+                    AccumMax = (AccumCount == 0 ? rkBin.Max : ComponentMax(AccumMax, rkBin.Max));
+                    AccumCount += rkBin.Count;
+                }
+
+                RightArea[iBin] = (AccumCount > 0 ? SurfaceArea(AccumMin, AccumMax) : 0.f);
+                RightCount[iBin] = AccumCount;
+            }
+
+            AccumCount = 0;
+
+            for (uint32 iBin = 0; iBin < gkNumSAHBins - 1; iBin++)
+            {
+                const SBin& rkBin = Bins[iBin];
+
+                if (rkBin.Count > 0)
+                {
+                    AccumMin = (AccumCount == 0 ? rkBin.Min : ComponentMin(AccumMin, rkBin.Min));
+                    AccumMax = (AccumCount == 0 ? rkBin.Max : ComponentMax(AccumMax, rkBin.Max));
+                    AccumCount += rkBin.Count;
+                }
+
+                if (AccumCount == 0 || RightCount[iBin + 1] == 0) continue;
+
+                float LeftPackets = (float) ((AccumCount + 3) / 4);
+                float RightPackets = (float) ((RightCount[iBin + 1] + 3) / 4);
+                float Cost = SurfaceArea(AccumMin, AccumMax) * LeftPackets + RightArea[iBin + 1] * RightPackets;
+
+                if (Cost < BestCost)
+                {
+                    BestCost = Cost;
+                    BestAxis = iAxis;
+                    BestBin = iBin;
+                }
+            }
+        }
+
+        float NodeArea = SurfaceArea(BoundsMin, BoundsMax);
+        float LeafCost = NodeArea * gkPacketCost * ((Count + 3) / 4);
+        float SplitCost = NodeArea * gkTraversalCost + BestCost * gkPacketCost;
+
+        if (BestCost < std::numeric_limits<float>::max() && (Count > gkMaxLeafTriangles || SplitCost < LeafCost))
+        {
+            float AxisMin = Component(CenterMin, BestAxis);
+            float BinScale = gkNumSAHBins / (Component(CenterMax, BestAxis) - AxisMin);
+
+            auto SplitIt = std::partition(mBuildTriangles.begin() + Start, mBuildTriangles.begin() + End,
+                [=](const SBuildTriangle& rkTri) {
+                    uint32 Bin = Math::Min<uint32>((uint32) ((Component(rkTri.Center, BestAxis) - AxisMin) * BinScale), gkNumSAHBins - 1);
+                    return Bin <= BestBin;
+                });
+
+            Mid = (uint32) (SplitIt - mBuildTriangles.begin());
+        }
+    }
+
+    // Fall back to a median split if SAH couldn't separate the triangles (e.g. every center is
+    // in the same spot) but there are too many of them for a leaf
+    if ((Mid == Start || Mid == End) && Count > gkMaxLeafTriangles)
+    {
+        CVector3f Extent = BoundsMax - BoundsMin;
+        uint32 Axis = (Extent.X > Extent.Y ? (Extent.X > Extent.Z ? 0 : 2) : (Extent.Y > Extent.Z ? 1 : 2));
+        Mid = Start + Count / 2;
+
+        std::nth_element(mBuildTriangles.begin() + Start, mBuildTriangles.begin() + Mid, mBuildTriangles.begin() + End,
+            [Axis](const SBuildTriangle& rkA, const SBuildTriangle& rkB) {
+                return Component(rkA.Center, Axis) < Component(rkB.Center, Axis);
+            });
+    }
+
+    // Leaf
+    if (Mid == Start || Mid == End)
+    {
+        uint32 FirstPacket = mPackets.size();
+        uint32 NumPackets = (Count + 3) / 4;
+        mPackets.resize(FirstPacket + NumPackets);
+
+        for (uint32 iPacket = 0; iPacket < NumPackets; iPacket++)
+        {
+            // Unused lanes are left as degenerate triangles, which never pass the determinant test
+            STrianglePacket& rPacket = mPackets[FirstPacket + iPacket];
+            memset(&rPacket, 0, sizeof(STrianglePacket));
+
+            for (uint32 iLane = 0; iLane < 4; iLane++)
+            {
+                uint32 TriIdx = Start + (iPacket * 4) + iLane;
+                if (TriIdx >= End) break;
+
+                const SBuildTriangle& rkTri = mBuildTriangles[TriIdx];
+                CVector3f Edge1 = rkTri.Vtx[1] - rkTri.Vtx[0];
+                CVector3f Edge2 = rkTri.Vtx[2] - rkTri.Vtx[0];
+
+                for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+                {
+                    rPacket.Vtx[iAxis][iLane] = Component(rkTri.Vtx[0], iAxis);
+                    rPacket.Edge1[iAxis][iLane] = Component(Edge1, iAxis);
+                    rPacket.Edge2[iAxis][iLane] = Component(Edge2, iAxis);
+                }
+                rPacket.IDs[iLane] = rkTri.ID;
+            }
+        }
+
+        rNode.Index = FirstPacket;
+        rNode.Count = NumPackets;
+        return 1;
+    }
+
+    // Branch; children are stored next to each other. Note rNode is invalidated by this
+    uint32 ChildIdx = mNodes.size();
+    mNodes[NodeIdx].Index = ChildIdx;
+    mNodes[NodeIdx].Count = 0;
+    mNodes.emplace_back();
+    mNodes.emplace_back();
+
+    uint32 LeftDepth = BuildRecursive(ChildIdx, Start, Mid, Depth + 1);
+    uint32 RightDepth = BuildRecursive(ChildIdx + 1, Mid, End, Depth + 1);
+    return Math::Max(LeftDepth, RightDepth) + 1;
+}
+
+std::pair<bool,float> CTriangleBVH::IntersectsRay(const CRay& rkRay, bool AllowBackfaces /*= false*/, uint32 *pOutID /*= nullptr*/) const
+{
+    if (mNodes.empty())
+        return std::pair<bool,float>(false, 0.f);
+
+    SRayData Ray;
+    const CVector3f& rkOrigin = rkRay.Origin();
+    const CVector3f& rkDir = rkRay.Direction();
+    Ray.Origin[0] = rkOrigin.X; Ray.Origin[1] = rkOrigin.Y; Ray.Origin[2] = rkOrigin.Z;
+    Ray.Dir[0] = rkDir.X; Ray.Dir[1] = rkDir.Y; Ray.Dir[2] = rkDir.Z;
+    Ray.AllowBackfaces = AllowBackfaces;
+
+    for (uint32 iAxis = 0; iAxis < 3; iAxis++)
+        Ray.InvDir[iAxis] = 1.f / Ray.Dir[iAxis];
+
+    float BestDist = std::numeric_limits<float>::infinity();
+    uint32 BestID = 0;
+    bool Hit = false;
+
+    const SNode& rkRoot = mNodes[0];
+    if (RayBoxEntry(rkRoot.BoundsMin, rkRoot.BoundsMax, Ray.Origin, Ray.InvDir, BestDist) == std::numeric_limits<float>::infinity())
+        return std::pair<bool,float>(false, 0.f);
+
+    uint32 Stack[gkMaxTraversalDepth * 2];
+    uint32 StackSize = 0;
+    Stack[StackSize++] = 0;
+
+    while (StackSize > 0)
+    {
+        const SNode& rkNode = mNodes[Stack[--StackSize]];
+
+        if (rkNode.Count > 0)
+        {
+            for (uint32 iPacket = 0; iPacket < rkNode.Count; iPacket++)
+                Hit |= IntersectPacket(mPackets[rkNode.Index + iPacket], Ray, BestDist, BestID);
+
+            continue;
+        }
+
+        // Visit the nearer child first so farther subtrees can be culled by the best hit so far
+        const SNode& rkLeft = mNodes[rkNode.Index];
+        const SNode& rkRight = mNodes[rkNode.Index + 1];
+        float LeftEntry = RayBoxEntry(rkLeft.BoundsMin, rkLeft.BoundsMax, Ray.Origin, Ray.InvDir, BestDist);
+        float RightEntry = RayBoxEntry(rkRight.BoundsMin, rkRight.BoundsMax, Ray.Origin, Ray.InvDir, BestDist);
+        bool LeftHit = (LeftEntry < BestDist);
+        bool RightHit = (RightEntry < BestDist);
+
+        if (LeftHit && RightHit)
+        {
+            bool LeftFirst = (LeftEntry <= RightEntry);
+            Stack[StackSize++] = rkNode.Index + (LeftFirst ? 1 : 0);
+            Stack[StackSize++] = rkNode.Index + (LeftFirst ? 0 : 1);
+        }
+        else if (LeftHit)
+            Stack[StackSize++] = rkNode.Index;
+        else if (RightHit)
+            Stack[StackSize++] = rkNode.Index + 1;
+    }
+
+    if (Hit && pOutID)
+        *pOutID = BestID;
+
+    return std::pair<bool,float>(Hit, BestDist);
+}
+
+CAABox CTriangleBVH::Bounds() const
+{
+    if (mNodes.empty())
+        return CAABox::skInfinite;
+
+    const SNode& rkRoot = mNodes[0];
+    return CAABox(CVector3f(rkRoot.BoundsMin[0], rkRoot.BoundsMin[1], rkRoot.BoundsMin[2]),
+                  CVector3f(rkRoot.BoundsMax[0], rkRoot.BoundsMax[1], rkRoot.BoundsMax[2]));
+}
@@ -0,0 +1,70 @@
+#ifndef CTRIANGLEBVH_H
+#define CTRIANGLEBVH_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CAABox.h>
+#include <Common/Math/CRay.h>
+#include <Common/Math/CVector3f.h>
+#include <vector>
+
+/**
+ * Bounding volume hierarchy over a triangle soup, for ray picking.
+ * Triangles are added with an ID, then Build() is called once. Leaves hold packets of up to
+ * four triangles in SoA layout, so a leaf is tested against the ray in one go (with SSE where
+ * available). Backface handling matches Math::RayTriangleIntersection: when backfaces aren't
+ * allowed, only triangles wound counter-clockwise from the ray's point of view can be hit.
+ */
+class CTriangleBVH
+{
+    struct SNode
+    {
+        float BoundsMin[3];
+        float BoundsMax[3];
+        uint32 Index; // First child for branches, first packet for leaves
+        uint32 Count; // Number of packets in a leaf; 0 for branches
+    };
+
+    struct STrianglePacket
+    {
+        float Vtx[3][4];   // First vertex of each triangle
+        float Edge1[3][4]; // B - A
+        float Edge2[3][4]; // C - A
+        uint32 IDs[4];
+    };
+
+    struct SBuildTriangle
+    {
+        CVector3f Vtx[3];
+        CVector3f Min, Max, Center;
+        uint32 ID;
+    };
+
+    struct SRayData;
+
+    std::vector<SBuildTriangle> mBuildTriangles;
+    std::vector<SNode> mNodes;
+    std::vector<STrianglePacket> mPackets;
+    uint32 mNumTriangles;
+
+public:
+    CTriangleBVH();
+
+    void Reserve(uint32 NumTriangles);
+    void AddTriangle(const CVector3f& rkA, const CVector3f& rkB, const CVector3f& rkC, uint32 ID = 0);
+    void Build();
+    void Clear();
+
+    // Returns the distance to the nearest hit, if any. pOutID receives the ID of the triangle that was hit.
+    std::pair<bool,float> IntersectsRay(const CRay& rkRay, bool AllowBackfaces = false, uint32 *pOutID = nullptr) const;
+
+    inline bool IsBuilt() const             { return !mNodes.empty() || mNumTriangles == 0; }
+    inline uint32 NumTriangles() const      { return mNumTriangles; }
+    inline uint32 NumNodes() const          { return mNodes.size(); }
+    CAABox Bounds() const;
+
+protected:
+    uint32 BuildRecursive(uint32 NodeIdx, uint32 Start, uint32 End, uint32 Depth);
+    static bool IntersectPacket(const STrianglePacket& rkPacket, const SRayData& rkRay, float& rBestDist, uint32& rBestID);
+};
+
+#endif // CTRIANGLEBVH_H
@@ -1,5 +1,9 @@
 #include "CompressionUtil.h"
+#include "ParallelUtil.h"
 #include <Common/Common.h>
+#include <Common/Math/MathUtil.h>
+#include <atomic>
+#include <mutex>
 
 #if USE_LZOKAY
 #include <lzokay.hpp>
@@ -11,6 +15,15 @@
 
 namespace CompressionUtil
 {
+    // Segmented data is split into segments of this size, aside from the last segment
+    const uint32 gkSegmentSize = 0x4000;
+
+    // Size of the chunks that compressed data is read from input streams in
+    const uint32 gkStreamChunkSize = 0x4000;
+
+    // Segmented buffers smaller than this are processed on the calling thread; it isn't worth spinning up workers for them
+    const uint32 gkMinParallelSegmentedSize = 0x40000;
+
     const char* ErrorText_zlib(int32 Error)
     {
         switch (Error)
@@ -66,32 +79,132 @@ namespace CompressionUtil
     }
 #endif
 
-    // ************ DECOMPRESS ************
-    bool DecompressZlib(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    // ************ CODEC CONTEXT ************
+    int32 ZlibLevel(ECompressionLevel Level)
+    {
+        switch (Level)
+        {
+        case ECompressionLevel::Fast:       return 1;
+        case ECompressionLevel::Default:    return 6;
+        default:                            return 9;
+        }
+    }
+
+#if !USE_LZOKAY
+    static std::once_flag gLZOInitFlag;
+#endif
+
+    CCodecContext::CCodecContext()
+        : mpInflateStream(nullptr)
+        , mpDeflateStream(nullptr)
+        , mDeflateLevel(-1)
     {
-        // Initialize z_stream
-        z_stream z;
-        z.zalloc = Z_NULL;
-        z.zfree = Z_NULL;
-        z.opaque = Z_NULL;
-        z.avail_in = SrcLen;
-        z.next_in = pSrc;
-        z.avail_out = DstLen;
-        z.next_out = pDst;
+#if !USE_LZOKAY
+        std::call_once(gLZOInitFlag, []() { lzo_init(); });
+#endif
+    }
 
-        // Attempt decompress
-        int32 Error = inflateInit(&z);
+    CCodecContext::~CCodecContext()
+    {
+        if (mpInflateStream)
+        {
+            inflateEnd(mpInflateStream);
+            delete mpInflateStream;
+        }
+
+        if (mpDeflateStream)
+        {
+            deflateEnd(mpDeflateStream);
+            delete mpDeflateStream;
+        }
+    }
 
-        if (!Error)
+    z_stream_s* CCodecContext::InflateStream()
+    {
+        // The inflate state is allocated once and reset between uses
+        if (mpInflateStream)
         {
-            Error = inflate(&z, Z_NO_FLUSH);
+            inflateReset(mpInflateStream);
+            return mpInflateStream;
+        }
 
-            if (!Error || Error == Z_STREAM_END)
-                Error = inflateEnd(&z);
+        z_stream *pStream = new z_stream;
+        pStream->zalloc = Z_NULL;
+        pStream->zfree = Z_NULL;
+        pStream->opaque = Z_NULL;
+        pStream->avail_in = 0;
+        pStream->next_in = Z_NULL;
 
-            rTotalOut = z.total_out;
+        int32 Error = inflateInit(pStream);
+
+        if (Error)
+        {
+            errorf("zlib error: %s", ErrorText_zlib(Error));
+            delete pStream;
+            return nullptr;
         }
 
+        mpInflateStream = pStream;
+        return mpInflateStream;
+    }
+
+    z_stream_s* CCodecContext::DeflateStream(int32 Level)
+    {
+        // The deflate state is allocated once per compression level and reset between uses
+        if (mpDeflateStream && mDeflateLevel == Level)
+        {
+            deflateReset(mpDeflateStream);
+            return mpDeflateStream;
+        }
+
+        if (mpDeflateStream)
+        {
+            deflateEnd(mpDeflateStream);
+            delete mpDeflateStream;
+            mpDeflateStream = nullptr;
+        }
+
+        z_stream *pStream = new z_stream;
+        pStream->zalloc = Z_NULL;
+        pStream->zfree = Z_NULL;
+        pStream->opaque = Z_NULL;
+
+        int32 Error = deflateInit(pStream, Level);
+
+        if (Error)
+        {
+            errorf("zlib error: %s", ErrorText_zlib(Error));
+            delete pStream;
+            return nullptr;
+        }
+
+        mpDeflateStream = pStream;
+        mDeflateLevel = Level;
+        return mpDeflateStream;
+    }
+
+    uint8* CCodecContext::StagingBuffer(uint32 Size)
+    {
+        if (mStagingBuffer.size() < Size)
+            mStagingBuffer.resize(Size);
+
+        return mStagingBuffer.data();
+    }
+
+    bool CCodecContext::DecompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    {
+        z_stream *pStream = InflateStream();
+        if (!pStream) return false;
+
+        pStream->avail_in = SrcLen;
+        pStream->next_in = (Bytef*) pSrc;
+        pStream->avail_out = DstLen;
+        pStream->next_out = pDst;
+
+        // Attempt decompress
+        int32 Error = inflate(pStream, Z_NO_FLUSH);
+        rTotalOut = pStream->total_out;
+
         // Check for errors
         if (Error && Error != Z_STREAM_END)
         {
@@ -102,7 +215,46 @@ namespace CompressionUtil
         else return true;
     }
 
-    bool DecompressLZO(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut)
+    bool CCodecContext::DecompressZlib(IInputStream& rSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    {
+        z_stream *pStream = InflateStream();
+        if (!pStream) return false;
+
+        pStream->avail_out = DstLen;
+        pStream->next_out = pDst;
+
+        // Feed the input to zlib in chunks so the whole compressed buffer never needs to be in memory at once
+        uint8 *pChunk = StagingBuffer(gkStreamChunkSize);
+        uint32 Remaining = SrcLen;
+        int32 Error = Z_OK;
+
+        while (Remaining > 0 && Error == Z_OK && pStream->avail_out > 0)
+        {
+            uint32 ChunkSize = Math::Min(Remaining, gkStreamChunkSize);
+            rSrc.ReadBytes(pChunk, ChunkSize);
+            Remaining -= ChunkSize;
+
+            pStream->avail_in = ChunkSize;
+            pStream->next_in = pChunk;
+            Error = inflate(pStream, Z_NO_FLUSH);
+        }
+
+        // Always leave the stream at the end of the compressed data
+        if (Remaining > 0)
+            rSrc.Seek(Remaining, SEEK_CUR);
+
+        rTotalOut = pStream->total_out;
+
+        if (Error && Error != Z_STREAM_END)
+        {
+            errorf("zlib error: %s", ErrorText_zlib(Error));
+            return false;
+        }
+
+        else return true;
+    }
+
+    bool CCodecContext::DecompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut)
     {
 #if USE_LZOKAY
         lzokay::EResult Result = lzokay::decompress(pSrc, (size_t) SrcLen, pDst, (size_t&) rTotalOut);
@@ -115,7 +267,6 @@ namespace CompressionUtil
 
         return true;
 #else
-        lzo_init();
         lzo_uint TotalOut;
         int32 Error = lzo1x_decompress(pSrc, SrcLen, pDst, &TotalOut, LZO1X_MEM_DECOMPRESS);
         rTotalOut = (uint32) TotalOut;
@@ -130,9 +281,180 @@ namespace CompressionUtil
 #endif
     }
 
-    bool DecompressSegmentedData(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen)
+    bool CCodecContext::CompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level /*= ECompressionLevel::Max*/)
+    {
+        z_stream *pStream = DeflateStream( ZlibLevel(Level) );
+        if (!pStream) return false;
+
+        pStream->avail_in = SrcLen;
+        pStream->next_in = (Bytef*) pSrc;
+        pStream->avail_out = DstLen;
+        pStream->next_out = pDst;
+
+        int32 Error = deflate(pStream, Z_FINISH);
+        rTotalOut = pStream->total_out;
+
+        // If the stream didn't finish, the output buffer was too small
+        if (Error == Z_OK)
+            Error = Z_BUF_ERROR;
+
+        if (Error && Error != Z_STREAM_END)
+        {
+            errorf("zlib error: %s", ErrorText_zlib(Error));
+            return false;
+        }
+
+        else return true;
+    }
+
+    bool CCodecContext::CompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level /*= ECompressionLevel::Max*/)
+    {
+#if USE_LZOKAY
+        // lzokay only has one compressor, so the level is ignored
+        (void) Level;
+        rTotalOut = DstLen;
+        lzokay::EResult Result = lzokay::compress(pSrc, (size_t) SrcLen, pDst, (size_t&) rTotalOut);
+
+        if (Result < lzokay::EResult::Success)
+        {
+            errorf("LZO error: %s", ErrorText_LZO(Result));
+            return false;
+        }
+
+        return true;
+#else
+        // Work memory is sized for LZO1X-999, which needs more than LZO1X-1
+        if (mLZOWorkMem.empty())
+            mLZOWorkMem.resize(LZO1X_999_MEM_COMPRESS);
+
+        int32 Error;
+
+        if (Level == ECompressionLevel::Fast)
+            Error = lzo1x_1_compress(pSrc, SrcLen, pDst, (lzo_uint*) &rTotalOut, mLZOWorkMem.data());
+        else
+            Error = lzo1x_999_compress(pSrc, SrcLen, pDst, (lzo_uint*) &rTotalOut, mLZOWorkMem.data());
+
+        if (Error)
+        {
+            errorf("LZO error: %s", ErrorText_LZO(Error));
+            return false;
+        }
+
+        return true;
+#endif
+    }
+
+    CCodecContext& CCodecContext::ThreadContext()
+    {
+        static thread_local CCodecContext sContext;
+        return sContext;
+    }
+
+    // ************ DECOMPRESS ************
+    bool DecompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    {
+        return CCodecContext::ThreadContext().DecompressZlib(pSrc, SrcLen, pDst, DstLen, rTotalOut);
+    }
+
+    bool DecompressZlib(IInputStream& rSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    {
+        return CCodecContext::ThreadContext().DecompressZlib(rSrc, SrcLen, pDst, DstLen, rTotalOut);
+    }
+
+    bool DecompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut)
+    {
+        return CCodecContext::ThreadContext().DecompressLZO(pSrc, SrcLen, pDst, rTotalOut);
+    }
+
+    // Segment of a segmented buffer, located by scanning the segment headers ahead of decompression
+    struct SSegmentInfo
+    {
+        const uint8 *pkSrc;
+        uint32 SrcSize;
+        uint32 DstOffset;
+        uint32 DstSize;
+        bool Compressed;
+    };
+
+    bool ScanSegments(const uint8 *pSrc, uint32 SrcLen, uint32 DstLen, std::vector<SSegmentInfo>& rOutSegments)
+    {
+        // Every segment but the last decompresses to exactly gkSegmentSize bytes, so the destination offset
+        // of each segment is known up front. Returns false if the headers don't add up to the expected sizes.
+        const uint8 *pSrcEnd = pSrc + SrcLen;
+        uint32 DstOffset = 0;
+
+        while ((pSrc < pSrcEnd) && (DstOffset < DstLen))
+        {
+            if (pSrcEnd - pSrc < 2)
+                return false;
+
+            int16 Size = (pSrc[0] << 8) | pSrc[1];
+            pSrc += 2;
+
+            SSegmentInfo Segment;
+            Segment.pkSrc = pSrc;
+            Segment.Compressed = (Size >= 0);
+            Segment.SrcSize = (Segment.Compressed ? (uint32) Size : (uint32) -((int32) Size));
+            Segment.DstOffset = DstOffset;
+            Segment.DstSize = (Segment.Compressed ? Math::Min(gkSegmentSize, DstLen - DstOffset) : Segment.SrcSize);
+
+            if (Segment.SrcSize > (uint32) (pSrcEnd - pSrc) || Segment.DstSize > DstLen - DstOffset)
+                return false;
+
+            pSrc += Segment.SrcSize;
+            DstOffset += Segment.DstSize;
+            rOutSegments.push_back(Segment);
+        }
+
+        return ((pSrc == pSrcEnd) && (DstOffset == DstLen));
+    }
+
+    bool DecompressSegment(const SSegmentInfo& rkSegment, uint8 *pDst)
     {
-        uint8 *pSrcEnd = pSrc + SrcLen;
+        uint8 *pSegmentDst = pDst + rkSegment.DstOffset;
+
+        if (!rkSegment.Compressed)
+        {
+            memcpy(pSegmentDst, rkSegment.pkSrc, rkSegment.SrcSize);
+            return true;
+        }
+
+        uint16 PeekMagic = (rkSegment.pkSrc[0] << 8) | rkSegment.pkSrc[1];
+        uint32 TotalOut = 0;
+        bool Success;
+
+        if (PeekMagic == 0x78DA || PeekMagic == 0x789C || PeekMagic == 0x7801)
+            Success = DecompressZlib(rkSegment.pkSrc, rkSegment.SrcSize, pSegmentDst, rkSegment.DstSize, TotalOut);
+        else
+            Success = DecompressLZO(rkSegment.pkSrc, rkSegment.SrcSize, pSegmentDst, TotalOut);
+
+        return Success && (TotalOut == rkSegment.DstSize);
+    }
+
+    bool DecompressSegmentedData(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen)
+    {
+        // Large buffers are decompressed one segment per task. If the segment headers don't match the
+        // layout we expect, or a segment doesn't decompress to the expected size, fall back on decoding in order.
+        if (DstLen >= gkMinParallelSegmentedSize && !ParallelUtil::IsWorkerThread())
+        {
+            std::vector<SSegmentInfo> Segments;
+
+            if (ScanSegments(pSrc, SrcLen, DstLen, Segments))
+            {
+                std::atomic<bool> Failed(false);
+
+                ParallelUtil::ParallelFor(Segments.size(), [&](uint32 SegmentIdx)
+                {
+                    if (!DecompressSegment(Segments[SegmentIdx], pDst))
+                        Failed = true;
+                });
+
+                if (!Failed)
+                    return true;
+            }
+        }
+
+        const uint8 *pSrcEnd = pSrc + SrcLen;
         uint8 *pDstEnd = pDst + DstLen;
 
         while ((pSrc < pSrcEnd) && (pDst < pDstEnd))
@@ -182,127 +504,159 @@ namespace CompressionUtil
         return ((pSrc == pSrcEnd) && (pDst == pDstEnd));
     }
 
-    // ************ COMPRESS ************
-    bool CompressZlib(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    bool DecompressSegmentedData(IInputStream& rSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen)
     {
-        z_stream z;
-        z.zalloc = Z_NULL;
-        z.zfree = Z_NULL;
-        z.opaque = Z_NULL;
-        z.avail_in = SrcLen;
-        z.next_in = pSrc;
-        z.avail_out = DstLen;
-        z.next_out = pDst;
-
-        int32 Error = deflateInit(&z, 9);
-
-        if (!Error)
+        // Segments are read from the stream one at a time, so only one segment ever needs to be buffered
+        CCodecContext& rContext = CCodecContext::ThreadContext();
+        uint8 *pDstEnd = pDst + DstLen;
+        uint32 SrcRead = 0;
+
+        while ((SrcRead < SrcLen) && (pDst < pDstEnd))
         {
-            Error = deflate(&z, Z_FINISH);
+            // Read size value (this method is Endian-independent)
+            uint8 ByteA = rSrc.ReadByte();
+            uint8 ByteB = rSrc.ReadByte();
+            int16 Size = (ByteA << 8) | ByteB;
+            SrcRead += 2;
+
+            // Negative size denotes uncompressed data; read it straight into the destination.
+            if (Size < 0)
+            {
+                Size = -Size;
+                rSrc.ReadBytes(pDst, Size);
+                SrcRead += Size;
+                pDst += Size;
+            }
 
-            if (!Error || Error == Z_STREAM_END)
-                Error = deflateEnd(&z);
+            // If size is positive then we have compressed data.
+            else
+            {
+                uint8 *pSegment = rContext.StagingBuffer(Size);
+                rSrc.ReadBytes(pSegment, Size);
+                SrcRead += Size;
 
-            rTotalOut = z.total_out;
-        }
+                uint16 PeekMagic = (pSegment[0] << 8) | pSegment[1];
+                uint32 TotalOut;
+                bool Success;
 
-        if (Error && Error != Z_STREAM_END)
-        {
-            errorf("zlib error: %s", ErrorText_zlib(Error));
-            return false;
+                if (PeekMagic == 0x78DA || PeekMagic == 0x789C || PeekMagic == 0x7801)
+                    Success = rContext.DecompressZlib(pSegment, Size, pDst, (uint32) (pDstEnd - pDst), TotalOut);
+                else
+                    Success = rContext.DecompressLZO(pSegment, Size, pDst, TotalOut);
+
+                if (!Success) return false;
+                pDst += TotalOut;
+            }
         }
 
-        else return true;
+        return ((SrcRead == SrcLen) && (pDst == pDstEnd));
     }
 
-    bool CompressLZO(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut)
+    // ************ COMPRESS ************
+    bool CompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level /*= ECompressionLevel::Max*/)
     {
-#if USE_LZOKAY
-        rTotalOut = DstLen;
-        lzokay::EResult Result = lzokay::compress(pSrc, (size_t) SrcLen, pDst, (size_t&) rTotalOut);
+        return CCodecContext::ThreadContext().CompressZlib(pSrc, SrcLen, pDst, DstLen, rTotalOut, Level);
+    }
 
-        if (Result < lzokay::EResult::Success)
-        {
-            errorf("LZO error: %s", ErrorText_LZO(Result));
-            return false;
-        }
+    bool CompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level /*= ECompressionLevel::Max*/)
+    {
+        return CCodecContext::ThreadContext().CompressLZO(pSrc, SrcLen, pDst, DstLen, rTotalOut, Level);
+    }
 
-        return true;
-#else
-        lzo_init();
+    void CompressSegment(const uint8 *pSrc, uint16 Size, std::vector<uint8>& rOutCompressed, uint32& rOutCompressedSize, bool IsZlib, ECompressionLevel Level)
+    {
+        rOutCompressed.resize(Size * 2);
 
-        uint8 *pWorkMem = new uint8[LZO1X_999_MEM_COMPRESS];
-        int32 Error = lzo1x_999_compress(pSrc, SrcLen, pDst, (lzo_uint*) &rTotalOut, pWorkMem);
-        delete[] pWorkMem;
+        if (IsZlib)
+            CompressZlib(pSrc, Size, rOutCompressed.data(), rOutCompressed.size(), rOutCompressedSize, Level);
+        else
+            CompressLZO(pSrc, Size, rOutCompressed.data(), rOutCompressed.size(), rOutCompressedSize, Level);
+    }
 
-        if (Error)
+    uint8* WriteSegment(const uint8 *pSrc, uint16 Size, const std::vector<uint8>& rkCompressed, uint32 TotalOut, uint8 *pDst, bool AllowUncompressedSegments)
+    {
+        // Verify that the compressed data is actually smaller.
+        if (AllowUncompressedSegments && TotalOut >= Size)
         {
-            errorf("LZO error: %s", ErrorText_LZO(Error));
-            return false;
+            // Write negative size value to destination (which signifies uncompressed)
+            *pDst++ = -Size >> 8;
+            *pDst++ = -Size & 0xFF;
+
+            // Write original uncompressed data to destination
+            memcpy(pDst, pSrc, Size);
+            TotalOut = Size;
         }
 
-        return true;
-#endif
+        // If it IS smaller, write the compressed data
+        else
+        {
+            // Write new compressed size + data to destination
+            *pDst++ = (TotalOut >> 8) & 0xFF;
+            *pDst++ = (TotalOut & 0xFF);
+            memcpy(pDst, rkCompressed.data(), TotalOut);
+        }
+
+        return pDst + TotalOut;
     }
 
-    bool CompressSegmentedData(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool IsZlib, bool AllowUncompressedSegments)
+    bool CompressSegmentedData(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool IsZlib, bool AllowUncompressedSegments, ECompressionLevel Level /*= ECompressionLevel::Max*/)
     {
-        uint8 *pSrcEnd = pSrc + SrcLen;
+        // Each segment is compressed separately. Segment size should always be 0x4000 unless there's less than 0x4000 bytes left.
         uint8 *pDstStart = pDst;
+        uint32 NumSegments = (SrcLen + gkSegmentSize - 1) / gkSegmentSize;
 
-        while (pSrc < pSrcEnd)
+        auto SegmentSize = [&](uint32 SegmentIdx) -> uint16
         {
-            // Each segment is compressed separately. Segment size should always be 0x4000 unless there's less than 0x4000 bytes left.
-            uint16 Size;
-            uint32 Remaining = (uint32) (pSrcEnd - pSrc);
+            uint32 Remaining = SrcLen - (SegmentIdx * gkSegmentSize);
+            return (uint16) Math::Min(Remaining, gkSegmentSize);
+        };
 
-            if (Remaining < 0x4000) Size = (uint16) Remaining;
-            else Size = 0x4000;
-
-            std::vector<uint8> Compressed(Size * 2);
-            uint32 TotalOut;
-
-            if (IsZlib)
-                CompressZlib(pSrc, Size, Compressed.data(), Compressed.size(), TotalOut);
-            else
-                CompressLZO(pSrc, Size, Compressed.data(), Compressed.size(), TotalOut);
+        // Large buffers have all their segments compressed up front, one segment per task. The output is then
+        // assembled in order, so it's identical to compressing one segment at a time.
+        if (SrcLen >= gkMinParallelSegmentedSize && !ParallelUtil::IsWorkerThread())
+        {
+            std::vector< std::vector<uint8> > CompressedSegments(NumSegments);
+            std::vector<uint32> CompressedSizes(NumSegments, 0);
 
-            // Verify that the compressed data is actually smaller.
-            if (AllowUncompressedSegments && TotalOut >= Size)
+            ParallelUtil::ParallelFor(NumSegments, [&](uint32 SegmentIdx)
             {
-                // Write negative size value to destination (which signifies uncompressed)
-                *pDst++ = -Size >> 8;
-                *pDst++ = -Size & 0xFF;
+                const uint8 *pSegmentSrc = pSrc + (SegmentIdx * gkSegmentSize);
+                CompressSegment(pSegmentSrc, SegmentSize(SegmentIdx), CompressedSegments[SegmentIdx], CompressedSizes[SegmentIdx], IsZlib, Level);
+            });
 
-                // Write original uncompressed data to destination
-                memcpy(pDst, pSrc, Size);
-                TotalOut = Size;
+            for (uint32 SegmentIdx = 0; SegmentIdx < NumSegments; SegmentIdx++)
+            {
+                const uint8 *pSegmentSrc = pSrc + (SegmentIdx * gkSegmentSize);
+                pDst = WriteSegment(pSegmentSrc, SegmentSize(SegmentIdx), CompressedSegments[SegmentIdx], CompressedSizes[SegmentIdx], pDst, AllowUncompressedSegments);
             }
+        }
 
-            // If it IS smaller, write the compressed data
-            else
+        else
+        {
+            std::vector<uint8> Compressed;
+
+            for (uint32 SegmentIdx = 0; SegmentIdx < NumSegments; SegmentIdx++)
             {
-                // Write new compressed size + data to destination
-                *pDst++ = (TotalOut >> 8) & 0xFF;
-                *pDst++ = (TotalOut & 0xFF);
-                memcpy(pDst, Compressed.data(), TotalOut);
-            }
+                const uint8 *pSegmentSrc = pSrc + (SegmentIdx * gkSegmentSize);
+                uint16 Size = SegmentSize(SegmentIdx);
+                uint32 TotalOut;
 
-            pSrc += Size;
-            pDst += TotalOut;
+                CompressSegment(pSegmentSrc, Size, Compressed, TotalOut, IsZlib, Level);
+                pDst = WriteSegment(pSegmentSrc, Size, Compressed, TotalOut, pDst, AllowUncompressedSegments);
+            }
         }
 
         rTotalOut = (uint32) (pDst - pDstStart);
         return true;
     }
 
-    bool CompressZlibSegmented(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments)
+    bool CompressZlibSegmented(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments, ECompressionLevel Level /*= ECompressionLevel::Max*/)
     {
-        return CompressSegmentedData(pSrc, SrcLen, pDst, rTotalOut, true, AllowUncompressedSegments);
+        return CompressSegmentedData(pSrc, SrcLen, pDst, rTotalOut, true, AllowUncompressedSegments, Level);
     }
 
-    bool CompressLZOSegmented(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments)
+    bool CompressLZOSegmented(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments, ECompressionLevel Level /*= ECompressionLevel::Max*/)
     {
-        return CompressSegmentedData(pSrc, SrcLen, pDst, rTotalOut, false, AllowUncompressedSegments);
+        return CompressSegmentedData(pSrc, SrcLen, pDst, rTotalOut, false, AllowUncompressedSegments, Level);
     }
 }
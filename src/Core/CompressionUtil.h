@@ -4,20 +4,70 @@
 #include <Common/BasicTypes.h>
 #include <Common/FileIO.h>
 #include <Common/TString.h>
+#include <vector>
+
+struct z_stream_s;
 
 namespace CompressionUtil
 {
+    // How much effort to spend on compression. Higher levels produce smaller output but take longer.
+    // Every level produces data the game can read; decompression speed is unaffected.
+    enum class ECompressionLevel
+    {
+        Fast,       // zlib level 1, LZO1X-1
+        Default,    // zlib level 6, LZO1X-999
+        Max         // zlib level 9, LZO1X-999
+    };
+
+    // Holds zlib/LZO state that is expensive to set up, so it can be reused across many calls instead of being
+    // initialized and torn down every time. A context must only be used by one thread at a time; the free functions
+    // below use the calling thread's context.
+    class CCodecContext
+    {
+        z_stream_s *mpInflateStream;
+        z_stream_s *mpDeflateStream;
+        int32 mDeflateLevel;
+        std::vector<uint8> mLZOWorkMem;
+        std::vector<uint8> mStagingBuffer;
+
+        z_stream_s* InflateStream();
+        z_stream_s* DeflateStream(int32 Level);
+
+    public:
+        CCodecContext();
+        ~CCodecContext();
+
+        bool DecompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut);
+        bool DecompressZlib(IInputStream& rSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut);
+        bool DecompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut);
+        bool CompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level = ECompressionLevel::Max);
+        bool CompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level = ECompressionLevel::Max);
+
+        // Scratch memory owned by the context; contents are only valid until the next call that uses it
+        uint8* StagingBuffer(uint32 Size);
+
+        static CCodecContext& ThreadContext();
+
+        CCodecContext(const CCodecContext&) = delete;
+        CCodecContext& operator=(const CCodecContext&) = delete;
+    };
+
     // Decompression
-    bool DecompressZlib(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut);
-    bool DecompressLZO(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut);
-    bool DecompressSegmentedData(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen);
+    // Source buffers are never written to, so they can point into read-only memory (such as a mapped pak).
+    bool DecompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut);
+    bool DecompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut);
+    bool DecompressSegmentedData(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen);
+
+    // Streaming decompression; reads SrcLen bytes of compressed data from the stream in small chunks
+    bool DecompressZlib(IInputStream& rSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut);
+    bool DecompressSegmentedData(IInputStream& rSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen);
 
     // Compression
-    bool CompressZlib(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut);
-    bool CompressLZO(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut);
-    bool CompressSegmentedData(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool IsZlib, bool AllowUncompressedSegments);
-    bool CompressZlibSegmented(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments);
-    bool CompressLZOSegmented(uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments);
+    bool CompressZlib(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level = ECompressionLevel::Max);
+    bool CompressLZO(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32 DstLen, uint32& rTotalOut, ECompressionLevel Level = ECompressionLevel::Max);
+    bool CompressSegmentedData(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool IsZlib, bool AllowUncompressedSegments, ECompressionLevel Level = ECompressionLevel::Max);
+    bool CompressZlibSegmented(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments, ECompressionLevel Level = ECompressionLevel::Max);
+    bool CompressLZOSegmented(const uint8 *pSrc, uint32 SrcLen, uint8 *pDst, uint32& rTotalOut, bool AllowUncompressedSegments, ECompressionLevel Level = ECompressionLevel::Max);
 }
 
 #endif // COMPRESSIONUTIL_H
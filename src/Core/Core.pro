@@ -160,6 +160,7 @@ HEADERS += \
     Scene/FShowFlags.h \
     Scene/CScene.h \
     Scene/CSceneIterator.h \
+    Scene/CSceneNodeTree.h \
     Resource/CPoiToWorld.h \
     Resource/Factory/CPoiToWorldLoader.h \
     Resource/Cooker/CPoiToWorldCooker.h \
@@ -246,7 +247,23 @@ HEADERS += \
     Resource/Script/Property/CGuidProperty.h \
     Resource/Script/CGameTemplate.h \
     Resource/Script/NPropertyMap.h \
-    Resource/Script/NGameList.h
+    Resource/Script/NGameList.h \
+    Resource/Script/CTemplateCache.h \
+    ParallelUtil.h \
+    GameProject/CResourceCache.h \
+    CMappedFile.h \
+    GameProject/CCompressedAssetCache.h \
+    GameProject/CResourceDatabaseCache.h \
+    GameProject/CDependencyIndex.h \
+    GameProject/CResourceSearchIndex.h \
+    GameProject/CAsyncLoader.h \
+    Resource/Factory/NTexelDecode.h \
+    Resource/Model/CVertexArray.h \
+    CTriangleBVH.h \
+    NBenchmark.h \
+    CRC32Util.h \
+    TFlatHashSet.h \
+    TFlatHashMap.h
 
 # Source Files
 SOURCES += \
@@ -311,6 +328,7 @@ SOURCES += \
     Scene/FShowFlags.cpp \
     Scene/CScene.cpp \
     Scene/CSceneIterator.cpp \
+    Scene/CSceneNodeTree.cpp \
     Resource/CPoiToWorld.cpp \
     Resource/Factory/CPoiToWorldLoader.cpp \
     Resource/Cooker/CPoiToWorldCooker.cpp \
@@ -357,7 +375,21 @@ SOURCES += \
     Resource/Script/Property/CFlagsProperty.cpp \
     Resource/Script/CGameTemplate.cpp \
     Resource/Script/NPropertyMap.cpp \
-    Resource/Script/NGameList.cpp
+    Resource/Script/NGameList.cpp \
+    Resource/Script/CTemplateCache.cpp \
+    ParallelUtil.cpp \
+    GameProject/CResourceCache.cpp \
+    CMappedFile.cpp \
+    GameProject/CCompressedAssetCache.cpp \
+    GameProject/CResourceDatabaseCache.cpp \
+    GameProject/CDependencyIndex.cpp \
+    GameProject/CResourceSearchIndex.cpp \
+    GameProject/CAsyncLoader.cpp \
+    Resource/Factory/NTexelDecode.cpp \
+    Resource/Model/CVertexArray.cpp \
+    CTriangleBVH.cpp \
+    NBenchmark.cpp \
+    CRC32Util.cpp
 
 # Codegen
 CODEGEN_DIR = $$EXTERNALS_DIR/CodeGen
@@ -1,10 +1,70 @@
 #include "CAssetNameMap.h"
+#include <Common/FileIO.h>
+#include <Common/FileUtil.h>
+#include <algorithm>
+
+const uint32 gkBinaryNameMapMagic = FOURCC('ANMP');
+const uint32 gkBinaryNameMapVersion = 1;
+const uint32 gkBinaryNameMapHeaderSize = 0x28;
+
+enum EBinaryNameMapFlags : uint8
+{
+    eBNF_AutoGenName    = 0x1,
+    eBNF_AutoGenDir     = 0x2
+};
+
+uint64 CAssetNameMap::SAssetNameInfo::PathKey() const
+{
+    // 64-bit FNV-1a over the uppercase path
+    uint64 Hash = 0xCBF29CE484222325ULL;
+
+    auto HashChars = [&Hash](const char *pkStr, uint32 Length)
+    {
+        for (uint32 CharIdx = 0; CharIdx < Length; CharIdx++)
+        {
+            char Chr = pkStr[CharIdx];
+            if (Chr >= 'a' && Chr <= 'z') Chr -= 0x20;
+            Hash = (Hash ^ (uint8) Chr) * 0x100000001B3ULL;
+        }
+    };
+
+    // The type is hashed from its raw value, in the same character order as its string form
+    uint32 TypeValue = Type.ToLong();
+    char TypeChars[4] = { (char) (TypeValue >> 24), (char) (TypeValue >> 16), (char) (TypeValue >> 8), (char) TypeValue };
+
+    HashChars(*Directory, Directory.Size());
+    HashChars(*Name, Name.Size());
+    HashChars(".", 1);
+    HashChars(TypeChars, 4);
+    return Hash;
+}
+
+CAssetNameMap::CAssetNameMap(EIDLength IDLength)
+    : mIsValid(true)
+    , mIDLength(IDLength)
+    , mpkBinaryIndex(nullptr)
+    , mpkBinaryStrings(nullptr)
+    , mNumBinaryEntries(0)
+{
+    ASSERT(mIDLength != kInvalidIDLength);
+}
+
+CAssetNameMap::CAssetNameMap(EGame Game)
+    : CAssetNameMap( CAssetID::GameIDLength(Game) )
+{
+}
 
 bool CAssetNameMap::LoadAssetNames(TString Path /*= ""*/)
 {
     if (Path.IsEmpty())
         Path = DefaultNameMapPath(mIDLength);
 
+    // Prefer the binary copy of the map if it's up to date with the XML
+    TString BinaryPath = BinaryNameMapPath(Path);
+
+    if (LoadBinary(BinaryPath, Path))
+        return true;
+
     CXMLReader Reader(Path);
 
     if (Reader.IsValid())
@@ -14,6 +74,10 @@ bool CAssetNameMap::LoadAssetNames(TString Path /*= ""*/)
         if (FileIDLength == mIDLength)
         {
             Serialize(Reader);
+
+            if (mIsValid)
+                SaveBinary(BinaryPath, Path);
+
             return true;
         }
         else
@@ -36,14 +100,42 @@ bool CAssetNameMap::SaveAssetNames(TString Path /*= ""*/)
     if (Path.IsEmpty())
         Path = DefaultNameMapPath(mIDLength);
 
+    UnpackBinary();
+
     EGame Game = (mIDLength == k32Bit ? EGame::Prime : EGame::Corruption);
-    CXMLWriter Writer(Path, "AssetNameMap", 0, Game);
-    Serialize(Writer);
-    return Writer.Save();
+    bool Success;
+    {
+        CXMLWriter Writer(Path, "AssetNameMap", 0, Game);
+        Serialize(Writer);
+        Success = Writer.Save();
+    }
+
+    if (Success && mIsValid)
+        SaveBinary(BinaryNameMapPath(Path), Path);
+
+    return Success;
 }
 
 bool CAssetNameMap::GetNameInfo(CAssetID ID, TString& rOutDirectory, TString& rOutName, bool& rOutAutoGenDir, bool& rOutAutoGenName)
 {
+    if (mpkBinaryIndex)
+    {
+        uint64 IntegralID = ID.ToLongLong();
+        const SBinaryIndexEntry *pkEnd = mpkBinaryIndex + mNumBinaryEntries;
+        const SBinaryIndexEntry *pkFind = std::lower_bound(mpkBinaryIndex, pkEnd, IntegralID,
+            [](const SBinaryIndexEntry& rkEntry, uint64 Value) { return rkEntry.ID < Value; });
+
+        if (pkFind != pkEnd && pkFind->ID == IntegralID && ID.Length() == mIDLength)
+        {
+            SAssetNameInfo Info = BinaryEntryInfo(*pkFind);
+            rOutName = Info.Name;
+            rOutDirectory = Info.Directory;
+            rOutAutoGenDir = Info.AutoGenDir;
+            rOutAutoGenName = Info.AutoGenName;
+            return true;
+        }
+    }
+
     auto It = mMap.find(ID);
 
     if (It != mMap.end())
@@ -71,6 +163,7 @@ void CAssetNameMap::CopyFromStore(CResourceStore *pStore /*= gpResourceStore*/)
 {
     // Do a first pass to remove old paths from used set to prevent false positives from eg. if two resources switch places
     ASSERT( CAssetID::GameIDLength(pStore->Game()) == mIDLength );
+    UnpackBinary();
 
     for (CResourceIterator It(pStore); It; ++It)
     {
@@ -81,7 +174,7 @@ void CAssetNameMap::CopyFromStore(CResourceStore *pStore /*= gpResourceStore*/)
             if (Find != mMap.end())
             {
                 SAssetNameInfo& rInfo = Find->second;
-                auto UsedFind = mUsedSet.find(rInfo);
+                auto UsedFind = mUsedSet.find(rInfo.PathKey());
                 ASSERT(UsedFind != mUsedSet.end());
                 mUsedSet.erase(UsedFind);
             }
@@ -104,12 +197,12 @@ void CAssetNameMap::CopyFromStore(CResourceStore *pStore /*= gpResourceStore*/)
             SAssetNameInfo NameInfo { Name, Directory, Type, AutoName, AutoDir };
 
             // Check for conflicts with new name
-            if (mUsedSet.find(NameInfo) != mUsedSet.end())
+            if (mUsedSet.find(NameInfo.PathKey()) != mUsedSet.end())
             {
                 SAssetNameInfo NewNameInfo = NameInfo;
                 int NumConflicted = 0;
 
-                while (mUsedSet.find(NewNameInfo) != mUsedSet.end())
+                while (mUsedSet.find(NewNameInfo.PathKey()) != mUsedSet.end())
                 {
                     NewNameInfo.Name = NameInfo.Name + '_' + TString::FromInt32(NumConflicted, 0, 10);
                     NumConflicted++;
@@ -125,7 +218,7 @@ void CAssetNameMap::CopyFromStore(CResourceStore *pStore /*= gpResourceStore*/)
 
             // Assign to map
             mMap[ID] = NameInfo;
-            mUsedSet.insert(NameInfo);
+            mUsedSet.insert(NameInfo.PathKey());
         }
     }
 }
@@ -144,19 +237,19 @@ void CAssetNameMap::PostLoadValidate()
     // Make sure the newly loaded map doesn't contain any errors or name conflicts.
     bool FoundErrors = false;
     mIsValid = false;
-    std::set<SAssetNameInfo> Dupes;
+    std::vector<SAssetNameInfo> Dupes;
+    mUsedSet.clear();
+    mUsedSet.reserve(mMap.size());
 
     for (auto Iter = mMap.begin(); Iter != mMap.end(); Iter++)
     {
         const SAssetNameInfo& rkInfo = Iter->second;
 
-        if (mUsedSet.find(rkInfo) != mUsedSet.end())
-            Dupes.insert(rkInfo);
+        if (!mUsedSet.insert(rkInfo.PathKey()).second)
+            Dupes.push_back(rkInfo);
 
         else
         {
-            mUsedSet.insert(rkInfo);
-
             // Verify the name/path is valid
             if (!CResourceStore::IsValidResourcePath(rkInfo.Directory, rkInfo.Name))
             {
@@ -191,6 +284,172 @@ void CAssetNameMap::PostLoadValidate()
         mIsValid = !FoundErrors;
 }
 
+bool CAssetNameMap::LoadBinary(const TString& rkPath, const TString& rkXMLPath)
+{
+    if (!FileUtil::Exists(rkPath) || !FileUtil::Exists(rkXMLPath))
+        return false;
+
+    CMappedFile& rFile = mBinaryMap;
+
+    if (!rFile.Open(rkPath))
+        return false;
+
+    CMemoryInStream Header(rFile.Data(), (uint32) std::min<uint64>(rFile.Size(), gkBinaryNameMapHeaderSize), EEndian::LittleEndian);
+
+    if (Header.Size() < gkBinaryNameMapHeaderSize)
+    {
+        rFile.Close();
+        return false;
+    }
+
+    uint32 Magic = Header.ReadLong();
+    uint32 Version = Header.ReadLong();
+    uint32 IDLength = Header.ReadLong();
+    uint32 NumEntries = Header.ReadLong();
+    uint64 XMLModifiedTime = Header.ReadLongLong();
+    uint64 XMLSize = Header.ReadLongLong();
+    uint32 StringTableSize = Header.ReadLong();
+
+    // A binary map that doesn't match the XML is ignored; the XML is loaded instead and the binary map rewritten
+    if (Magic != gkBinaryNameMapMagic || Version != gkBinaryNameMapVersion || IDLength != (uint32) mIDLength ||
+        XMLModifiedTime != FileUtil::LastModifiedTime(rkXMLPath) || XMLSize != FileUtil::FileSize(rkXMLPath))
+    {
+        rFile.Close();
+        return false;
+    }
+
+    uint64 IndexSize = (uint64) NumEntries * sizeof(SBinaryIndexEntry);
+    const SBinaryIndexEntry *pkIndex = (const SBinaryIndexEntry*) rFile.DataAt(gkBinaryNameMapHeaderSize, IndexSize);
+    const char *pkStrings = (const char*) rFile.DataAt(gkBinaryNameMapHeaderSize + IndexSize, StringTableSize);
+
+    if (!pkIndex || !pkStrings)
+    {
+        rFile.Close();
+        return false;
+    }
+
+    for (uint32 EntryIdx = 0; EntryIdx < NumEntries; EntryIdx++)
+    {
+        const SBinaryIndexEntry& rkEntry = pkIndex[EntryIdx];
+
+        if ((uint64) rkEntry.StringOffset + rkEntry.DirectoryLength + rkEntry.NameLength > StringTableSize)
+        {
+            warnf("Binary asset name map is corrupt; loading XML instead: %s", *rkPath);
+            rFile.Close();
+            return false;
+        }
+    }
+
+    // Binary maps are only written from valid maps, so the entries don't need to be validated again
+    mMap.clear();
+    mUsedSet.clear();
+    mpkBinaryIndex = pkIndex;
+    mpkBinaryStrings = pkStrings;
+    mNumBinaryEntries = NumEntries;
+    mIsValid = true;
+    return true;
+}
+
+bool CAssetNameMap::SaveBinary(const TString& rkPath, const TString& rkXMLPath) const
+{
+    // Build the string table and index; mMap is already sorted by ID
+    std::vector<SBinaryIndexEntry> Index;
+    std::vector<char> Strings;
+    Index.reserve(mMap.size());
+
+    for (auto Iter = mMap.begin(); Iter != mMap.end(); Iter++)
+    {
+        const SAssetNameInfo& rkInfo = Iter->second;
+
+        if (rkInfo.Directory.Size() > 0xFFFF || rkInfo.Name.Size() > 0xFFFF)
+        {
+            warnf("Asset path is too long to store in a binary name map: %s", *rkInfo.FullPath());
+            return false;
+        }
+
+        SBinaryIndexEntry Entry = {};
+        Entry.ID = Iter->first.ToLongLong();
+        Entry.StringOffset = Strings.size();
+        Entry.Type = rkInfo.Type.ToLong();
+        Entry.DirectoryLength = (uint16) rkInfo.Directory.Size();
+        Entry.NameLength = (uint16) rkInfo.Name.Size();
+        Entry.Flags = (rkInfo.AutoGenName ? eBNF_AutoGenName : 0) | (rkInfo.AutoGenDir ? eBNF_AutoGenDir : 0);
+        Index.push_back(Entry);
+
+        Strings.insert(Strings.end(), *rkInfo.Directory, *rkInfo.Directory + rkInfo.Directory.Size());
+        Strings.insert(Strings.end(), *rkInfo.Name, *rkInfo.Name + rkInfo.Name.Size());
+    }
+
+    // Write to a temp file first, since this map's own binary map may still be mapped from the destination
+    TString TempPath = rkPath + ".tmp";
+    {
+        CFileOutStream File(TempPath, EEndian::LittleEndian);
+
+        if (!File.IsValid())
+        {
+            warnf("Unable to open binary asset name map for writing: %s", *TempPath);
+            return false;
+        }
+
+        File.WriteLong(gkBinaryNameMapMagic);
+        File.WriteLong(gkBinaryNameMapVersion);
+        File.WriteLong((uint32) mIDLength);
+        File.WriteLong(Index.size());
+        File.WriteLongLong(FileUtil::LastModifiedTime(rkXMLPath));
+        File.WriteLongLong(FileUtil::FileSize(rkXMLPath));
+        File.WriteLong(Strings.size());
+        File.WriteLong(0);
+
+        // The index is written as-is so it can be used straight from the mapped file
+        if (!Index.empty())   File.WriteBytes(Index.data(), Index.size() * sizeof(SBinaryIndexEntry));
+        if (!Strings.empty()) File.WriteBytes(Strings.data(), Strings.size());
+    }
+
+    if (FileUtil::Exists(rkPath))
+        FileUtil::DeleteFile(rkPath);
+
+    if (!FileUtil::MoveFile(TempPath, rkPath))
+    {
+        warnf("Failed to save binary asset name map: %s", *rkPath);
+        FileUtil::DeleteFile(TempPath);
+        return false;
+    }
+
+    return true;
+}
+
+void CAssetNameMap::UnpackBinary()
+{
+    if (!mpkBinaryIndex)
+        return;
+
+    mUsedSet.reserve(mNumBinaryEntries);
+
+    for (uint32 EntryIdx = 0; EntryIdx < mNumBinaryEntries; EntryIdx++)
+    {
+        const SBinaryIndexEntry& rkEntry = mpkBinaryIndex[EntryIdx];
+        SAssetNameInfo Info = BinaryEntryInfo(rkEntry);
+        mUsedSet.insert(Info.PathKey());
+        mMap.emplace_hint(mMap.end(), CAssetID(rkEntry.ID, mIDLength), std::move(Info));
+    }
+
+    mpkBinaryIndex = nullptr;
+    mpkBinaryStrings = nullptr;
+    mNumBinaryEntries = 0;
+    mBinaryMap.Close();
+}
+
+CAssetNameMap::SAssetNameInfo CAssetNameMap::BinaryEntryInfo(const SBinaryIndexEntry& rkEntry) const
+{
+    SAssetNameInfo Info;
+    Info.Directory = TString(mpkBinaryStrings + rkEntry.StringOffset, rkEntry.DirectoryLength);
+    Info.Name = TString(mpkBinaryStrings + rkEntry.StringOffset + rkEntry.DirectoryLength, rkEntry.NameLength);
+    Info.Type = CFourCC(rkEntry.Type);
+    Info.AutoGenName = (rkEntry.Flags & eBNF_AutoGenName) != 0;
+    Info.AutoGenDir = (rkEntry.Flags & eBNF_AutoGenDir) != 0;
+    return Info;
+}
+
 TString CAssetNameMap::DefaultNameMapPath(EIDLength IDLength)
 {
     ASSERT(IDLength != kInvalidIDLength);
@@ -202,3 +461,8 @@ TString CAssetNameMap::DefaultNameMapPath(EGame Game)
 {
     return DefaultNameMapPath( CAssetID::GameIDLength(Game) );
 }
+
+TString CAssetNameMap::BinaryNameMapPath(const TString& rkXMLPath)
+{
+    return rkXMLPath.GetFilePathWithoutExtension() + "." + gkAssetMapBinaryExt;
+}
@@ -3,13 +3,16 @@
 
 #include "CResourceIterator.h"
 #include "CResourceStore.h"
+#include "Core/CMappedFile.h"
 #include <Common/CAssetID.h>
 #include <Common/Serialization/XML.h>
 #include <map>
 #include <memory>
+#include <unordered_set>
 
 const TString gkAssetMapPath = "../resources/gameinfo/AssetNameMap";
 const TString gkAssetMapExt = "xml";
+const TString gkAssetMapBinaryExt = "bin";
 
 class CAssetNameMap
 {
@@ -35,10 +38,9 @@ class CAssetNameMap
                  << SerialParameter("AutoGenDir", AutoGenDir);
         }
 
-        bool operator<(const SAssetNameInfo& rkOther) const
-        {
-            return FullPath().ToUpper() < rkOther.FullPath().ToUpper();
-        }
+        // Case-insensitive hash of the full path, used for conflict detection. Computed straight from the
+        // path components, so it doesn't need to build the full path or an uppercase copy of it.
+        uint64 PathKey() const;
 
         bool operator==(const SAssetNameInfo& rkOther) const
         {
@@ -46,18 +48,43 @@ class CAssetNameMap
         }
     };
 
-    std::set<SAssetNameInfo> mUsedSet; // Used to prevent name conflicts
+    // Entry in the ID index of a binary name map; the index is sorted by ID, and the directory
+    // and name strings are stored in a string table after the index
+    struct SBinaryIndexEntry
+    {
+        uint64 ID;
+        uint32 StringOffset;
+        uint32 Type;
+        uint16 DirectoryLength;
+        uint16 NameLength;
+        uint8 Flags;
+        uint8 Padding[3];
+    };
+    static_assert(sizeof(SBinaryIndexEntry) == 0x18, "Binary name map index entries must be 0x18 bytes");
+
+    std::unordered_set<uint64> mUsedSet; // Path keys of every entry; used to prevent name conflicts
     std::map<CAssetID, SAssetNameInfo> mMap;
     bool mIsValid;
     EIDLength mIDLength;
 
+    // A map loaded from a binary file is looked up straight from the mapped index, and is only
+    // unpacked into mMap if it needs to be modified
+    CMappedFile mBinaryMap;
+    const SBinaryIndexEntry *mpkBinaryIndex;
+    const char *mpkBinaryStrings;
+    uint32 mNumBinaryEntries;
+
     // Private Methods
     void Serialize(IArchive& rArc);
     void PostLoadValidate();
+    bool LoadBinary(const TString& rkPath, const TString& rkXMLPath);
+    bool SaveBinary(const TString& rkPath, const TString& rkXMLPath) const;
+    void UnpackBinary();
+    SAssetNameInfo BinaryEntryInfo(const SBinaryIndexEntry& rkEntry) const;
 
 public:
-    CAssetNameMap(EIDLength IDLength) : mIsValid(true), mIDLength(IDLength)                       { ASSERT(mIDLength != kInvalidIDLength); }
-    CAssetNameMap(EGame Game)         : mIsValid(true), mIDLength( CAssetID::GameIDLength(Game) ) { ASSERT(mIDLength != kInvalidIDLength); }
+    CAssetNameMap(EIDLength IDLength);
+    CAssetNameMap(EGame Game);
     bool LoadAssetNames(TString Path = "");
     bool SaveAssetNames(TString Path = "");
     bool GetNameInfo(CAssetID ID, TString& rOutDirectory, TString& rOutName, bool& rOutAutoGenDir, bool& rOutAutoGenName);
@@ -65,6 +92,7 @@ public:
 
     static TString DefaultNameMapPath(EIDLength IDLength);
     static TString DefaultNameMapPath(EGame Game);
+    static TString BinaryNameMapPath(const TString& rkXMLPath);
 
     inline bool IsValid() const                 { return mIsValid; }
     inline static TString GetExtension()        { return gkAssetMapExt; }
@@ -0,0 +1,266 @@
+#include "CAsyncLoader.h"
+#include "CResourceEntry.h"
+#include "CResourceStore.h"
+#include "Core/CMappedFile.h"
+#include "Core/ParallelUtil.h"
+#include <Common/Macros.h>
+#include <algorithm>
+
+CAsyncLoader::CAsyncLoader(uint32 NumThreads /*= 0*/)
+    : mNumThreads(NumThreads)
+    , mNumQueued(0)
+    , mNextSequence(0)
+    , mStopping(false)
+{
+    // Parsing is serialized, so a few workers are enough to keep file reads ahead of it
+    if (mNumThreads == 0)
+        mNumThreads = std::min<uint32>(std::max<uint32>(ParallelUtil::DefaultThreadCount() / 2, 1), 4);
+}
+
+CAsyncLoader::~CAsyncLoader()
+{
+    Shutdown();
+}
+
+void CAsyncLoader::RequestLoad(CResourceEntry *pEntry, int32 Priority, const void *pkOwner, FLoadCallback Callback)
+{
+    ASSERT(pEntry);
+    ASSERT(pEntry->ResourceStore() == gpResourceStore);
+    bool IsLoaded = pEntry->IsLoaded();
+    TString FilePath;
+
+    if (!IsLoaded && !IsLoadPending(pEntry))
+        FilePath = (pEntry->HasRawVersion() ? pEntry->RawAssetPath() : pEntry->CookedAssetPath());
+
+    std::unique_lock<std::mutex> Lock(mMutex);
+    auto Iter = mRequests.find(pEntry);
+
+    if (Iter == mRequests.end())
+    {
+        SRequest Request;
+        Request.State = (IsLoaded ? ERequestState::Loaded : ERequestState::Queued);
+        Request.Priority = Priority;
+        Request.Sequence = mNextSequence++;
+        Request.FilePath = FilePath;
+        Request.Succeeded = IsLoaded;
+        Iter = mRequests.emplace(pEntry, std::move(Request)).first;
+
+        if (!IsLoaded)
+            mNumQueued++;
+    }
+
+    else if (Iter->second.State == ERequestState::Queued)
+        Iter->second.Priority = std::min(Iter->second.Priority, Priority);
+
+    Iter->second.Callbacks.push_back( SCallback { pkOwner, std::move(Callback) } );
+    bool ShouldWake = (Iter->second.State == ERequestState::Queued);
+
+    if (ShouldWake && mWorkers.empty())
+    {
+        for (uint32 ThreadIdx = 0; ThreadIdx < mNumThreads; ThreadIdx++)
+            mWorkers.emplace_back(&CAsyncLoader::WorkerThread, this);
+    }
+
+    Lock.unlock();
+
+    if (ShouldWake)
+        mWorkCondition.notify_one();
+}
+
+void CAsyncLoader::SetPriority(CResourceEntry *pEntry, int32 Priority)
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    auto Iter = mRequests.find(pEntry);
+
+    if (Iter != mRequests.end() && Iter->second.State == ERequestState::Queued)
+        Iter->second.Priority = Priority;
+}
+
+void CAsyncLoader::CancelCallbacks(const void *pkOwner)
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    auto IsOwnedCallback = [pkOwner](const SCallback& rkCallback) { return rkCallback.pkOwner == pkOwner; };
+    auto Iter = mRequests.begin();
+
+    while (Iter != mRequests.end())
+    {
+        std::vector<SCallback>& rCallbacks = Iter->second.Callbacks;
+        rCallbacks.erase( std::remove_if(rCallbacks.begin(), rCallbacks.end(), IsOwnedCallback), rCallbacks.end() );
+
+        if (rCallbacks.empty() && Iter->second.State == ERequestState::Queued)
+        {
+            mNumQueued--;
+            Iter = mRequests.erase(Iter);
+        }
+
+        else Iter++;
+    }
+
+    // The owner may be cancelling from inside another callback
+    for (auto& rPair : mDelivering)
+    {
+        std::vector<SCallback>& rCallbacks = rPair.second.Callbacks;
+        rCallbacks.erase( std::remove_if(rCallbacks.begin(), rCallbacks.end(), IsOwnedCallback), rCallbacks.end() );
+    }
+}
+
+void CAsyncLoader::RemoveEntry(CResourceEntry *pEntry)
+{
+    std::unique_lock<std::mutex> Lock(mMutex);
+
+    for (auto& rPair : mDelivering)
+    {
+        if (rPair.first == pEntry)
+            rPair.second.Callbacks.clear();
+    }
+
+    auto Iter = mRequests.find(pEntry);
+    if (Iter == mRequests.end()) return;
+
+    // Requests are only erased on the calling thread, so the iterator stays valid while we wait
+    mLoadedCondition.wait(Lock, [&Iter]() { return Iter->second.State != ERequestState::Loading; });
+
+    if (Iter->second.State == ERequestState::Queued)
+        mNumQueued--;
+
+    mRequests.erase(Iter);
+}
+
+uint32 CAsyncLoader::ProcessCompletedLoads()
+{
+    std::unique_lock<std::mutex> Lock(mMutex);
+    uint32 NumProcessed = 0;
+    auto Iter = mRequests.begin();
+
+    while (Iter != mRequests.end())
+    {
+        if (Iter->second.State == ERequestState::Loaded)
+        {
+            mDelivering.emplace_back(Iter->first, std::move(Iter->second));
+            Iter = mRequests.erase(Iter);
+            NumProcessed++;
+        }
+
+        else Iter++;
+    }
+
+    // Callbacks are taken out one at a time with the lock released, so they can make new requests or cancel other callbacks
+    while (!mDelivering.empty())
+    {
+        std::pair<CResourceEntry*, SRequest>& rPair = mDelivering.back();
+
+        if (rPair.second.Callbacks.empty())
+        {
+            mDelivering.pop_back();
+            continue;
+        }
+
+        CResourceEntry *pEntry = rPair.first;
+        bool Succeeded = rPair.second.Succeeded;
+        SCallback Callback = std::move(rPair.second.Callbacks.front());
+        rPair.second.Callbacks.erase(rPair.second.Callbacks.begin());
+        Lock.unlock();
+
+        // If nothing referenced the resource, it may have been unloaded since; Load() brings it back in that case
+        CResource *pRes = (Succeeded ? pEntry->Load() : nullptr);
+        Callback.Callback(pRes);
+        Lock.lock();
+    }
+
+    return NumProcessed;
+}
+
+void CAsyncLoader::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> Lock(mMutex);
+        mStopping = true;
+    }
+
+    mWorkCondition.notify_all();
+
+    for (std::thread& rWorker : mWorkers)
+        rWorker.join();
+
+    std::lock_guard<std::mutex> Lock(mMutex);
+    mWorkers.clear();
+    mRequests.clear();
+    mDelivering.clear();
+    mNumQueued = 0;
+    mStopping = false;
+}
+
+bool CAsyncLoader::IsLoadPending(CResourceEntry *pEntry) const
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    return mRequests.find(pEntry) != mRequests.end();
+}
+
+uint32 CAsyncLoader::NumPendingLoads() const
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    return mRequests.size();
+}
+
+// ************ PROTECTED ************
+void CAsyncLoader::WorkerThread()
+{
+    std::unique_lock<std::mutex> Lock(mMutex);
+
+    while (true)
+    {
+        mWorkCondition.wait(Lock, [this]() { return mStopping || mNumQueued > 0; });
+        if (mStopping) break;
+
+        // Take the most urgent request. The queue is only as long as the number of assets still streaming in,
+        // and entries can be reprioritized at any time, so a linear scan is simpler than keeping a heap in order.
+        auto Next = mRequests.end();
+
+        for (auto Iter = mRequests.begin(); Iter != mRequests.end(); Iter++)
+        {
+            const SRequest& rkRequest = Iter->second;
+            if (rkRequest.State != ERequestState::Queued) continue;
+
+            if (Next == mRequests.end() || rkRequest.Priority < Next->second.Priority ||
+                (rkRequest.Priority == Next->second.Priority && rkRequest.Sequence < Next->second.Sequence))
+            {
+                Next = Iter;
+            }
+        }
+
+        ASSERT(Next != mRequests.end());
+        CResourceEntry *pEntry = Next->first;
+        SRequest& rRequest = Next->second;
+        rRequest.State = ERequestState::Loading;
+        mNumQueued--;
+        TString FilePath = rRequest.FilePath;
+        Lock.unlock();
+
+        // Requests that are loading are never erased, so rRequest stays valid while the lock is released
+        ReadAhead(FilePath);
+        CResource *pRes = pEntry->Load();
+
+        Lock.lock();
+        rRequest.State = ERequestState::Loaded;
+        rRequest.Succeeded = (pRes != nullptr);
+        mLoadedCondition.notify_all();
+    }
+}
+
+void CAsyncLoader::ReadAhead(const TString& rkPath)
+{
+    // Touch every page of the file so it's in the OS file cache by the time the loader maps it
+    if (rkPath.IsEmpty()) return;
+    CMappedFile File(rkPath);
+    if (!File.IsValid()) return;
+
+    const uint8 *pkData = File.Data();
+    uint32 Checksum = 0;
+
+    for (uint64 Offset = 0; Offset < File.Size(); Offset += 4096)
+        Checksum += pkData[Offset];
+
+    // Keep the reads from being optimized out
+    volatile uint32 Sink = Checksum;
+    (void) Sink;
+}
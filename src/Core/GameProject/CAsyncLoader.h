@@ -0,0 +1,94 @@
+#ifndef CASYNCLOADER_H
+#define CASYNCLOADER_H
+
+#include <Common/BasicTypes.h>
+#include <Common/TString.h>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CResource;
+class CResourceEntry;
+
+/* Loads resources on worker threads, so the editor can keep running while assets stream in. Requests are
+ * handed out in priority order (lowest value first, so a distance from the camera works as a priority) and
+ * can be reprioritized until they start loading. Callbacks are never run on the workers; they're run from
+ * ProcessCompletedLoads, which the editor calls on the main thread every tick. GL objects aren't created on
+ * the workers either, since models and textures buffer themselves on the main thread the first time they're drawn.
+ *
+ * Resource loaders share global state (gpResourceStore, the store's loaded resource list, and the resources
+ * referenced by the asset being loaded), so resources are still parsed one at a time under
+ * CResourceEntry::LoadMutex(). Each worker reads its asset's file before taking the lock, so disk reads overlap
+ * with parsing on the other workers. Only entries from the current gpResourceStore can be requested; loads
+ * only write gpResourceStore when they switch to a different store, so the workers never write it while the
+ * main thread is reading it. */
+class CAsyncLoader
+{
+public:
+    typedef std::function<void(CResource*)> FLoadCallback;
+
+private:
+    enum class ERequestState
+    {
+        Queued, Loading, Loaded
+    };
+
+    struct SCallback
+    {
+        const void *pkOwner;
+        FLoadCallback Callback;
+    };
+
+    struct SRequest
+    {
+        ERequestState State;
+        int32 Priority;
+        uint64 Sequence;    // Requests with equal priority are loaded in the order they were made
+        TString FilePath;   // File to read ahead of loading; looked up on the main thread
+        bool Succeeded;
+        std::vector<SCallback> Callbacks;
+    };
+
+    std::map<CResourceEntry*, SRequest> mRequests;
+    std::vector< std::pair<CResourceEntry*, SRequest> > mDelivering; // Finished loads whose callbacks are being run
+    std::vector<std::thread> mWorkers;
+    uint32 mNumThreads;
+    uint32 mNumQueued;
+    uint64 mNextSequence;
+    bool mStopping;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWorkCondition;    // Signaled when a request is queued or the workers need to stop
+    std::condition_variable mLoadedCondition;  // Signaled when a load finishes
+
+public:
+    // NumThreads = 0 picks a thread count based on the hardware. Threads aren't started until the first request.
+    CAsyncLoader(uint32 NumThreads = 0);
+    ~CAsyncLoader();
+
+    // Queues the entry to be loaded; it must belong to gpResourceStore. The callback is passed the resource, or nullptr if it failed to load.
+    // If the entry is already loaded, the callback still runs from the next ProcessCompletedLoads call.
+    void RequestLoad(CResourceEntry *pEntry, int32 Priority, const void *pkOwner, FLoadCallback Callback);
+    // Only affects requests that haven't started loading yet
+    void SetPriority(CResourceEntry *pEntry, int32 Priority);
+    // Drops every callback registered by the owner; requests left without callbacks are dropped if they haven't started
+    void CancelCallbacks(const void *pkOwner);
+    // Drops any request for an entry that's about to be deleted, waiting for the load to finish if it's in progress
+    void RemoveEntry(CResourceEntry *pEntry);
+    // Runs the callbacks of every finished load; must be called on the main thread. Returns the number of loads processed.
+    uint32 ProcessCompletedLoads();
+    // Drops all requests and waits for the workers to finish their current loads
+    void Shutdown();
+
+    bool IsLoadPending(CResourceEntry *pEntry) const;
+    uint32 NumPendingLoads() const;
+
+protected:
+    void WorkerThread();
+    static void ReadAhead(const TString& rkPath);
+};
+
+#endif // CASYNCLOADER_H
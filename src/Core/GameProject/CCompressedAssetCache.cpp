@@ -0,0 +1,150 @@
+#include "CCompressedAssetCache.h"
+#include <Common/FileUtil.h>
+#include <Common/Macros.h>
+#include <Common/Hash/CFNV1A.h>
+
+const uint32 gkCacheMagic = FOURCC('CMPC');
+const uint32 gkCacheVersion = 1;
+
+CCompressedAssetCache::CCompressedAssetCache(const TString& rkPath, EGame Game)
+    : mPath(rkPath)
+    , mGame(Game)
+    , mNumNewEntries(0)
+{
+    LoadPrevCache();
+
+    FileUtil::MakeDirectory(mPath.GetFileDirectory());
+    mpNewCache = std::make_unique<CFileOutStream>(TempPath(), EEndian::LittleEndian);
+
+    if (mpNewCache->IsValid())
+    {
+        mpNewCache->WriteLong(gkCacheMagic);
+        mpNewCache->WriteLong(gkCacheVersion);
+        mpNewCache->WriteLong((uint32) mGame);
+        mpNewCache->WriteLong(0); // Entry count; filled in by Commit()
+    }
+    else
+    {
+        warnf("Unable to open compressed asset cache for writing: %s", *TempPath());
+        mpNewCache.reset();
+    }
+}
+
+CCompressedAssetCache::~CCompressedAssetCache()
+{
+    // If the cache was never committed, throw away the partial new cache and keep the previous one
+    if (mpNewCache)
+    {
+        mpNewCache->Close();
+        mpNewCache.reset();
+        FileUtil::DeleteFile(TempPath());
+    }
+}
+
+const CCompressedAssetCache::SEntry* CCompressedAssetCache::Find(const CAssetID& rkID, uint64 DataHash, uint32 UncompressedSize, CompressionUtil::ECompressionLevel Level) const
+{
+    auto Find = mPrevEntries.find(rkID);
+    if (Find == mPrevEntries.end()) return nullptr;
+
+    const SEntry& rkEntry = Find->second;
+
+    if (rkEntry.DataHash == DataHash && rkEntry.UncompressedSize == UncompressedSize && rkEntry.Level == Level)
+        return &rkEntry;
+    else
+        return nullptr;
+}
+
+void CCompressedAssetCache::Add(const CAssetID& rkID, const SEntry& rkEntry)
+{
+    if (!mpNewCache) return;
+
+    uint32 CompressedSize = (rkEntry.Compressed ? rkEntry.CompressedSize : 0);
+
+    rkID.Write(*mpNewCache);
+    mpNewCache->WriteLongLong(rkEntry.DataHash);
+    mpNewCache->WriteLong(rkEntry.UncompressedSize);
+    mpNewCache->WriteByte((uint8) rkEntry.Level);
+    mpNewCache->WriteByte(rkEntry.Compressed ? 1 : 0);
+    mpNewCache->WriteLong(CompressedSize);
+    mpNewCache->WriteBytes(rkEntry.pkCompressedData, CompressedSize);
+    mNumNewEntries++;
+}
+
+bool CCompressedAssetCache::Commit()
+{
+    if (!mpNewCache) return false;
+
+    mpNewCache->Seek(0xC, SEEK_SET);
+    mpNewCache->WriteLong(mNumNewEntries);
+    mpNewCache->Close();
+    mpNewCache.reset();
+
+    // Entries from the previous cache point into its mapping, so they have to go before the file can be replaced
+    mPrevEntries.clear();
+    mPrevCache.Close();
+
+    if (FileUtil::Exists(mPath))
+        FileUtil::DeleteFile(mPath);
+
+    if (!FileUtil::MoveFile(TempPath(), mPath))
+    {
+        warnf("Failed to save compressed asset cache: %s", *mPath);
+        FileUtil::DeleteFile(TempPath());
+        return false;
+    }
+
+    return true;
+}
+
+uint64 CCompressedAssetCache::HashData(const uint8 *pkData, uint32 Size)
+{
+    CFNV1A Hash(CFNV1A::k64Bit);
+    Hash.HashData(pkData, Size);
+    return Hash.GetHash64();
+}
+
+// ************ PROTECTED ************
+void CCompressedAssetCache::LoadPrevCache()
+{
+    if (!FileUtil::Exists(mPath) || !mPrevCache.Open(mPath))
+        return;
+
+    CMemoryInStream Cache(mPrevCache.Data(), (uint32) mPrevCache.Size(), EEndian::LittleEndian);
+    EIDLength IDLength = CAssetID::GameIDLength(mGame);
+    uint32 EntryHeaderSize = (IDLength == k32Bit ? 4 : 8) + 0x12;
+
+    if (Cache.Size() < 0x10)
+        return;
+
+    uint32 Magic = Cache.ReadLong();
+    uint32 Version = Cache.ReadLong();
+    EGame Game = (EGame) Cache.ReadLong();
+    uint32 NumEntries = Cache.ReadLong();
+
+    // An outdated cache is just ignored; it'll be replaced once the package is cooked
+    if (Magic != gkCacheMagic || Version != gkCacheVersion || Game != mGame)
+        return;
+
+    for (uint32 EntryIdx = 0; EntryIdx < NumEntries; EntryIdx++)
+    {
+        if (!mPrevCache.DataAt(Cache.Tell(), EntryHeaderSize))
+            break;
+
+        CAssetID ID(Cache, IDLength);
+
+        SEntry Entry;
+        Entry.DataHash = Cache.ReadLongLong();
+        Entry.UncompressedSize = Cache.ReadLong();
+        Entry.Level = (CompressionUtil::ECompressionLevel) Cache.ReadByte();
+        Entry.Compressed = (Cache.ReadByte() != 0);
+        Entry.CompressedSize = Cache.ReadLong();
+        Entry.pkCompressedData = mPrevCache.DataAt(Cache.Tell(), Entry.CompressedSize);
+
+        // Truncated file; keep whatever was read intact up to this point
+        if (!Entry.pkCompressedData)
+            break;
+
+        Cache.Seek(Entry.CompressedSize, SEEK_CUR);
+        mPrevEntries[ID] = Entry;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CCOMPRESSEDASSETCACHE_H
+#define CCOMPRESSEDASSETCACHE_H
+
+#include "Core/CMappedFile.h"
+#include "Core/CompressionUtil.h"
+#include <Common/CAssetID.h>
+#include <Common/EGame.h>
+#include <Common/FileIO.h>
+#include <Common/TString.h>
+#include <map>
+#include <memory>
+
+/* Remembers how each asset in a package was compressed the last time the package was cooked, so assets whose
+ * cooked data hasn't changed can be written to the new pak without being compressed again. A cached entry is
+ * only reused if the hash and size of the cooked data and the compression level all match.
+ *
+ * The previous cache is memory mapped rather than loaded. The new cache is streamed to a temporary file while
+ * the pak is written, and only replaces the previous one when Commit() is called, so a cancelled cook leaves
+ * the previous cache intact. */
+class CCompressedAssetCache
+{
+public:
+    struct SEntry
+    {
+        uint64 DataHash;
+        uint32 UncompressedSize;
+        CompressionUtil::ECompressionLevel Level;
+        bool Compressed; // False if compressing the asset didn't save any space, so it was stored uncompressed
+        const uint8 *pkCompressedData;
+        uint32 CompressedSize;
+    };
+
+private:
+    TString mPath;
+    EGame mGame;
+
+    CMappedFile mPrevCache;
+    std::map<CAssetID, SEntry> mPrevEntries;
+
+    std::unique_ptr<CFileOutStream> mpNewCache;
+    uint32 mNumNewEntries;
+
+public:
+    CCompressedAssetCache(const TString& rkPath, EGame Game);
+    ~CCompressedAssetCache();
+
+    // Find is safe to call from multiple threads at once, as long as Add isn't called at the same time
+    const SEntry* Find(const CAssetID& rkID, uint64 DataHash, uint32 UncompressedSize, CompressionUtil::ECompressionLevel Level) const;
+    void Add(const CAssetID& rkID, const SEntry& rkEntry);
+    bool Commit();
+
+    static uint64 HashData(const uint8 *pkData, uint32 Size);
+
+protected:
+    void LoadPrevCache();
+    inline TString TempPath() const { return mPath + ".tmp"; }
+};
+
+#endif // CCOMPRESSEDASSETCACHE_H
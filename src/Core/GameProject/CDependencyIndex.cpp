@@ -0,0 +1,150 @@
+#include "CDependencyIndex.h"
+#include "CDependencyTree.h"
+#include <Common/CAssetID.h>
+#include <algorithm>
+
+void CDependencyIndex::SetReferences(uint64 ID, std::vector<uint64> References)
+{
+    std::sort(References.begin(), References.end());
+    References.erase( std::unique(References.begin(), References.end()), References.end() );
+
+    std::lock_guard<std::mutex> Lock(mMutex);
+    SNode& rNode = FindOrCreateNode(ID);
+
+    // Walk the old and new lists together; only references that were added or removed touch other nodes
+    std::vector<uint64> OldReferences;
+    OldReferences.swap(rNode.References);
+    uint32 OldIdx = 0, NewIdx = 0;
+
+    while (OldIdx < OldReferences.size() || NewIdx < References.size())
+    {
+        bool TakeOld = (NewIdx == References.size() || (OldIdx < OldReferences.size() && OldReferences[OldIdx] < References[NewIdx]));
+        bool TakeNew = (OldIdx == OldReferences.size() || (NewIdx < References.size() && References[NewIdx] < OldReferences[OldIdx]));
+
+        if (TakeOld)
+        {
+            SNode *pRefNode = FindNode(OldReferences[OldIdx]);
+
+            if (pRefNode)
+            {
+                auto Iter = std::find(pRefNode->Referencers.begin(), pRefNode->Referencers.end(), ID);
+
+                if (Iter != pRefNode->Referencers.end())
+                {
+                    *Iter = pRefNode->Referencers.back();
+                    pRefNode->Referencers.pop_back();
+                }
+            }
+
+            OldIdx++;
+        }
+        else if (TakeNew)
+        {
+            FindOrCreateNode(References[NewIdx]).Referencers.push_back(ID);
+            NewIdx++;
+        }
+        else
+        {
+            OldIdx++;
+            NewIdx++;
+        }
+    }
+
+    // FindOrCreateNode may have reallocated the node list, so look the node up again
+    FindNode(ID)->References.swap(References);
+}
+
+void CDependencyIndex::SetReferences(uint64 ID, const CDependencyTree *pkTree)
+{
+    SetReferences(ID, FlattenReferences(ID, pkTree));
+}
+
+void CDependencyIndex::RemoveReferences(uint64 ID)
+{
+    SetReferences(ID, std::vector<uint64>());
+}
+
+void CDependencyIndex::Clear()
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    mNodeIndices.Clear();
+    mNodes.clear();
+}
+
+std::vector<uint64> CDependencyIndex::References(uint64 ID) const
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    const SNode *pkNode = FindNode(ID);
+    return (pkNode ? pkNode->References : std::vector<uint64>());
+}
+
+std::vector<uint64> CDependencyIndex::Referencers(uint64 ID) const
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    const SNode *pkNode = FindNode(ID);
+    return (pkNode ? pkNode->Referencers : std::vector<uint64>());
+}
+
+std::set<uint64> CDependencyIndex::AllReferencers(uint64 ID) const
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    std::set<uint64> Out;
+    std::vector<uint64> Queue(1, ID);
+
+    while (!Queue.empty())
+    {
+        uint64 CurID = Queue.back();
+        Queue.pop_back();
+        const SNode *pkNode = FindNode(CurID);
+        if (!pkNode) continue;
+
+        for (uint64 ReferencerID : pkNode->Referencers)
+        {
+            if (ReferencerID != ID && Out.insert(ReferencerID).second)
+                Queue.push_back(ReferencerID);
+        }
+    }
+
+    return Out;
+}
+
+std::vector<uint64> CDependencyIndex::FlattenReferences(uint64 ID, const CDependencyTree *pkTree)
+{
+    std::vector<uint64> Out;
+    if (!pkTree) return Out;
+
+    std::set<CAssetID> References;
+    pkTree->GetAllResourceReferences(References);
+    Out.reserve(References.size());
+
+    for (auto Iter = References.begin(); Iter != References.end(); Iter++)
+    {
+        if (Iter->IsValid() && Iter->ToLongLong() != ID)
+            Out.push_back(Iter->ToLongLong());
+    }
+
+    return Out;
+}
+
+// ************ PROTECTED ************
+CDependencyIndex::SNode* CDependencyIndex::FindNode(uint64 ID)
+{
+    uint32 *pIndex = mNodeIndices.Find(ID);
+    return (pIndex ? &mNodes[*pIndex] : nullptr);
+}
+
+const CDependencyIndex::SNode* CDependencyIndex::FindNode(uint64 ID) const
+{
+    const uint32 *pkIndex = mNodeIndices.Find(ID);
+    return (pkIndex ? &mNodes[*pkIndex] : nullptr);
+}
+
+CDependencyIndex::SNode& CDependencyIndex::FindOrCreateNode(uint64 ID)
+{
+    uint32 *pIndex = mNodeIndices.Find(ID);
+    if (pIndex) return mNodes[*pIndex];
+
+    mNodeIndices.Insert(ID, mNodes.size());
+    mNodes.push_back(SNode());
+    return mNodes.back();
+}
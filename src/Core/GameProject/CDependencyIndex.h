@@ -0,0 +1,52 @@
+#ifndef CDEPENDENCYINDEX_H
+#define CDEPENDENCYINDEX_H
+
+#include "Core/TFlatHashMap.h"
+#include <Common/BasicTypes.h>
+#include <mutex>
+#include <set>
+#include <vector>
+
+class CDependencyTree;
+
+/* Inverted index of the references between resources, so the resources referencing an asset can be found
+ * without walking every dependency tree in the store. Each resource's references are the flattened list of
+ * asset IDs in its dependency tree; referencer lists are derived from them and kept in sync whenever a
+ * resource's references are replaced. Assets are keyed by their ID as a 64-bit integer.
+ *
+ * The resource database stores each entry's reference list next to its dependency tree, so the index can be
+ * rebuilt on load without deserializing any dependency trees. */
+class CDependencyIndex
+{
+    struct SNode
+    {
+        std::vector<uint64> References; // Sorted
+        std::vector<uint64> Referencers;
+    };
+
+    TFlatHashMap<uint64, uint32> mNodeIndices;
+    std::vector<SNode> mNodes;
+    mutable std::mutex mMutex;
+
+public:
+    // Replaces the assets referenced by the given asset; the list doesn't need to be sorted or unique
+    void SetReferences(uint64 ID, std::vector<uint64> References);
+    void SetReferences(uint64 ID, const CDependencyTree *pkTree);
+    void RemoveReferences(uint64 ID);
+    void Clear();
+
+    std::vector<uint64> References(uint64 ID) const;
+    std::vector<uint64> Referencers(uint64 ID) const;
+
+    // Every asset that references the given asset directly or indirectly, not including the asset itself
+    std::set<uint64> AllReferencers(uint64 ID) const;
+
+    static std::vector<uint64> FlattenReferences(uint64 ID, const CDependencyTree *pkTree);
+
+protected:
+    SNode* FindNode(uint64 ID);
+    const SNode* FindNode(uint64 ID) const;
+    SNode& FindOrCreateNode(uint64 ID);
+};
+
+#endif // CDEPENDENCYINDEX_H
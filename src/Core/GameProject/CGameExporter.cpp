@@ -3,6 +3,7 @@
 #include "CResourceIterator.h"
 #include "CResourceStore.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include "Core/Resource/CWorld.h"
 #include "Core/Resource/Script/CGameTemplate.h"
 #include <Common/Macros.h>
@@ -19,6 +20,12 @@
 #define USE_ASSET_NAME_MAP 1
 #define EXPORT_COOKED 1
 
+// Max number of resources kept loaded between dependents while generating editor data
+const uint32 gkEditorDataCacheSize = 2048;
+
+// Number of resident resources that are saved together when generating editor data on multiple threads
+const uint32 gkEditorDataBatchSize = 64;
+
 CGameExporter::CGameExporter(EDiscType DiscType, EGame Game, bool FrontEnd, ERegion Region, const TString& rkGameName, const TString& rkGameID, float BuildVersion)
     : mGame(Game)
     , mRegion(Region)
@@ -27,6 +34,7 @@ CGameExporter::CGameExporter(EDiscType DiscType, EGame Game, bool FrontEnd, EReg
     , mBuildVersion(BuildVersion)
     , mDiscType(DiscType)
     , mFrontEnd(FrontEnd)
+    , mNumExportThreads(ParallelUtil::DefaultThreadCount())
     , mpProgress(nullptr)
 {
     ASSERT(mGame != EGame::Invalid);
@@ -77,6 +85,7 @@ bool CGameExporter::Export(nod::DiscBase *pDisc, const TString& rkOutputDir, CAs
     // Export cooked data
     LoadPaks();
     ExportCookedResources();
+    UnmapPaks();
 
     // Export editor data
     if (!mpProgress->ShouldCancel())
@@ -272,6 +281,17 @@ void CGameExporter::LoadPaks()
             continue;
         }
 
+        // Map the pak so resource data can be read straight out of it later. If this fails, we fall back on regular file reads.
+        CMappedFile *pMappedPak = new CMappedFile(PakPath);
+
+        if (!pMappedPak->IsValid() || pMappedPak->Size() == 0)
+        {
+            delete pMappedPak;
+            pMappedPak = nullptr;
+        }
+        else
+            mMappedPaks.emplace_back(pMappedPak);
+
         TString RelPakPath = FileUtil::MakeRelative(PakPath.GetFileDirectory(), mpProject->DiscFilesystemRoot(false));
         CPackage *pPackage = new CPackage(mpProject, PakPath.GetFileName(false), RelPakPath);
 
@@ -312,7 +332,7 @@ void CGameExporter::LoadPaks()
                     uint32 ResOffset = Pak.ReadLong();
 
                     if (mResourceMap.find(ResID) == mResourceMap.end())
-                        mResourceMap[ResID] = SResourceInstance { PakPath, ResID, ResType, ResOffset, ResSize, Compressed, false };
+                        mResourceMap[ResID] = SResourceInstance { PakPath, ResID, ResType, ResOffset, ResSize, Compressed, false, pMappedPak };
 
                     // Check for duplicate resources
                     if (ResType == "MREA")
@@ -391,7 +411,7 @@ void CGameExporter::LoadPaks()
                         uint32 Offset = DataStart + Pak.ReadLong();
 
                         if (mResourceMap.find(ResID) == mResourceMap.end())
-                            mResourceMap[ResID] = SResourceInstance { PakPath, ResID, Type, Offset, Size, Compressed, false };
+                            mResourceMap[ResID] = SResourceInstance { PakPath, ResID, Type, Offset, Size, Compressed, false, pMappedPak };
 
                         // Check for duplicate resources (unnecessary for DKCR)
                         if (mGame != EGame::DKCReturns)
@@ -425,120 +445,219 @@ void CGameExporter::LoadPaks()
 #endif
 }
 
+void CGameExporter::UnmapPaks()
+{
+    for (auto It = mResourceMap.begin(); It != mResourceMap.end(); It++)
+        It->second.pkMappedPak = nullptr;
+
+    mMappedPaks.clear();
+}
+
 void CGameExporter::LoadResource(const SResourceInstance& rkResource, std::vector<uint8>& rBuffer)
 {
-    CFileInStream Pak(rkResource.PakFile, EEndian::BigEndian);
+    if (rkResource.pkMappedPak)
+    {
+        const CMappedFile *pkPak = rkResource.pkMappedPak;
+        CMemoryInStream Pak(pkPak->Data(), (uint32) pkPak->Size(), EEndian::BigEndian);
+        LoadResource(rkResource, Pak, pkPak, rBuffer);
+    }
 
-    if (Pak.IsValid())
+    else
     {
-        Pak.Seek(rkResource.PakOffset, SEEK_SET);
+        CFileInStream Pak(rkResource.PakFile, EEndian::BigEndian);
 
-        // Handle compression
-        if (rkResource.Compressed)
-        {
-            bool ZlibCompressed = (mGame <= EGame::EchoesDemo || mGame == EGame::DKCReturns);
+        if (Pak.IsValid())
+            LoadResource(rkResource, Pak, nullptr, rBuffer);
+    }
+}
 
-            if (mGame <= EGame::CorruptionProto)
-            {
-                std::vector<uint8> CompressedData(rkResource.PakSize);
+void CGameExporter::LoadResource(const SResourceInstance& rkResource, IInputStream& rPak, const CMappedFile *pkMappedPak, std::vector<uint8>& rBuffer)
+{
+    // Compressed data is decompressed straight out of the mapping when the pak is mapped. Otherwise
+    // it's streamed from the pak in chunks, so the compressed data doesn't need to be copied first.
+    bool ZlibCompressed = (mGame <= EGame::EchoesDemo || mGame == EGame::DKCReturns);
 
-                uint32 UncompressedSize = Pak.ReadLong();
-                rBuffer.resize(UncompressedSize);
-                Pak.ReadBytes(CompressedData.data(), CompressedData.size());
+    auto DecompressPakData = [&](uint32 CompressedSize, uint8 *pDst, uint32 DstLen)
+    {
+        if (pkMappedPak)
+        {
+            uint32 Offset = rPak.Tell();
+            uint64 Remaining = (Offset < pkMappedPak->Size() ? pkMappedPak->Size() - Offset : 0);
+            CompressedSize = (uint32) Math::Min<uint64>(CompressedSize, Remaining);
+            const uint8 *pkCompressedData = pkMappedPak->DataAt(Offset, CompressedSize);
+            rPak.Seek(CompressedSize, SEEK_CUR);
 
-                if (ZlibCompressed)
-                {
-                    uint32 TotalOut;
-                    CompressionUtil::DecompressZlib(CompressedData.data(), CompressedData.size(), rBuffer.data(), rBuffer.size(), TotalOut);
-                }
-                else
-                {
-                    CompressionUtil::DecompressSegmentedData(CompressedData.data(), CompressedData.size(), rBuffer.data(), rBuffer.size());
-                }
+            if (ZlibCompressed)
+            {
+                uint32 TotalOut;
+                CompressionUtil::DecompressZlib(pkCompressedData, CompressedSize, pDst, DstLen, TotalOut);
             }
-
             else
             {
-                CFourCC Magic = Pak.ReadLong();
-                ASSERT(Magic == "CMPD");
+                CompressionUtil::DecompressSegmentedData(pkCompressedData, CompressedSize, pDst, DstLen);
+            }
+        }
+        else
+        {
+            if (ZlibCompressed)
+            {
+                uint32 TotalOut;
+                CompressionUtil::DecompressZlib(rPak, CompressedSize, pDst, DstLen, TotalOut);
+            }
+            else
+            {
+                CompressionUtil::DecompressSegmentedData(rPak, CompressedSize, pDst, DstLen);
+            }
+        }
+    };
 
-                uint32 NumBlocks = Pak.ReadLong();
+    rPak.Seek(rkResource.PakOffset, SEEK_SET);
 
-                struct SCompressedBlock {
-                    uint32 CompressedSize; uint32 UncompressedSize;
-                };
-                std::vector<SCompressedBlock> CompressedBlocks;
+    // Handle compression
+    if (rkResource.Compressed)
+    {
+        if (mGame <= EGame::CorruptionProto)
+        {
+            uint32 UncompressedSize = rPak.ReadLong();
+            rBuffer.resize(UncompressedSize);
+            DecompressPakData(rkResource.PakSize, rBuffer.data(), rBuffer.size());
+        }
 
-                uint32 TotalUncompressedSize = 0;
-                for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
-                {
-                    uint32 CompressedSize = (Pak.ReadLong() & 0x00FFFFFF);
-                    uint32 UncompressedSize = Pak.ReadLong();
+        else
+        {
+            CFourCC Magic = rPak.ReadLong();
+            ASSERT(Magic == "CMPD");
 
-                    TotalUncompressedSize += UncompressedSize;
-                    CompressedBlocks.push_back( SCompressedBlock { CompressedSize, UncompressedSize } );
-                }
+            uint32 NumBlocks = rPak.ReadLong();
 
-                rBuffer.resize(TotalUncompressedSize);
-                uint32 Offset = 0;
+            struct SCompressedBlock {
+                uint32 CompressedSize; uint32 UncompressedSize;
+            };
+            std::vector<SCompressedBlock> CompressedBlocks;
 
-                for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
-                {
-                    uint32 CompressedSize = CompressedBlocks[iBlock].CompressedSize;
-                    uint32 UncompressedSize = CompressedBlocks[iBlock].UncompressedSize;
+            uint32 TotalUncompressedSize = 0;
+            for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
+            {
+                uint32 CompressedSize = (rPak.ReadLong() & 0x00FFFFFF);
+                uint32 UncompressedSize = rPak.ReadLong();
 
-                    // Block is compressed
-                    if (CompressedSize != UncompressedSize)
-                    {
-                        std::vector<uint8> CompressedData(CompressedBlocks[iBlock].CompressedSize);
-                        Pak.ReadBytes(CompressedData.data(), CompressedData.size());
+                TotalUncompressedSize += UncompressedSize;
+                CompressedBlocks.push_back( SCompressedBlock { CompressedSize, UncompressedSize } );
+            }
 
-                        if (ZlibCompressed)
-                        {
-                            uint32 TotalOut;
-                            CompressionUtil::DecompressZlib(CompressedData.data(), CompressedData.size(), rBuffer.data() + Offset, UncompressedSize, TotalOut);
-                        }
-                        else
-                        {
-                            CompressionUtil::DecompressSegmentedData(CompressedData.data(), CompressedData.size(), rBuffer.data() + Offset, UncompressedSize);
-                        }
-                    }
-                    // Block is uncompressed
-                    else
-                        Pak.ReadBytes(rBuffer.data() + Offset, UncompressedSize);
+            rBuffer.resize(TotalUncompressedSize);
+            uint32 Offset = 0;
 
-                    Offset += UncompressedSize;
-                }
+            for (uint32 iBlock = 0; iBlock < NumBlocks; iBlock++)
+            {
+                uint32 CompressedSize = CompressedBlocks[iBlock].CompressedSize;
+                uint32 UncompressedSize = CompressedBlocks[iBlock].UncompressedSize;
+
+                // Block is compressed
+                if (CompressedSize != UncompressedSize)
+                    DecompressPakData(CompressedSize, rBuffer.data() + Offset, UncompressedSize);
+                // Block is uncompressed
+                else
+                    rPak.ReadBytes(rBuffer.data() + Offset, UncompressedSize);
+
+                Offset += UncompressedSize;
             }
         }
+    }
 
-        // Handle uncompressed
-        else
-        {
-            rBuffer.resize(rkResource.PakSize);
-            Pak.ReadBytes(rBuffer.data(), rBuffer.size());
-        }
+    // Handle uncompressed
+    else
+    {
+        rBuffer.resize(rkResource.PakSize);
+        rPak.ReadBytes(rBuffer.data(), rBuffer.size());
     }
 }
 
+const uint8* CGameExporter::MappedResourceData(const SResourceInstance& rkResource) const
+{
+    // Uncompressed resources can be used as-is straight out of the mapped pak without any copies
+    if (rkResource.Compressed || !rkResource.pkMappedPak)
+        return nullptr;
+    else
+        return rkResource.pkMappedPak->DataAt(rkResource.PakOffset, rkResource.PakSize);
+}
+
 void CGameExporter::ExportCookedResources()
 {
     SCOPED_TIMER(ExportCookedResources);
     FileUtil::MakeDirectory(mResourcesDir);
 
     mpProgress->SetTask(eES_ExportCooked, "Unpacking cooked assets");
-    int ResIndex = 0;
 
-    for (auto It = mResourceMap.begin(); It != mResourceMap.end() && !mpProgress->ShouldCancel(); It++, ResIndex++)
+    if (mNumExportThreads <= 1)
     {
-        SResourceInstance& rRes = It->second;
+        int ResIndex = 0;
 
-        // Update progress
-        if ((ResIndex & 0x3) == 0)
-            mpProgress->Report(ResIndex, mResourceMap.size(), TString::Format("Unpacking asset %d/%d", ResIndex, mResourceMap.size()) );
+        for (auto It = mResourceMap.begin(); It != mResourceMap.end() && !mpProgress->ShouldCancel(); It++, ResIndex++)
+        {
+            SResourceInstance& rRes = It->second;
+
+            // Update progress
+            if ((ResIndex & 0x3) == 0)
+                mpProgress->Report(ResIndex, mResourceMap.size(), TString::Format("Unpacking asset %d/%d", ResIndex, mResourceMap.size()) );
+
+            // Export resource
+            ExportResource(rRes);
+        }
+    }
+
+    else
+    {
+        // Registering entries touches the resource store and the name map, so that part has to stay on this
+        // thread. Once every entry exists, reading from the paks, decompressing and writing the cooked files
+        // are independent per resource and can be handed out to worker threads.
+        struct SExportJob
+        {
+            SResourceInstance *pRes;
+            CResourceEntry *pEntry;
+        };
+        std::vector<SExportJob> Jobs;
+        Jobs.reserve(mResourceMap.size());
+
+        for (auto It = mResourceMap.begin(); It != mResourceMap.end() && !mpProgress->ShouldCancel(); It++)
+        {
+            SResourceInstance& rRes = It->second;
 
-        // Export resource
-        ExportResource(rRes);
+            if (!rRes.Exported)
+            {
+                CResourceEntry *pEntry = RegisterExportedResource(rRes);
+                Jobs.push_back( SExportJob { &rRes, pEntry } );
+            }
+        }
+
+        if (mpProgress->ShouldCancel())
+            return;
+
+        uint32 NumJobs = Jobs.size();
+
+        // Each worker only writes its own job's flag, so these don't need synchronizing
+        std::vector<uint8> JobsCompleted(NumJobs, 0);
+
+        ParallelUtil::ParallelFor(NumJobs, [&](uint32 JobIdx)
+        {
+            const SExportJob& rkJob = Jobs[JobIdx];
+            WriteCookedResource(*rkJob.pRes, rkJob.pEntry);
+            JobsCompleted[JobIdx] = 1;
+        },
+        mNumExportThreads,
+        [&](uint32 NumCompleted) -> bool
+        {
+            mpProgress->Report(NumCompleted, NumJobs, TString::Format("Unpacking asset %d/%d", NumCompleted, NumJobs) );
+            return !mpProgress->ShouldCancel();
+        });
+
+        // Only flag resources as exported once their worker has finished; this is safe to do now that all workers have exited.
+        // If the export was cancelled, jobs that never ran stay unexported.
+        for (uint32 JobIdx = 0; JobIdx < NumJobs; JobIdx++)
+        {
+            if (JobsCompleted[JobIdx])
+                Jobs[JobIdx].pRes->Exported = true;
+        }
     }
 }
 
@@ -553,46 +672,18 @@ void CGameExporter::ExportResourceEditorData()
         mpProgress->SetTask(eES_GenerateRaw, "Generating editor data");
         int ResIndex = 0;
 
-        // todo: we're wasting a ton of time loading the same resources over and over because most resources automatically
-        // load all their dependencies and then we just clear it out from memory even though we'll need it again later. we
-        // should really be doing this by dependency order instead of by ID order.
-        for (CResourceIterator It(mpStore); It && !mpProgress->ShouldCancel(); ++It, ++ResIndex)
-        {
-            // Update progress
-            if ((ResIndex & 0x3) == 0 || It->ResourceType() == EResourceType::Area)
-                mpProgress->Report(ResIndex, mpStore->NumTotalResources(), TString::Format("Processing asset %d/%d: %s",
-                    ResIndex, mpStore->NumTotalResources(), *It->CookedAssetPath(true).GetFileName()) );
-
-            // Worlds need some info we can only get from the pak at export time; namely, which areas can
-            // have duplicates, as well as the world's internal name.
-            if (It->ResourceType() == EResourceType::World)
-            {
-                CWorld *pWorld = (CWorld*) It->Load();
+        // Resources are processed in dependency order rather than ID order. Before a resource is saved, all of its
+        // dependencies are processed first while the dependent keeps them loaded, and processed resources are kept
+        // in a cache afterwards so that later resources sharing the same dependencies don't load them again.
+        CResourceCache Cache(mpStore, gkEditorDataCacheSize);
+        std::set<CAssetID> VisitedSet;
+        std::vector<CResourceEntry*> SaveQueue;
 
-                // Set area duplicate flags
-                for (uint32 iArea = 0; iArea < pWorld->NumAreas(); iArea++)
-                {
-                    CAssetID AreaID = pWorld->AreaResourceID(iArea);
-                    auto Find = mAreaDuplicateMap.find(AreaID);
+        for (CResourceIterator It(mpStore); It && !mpProgress->ShouldCancel(); ++It)
+            ExportEditorDataRecursive(*It, Cache, VisitedSet, SaveQueue, ResIndex);
 
-                    if (Find != mAreaDuplicateMap.end())
-                        pWorld->SetAreaAllowsPakDuplicates(iArea, Find->second);
-                }
-
-                // Set world name
-                TString WorldName = MakeWorldName(pWorld->ID());
-                pWorld->SetName(WorldName);
-            }
-
-            // Save raw resource + generate dependencies
-            if (It->TypeInfo()->CanBeSerialized())
-                It->Save(true);
-            else
-                It->UpdateDependencies();
-
-            // Set flags, save metadata
-            It->SaveMetadata(true);
-        }
+        if (!mpProgress->ShouldCancel())
+            FlushEditorDataQueue(Cache, SaveQueue, ResIndex);
     }
 
     if (!mpProgress->ShouldCancel())
@@ -608,45 +699,198 @@ void CGameExporter::ExportResourceEditorData()
     }
 }
 
+void CGameExporter::ExportEditorDataRecursive(CResourceEntry *pEntry, CResourceCache& rCache, std::set<CAssetID>& rVisitedSet, std::vector<CResourceEntry*>& rSaveQueue, int& rResIndex)
+{
+    if (mpProgress->ShouldCancel() || rVisitedSet.find(pEntry->ID()) != rVisitedSet.end())
+        return;
+
+    rVisitedSet.insert(pEntry->ID());
+    CResTypeInfo *pTypeInfo = pEntry->TypeInfo();
+
+    if (pTypeInfo->CanBeSerialized() || pTypeInfo->CanHaveDependencies())
+    {
+        // Pin the resource until it's been saved. Its dependencies were loaded along with it, so they stay resident
+        // while we process them. Since it's already loaded, UpdateDependencies() won't garbage collect anything.
+        if (!rCache.Acquire(pEntry))
+        {
+            // Resources can only be loaded from this thread, so don't hand the entry to the workers to load it again.
+            // UpdateDependencies() gives it an empty dependency tree when the resource fails to load.
+            errorf("Failed to load resource for editor data export: %s", *pEntry->CookedAssetPath(true));
+            pEntry->UpdateDependencies();
+            pEntry->SaveMetadata(true);
+            rResIndex++;
+            return;
+        }
+
+        // The save workers reuse this dependency tree rather than building it again
+        pEntry->UpdateDependencies();
+
+        std::set<CAssetID> DependencyIDs;
+        pEntry->Dependencies()->GetAllResourceReferences(DependencyIDs);
+
+        for (auto Iter = DependencyIDs.begin(); Iter != DependencyIDs.end(); Iter++)
+        {
+            CResourceEntry *pDependency = mpStore->FindEntry(*Iter);
+
+            if (pDependency)
+                ExportEditorDataRecursive(pDependency, rCache, rVisitedSet, rSaveQueue, rResIndex);
+        }
+    }
+
+    rSaveQueue.push_back(pEntry);
+
+    if (mNumExportThreads <= 1 || rSaveQueue.size() >= gkEditorDataBatchSize)
+        FlushEditorDataQueue(rCache, rSaveQueue, rResIndex);
+}
+
+void CGameExporter::FlushEditorDataQueue(CResourceCache& rCache, std::vector<CResourceEntry*>& rSaveQueue, int& rResIndex)
+{
+    // Worlds need some info we can only get from the pak at export time; namely, which areas can
+    // have duplicates, as well as the world's internal name.
+    for (CResourceEntry *pEntry : rSaveQueue)
+    {
+        if (pEntry->ResourceType() == EResourceType::World)
+        {
+            CWorld *pWorld = (CWorld*) pEntry->Load();
+
+            // Set area duplicate flags
+            for (uint32 iArea = 0; iArea < pWorld->NumAreas(); iArea++)
+            {
+                CAssetID AreaID = pWorld->AreaResourceID(iArea);
+                auto Find = mAreaDuplicateMap.find(AreaID);
+
+                if (Find != mAreaDuplicateMap.end())
+                    pWorld->SetAreaAllowsPakDuplicates(iArea, Find->second);
+            }
+
+            // Set world name
+            TString WorldName = MakeWorldName(pWorld->ID());
+            pWorld->SetName(WorldName);
+        }
+    }
+
+    // Creating directories isn't safe to do from multiple threads at once, so create the output directories up front
+    for (CResourceEntry *pEntry : rSaveQueue)
+    {
+        if (pEntry->TypeInfo()->CanBeSerialized())
+            FileUtil::MakeDirectory(pEntry->RawAssetPath().GetFileDirectory());
+
+        FileUtil::MakeDirectory(pEntry->MetadataFilePath().GetFileDirectory());
+    }
+
+    // Everything in the queue is already resident, so saving doesn't need to load anything
+    // and the entries in the queue can be saved independently of each other.
+    uint32 NumResources = mpStore->NumTotalResources();
+    uint32 NumQueued = rSaveQueue.size();
+
+    ParallelUtil::ParallelFor(NumQueued, [&](uint32 QueueIdx)
+    {
+        SaveEditorData(rSaveQueue[QueueIdx]);
+    },
+    mNumExportThreads,
+    [&](uint32 NumCompleted) -> bool
+    {
+        int ResIndex = rResIndex + NumCompleted;
+        CResourceEntry *pEntry = rSaveQueue[Math::Min(NumCompleted, NumQueued - 1)];
+
+        // Update progress
+        if ((ResIndex & 0x3) == 0 || pEntry->ResourceType() == EResourceType::Area)
+            mpProgress->Report(ResIndex, NumResources, TString::Format("Processing asset %d/%d: %s",
+                ResIndex, NumResources, *pEntry->CookedAssetPath(true).GetFileName()) );
+
+        return !mpProgress->ShouldCancel();
+    });
+
+    // The workers only flag their own entries' cache records, so flag the store once for the whole batch
+    if (NumQueued > 0)
+        mpStore->SetCacheDirty();
+
+    // Saved resources no longer need to be pinned; the cache will unload them when it needs the space
+    for (CResourceEntry *pEntry : rSaveQueue)
+        rCache.Release(pEntry);
+
+    rResIndex += NumQueued;
+    rSaveQueue.clear();
+}
+
+void CGameExporter::SaveEditorData(CResourceEntry *pEntry)
+{
+    // Save raw resource + generate dependencies
+    // This is called from worker threads, so the store's cache is flagged dirty by the caller instead.
+    // Resources that can have dependencies already had them built by ExportEditorDataRecursive.
+    CResTypeInfo *pTypeInfo = pEntry->TypeInfo();
+
+    if (pTypeInfo->CanBeSerialized())
+        pEntry->Save(true, true);
+    else if (!pTypeInfo->CanHaveDependencies())
+        pEntry->UpdateDependencies(true);
+
+    // Set flags, save metadata
+    pEntry->SaveMetadata(true);
+}
+
 void CGameExporter::ExportResource(SResourceInstance& rRes)
 {
     if (!rRes.Exported)
     {
-        std::vector<uint8> ResourceData;
-        LoadResource(rRes, ResourceData);
+        CResourceEntry *pEntry = RegisterExportedResource(rRes);
+        WriteCookedResource(rRes, pEntry);
+        rRes.Exported = true;
+    }
+}
 
-        // Register resource and write to file
-        TString Directory, Name;
-        bool AutoDir, AutoName;
+CResourceEntry* CGameExporter::RegisterExportedResource(const SResourceInstance& rkRes)
+{
+    // Register resource
+    TString Directory, Name;
+    bool AutoDir, AutoName;
 
 #if USE_ASSET_NAME_MAP
-        mpNameMap->GetNameInfo(rRes.ResourceID, Directory, Name, AutoDir, AutoName);
+    mpNameMap->GetNameInfo(rkRes.ResourceID, Directory, Name, AutoDir, AutoName);
 #else
-        Directory = mpStore->DefaultAssetDirectoryPath(mpStore->Game());
-        Name = rRes.ResourceID.ToString();
+    Directory = mpStore->DefaultAssetDirectoryPath(mpStore->Game());
+    Name = rkRes.ResourceID.ToString();
 #endif
 
-        CResourceEntry *pEntry = mpStore->RegisterResource(rRes.ResourceID, CResTypeInfo::TypeForCookedExtension(mGame, rRes.ResourceType)->Type(), Directory, Name);
+    CResourceEntry *pEntry = mpStore->RegisterResource(rkRes.ResourceID, CResTypeInfo::TypeForCookedExtension(mGame, rkRes.ResourceType)->Type(), Directory, Name);
 
-        // Set flags
-        pEntry->SetFlag(EResEntryFlag::IsBaseGameResource);
-        pEntry->SetFlagEnabled(EResEntryFlag::AutoResDir, AutoDir);
-        pEntry->SetFlagEnabled(EResEntryFlag::AutoResName, AutoName);
+    // Set flags
+    pEntry->SetFlag(EResEntryFlag::IsBaseGameResource);
+    pEntry->SetFlagEnabled(EResEntryFlag::AutoResDir, AutoDir);
+    pEntry->SetFlagEnabled(EResEntryFlag::AutoResName, AutoName);
 
 #if EXPORT_COOKED
-        // Save cooked asset
-        TString OutCookedPath = pEntry->CookedAssetPath();
-        FileUtil::MakeDirectory(OutCookedPath.GetFileDirectory());
-        CFileOutStream Out(OutCookedPath, EEndian::BigEndian);
+    // Create the output directory up front; this isn't safe to do from multiple threads at once
+    FileUtil::MakeDirectory(pEntry->CookedAssetPath().GetFileDirectory());
+#endif
 
-        if (Out.IsValid())
-            Out.WriteBytes(ResourceData.data(), ResourceData.size());
+    return pEntry;
+}
 
-        ASSERT(pEntry->HasCookedVersion());
-#endif
+void CGameExporter::WriteCookedResource(const SResourceInstance& rkRes, CResourceEntry *pEntry)
+{
+    // This can be called from worker threads. It must only read the pak and write the cooked file!
+#if EXPORT_COOKED
+    std::vector<uint8> ResourceData;
+    const uint8 *pkResourceData = MappedResourceData(rkRes);
+    uint32 ResourceSize = rkRes.PakSize;
 
-        rRes.Exported = true;
+    if (!pkResourceData)
+    {
+        LoadResource(rkRes, ResourceData);
+        pkResourceData = ResourceData.data();
+        ResourceSize = ResourceData.size();
     }
+
+    // Save cooked asset
+    TString OutCookedPath = pEntry->CookedAssetPath();
+    CFileOutStream Out(OutCookedPath, EEndian::BigEndian);
+
+    if (Out.IsValid())
+        Out.WriteBytes(pkResourceData, ResourceSize);
+
+    ASSERT(pEntry->HasCookedVersion());
+#endif
 }
 
 TString CGameExporter::MakeWorldName(CAssetID WorldID)
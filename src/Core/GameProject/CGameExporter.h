@@ -4,11 +4,15 @@
 #include "CAssetNameMap.h"
 #include "CGameInfo.h"
 #include "CGameProject.h"
+#include "CResourceCache.h"
 #include "CResourceStore.h"
+#include "Core/CMappedFile.h"
 #include <Common/CAssetID.h>
 #include <Common/Flags.h>
 #include <Common/TString.h>
 #include <map>
+#include <memory>
+#include <set>
 #include <nod/nod.hpp>
 
 enum class EDiscType
@@ -57,8 +61,13 @@ class CGameExporter
         uint32 PakSize;
         bool Compressed;
         bool Exported;
+        const CMappedFile *pkMappedPak; // Null if the pak couldn't be mapped
     };
     std::map<CAssetID, SResourceInstance> mResourceMap;
+    std::vector< std::unique_ptr<CMappedFile> > mMappedPaks;
+
+    // Number of threads used to unpack cooked assets; 1 = serial
+    uint32 mNumExportThreads;
 
     // Progress
     IProgressNotifier *mpProgress;
@@ -79,15 +88,24 @@ public:
     bool ShouldExportDiscNode(const nod::Node *pkNode, bool IsInRoot);
 
     inline TString ProjectPath() const  { return mProjectPath; }
+    inline void SetNumExportThreads(uint32 NumThreads)  { mNumExportThreads = (NumThreads > 0 ? NumThreads : 1); }
 
 protected:
     bool ExtractDiscData();
     bool ExtractDiscNodeRecursive(const nod::Node *pkNode, const TString& rkDir, bool RootNode, const nod::ExtractionContext& rkContext);
     void LoadPaks();
+    void UnmapPaks();
     void LoadResource(const SResourceInstance& rkResource, std::vector<uint8>& rBuffer);
+    void LoadResource(const SResourceInstance& rkResource, IInputStream& rPak, const CMappedFile *pkMappedPak, std::vector<uint8>& rBuffer);
+    const uint8* MappedResourceData(const SResourceInstance& rkResource) const;
     void ExportCookedResources();
     void ExportResourceEditorData();
+    void ExportEditorDataRecursive(CResourceEntry *pEntry, CResourceCache& rCache, std::set<CAssetID>& rVisitedSet, std::vector<CResourceEntry*>& rSaveQueue, int& rResIndex);
+    void FlushEditorDataQueue(CResourceCache& rCache, std::vector<CResourceEntry*>& rSaveQueue, int& rResIndex);
+    void SaveEditorData(CResourceEntry *pEntry);
     void ExportResource(SResourceInstance& rRes);
+    CResourceEntry* RegisterExportedResource(const SResourceInstance& rkRes);
+    void WriteCookedResource(const SResourceInstance& rkRes, CResourceEntry *pEntry);
     TString MakeWorldName(CAssetID WorldID);
 
     // Convenience Functions
@@ -1,4 +1,5 @@
 #include "CGameProject.h"
+#include "CAsyncLoader.h"
 #include "IUIRelay.h"
 #include "Core/Resource/Script/CGameTemplate.h"
 #include <Common/Serialization/XML.h>
@@ -10,6 +11,9 @@ CGameProject::~CGameProject()
     {
         ASSERT(!mpResourceStore->IsCacheDirty());
 
+        // Stop any async loads while gpResourceStore is still pointing at this project
+        mpResourceStore->AsyncLoader()->Shutdown();
+
         if (gpResourceStore == mpResourceStore)
             gpResourceStore = nullptr;
     }
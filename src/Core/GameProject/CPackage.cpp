@@ -1,15 +1,23 @@
 #include "CPackage.h"
 #include "DependencyListBuilders.h"
+#include "CCompressedAssetCache.h"
 #include "CGameProject.h"
+#include "Core/CMappedFile.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include "Core/Resource/Cooker/CWorldCooker.h"
 #include <Common/Macros.h>
 #include <Common/FileIO.h>
 #include <Common/FileUtil.h>
+#include <Common/Math/MathUtil.h>
 #include <Common/Serialization/XML.h>
+#include <memory>
 
 using namespace tinyxml2;
 
+// Number of assets compressed together before they're written to the pak
+const uint32 gkCookBatchSize = 64;
+
 bool CPackage::Load()
 {
     TString DefPath = DefinitionPath(false);
@@ -59,7 +67,46 @@ void CPackage::UpdateDependencyCache() const
     mCacheDirty = false;
 }
 
-void CPackage::Cook(IProgressNotifier *pProgress)
+static CompressionUtil::ECompressionLevel CompressionLevel(ECookProfile Profile)
+{
+    switch (Profile)
+    {
+    case ECookProfile::Fast:    return CompressionUtil::ECompressionLevel::Fast;
+    case ECookProfile::Max:     return CompressionUtil::ECompressionLevel::Max;
+    default:                    return CompressionUtil::ECompressionLevel::Default;
+    }
+}
+
+static bool ShouldCompressAsset(EGame Game, EResourceType Type, uint32 ResourceSize)
+{
+    // Check if this asset should be compressed; there are a few resource types that are
+    // always compressed, and some types that are compressed if they're over a certain size
+    uint32 CompressThreshold = (Game <= EGame::CorruptionProto ? 0x400 : 0x80);
+
+    bool ShouldAlwaysCompress = (Type == EResourceType::Texture || Type == EResourceType::Model ||
+                                 Type == EResourceType::Skin || Type == EResourceType::AnimSet ||
+                                 Type == EResourceType::Animation || Type == EResourceType::Font);
+
+    if (Game >= EGame::Corruption)
+    {
+        ShouldAlwaysCompress = ShouldAlwaysCompress ||
+                               (Type == EResourceType::Character || Type == EResourceType::SourceAnimData ||
+                                Type == EResourceType::Scan || Type == EResourceType::AudioSample ||
+                                Type == EResourceType::StringTable || Type == EResourceType::AudioAmplitudeData ||
+                                Type == EResourceType::DynamicCollision);
+    }
+
+    bool ShouldCompressConditional = !ShouldAlwaysCompress &&
+            (Type == EResourceType::Particle || Type == EResourceType::ParticleElectric ||
+             Type == EResourceType::ParticleSwoosh || Type == EResourceType::ParticleWeapon ||
+             Type == EResourceType::ParticleDecal || Type == EResourceType::ParticleCollisionResponse ||
+             Type == EResourceType::ParticleSpawn || Type == EResourceType::ParticleSorted ||
+             Type == EResourceType::BurstFireData);
+
+    return ShouldAlwaysCompress || (ShouldCompressConditional && ResourceSize >= CompressThreshold);
+}
+
+void CPackage::Cook(IProgressNotifier *pProgress, ECookProfile Profile /*= ECookProfile::Max*/)
 {
     SCOPED_TIMER(CookPackage);
 
@@ -165,96 +212,133 @@ void CPackage::Cook(IProgressNotifier *pProgress)
     uint32 ResIdx = 0;
     uint32 ResDataOffset = Pak.Tell();
 
-    for (auto Iter = AssetList.begin(); Iter != AssetList.end() && !pProgress->ShouldCancel(); Iter++, ResIdx++)
+    // Assets are handled in batches. Each batch is compressed in parallel and then written to the pak in order,
+    // so the pak is identical regardless of thread count, and only one batch of compressed data is held at a time.
+    struct SPendingAsset
     {
-        // Initialize entry, recook assets if needed
-        uint32 AssetOffset = Pak.Tell();
-        CAssetID ID = *Iter;
-        CResourceEntry *pEntry = gpResourceStore->FindEntry(ID);
-        ASSERT(pEntry != nullptr);
+        CResourceEntry *pEntry;
+        std::unique_ptr<CMappedFile> pCookedData;
+        bool ShouldCompress;
+        bool Compressed;
+        uint64 DataHash;
+        const CCompressedAssetCache::SEntry *pkCached;
+        std::vector<uint8> CompressedData;
+        uint32 CompressedSize;
+    };
+    std::vector<SPendingAsset> Batch;
 
-        if (pEntry->NeedsRecook())
-        {
-            pProgress->Report(ResIdx, AssetList.size(), "Cooking asset: " + pEntry->Name() + "." + pEntry->CookedExtension());
-            pEntry->Cook();
-        }
+    CompressionUtil::ECompressionLevel Level = CompressionLevel(Profile);
+    CCompressedAssetCache CompressionCache(CompressionCachePath(), Game);
+    bool UseZlib = (Game <= EGame::EchoesDemo || Game == EGame::DKCReturns);
+    uint32 CompressionHeaderSize = (Game <= EGame::CorruptionProto ? 4 : 0x10);
+    auto Iter = AssetList.begin();
 
-        // Update progress bar
-        if (ResIdx & 0x1 || ResIdx == AssetList.size() - 1)
-        {
-            pProgress->Report(ResIdx, AssetList.size(), TString::Format("Writing asset %d/%d: %s", ResIdx+1, AssetList.size(), *(pEntry->Name() + "." + pEntry->CookedExtension())));
-        }
-
-        // Update table info
-        SResourceTableInfo& rTableInfo = ResourceTableData[ResIdx];
-        rTableInfo.pEntry = pEntry;
-        rTableInfo.Offset = (Game <= EGame::Echoes ? AssetOffset : AssetOffset - ResDataOffset);
+    while (ResIdx < AssetList.size() && !pProgress->ShouldCancel())
+    {
+        uint32 BatchStart = ResIdx;
+        uint32 BatchSize = Math::Min<uint32>(gkCookBatchSize, AssetList.size() - BatchStart);
+        Batch.clear();
+        Batch.resize(BatchSize);
 
-        // Load resource data
-        CFileInStream CookedAsset(pEntry->CookedAssetPath(), EEndian::BigEndian);
-        ASSERT(CookedAsset.IsValid());
-        uint32 ResourceSize = CookedAsset.Size();
+        // Initialize entries, recook assets if needed; this modifies the resource store, so it stays on this thread
+        for (uint32 BatchIdx = 0; BatchIdx < BatchSize && !pProgress->ShouldCancel(); BatchIdx++, Iter++)
+        {
+            CAssetID ID = *Iter;
+            CResourceEntry *pEntry = gpResourceStore->FindEntry(ID);
+            ASSERT(pEntry != nullptr);
 
-        std::vector<uint8> ResourceData(ResourceSize);
-        CookedAsset.ReadBytes(ResourceData.data(), ResourceData.size());
+            if (pEntry->NeedsRecook())
+            {
+                pProgress->Report(BatchStart + BatchIdx, AssetList.size(), "Cooking asset: " + pEntry->Name() + "." + pEntry->CookedExtension());
+                pEntry->Cook();
+            }
 
-        // Check if this asset should be compressed; there are a few resource types that are
-        // always compressed, and some types that are compressed if they're over a certain size
-        EResourceType Type = pEntry->ResourceType();
-        uint32 CompressThreshold = (Game <= EGame::CorruptionProto ? 0x400 : 0x80);
+            // Map resource data; the cooked file is written to the pak straight out of the mapping
+            SPendingAsset& rAsset = Batch[BatchIdx];
+            rAsset.pEntry = pEntry;
+            rAsset.pCookedData = std::make_unique<CMappedFile>(pEntry->CookedAssetPath());
+            ASSERT(rAsset.pCookedData->IsValid());
+            rAsset.ShouldCompress = ShouldCompressAsset(Game, pEntry->ResourceType(), (uint32) rAsset.pCookedData->Size());
+            rAsset.Compressed = false;
+            rAsset.DataHash = 0;
+            rAsset.pkCached = nullptr;
+            rAsset.CompressedSize = 0;
+        }
 
-        bool ShouldAlwaysCompress = (Type == EResourceType::Texture || Type == EResourceType::Model ||
-                                     Type == EResourceType::Skin || Type == EResourceType::AnimSet ||
-                                     Type == EResourceType::Animation || Type == EResourceType::Font);
+        if (pProgress->ShouldCancel())
+            break;
 
-        if (Game >= EGame::Corruption)
+        // Compress the batch. Assets whose cooked data hasn't changed since the last cook reuse the cached result.
+        bool Finished = ParallelUtil::ParallelFor(BatchSize, [&](uint32 BatchIdx)
         {
-            ShouldAlwaysCompress = ShouldAlwaysCompress ||
-                                   (Type == EResourceType::Character || Type == EResourceType::SourceAnimData ||
-                                    Type == EResourceType::Scan || Type == EResourceType::AudioSample ||
-                                    Type == EResourceType::StringTable || Type == EResourceType::AudioAmplitudeData ||
-                                    Type == EResourceType::DynamicCollision);
-        }
+            SPendingAsset& rAsset = Batch[BatchIdx];
+            if (!rAsset.ShouldCompress) return;
 
-        bool ShouldCompressConditional = !ShouldAlwaysCompress &&
-                (Type == EResourceType::Particle || Type == EResourceType::ParticleElectric ||
-                 Type == EResourceType::ParticleSwoosh || Type == EResourceType::ParticleWeapon ||
-                 Type == EResourceType::ParticleDecal || Type == EResourceType::ParticleCollisionResponse ||
-                 Type == EResourceType::ParticleSpawn || Type == EResourceType::ParticleSorted ||
-                 Type == EResourceType::BurstFireData);
+            const uint8 *pkResourceData = rAsset.pCookedData->Data();
+            uint32 ResourceSize = (uint32) rAsset.pCookedData->Size();
+            rAsset.DataHash = CCompressedAssetCache::HashData(pkResourceData, ResourceSize);
+            rAsset.pkCached = CompressionCache.Find(rAsset.pEntry->ID(), rAsset.DataHash, ResourceSize, Level);
 
-        bool ShouldCompress = ShouldAlwaysCompress || (ShouldCompressConditional && ResourceSize >= CompressThreshold);
-
-        // Write resource data to pak
-        if (!ShouldCompress)
-        {
-            Pak.WriteBytes(ResourceData.data(), ResourceSize);
-            rTableInfo.Compressed = false;
-        }
+            if (rAsset.pkCached)
+            {
+                rAsset.Compressed = rAsset.pkCached->Compressed;
+                return;
+            }
 
-        else
-        {
-            uint32 CompressedSize;
-            std::vector<uint8> CompressedData(ResourceData.size() * 2);
+            rAsset.CompressedData.resize(ResourceSize * 2);
             bool Success = false;
 
-            if (Game <= EGame::EchoesDemo || Game == EGame::DKCReturns)
-                Success = CompressionUtil::CompressZlib(ResourceData.data(), ResourceData.size(), CompressedData.data(), CompressedData.size(), CompressedSize);
+            if (UseZlib)
+                Success = CompressionUtil::CompressZlib(pkResourceData, ResourceSize, rAsset.CompressedData.data(), rAsset.CompressedData.size(), rAsset.CompressedSize, Level);
             else
-                Success = CompressionUtil::CompressLZOSegmented(ResourceData.data(), ResourceData.size(), CompressedData.data(), CompressedSize, false);
+                Success = CompressionUtil::CompressLZOSegmented(pkResourceData, ResourceSize, rAsset.CompressedData.data(), rAsset.CompressedSize, false, Level);
 
             // Make sure that the compressed data is actually smaller, accounting for padding + uncompressed size value
             if (Success)
             {
-                uint32 CompressionHeaderSize = (Game <= EGame::CorruptionProto ? 4 : 0x10);
                 uint32 PaddedUncompressedSize = (ResourceSize + AlignmentMinusOne) & ~AlignmentMinusOne;
-                uint32 PaddedCompressedSize = (CompressedSize + CompressionHeaderSize + AlignmentMinusOne) & ~AlignmentMinusOne;
+                uint32 PaddedCompressedSize = (rAsset.CompressedSize + CompressionHeaderSize + AlignmentMinusOne) & ~AlignmentMinusOne;
                 Success = (PaddedCompressedSize < PaddedUncompressedSize);
             }
 
-            // Write file to pak
-            if (Success)
+            rAsset.Compressed = Success;
+        },
+        0, [pProgress](uint32) { return !pProgress->ShouldCancel(); });
+
+        if (!Finished)
+            break;
+
+        // Write the batch to the pak
+        for (uint32 BatchIdx = 0; BatchIdx < BatchSize; BatchIdx++, ResIdx++)
+        {
+            SPendingAsset& rAsset = Batch[BatchIdx];
+            CResourceEntry *pEntry = rAsset.pEntry;
+            uint32 AssetOffset = Pak.Tell();
+
+            // Update progress bar
+            if (ResIdx & 0x1 || ResIdx == AssetList.size() - 1)
             {
+                pProgress->Report(ResIdx, AssetList.size(), TString::Format("Writing asset %d/%d: %s", ResIdx+1, AssetList.size(), *(pEntry->Name() + "." + pEntry->CookedExtension())));
+            }
+
+            // Update table info
+            SResourceTableInfo& rTableInfo = ResourceTableData[ResIdx];
+            rTableInfo.pEntry = pEntry;
+            rTableInfo.Offset = (Game <= EGame::Echoes ? AssetOffset : AssetOffset - ResDataOffset);
+            rTableInfo.Compressed = rAsset.Compressed;
+
+            const uint8 *pkResourceData = rAsset.pCookedData->Data();
+            uint32 ResourceSize = (uint32) rAsset.pCookedData->Size();
+
+            // Write resource data to pak
+            if (!rAsset.Compressed)
+                Pak.WriteBytes(pkResourceData, ResourceSize);
+
+            else
+            {
+                const uint8 *pkCompressedData = (rAsset.pkCached ? rAsset.pkCached->pkCompressedData : rAsset.CompressedData.data());
+                uint32 CompressedSize = (rAsset.pkCached ? rAsset.pkCached->CompressedSize : rAsset.CompressedSize);
+
                 // Write MP1/2 compressed asset
                 if (Game <= EGame::CorruptionProto)
                 {
@@ -272,16 +356,25 @@ void CPackage::Cook(IProgressNotifier *pProgress)
                     Pak.WriteLong(0xA0000000 | CompressedSize);
                     Pak.WriteLong(ResourceSize);
                 }
-                Pak.WriteBytes(CompressedData.data(), CompressedSize);
+                Pak.WriteBytes(pkCompressedData, CompressedSize);
             }
-            else
-                Pak.WriteBytes(ResourceData.data(), ResourceSize);
 
-            rTableInfo.Compressed = Success;
-        }
+            // Remember the result so the asset doesn't need to be compressed again next time
+            if (rAsset.ShouldCompress)
+            {
+                CCompressedAssetCache::SEntry CacheEntry;
+                CacheEntry.DataHash = rAsset.DataHash;
+                CacheEntry.UncompressedSize = ResourceSize;
+                CacheEntry.Level = Level;
+                CacheEntry.Compressed = rAsset.Compressed;
+                CacheEntry.pkCompressedData = (rAsset.pkCached ? rAsset.pkCached->pkCompressedData : rAsset.CompressedData.data());
+                CacheEntry.CompressedSize = (rAsset.pkCached ? rAsset.pkCached->CompressedSize : rAsset.CompressedSize);
+                CompressionCache.Add(pEntry->ID(), CacheEntry);
+            }
 
-        Pak.WriteToBoundary(Alignment, 0xFF);
-        rTableInfo.Size = Pak.Tell() - AssetOffset;
+            Pak.WriteToBoundary(Alignment, 0xFF);
+            rTableInfo.Size = Pak.Tell() - AssetOffset;
+        }
     }
     ResDataSize = Pak.Tell() - ResDataOffset;
 
@@ -325,6 +418,7 @@ void CPackage::Cook(IProgressNotifier *pProgress)
 
         // Clear recook flag
         mNeedsRecook = false;
+        CompressionCache.Commit();
         debugf("Finished writing %s", *PakPath);
     }
 
@@ -452,3 +546,8 @@ TString CPackage::CookedPackagePath(bool Relative) const
     TString RelPath = mPakPath + mPakName + ".pak";
     return Relative ? RelPath : mpProject->DiscFilesystemRoot(false) + RelPath;
 }
+
+TString CPackage::CompressionCachePath() const
+{
+    return mpProject->PackagesDir(false) + mPakPath + mPakName + ".pakcache";
+}
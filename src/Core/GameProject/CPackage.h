@@ -18,6 +18,15 @@ enum class EPackageDefinitionVersion
     Current = EPackageDefinitionVersion::Max - 1
 };
 
+// Trades cook time against pak size. The compression cache only keeps each asset's output from the last profile it
+// was cooked with, so switching profiles recompresses every asset on the next cook.
+enum class ECookProfile
+{
+    Fast,       // Lowest compression level; for quick iteration while working on a mod
+    Default,
+    Max         // Smallest paks; for release builds
+};
+
 struct SNamedResource
 {
     TString Name;
@@ -61,12 +70,13 @@ public:
     void AddResource(const TString& rkName, const CAssetID& rkID, const CFourCC& rkType);
     void UpdateDependencyCache() const;
 
-    void Cook(IProgressNotifier *pProgress);
+    void Cook(IProgressNotifier *pProgress, ECookProfile Profile = ECookProfile::Max);
     void CompareOriginalAssetList(const std::list<CAssetID>& rkNewList);
     bool ContainsAsset(const CAssetID& rkID) const;
 
     TString DefinitionPath(bool Relative) const;
     TString CookedPackagePath(bool Relative) const;
+    TString CompressionCachePath() const;
 
     // Accessors
     inline TString Name() const                                         { return mPakName; }
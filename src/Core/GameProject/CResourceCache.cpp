@@ -0,0 +1,81 @@
+#include "CResourceCache.h"
+#include "CResourceStore.h"
+#include <Common/Macros.h>
+
+CResourceCache::CResourceCache(CResourceStore *pStore, uint32 MaxCachedResources)
+    : mpStore(pStore)
+    , mMaxCachedResources(MaxCachedResources)
+{
+    ASSERT(mpStore);
+}
+
+CResourceCache::~CResourceCache()
+{
+    Clear();
+}
+
+CResource* CResourceCache::Acquire(CResourceEntry *pEntry)
+{
+    auto Find = mCache.find(pEntry->ID());
+
+    if (Find != mCache.end())
+    {
+        SCachedResource& rCached = Find->second;
+
+        if (rCached.PinCount == 0)
+            mReleasedList.erase(rCached.ReleasedIter);
+
+        rCached.PinCount++;
+        return rCached.pResource;
+    }
+
+    CResource *pRes = pEntry->Load();
+    if (!pRes) return nullptr;
+
+    SCachedResource& rCached = mCache[pEntry->ID()];
+    rCached.pResource = pRes;
+    rCached.PinCount = 1;
+    rCached.ReleasedIter = mReleasedList.end();
+    return pRes;
+}
+
+void CResourceCache::Release(CResourceEntry *pEntry)
+{
+    auto Find = mCache.find(pEntry->ID());
+    if (Find == mCache.end()) return;
+
+    SCachedResource& rCached = Find->second;
+    ASSERT(rCached.PinCount > 0);
+    rCached.PinCount--;
+
+    if (rCached.PinCount == 0)
+    {
+        mReleasedList.push_front(pEntry->ID());
+        rCached.ReleasedIter = mReleasedList.begin();
+
+        if (mCache.size() > mMaxCachedResources)
+            EvictResources();
+    }
+}
+
+void CResourceCache::Clear()
+{
+    mCache.clear();
+    mReleasedList.clear();
+    mpStore->DestroyUnreferencedResources();
+}
+
+// ************ PROTECTED ************
+void CResourceCache::EvictResources()
+{
+    // Garbage collection walks every loaded resource, so evict in batches rather than one at a time
+    uint32 Target = mMaxCachedResources - (mMaxCachedResources / 4);
+
+    while (mCache.size() > Target && !mReleasedList.empty())
+    {
+        mCache.erase(mReleasedList.back());
+        mReleasedList.pop_back();
+    }
+
+    mpStore->DestroyUnreferencedResources();
+}
@@ -0,0 +1,44 @@
+#ifndef CRESOURCECACHE_H
+#define CRESOURCECACHE_H
+
+#include "CResourceEntry.h"
+#include "Core/Resource/TResPtr.h"
+#include <Common/CAssetID.h>
+#include <list>
+#include <map>
+
+/* Keeps loaded resources resident across multiple operations so their dependents don't have to reload them.
+ * Acquired resources are pinned and are never evicted while pinned. Once released, a resource stays loaded
+ * until the number of cached resources exceeds the limit, at which point the least recently released
+ * resources are dropped and the store garbage collects anything that is no longer referenced. */
+class CResourceCache
+{
+    struct SCachedResource
+    {
+        TResPtr<CResource> pResource;
+        uint32 PinCount;
+        std::list<CAssetID>::iterator ReleasedIter;
+    };
+
+    CResourceStore *mpStore;
+    uint32 mMaxCachedResources;
+    std::map<CAssetID, SCachedResource> mCache;
+    std::list<CAssetID> mReleasedList; // Unpinned resources; most recently released at the front
+
+public:
+    CResourceCache(CResourceStore *pStore, uint32 MaxCachedResources);
+    ~CResourceCache();
+
+    CResource* Acquire(CResourceEntry *pEntry);
+    void Release(CResourceEntry *pEntry);
+    void Clear();
+
+    // Accessors
+    inline uint32 NumCachedResources() const    { return mCache.size(); }
+    inline uint32 NumPinnedResources() const    { return mCache.size() - mReleasedList.size(); }
+
+protected:
+    void EvictResources();
+};
+
+#endif // CRESOURCECACHE_H
@@ -0,0 +1,536 @@
+#include "CResourceDatabaseCache.h"
+#include "CDependencyIndex.h"
+#include "CResourceEntry.h"
+#include "CResourceStore.h"
+#include "CDependencyTree.h"
+#include <Common/FileIO.h>
+#include <Common/FileUtil.h>
+#include <Common/Log.h>
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <Common/Serialization/Binary.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+const uint32 gkDatabaseMagic = FOURCC('RDBC');
+
+// Bump this whenever the record layout or the dependency tree serializers change
+const uint32 gkDatabaseVersion = 2;
+
+// Record table size for new files; the table is given some slack so new entries can be added without a rewrite
+const uint32 gkMinRecordCapacity = 1024;
+
+// Heap data that's no longer referenced is only reclaimed by a full rewrite, once there's more of it than live data
+const uint64 gkMinGarbageForRewrite = 0x400000;
+
+CResourceDatabaseCache::CResourceDatabaseCache(const TString& rkPath, EGame Game)
+    : mPath(rkPath)
+    , mGame(Game)
+    , mNeedsRewrite(false)
+{
+    memset(&mHeader, 0, sizeof(SHeader));
+}
+
+CResourceDatabaseCache::~CResourceDatabaseCache()
+{
+    Close();
+}
+
+bool CResourceDatabaseCache::Load(CResourceStore *pStore, std::vector<CResourceEntry*>& rOutEntries, TStringList& rOutEmptyDirectories)
+{
+    std::lock_guard<std::recursive_mutex> Lock(mMutex);
+
+    if (!MapFile())
+        return false;
+
+    const SRecord *pkRecords = (const SRecord*) mFile.DataAt(sizeof(SHeader), (uint64) mHeader.NumRecords * sizeof(SRecord));
+    EGame Game = (EGame) mHeader.Game;
+
+    // Validate every record up front, so a damaged file doesn't leave half of its entries in the store
+    for (uint32 RecordIdx = 0; RecordIdx < mHeader.NumRecords; RecordIdx++)
+    {
+        const SRecord& rkRecord = pkRecords[RecordIdx];
+        if (!rkRecord.InUse) continue;
+
+        if (!mFile.DataAt(rkRecord.StringOffset, (uint64) rkRecord.NameLength + rkRecord.DirectoryLength) ||
+            !mFile.DataAt(rkRecord.DependenciesOffset, rkRecord.DependenciesSize) ||
+            (uint64) rkRecord.NumReferences * sizeof(uint64) > rkRecord.DependenciesSize ||
+            !CResTypeInfo::FindTypeInfo((EResourceType) rkRecord.Type))
+        {
+            errorf("Resource database is corrupt: %s", *mPath);
+            Close();
+            return false;
+        }
+    }
+
+    EIDLength IDLength = CAssetID::GameIDLength(Game);
+    mGame = Game;
+    mFreeRecords.clear();
+    mDeletedRecords.clear();
+    rOutEntries.reserve(mHeader.NumRecords);
+
+    for (uint32 RecordIdx = 0; RecordIdx < mHeader.NumRecords; RecordIdx++)
+    {
+        const SRecord& rkRecord = pkRecords[RecordIdx];
+
+        if (rkRecord.InUse)
+        {
+            const char *pkStrings = (const char*) mFile.DataAt(rkRecord.StringOffset, (uint64) rkRecord.NameLength + rkRecord.DirectoryLength);
+            rOutEntries.push_back( CResourceEntry::BuildFromDatabaseCache(pStore, CAssetID(rkRecord.ID, IDLength), rkRecord, pkStrings, RecordIdx) );
+
+            if (rkRecord.NumReferences > 0)
+            {
+                uint32 ReferencesSize = rkRecord.NumReferences * sizeof(uint64);
+                std::vector<uint64> References(rkRecord.NumReferences);
+                memcpy(References.data(), mFile.DataAt(rkRecord.DependenciesOffset + rkRecord.DependenciesSize - ReferencesSize, ReferencesSize), ReferencesSize);
+                pStore->DependencyIndex()->SetReferences(rkRecord.ID, References);
+            }
+        }
+        else
+            mFreeRecords.push_back(RecordIdx);
+    }
+
+    for (uint32 RecordIdx = mHeader.NumRecords; RecordIdx < mHeader.RecordCapacity; RecordIdx++)
+        mFreeRecords.push_back(RecordIdx);
+
+    // Free records are handed out from the back; keep the lowest indices there so the table stays dense
+    std::sort(mFreeRecords.begin(), mFreeRecords.end(), std::greater<uint32>());
+
+    // Empty directory list
+    const uint8 *pkEmptyDirs = mFile.DataAt(mHeader.EmptyDirectoriesOffset, mHeader.EmptyDirectoriesSize);
+
+    if (pkEmptyDirs && mHeader.EmptyDirectoriesSize >= 4)
+    {
+        CMemoryInStream EmptyDirs(pkEmptyDirs, mHeader.EmptyDirectoriesSize, EEndian::LittleEndian);
+        uint32 NumDirs = EmptyDirs.ReadLong();
+
+        for (uint32 DirIdx = 0; DirIdx < NumDirs && EmptyDirs.Tell() + 4 <= EmptyDirs.Size(); DirIdx++)
+        {
+            uint32 Length = EmptyDirs.ReadLong();
+            if (EmptyDirs.Tell() + Length > EmptyDirs.Size()) break;
+            rOutEmptyDirectories.push_back( EmptyDirs.ReadString(Length) );
+        }
+    }
+
+    mNeedsRewrite = false;
+    return true;
+}
+
+bool CResourceDatabaseCache::Save(const std::map<CAssetID, CResourceEntry*>& rkEntries, const TStringList& rkEmptyDirectories)
+{
+    std::lock_guard<std::recursive_mutex> Lock(mMutex);
+
+    if (!mFile.IsValid() || mNeedsRewrite)
+        return SaveFull(rkEntries, rkEmptyDirectories);
+
+    std::vector<CResourceEntry*> DirtyEntries;
+    uint32 NumNewEntries = 0;
+
+    for (auto Iter = rkEntries.begin(); Iter != rkEntries.end(); Iter++)
+    {
+        CResourceEntry *pEntry = Iter->second;
+
+        if (pEntry->mCacheRecord == -1)
+        {
+            DirtyEntries.push_back(pEntry);
+            NumNewEntries++;
+        }
+        else if (pEntry->mCacheRecordDirty || pEntry->mCacheDependenciesDirty)
+            DirtyEntries.push_back(pEntry);
+    }
+
+    // Fall back to a full rewrite if the record table is full or the heap is mostly garbage
+    uint64 Garbage = (mHeader.HeapEnd - HeapStart()) - mHeader.LiveDataSize;
+    bool TableFull = (NumNewEntries > mFreeRecords.size() + mDeletedRecords.size());
+    bool TooMuchGarbage = (Garbage > gkMinGarbageForRewrite && Garbage > mHeader.LiveDataSize);
+
+    if (TableFull || TooMuchGarbage)
+        return SaveFull(rkEntries, rkEmptyDirectories);
+
+    if (SaveIncremental(DirtyEntries, rkEmptyDirectories))
+        return true;
+
+    // The file couldn't be updated in place; try writing a new one instead
+    return SaveFull(rkEntries, rkEmptyDirectories);
+}
+
+void CResourceDatabaseCache::Close()
+{
+    std::lock_guard<std::recursive_mutex> Lock(mMutex);
+    mFile.Close();
+    mFreeRecords.clear();
+    mDeletedRecords.clear();
+}
+
+CDependencyTree* CResourceDatabaseCache::LoadDependencies(const CResourceEntry *pkEntry)
+{
+    std::lock_guard<std::recursive_mutex> Lock(mMutex);
+
+    // Another thread may have loaded them while we were waiting for the lock
+    if (pkEntry->mpDependencies || pkEntry->mCachedDependenciesSize == 0)
+        return pkEntry->mpDependencies;
+
+    const uint8 *pkData = mFile.DataAt(pkEntry->mCachedDependenciesOffset, pkEntry->mCachedDependenciesSize);
+
+    if (!pkData)
+    {
+        errorf("Failed to load cached dependencies for resource: %s", *pkEntry->ID().ToString());
+        return nullptr;
+    }
+
+    CBasicBinaryReader Reader((void*) pkData, pkEntry->mCachedDependenciesSize, CSerialVersion(IArchive::skCurrentArchiveVersion, 0, mGame));
+    CDependencyTree *pTree = nullptr;
+    Reader << SerialParameter("Dependencies", pTree);
+    pkEntry->mpDependencies = pTree;
+    return pTree;
+}
+
+void CResourceDatabaseCache::RemoveEntry(CResourceEntry *pEntry)
+{
+    std::lock_guard<std::recursive_mutex> Lock(mMutex);
+
+    if (pEntry->mCacheRecord == -1)
+        return;
+
+    // The record is cleared on the next save; its data stops counting as live right away
+    const SRecord *pkRecord = (const SRecord*) mFile.DataAt(sizeof(SHeader) + (uint64) pEntry->mCacheRecord * sizeof(SRecord), sizeof(SRecord));
+
+    if (pkRecord && pkRecord->InUse)
+        mHeader.LiveDataSize -= pkRecord->NameLength + pkRecord->DirectoryLength + pkRecord->DependenciesSize;
+
+    mDeletedRecords.push_back(pEntry->mCacheRecord);
+    pEntry->mCacheRecord = -1;
+}
+
+void CResourceDatabaseCache::Invalidate()
+{
+    std::lock_guard<std::recursive_mutex> Lock(mMutex);
+    mNeedsRewrite = true;
+}
+
+// ************ PROTECTED ************
+bool CResourceDatabaseCache::MapFile()
+{
+    mFile.Close();
+
+    if (!FileUtil::Exists(mPath) || !mFile.Open(mPath))
+        return false;
+
+    const uint8 *pkHeader = mFile.DataAt(0, sizeof(SHeader));
+
+    if (!pkHeader)
+    {
+        mFile.Close();
+        return false;
+    }
+
+    memcpy(&mHeader, pkHeader, sizeof(SHeader));
+
+    // Files in another format (including the previous database format) aren't loaded; the store will convert them
+    if (mHeader.Magic != gkDatabaseMagic || mHeader.Version != gkDatabaseVersion ||
+        mHeader.ArchiveVersion != IArchive::skCurrentArchiveVersion ||
+        mHeader.NumRecords > mHeader.RecordCapacity ||
+        !mFile.DataAt(0, HeapStart()) || mHeader.HeapEnd > mFile.Size() || mHeader.HeapEnd < HeapStart())
+    {
+        memset(&mHeader, 0, sizeof(SHeader));
+        mFile.Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool CResourceDatabaseCache::SaveIncremental(const std::vector<CResourceEntry*>& rkDirtyEntries, const TStringList& rkEmptyDirectories)
+{
+    // Work on copies of the header and free list, so nothing changes if the file can't be written
+    SHeader Header = mHeader;
+    std::vector<uint32> FreeRecords = mFreeRecords;
+    FreeRecords.insert(FreeRecords.end(), mDeletedRecords.begin(), mDeletedRecords.end());
+    std::sort(FreeRecords.begin(), FreeRecords.end(), std::greater<uint32>());
+
+    std::vector<uint8> NewData;
+    std::vector<std::pair<uint32, SRecord>> Patches;
+    Patches.reserve(rkDirtyEntries.size());
+
+    auto AppendData = [&NewData, &Header](const void *pkData, uint32 Size) -> uint64
+    {
+        uint64 Offset = Header.HeapEnd + NewData.size();
+        NewData.insert(NewData.end(), (const uint8*) pkData, (const uint8*) pkData + Size);
+        return Offset;
+    };
+
+    for (CResourceEntry *pEntry : rkDirtyEntries)
+    {
+        uint32 RecordIdx = pEntry->mCacheRecord;
+        bool WriteDependencies = pEntry->mCacheDependenciesDirty || RecordIdx == -1;
+        uint32 OldNumReferences = 0;
+
+        // Data that's being replaced is garbage from now on
+        if (RecordIdx != -1)
+        {
+            const SRecord& rkOld = ((const SRecord*) mFile.DataAt(sizeof(SHeader), (uint64) Header.NumRecords * sizeof(SRecord)))[RecordIdx];
+            Header.LiveDataSize -= rkOld.NameLength + rkOld.DirectoryLength;
+            if (WriteDependencies) Header.LiveDataSize -= rkOld.DependenciesSize;
+            OldNumReferences = rkOld.NumReferences;
+        }
+        else
+        {
+            RecordIdx = FreeRecords.back();
+            FreeRecords.pop_back();
+            Header.NumRecords = Math::Max(Header.NumRecords, RecordIdx + 1);
+        }
+
+        TString Dir = pEntry->DirectoryPath();
+        SRecord Record = {};
+        Record.ID = pEntry->ID().ToLongLong();
+        Record.Type = (uint32) pEntry->ResourceType();
+        Record.Flags = (uint32) pEntry->mFlags;
+        Record.NameLength = (uint16) pEntry->mName.Size();
+        Record.DirectoryLength = (uint16) Dir.Size();
+        Record.StringOffset = AppendData(*pEntry->mName, Record.NameLength);
+        AppendData(*Dir, Record.DirectoryLength);
+        Record.InUse = 1;
+
+        if (WriteDependencies)
+        {
+            std::vector<uint8> Dependencies = SerializeDependencies(pEntry, Record.NumReferences);
+            Record.DependenciesSize = Dependencies.size();
+            Record.DependenciesOffset = AppendData(Dependencies.data(), Dependencies.size());
+        }
+        else
+        {
+            Record.DependenciesOffset = pEntry->mCachedDependenciesOffset;
+            Record.DependenciesSize = pEntry->mCachedDependenciesSize;
+            Record.NumReferences = OldNumReferences;
+        }
+
+        Header.LiveDataSize += Record.NameLength + Record.DirectoryLength + (WriteDependencies ? Record.DependenciesSize : 0);
+        Patches.push_back( std::make_pair(RecordIdx, Record) );
+    }
+
+    std::vector<uint8> EmptyDirs = SerializeEmptyDirectories(rkEmptyDirectories);
+    Header.LiveDataSize -= Header.EmptyDirectoriesSize;
+    Header.EmptyDirectoriesSize = EmptyDirs.size();
+    Header.EmptyDirectoriesOffset = AppendData(EmptyDirs.data(), EmptyDirs.size());
+    Header.LiveDataSize += Header.EmptyDirectoriesSize;
+    Header.HeapEnd += NewData.size();
+
+    // The file can't be written while it's mapped
+    mFile.Close();
+    FILE *pFile = fopen(*mPath, "r+b");
+
+    if (!pFile)
+    {
+        warnf("Unable to open resource database for writing: %s", *mPath);
+        MapFile();
+        return false;
+    }
+
+    // Write new data first and the header last, so the file stays consistent for as long as possible
+    bool Success = (fseek(pFile, (long) mHeader.HeapEnd, SEEK_SET) == 0) &&
+                   (NewData.empty() || fwrite(NewData.data(), NewData.size(), 1, pFile) == 1);
+
+    SRecord EmptyRecord = {};
+
+    for (uint32 RecordIdx : mDeletedRecords)
+    {
+        Success = Success && (fseek(pFile, (long) (sizeof(SHeader) + RecordIdx * sizeof(SRecord)), SEEK_SET) == 0) &&
+                             (fwrite(&EmptyRecord, sizeof(SRecord), 1, pFile) == 1);
+    }
+
+    for (const auto& rkPatch : Patches)
+    {
+        Success = Success && (fseek(pFile, (long) (sizeof(SHeader) + rkPatch.first * sizeof(SRecord)), SEEK_SET) == 0) &&
+                             (fwrite(&rkPatch.second, sizeof(SRecord), 1, pFile) == 1);
+    }
+
+    Success = Success && (fseek(pFile, 0, SEEK_SET) == 0) && (fwrite(&Header, sizeof(SHeader), 1, pFile) == 1);
+    Success = (fclose(pFile) == 0) && Success;
+
+    if (!Success)
+    {
+        // The file is in an unknown state now, so it has to be rewritten
+        warnf("Failed to update resource database: %s", *mPath);
+        mNeedsRewrite = true;
+        MapFile();
+        return false;
+    }
+
+    // Commit the new state
+    for (uint32 PatchIdx = 0; PatchIdx < Patches.size(); PatchIdx++)
+    {
+        CResourceEntry *pEntry = rkDirtyEntries[PatchIdx];
+        const SRecord& rkRecord = Patches[PatchIdx].second;
+        pEntry->mCacheRecord = Patches[PatchIdx].first;
+        pEntry->mCachedDependenciesOffset = rkRecord.DependenciesOffset;
+        pEntry->mCachedDependenciesSize = rkRecord.DependenciesSize;
+        pEntry->mCacheRecordDirty = false;
+        pEntry->mCacheDependenciesDirty = false;
+    }
+
+    mFreeRecords = FreeRecords;
+    mDeletedRecords.clear();
+    MapFile();
+    return true;
+}
+
+bool CResourceDatabaseCache::SaveFull(const std::map<CAssetID, CResourceEntry*>& rkEntries, const TStringList& rkEmptyDirectories)
+{
+    uint32 NumEntries = rkEntries.size();
+
+    SHeader Header;
+    memset(&Header, 0, sizeof(SHeader));
+    Header.Magic = gkDatabaseMagic;
+    Header.Version = gkDatabaseVersion;
+    Header.ArchiveVersion = IArchive::skCurrentArchiveVersion;
+    Header.Game = (uint32) mGame;
+    Header.RecordCapacity = Math::Max(gkMinRecordCapacity, NumEntries + NumEntries / 4);
+    Header.NumRecords = NumEntries;
+
+    std::vector<SRecord> Records(Header.RecordCapacity, SRecord {});
+    {
+        CFileOutStream File(TempPath(), EEndian::LittleEndian);
+
+        if (!File.IsValid())
+        {
+            warnf("Unable to open resource database for writing: %s", *TempPath());
+            return false;
+        }
+
+        // Reserve space for the header and record table; they're written once the heap is done
+        File.WriteBytes(&Header, sizeof(SHeader));
+        File.WriteBytes(Records.data(), Records.size() * sizeof(SRecord));
+
+        uint32 RecordIdx = 0;
+
+        for (auto Iter = rkEntries.begin(); Iter != rkEntries.end(); Iter++, RecordIdx++)
+        {
+            CResourceEntry *pEntry = Iter->second;
+            SRecord& rRecord = Records[RecordIdx];
+            TString Dir = pEntry->DirectoryPath();
+
+            rRecord.ID = pEntry->ID().ToLongLong();
+            rRecord.Type = (uint32) pEntry->ResourceType();
+            rRecord.Flags = (uint32) pEntry->mFlags;
+            rRecord.InUse = 1;
+
+            rRecord.StringOffset = File.Tell();
+            rRecord.NameLength = (uint16) pEntry->mName.Size();
+            rRecord.DirectoryLength = (uint16) Dir.Size();
+            File.WriteBytes(*pEntry->mName, rRecord.NameLength);
+            File.WriteBytes(*Dir, rRecord.DirectoryLength);
+
+            // Dependencies that were never loaded are copied over as-is
+            rRecord.DependenciesOffset = File.Tell();
+
+            if (pEntry->mpDependencies)
+            {
+                std::vector<uint8> Dependencies = SerializeDependencies(pEntry, rRecord.NumReferences);
+                rRecord.DependenciesSize = Dependencies.size();
+                File.WriteBytes(Dependencies.data(), Dependencies.size());
+            }
+            else if (pEntry->mCachedDependenciesSize > 0)
+            {
+                const uint8 *pkData = mFile.DataAt(pEntry->mCachedDependenciesOffset, pEntry->mCachedDependenciesSize);
+
+                if (pkData)
+                {
+                    rRecord.DependenciesSize = pEntry->mCachedDependenciesSize;
+                    rRecord.NumReferences = RecordNumReferences(pEntry->mCacheRecord);
+                    File.WriteBytes(pkData, rRecord.DependenciesSize);
+                }
+            }
+
+            Header.LiveDataSize += rRecord.NameLength + rRecord.DirectoryLength + rRecord.DependenciesSize;
+        }
+
+        std::vector<uint8> EmptyDirs = SerializeEmptyDirectories(rkEmptyDirectories);
+        Header.EmptyDirectoriesOffset = File.Tell();
+        Header.EmptyDirectoriesSize = EmptyDirs.size();
+        Header.LiveDataSize += Header.EmptyDirectoriesSize;
+        File.WriteBytes(EmptyDirs.data(), EmptyDirs.size());
+        Header.HeapEnd = File.Tell();
+
+        File.Seek(0, SEEK_SET);
+        File.WriteBytes(&Header, sizeof(SHeader));
+        File.WriteBytes(Records.data(), Records.size() * sizeof(SRecord));
+    }
+
+    // Replace the previous file; every entry has been written out, so it's no longer needed
+    mFile.Close();
+
+    if (FileUtil::Exists(mPath))
+        FileUtil::DeleteFile(mPath);
+
+    if (!FileUtil::MoveFile(TempPath(), mPath))
+    {
+        warnf("Failed to save resource database: %s", *mPath);
+        FileUtil::DeleteFile(TempPath());
+        mNeedsRewrite = true;
+        return false;
+    }
+
+    uint32 RecordIdx = 0;
+
+    for (auto Iter = rkEntries.begin(); Iter != rkEntries.end(); Iter++, RecordIdx++)
+    {
+        CResourceEntry *pEntry = Iter->second;
+        pEntry->mCacheRecord = RecordIdx;
+        pEntry->mCachedDependenciesOffset = Records[RecordIdx].DependenciesOffset;
+        pEntry->mCachedDependenciesSize = Records[RecordIdx].DependenciesSize;
+        pEntry->mCacheRecordDirty = false;
+        pEntry->mCacheDependenciesDirty = false;
+    }
+
+    mFreeRecords.clear();
+    mDeletedRecords.clear();
+
+    for (uint32 FreeIdx = Header.RecordCapacity; FreeIdx > NumEntries; FreeIdx--)
+        mFreeRecords.push_back(FreeIdx - 1);
+
+    mNeedsRewrite = false;
+    MapFile();
+    return true;
+}
+
+std::vector<uint8> CResourceDatabaseCache::SerializeDependencies(CResourceEntry *pEntry, uint32& rOutNumReferences) const
+{
+    rOutNumReferences = 0;
+
+    if (!pEntry->mpDependencies)
+        return std::vector<uint8>();
+
+    CVectorOutStream Data;
+    {
+        CBasicBinaryWriter Writer(&Data, CSerialVersion(IArchive::skCurrentArchiveVersion, 0, mGame));
+        Writer << SerialParameter("Dependencies", pEntry->mpDependencies);
+    }
+
+    // The reference list goes after the tree, so reading the tree isn't affected by it
+    std::vector<uint64> References = pEntry->ResourceStore()->DependencyIndex()->References( pEntry->ID().ToLongLong() );
+    rOutNumReferences = References.size();
+
+    std::vector<uint8> Out((const uint8*) Data.Data(), (const uint8*) Data.Data() + Data.Size());
+    Out.insert(Out.end(), (const uint8*) References.data(), (const uint8*) (References.data() + References.size()));
+    return Out;
+}
+
+uint32 CResourceDatabaseCache::RecordNumReferences(uint32 RecordIdx) const
+{
+    if (RecordIdx == -1) return 0;
+    const SRecord *pkRecord = (const SRecord*) mFile.DataAt(sizeof(SHeader) + (uint64) RecordIdx * sizeof(SRecord), sizeof(SRecord));
+    return (pkRecord && pkRecord->InUse ? pkRecord->NumReferences : 0);
+}
+
+std::vector<uint8> CResourceDatabaseCache::SerializeEmptyDirectories(const TStringList& rkEmptyDirectories) const
+{
+    CVectorOutStream Data(EEndian::LittleEndian);
+    Data.WriteLong(rkEmptyDirectories.size());
+
+    for (auto Iter = rkEmptyDirectories.begin(); Iter != rkEmptyDirectories.end(); Iter++)
+        Data.WriteSizedString(*Iter);
+
+    return std::vector<uint8>((const uint8*) Data.Data(), (const uint8*) Data.Data() + Data.Size());
+}
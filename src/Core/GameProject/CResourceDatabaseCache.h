@@ -0,0 +1,104 @@
+#ifndef CRESOURCEDATABASECACHE_H
+#define CRESOURCEDATABASECACHE_H
+
+#include "Core/CMappedFile.h"
+#include <Common/BasicTypes.h>
+#include <Common/CAssetID.h>
+#include <Common/EGame.h>
+#include <Common/TString.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class CDependencyTree;
+class CResourceEntry;
+class CResourceStore;
+
+/* On-disk resource database. Every entry has a fixed-size record in a table at the start of the file, and its
+ * name, directory, dependency tree and reference list are stored in a data heap after the table. The file is memory mapped
+ * when the project is opened; entry records are read straight from the mapping, and an entry's dependency
+ * tree is only deserialized the first time it's accessed.
+ *
+ * Saving only touches entries that have changed since the last save. Their new data is appended to the heap
+ * and their records are patched in place. The file is only rewritten from scratch when the record table is
+ * full, or when most of the heap is taken up by data that's no longer referenced. */
+class CResourceDatabaseCache
+{
+public:
+    // Record for one entry; the table is written as-is so records can be read from the mapped file
+    struct SRecord
+    {
+        uint64 ID;
+        uint32 Type;
+        uint32 Flags;
+        uint64 StringOffset; // Name, followed by directory
+        uint64 DependenciesOffset; // Dependency tree, followed by the flattened list of referenced asset IDs
+        uint16 NameLength;
+        uint16 DirectoryLength;
+        uint32 NumReferences;
+        uint32 DependenciesSize; // Includes the reference list
+        uint32 InUse;
+    };
+    static_assert(sizeof(SRecord) == 0x30, "Resource database records must be 0x30 bytes");
+
+private:
+    struct SHeader
+    {
+        uint32 Magic;
+        uint32 Version;
+        uint32 ArchiveVersion;
+        uint32 Game;
+        uint32 RecordCapacity;
+        uint32 NumRecords; // Number of records in use, including freed records below the highest one in use
+        uint64 HeapEnd;
+        uint64 LiveDataSize; // Size of the heap data that's still referenced by a record
+        uint64 EmptyDirectoriesOffset;
+        uint32 EmptyDirectoriesSize;
+        uint32 Padding[3];
+    };
+    static_assert(sizeof(SHeader) == 0x40, "Resource database header must be 0x40 bytes");
+
+    TString mPath;
+    EGame mGame;
+    CMappedFile mFile;
+    SHeader mHeader;
+    std::recursive_mutex mMutex;
+
+    // Records that can be reused for new entries, and records of deleted entries that need to be cleared
+    std::vector<uint32> mFreeRecords;
+    std::vector<uint32> mDeletedRecords;
+
+    // Set when the file no longer matches the store, e.g. when the store has been rebuilt
+    bool mNeedsRewrite;
+
+public:
+    CResourceDatabaseCache(const TString& rkPath, EGame Game);
+    ~CResourceDatabaseCache();
+
+    // Creates entries for every record in the file and adds their references to the store's dependency index;
+    // returns false if the file is missing or in another format
+    bool Load(CResourceStore *pStore, std::vector<CResourceEntry*>& rOutEntries, TStringList& rOutEmptyDirectories);
+    bool Save(const std::map<CAssetID, CResourceEntry*>& rkEntries, const TStringList& rkEmptyDirectories);
+    void Close();
+
+    // Deserializes an entry's dependency tree from the file if it hasn't been yet and returns it; safe to call from multiple threads
+    CDependencyTree* LoadDependencies(const CResourceEntry *pkEntry);
+    void RemoveEntry(CResourceEntry *pEntry);
+    void Invalidate();
+
+    inline TString Path() const             { return mPath; }
+    inline EGame Game() const               { return mGame; }
+    inline bool IsLoaded() const            { return mFile.IsValid(); }
+
+protected:
+    bool MapFile();
+    inline uint64 HeapStart() const         { return sizeof(SHeader) + (uint64) mHeader.RecordCapacity * sizeof(SRecord); }
+    bool SaveIncremental(const std::vector<CResourceEntry*>& rkDirtyEntries, const TStringList& rkEmptyDirectories);
+    bool SaveFull(const std::map<CAssetID, CResourceEntry*>& rkEntries, const TStringList& rkEmptyDirectories);
+    std::vector<uint8> SerializeDependencies(CResourceEntry *pEntry, uint32& rOutNumReferences) const;
+    uint32 RecordNumReferences(uint32 RecordIdx) const;
+    std::vector<uint8> SerializeEmptyDirectories(const TStringList& rkEmptyDirectories) const;
+    inline TString TempPath() const         { return mPath + ".tmp"; }
+};
+
+#endif // CRESOURCEDATABASECACHE_H
@@ -1,6 +1,9 @@
 #include "CResourceEntry.h"
+#include "CAsyncLoader.h"
+#include "CDependencyIndex.h"
 #include "CGameProject.h"
 #include "CResourceStore.h"
+#include "Core/CMappedFile.h"
 #include "Core/Resource/CResource.h"
 #include "Core/Resource/Cooker/CResourceCooker.h"
 #include "Core/Resource/Factory/CResourceFactory.h"
@@ -12,6 +15,7 @@
 
 CResourceEntry::CResourceEntry(CResourceStore *pStore)
     : mpResource(nullptr)
+    , mIsLoading(false)
     , mpTypeInfo(nullptr)
     , mpStore(pStore)
     , mpDependencies(nullptr)
@@ -19,6 +23,11 @@ CResourceEntry::CResourceEntry(CResourceStore *pStore)
     , mpDirectory(nullptr)
     , mMetadataDirty(false)
     , mCachedSize(-1)
+    , mCacheRecord(-1)
+    , mCachedDependenciesOffset(0)
+    , mCachedDependenciesSize(0)
+    , mCacheRecordDirty(true)
+    , mCacheDependenciesDirty(true)
 {}
 
 // Static constructors
@@ -76,9 +85,58 @@ CResourceEntry* CResourceEntry::BuildFromDirectory(CResourceStore *pStore, CResT
     return pEntry;
 }
 
+CResourceEntry* CResourceEntry::BuildFromMetadata(CResourceStore *pStore, CResTypeInfo *pTypeInfo,
+                                                  CVirtualDirectory *pDir, const TString& rkName)
+{
+    // Same as BuildFromDirectory, except the directory must already exist and the entry isn't added to it.
+    // This doesn't modify the store, so entries can be built from multiple threads at once; the caller adds
+    // them to their directories afterwards.
+    ASSERT(pTypeInfo && pDir);
+
+    CResourceEntry *pEntry = new CResourceEntry(pStore);
+    pEntry->mpTypeInfo = pTypeInfo;
+    pEntry->mName = rkName;
+    pEntry->mCachedUppercaseName = rkName.ToUpper();
+    pEntry->mpDirectory = pDir;
+
+    if (!pEntry->LoadMetadata())
+    {
+        delete pEntry;
+        return nullptr;
+    }
+
+    return pEntry;
+}
+
+CResourceEntry* CResourceEntry::BuildFromDatabaseCache(CResourceStore *pStore, const CAssetID& rkID,
+                                                       const CResourceDatabaseCache::SRecord& rkRecord,
+                                                       const char *pkStrings, uint32 RecordIndex)
+{
+    // Load the entry info from the database record. The dependency tree stays in the database until it's needed.
+    CResourceEntry *pEntry = new CResourceEntry(pStore);
+    pEntry->mID = rkID;
+    pEntry->mpTypeInfo = CResTypeInfo::FindTypeInfo((EResourceType) rkRecord.Type);
+    pEntry->mFlags = FResEntryFlags(rkRecord.Flags);
+    pEntry->mName = TString(pkStrings, rkRecord.NameLength);
+    pEntry->mCachedUppercaseName = pEntry->mName.ToUpper();
+    ASSERT(pEntry->mpTypeInfo);
+
+    TString Dir(pkStrings + rkRecord.NameLength, rkRecord.DirectoryLength);
+    pEntry->mpDirectory = pStore->GetVirtualDirectory(Dir, true);
+    ASSERT(pEntry->mpDirectory);
+    pEntry->mpDirectory->AddChild("", pEntry);
+
+    pEntry->mCacheRecord = RecordIndex;
+    pEntry->mCachedDependenciesOffset = rkRecord.DependenciesOffset;
+    pEntry->mCachedDependenciesSize = rkRecord.DependenciesSize;
+    pEntry->mCacheRecordDirty = false;
+    pEntry->mCacheDependenciesDirty = false;
+    return pEntry;
+}
+
 CResourceEntry::~CResourceEntry()
 {
-    if (mpResource) delete mpResource;
+    if (mpResource) delete mpResource.load();
     if (mpDependencies) delete mpDependencies;
 }
 
@@ -138,6 +196,9 @@ void CResourceEntry::SerializeEntryInfo(IArchive& rArc, bool MetadataOnly)
     // Serialize extra data that we exclude from the metadata file
     if (!MetadataOnly)
     {
+        if (!rArc.IsReader())
+            Dependencies();
+
         TString Dir = (mpDirectory ? mpDirectory->FullPath() : "");
 
         rArc << SerialParameter("Name", mName)
@@ -153,7 +214,7 @@ void CResourceEntry::SerializeEntryInfo(IArchive& rArc, bool MetadataOnly)
     }
 }
 
-void CResourceEntry::UpdateDependencies()
+void CResourceEntry::UpdateDependencies(bool SkipStoreCacheDirty /*= false*/)
 {
     if (mpDependencies)
     {
@@ -161,9 +222,15 @@ void CResourceEntry::UpdateDependencies()
         mpDependencies = nullptr;
     }
 
+    // The cached dependencies are out of date now regardless of whether the new ones can be built
+    mCachedDependenciesSize = 0;
+    mCacheDependenciesDirty = true;
+    mCacheRecordDirty = true;
+
     if (!mpTypeInfo->CanHaveDependencies())
     {
         mpDependencies = new CDependencyTree();
+        mpStore->DependencyIndex()->RemoveReferences(mID.ToLongLong());
         return;
     }
 
@@ -176,11 +243,18 @@ void CResourceEntry::UpdateDependencies()
     {
         errorf("Unable to update cached dependencies; failed to load resource");
         mpDependencies = new CDependencyTree();
+        mpStore->DependencyIndex()->RemoveReferences(mID.ToLongLong());
         return;
     }
 
-    mpDependencies = mpResource->BuildDependencyTree();
-    mpStore->SetCacheDirty();
+    mpDependencies = mpResource.load()->BuildDependencyTree();
+    mpStore->DependencyIndex()->SetReferences(mID.ToLongLong(), mpDependencies);
+
+    // SkipStoreCacheDirty only flags this entry's cache record; the caller is responsible for flagging the store
+    if (SkipStoreCacheDirty)
+        mCacheRecordDirty = true;
+    else
+        SetCacheDirty();
 
     if (!WasLoaded)
         mpStore->DestroyUnreferencedResources();
@@ -261,12 +335,14 @@ bool CResourceEntry::NeedsRecook() const
     return (FileUtil::LastModifiedTime(CookedAssetPath()) < FileUtil::LastModifiedTime(RawAssetPath()));
 }
 
-bool CResourceEntry::Save(bool SkipCacheSave /*= false*/)
+bool CResourceEntry::Save(bool SkipCacheSave /*= false*/, bool SkipDependencies /*= false*/)
 {
     // SkipCacheSave argument tells us not to save the resource cache file. This is generally not advised because we don't
     // want the actual resource data to desync from the cache data. However, there are occasions where we save multiple
     // resources at a time and in that case it's preferable to only save the cache once. If you do set SkipCacheSave to true,
-    // then make sure you manually update the cache file afterwards.
+    // then make sure you manually update the cache file afterwards. The store's cache also won't be flagged dirty, so that
+    // several resources can be saved from different threads at once; flag it yourself once they're all saved.
+    // SkipDependencies leaves the dependency tree as it is, for callers that have just built it with UpdateDependencies().
     //
     // For now, always save the resource when this function is called even if there's been no changes made to it in memory.
     // In the future this might not be desired behavior 100% of the time.
@@ -290,7 +366,7 @@ bool CResourceEntry::Save(bool SkipCacheSave /*= false*/)
         SerialName.RemoveWhitespace();
 
         CXMLWriter Writer(Path, SerialName, 0, Game());
-        mpResource->Serialize(Writer);
+        mpResource.load()->Serialize(Writer);
 
         if (!Writer.Save())
         {
@@ -316,20 +392,20 @@ bool CResourceEntry::Save(bool SkipCacheSave /*= false*/)
     // Resource has been saved; now make sure metadata, dependencies, and packages are all up to date
     SetFlag(EResEntryFlag::HasBeenModified);
     SaveMetadata();
-    UpdateDependencies();
+
+    if (!SkipDependencies)
+        UpdateDependencies(SkipCacheSave);
 
     if (!SkipCacheSave)
     {
         mpStore->ConditionalSaveStore();
 
         // Flag dirty any packages that contain this resource.
-        for (uint32 iPkg = 0; iPkg < mpStore->Project()->NumPackages(); iPkg++)
-        {
-            CPackage *pPkg = mpStore->Project()->PackageByIndex(iPkg);
+        std::vector<CPackage*> Packages;
+        mpStore->GetPackagesContainingAsset(ID(), Packages);
 
-            if (pPkg->ContainsAsset(ID()))
-                pPkg->MarkDirty();
-        }
+        for (CPackage *pPkg : Packages)
+            pPkg->MarkDirty();
     }
 
     if (ShouldCollectGarbage)
@@ -370,8 +446,21 @@ bool CResourceEntry::Cook()
 CResource* CResourceEntry::Load()
 {
     // If the asset is already loaded then just return it immediately
+    if (mpResource && !mIsLoading) return mpResource;
+
+    // Otherwise wait for any load on another thread to finish. If the resource is set by then, it was either
+    // loaded on another thread, or this is a circular reference from a load further up this thread's stack.
+    std::lock_guard<std::recursive_mutex> Lock(LoadMutex());
     if (mpResource) return mpResource;
 
+    mIsLoading = true;
+    CResource *pRes = LoadFromDisk();
+    mIsLoading = false;
+    return pRes;
+}
+
+CResource* CResourceEntry::LoadFromDisk()
+{
     // Always try to load raw version as the raw version contains extra editor-only data.
     // If there is no raw version (which will be the case for resource types that don't
     // support serialization yet) then load the cooked version as a backup.
@@ -383,23 +472,24 @@ CResource* CResourceEntry::Load()
         {
             // Set gpResourceStore to ensure the correct resource store is accessed by loader functions
             CResourceStore *pOldStore = gpResourceStore;
-            gpResourceStore = mpStore;
+            SetGlobalResourceStore(mpStore);
 
             CXMLReader Reader(RawAssetPath());
 
             if (!Reader.IsValid())
             {
                 errorf("Failed to load raw resource; falling back on cooked. Raw path: %s", *RawAssetPath());
-                delete mpResource;
+                delete mpResource.load();
                 mpResource = nullptr;
             }
 
             else
             {
-                mpResource->Serialize(Reader);
+                mpResource.load()->Serialize(Reader);
                 mpStore->TrackLoadedResource(this);
-                gpResourceStore = pOldStore;
             }
+
+            SetGlobalResourceStore(pOldStore);
         }
 
         if (mpResource)
@@ -409,6 +499,16 @@ CResource* CResourceEntry::Load()
     ASSERT(!mpResource);
     if (HasCookedVersion())
     {
+        // Map the cooked file and parse it in place rather than going through buffered file reads.
+        // Loaders copy out anything they keep, so the mapping can be closed once the load is done.
+        CMappedFile MappedFile(CookedAssetPath());
+
+        if (MappedFile.IsValid() && MappedFile.Size() > 0)
+        {
+            CMemoryInStream Mem(MappedFile.Data(), (uint32) MappedFile.Size(), EEndian::BigEndian);
+            return LoadCooked(Mem);
+        }
+
         CFileInStream File(CookedAssetPath(), EEndian::BigEndian);
 
         if (!File.IsValid())
@@ -430,30 +530,38 @@ CResource* CResourceEntry::Load()
 CResource* CResourceEntry::LoadCooked(IInputStream& rInput)
 {
     // Overload to allow for load from an arbitrary input stream.
+    std::lock_guard<std::recursive_mutex> Lock(LoadMutex());
     if (mpResource) return mpResource;
     if (!rInput.IsValid()) return nullptr;
 
     // Set gpResourceStore to ensure the correct resource store is accessed by loader functions
     CResourceStore *pOldStore = gpResourceStore;
-    gpResourceStore = mpStore;
+    SetGlobalResourceStore(mpStore);
 
     mpResource = CResourceFactory::LoadCookedResource(this, rInput);
     if (mpResource)
         mpStore->TrackLoadedResource(this);
 
-    gpResourceStore = pOldStore;
+    SetGlobalResourceStore(pOldStore);
     return mpResource;
 }
 
 bool CResourceEntry::Unload()
 {
-    ASSERT(mpResource != nullptr);
-    ASSERT(!mpResource->IsReferenced());
-    delete mpResource;
+    std::lock_guard<std::recursive_mutex> Lock(LoadMutex());
+    CResource *pRes = mpResource;
+    ASSERT(pRes != nullptr);
+    ASSERT(!pRes->IsReferenced());
     mpResource = nullptr;
+    delete pRes;
     return true;
 }
 
+void CResourceEntry::LoadAsync(int32 Priority, const void *pkOwner, std::function<void(CResource*)> Callback)
+{
+    mpStore->AsyncLoader()->RequestLoad(this, Priority, pkOwner, std::move(Callback));
+}
+
 bool CResourceEntry::CanMoveTo(const TString& rkDir, const TString& rkName)
 {
     // Validate that the path/name are valid
@@ -482,6 +590,7 @@ bool CResourceEntry::MoveAndRename(const TString& rkDir, const TString& rkName,
     // Store old paths
     CVirtualDirectory *pOldDir = mpDirectory;
     TString OldName = mName;
+    TString OldRelativePath = CookedAssetPath(true);
     TString OldCookedPath = CookedAssetPath();
     TString OldRawPath = RawAssetPath();
     TString OldMetaPath = MetadataFilePath();
@@ -579,8 +688,9 @@ bool CResourceEntry::MoveAndRename(const TString& rkDir, const TString& rkName,
             SetFlagEnabled(EResEntryFlag::AutoResName, IsAutoGenName);
         }
 
-        mpStore->SetCacheDirty();
+        SetCacheDirty();
         mCachedUppercaseName = rkName.ToUpper();
+        mpStore->UpdateEntryPath(this, OldRelativePath);
         SaveMetadata();
         return true;
     }
@@ -623,12 +733,23 @@ EGame CResourceEntry::Game() const
     return mpStore ? mpStore->Game() : EGame::Invalid;
 }
 
+CDependencyTree* CResourceEntry::Dependencies() const
+{
+    // Entries loaded from the resource database only deserialize their dependencies the first time they're needed.
+    // Until the entry's dependencies are rebuilt, the pointer is only read under the database cache's lock.
+    if (mCachedDependenciesSize > 0)
+        return mpStore->DatabaseCache()->LoadDependencies(this);
+
+    return mpDependencies;
+}
+
 void CResourceEntry::SetFlag(EResEntryFlag Flag)
 {
     if (!HasFlag(Flag))
     {
         mFlags.SetFlag(Flag);
         mMetadataDirty = true;
+        mCacheRecordDirty = true;
     }
 }
 
@@ -638,5 +759,20 @@ void CResourceEntry::ClearFlag(EResEntryFlag Flag)
     {
         mFlags.ClearFlag(Flag);
         mMetadataDirty = true;
+        mCacheRecordDirty = true;
     }
 }
+
+void CResourceEntry::SetGlobalResourceStore(CResourceStore *pStore)
+{
+    // The main thread reads gpResourceStore without holding the load lock. CAsyncLoader only accepts entries from the
+    // current gpResourceStore, so loads on its workers never get here with a different store, and never write the global.
+    if (gpResourceStore != pStore)
+        gpResourceStore = pStore;
+}
+
+std::recursive_mutex& CResourceEntry::LoadMutex()
+{
+    static std::recursive_mutex sLoadMutex;
+    return sLoadMutex;
+}
@@ -1,6 +1,7 @@
 #ifndef CRESOURCEENTRY_H
 #define CRESOURCEENTRY_H
 
+#include "CResourceDatabaseCache.h"
 #include "CResourceStore.h"
 #include "CVirtualDirectory.h"
 #include "Core/Resource/CResTypeInfo.h"
@@ -8,6 +9,9 @@
 #include <Common/CAssetID.h>
 #include <Common/CFourCC.h>
 #include <Common/Flags.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
 
 class CResource;
 class CGameProject;
@@ -26,10 +30,15 @@ DECLARE_FLAGS(EResEntryFlag, FResEntryFlags)
 
 class CResourceEntry
 {
-    CResource *mpResource;
+    friend class CResourceDatabaseCache;
+
+    // The resource is set before it finishes loading, so circular references resolve during the load;
+    // mIsLoading is set meanwhile so other threads wait for the load to finish instead of using it.
+    std::atomic<CResource*> mpResource;
+    std::atomic<bool> mIsLoading;
     CResTypeInfo *mpTypeInfo;
     CResourceStore *mpStore;
-    CDependencyTree *mpDependencies;
+    mutable CDependencyTree *mpDependencies;
     CAssetID mID;
     CVirtualDirectory *mpDirectory;
     TString mName;
@@ -39,6 +48,14 @@ class CResourceEntry
     mutable uint64 mCachedSize;
     mutable TString mCachedUppercaseName; // This is used to speed up case-insensitive sorting and filtering.
 
+    // Location of this entry in the resource database. Dependencies loaded from the database aren't
+    // deserialized until they're first accessed.
+    uint32 mCacheRecord;
+    uint64 mCachedDependenciesOffset;
+    uint32 mCachedDependenciesSize;
+    bool mCacheRecordDirty;
+    bool mCacheDependenciesDirty;
+
     // Private constructor
     CResourceEntry(CResourceStore *pStore);
 
@@ -49,12 +66,17 @@ public:
     static CResourceEntry* BuildFromArchive(CResourceStore *pStore, IArchive& rArc);
     static CResourceEntry* BuildFromDirectory(CResourceStore *pStore, CResTypeInfo *pTypeInfo,
                                               const TString& rkDirPath, const TString& rkName);
+    static CResourceEntry* BuildFromMetadata(CResourceStore *pStore, CResTypeInfo *pTypeInfo,
+                                             CVirtualDirectory *pDir, const TString& rkName);
+    static CResourceEntry* BuildFromDatabaseCache(CResourceStore *pStore, const CAssetID& rkID,
+                                                  const CResourceDatabaseCache::SRecord& rkRecord,
+                                                  const char *pkStrings, uint32 RecordIndex);
     ~CResourceEntry();
 
     bool LoadMetadata();
     bool SaveMetadata(bool ForceSave = false);
     void SerializeEntryInfo(IArchive& rArc, bool MetadataOnly);
-    void UpdateDependencies();
+    void UpdateDependencies(bool SkipStoreCacheDirty = false);
 
     bool HasRawVersion() const;
     bool HasCookedVersion() const;
@@ -67,11 +89,14 @@ public:
     bool IsInDirectory(CVirtualDirectory *pDir) const;
     uint64 Size() const;
     bool NeedsRecook() const;
-    bool Save(bool SkipCacheSave = false);
+    bool Save(bool SkipCacheSave = false, bool SkipDependencies = false);
     bool Cook();
     CResource* Load();
     CResource* LoadCooked(IInputStream& rInput);
     bool Unload();
+    // Loads the resource on the store's async loader; the callback is run on the main thread once it's loaded.
+    // pkOwner identifies the callback so it can be cancelled through CAsyncLoader::CancelCallbacks.
+    void LoadAsync(int32 Priority, const void *pkOwner, std::function<void(CResource*)> Callback);
     bool CanMoveTo(const TString& rkDir, const TString& rkName);
     bool MoveAndRename(const TString& rkDir, const TString& rkName, bool IsAutoGenDir = false, bool IsAutoGenName = false);
     bool Move(const TString& rkDir, bool IsAutoGenDir = false);
@@ -79,6 +104,7 @@ public:
 
     CGameProject* Project() const;
     EGame Game() const;
+    CDependencyTree* Dependencies() const;
 
     void SetFlag(EResEntryFlag Flag);
     void ClearFlag(EResEntryFlag Flag);
@@ -87,6 +113,7 @@ public:
     inline void SetFlagEnabled(EResEntryFlag Flag, bool Enabled)    { Enabled ? SetFlag(Flag) : ClearFlag(Flag); }
 
     inline void SetDirty()                          { SetFlag(EResEntryFlag::NeedsRecook); }
+    inline void SetCacheDirty()                     { mCacheRecordDirty = true; mpStore->SetCacheDirty(); }
     inline void SetHidden(bool Hidden)              { Hidden ? SetFlag(EResEntryFlag::Hidden) : ClearFlag(EResEntryFlag::Hidden); }
     inline bool HasFlag(EResEntryFlag Flag) const   { return mFlags.HasFlag(Flag); }
     inline bool IsHidden() const                    { return HasFlag(EResEntryFlag::Hidden); }
@@ -97,7 +124,6 @@ public:
     inline CResource* Resource() const              { return mpResource; }
     inline CResTypeInfo* TypeInfo() const           { return mpTypeInfo; }
     inline CResourceStore* ResourceStore() const    { return mpStore; }
-    inline CDependencyTree* Dependencies() const    { return mpDependencies; }
     inline CAssetID ID() const                      { return mID; }
     inline CVirtualDirectory* Directory() const     { return mpDirectory; }
     inline TString DirectoryPath() const            { return mpDirectory->FullPath(); }
@@ -105,8 +131,13 @@ public:
     inline const TString& UppercaseName() const     { return mCachedUppercaseName; }
     inline EResourceType ResourceType() const            { return mpTypeInfo->Type(); }
 
+    // Held while any resource is loading. Loaders share global state, so loads on different threads can't overlap.
+    static std::recursive_mutex& LoadMutex();
+
 protected:
     CResource* InternalLoad(IInputStream& rInput);
+    CResource* LoadFromDisk();
+    static void SetGlobalResourceStore(CResourceStore *pStore);
 };
 
 #endif // CRESOURCEENTRY_H
@@ -0,0 +1,238 @@
+#include "CResourceSearchIndex.h"
+#include <algorithm>
+
+// Trigram keys are three characters packed into the low 24 bits; ID trigrams are kept apart from name trigrams with this bit
+static const uint32 gkIDKeyFlag = 1 << 24;
+// Don't bother rebuilding the posting lists until there are at least this many stale postings
+static const uint32 gkMinStalePostings = 4096;
+
+CResourceSearchIndex::CResourceSearchIndex()
+    : mNumLivePostings(0)
+    , mNumStalePostings(0)
+{
+}
+
+void CResourceSearchIndex::Reserve(uint32 NumEntries)
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    mEntries.reserve(NumEntries);
+    mEntryIndices.Reserve(NumEntries);
+}
+
+void CResourceSearchIndex::SetEntry(uint64 ID, uint32 IDLength, const TString& rkUppercaseName)
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    uint32 *pIndex = mEntryIndices.Find(ID);
+    uint32 EntryIdx;
+
+    if (pIndex)
+    {
+        EntryIdx = *pIndex;
+        SEntry& rEntry = mEntries[EntryIdx];
+        if (rEntry.Valid && rEntry.Name == rkUppercaseName) return;
+
+        // The old postings are left in place; searches skip them when the name no longer matches
+        if (rEntry.Valid)
+        {
+            std::vector<uint32> OldTrigrams;
+            GetTrigrams(rEntry.Name, 0, OldTrigrams);
+            mNumStalePostings += OldTrigrams.size();
+            mNumLivePostings -= OldTrigrams.size();
+        }
+        else
+            AddPostings(EntryIdx, rEntry.IDString, gkIDKeyFlag);
+
+        rEntry.Name = rkUppercaseName;
+        rEntry.Valid = true;
+    }
+    else
+    {
+        EntryIdx = mEntries.size();
+        mEntryIndices.Insert(ID, EntryIdx);
+        mEntries.push_back( SEntry { ID, rkUppercaseName, IDToHexString(ID, IDLength), true } );
+        AddPostings(EntryIdx, mEntries.back().IDString, gkIDKeyFlag);
+    }
+
+    AddPostings(EntryIdx, rkUppercaseName, 0);
+
+    if (mNumStalePostings > gkMinStalePostings && mNumStalePostings > mNumLivePostings)
+        RebuildPostings();
+}
+
+void CResourceSearchIndex::RemoveEntry(uint64 ID)
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    uint32 *pIndex = mEntryIndices.Find(ID);
+    if (!pIndex) return;
+
+    // The slot is kept so the ID maps to the same entry if it's registered again
+    SEntry& rEntry = mEntries[*pIndex];
+    if (!rEntry.Valid) return;
+    rEntry.Valid = false;
+
+    std::vector<uint32> Trigrams;
+    GetTrigrams(rEntry.Name, 0, Trigrams);
+    GetTrigrams(rEntry.IDString, gkIDKeyFlag, Trigrams);
+    mNumStalePostings += Trigrams.size();
+    mNumLivePostings -= Trigrams.size();
+}
+
+void CResourceSearchIndex::Clear()
+{
+    std::lock_guard<std::mutex> Lock(mMutex);
+    mEntries.clear();
+    mEntryIndices.Clear();
+    mTrigramLists.Clear();
+    mPostings.clear();
+    mNumLivePostings = 0;
+    mNumStalePostings = 0;
+}
+
+std::vector<uint64> CResourceSearchIndex::Search(const TString& rkSearchString) const
+{
+    std::vector<uint64> Out;
+    if (rkSearchString.IsEmpty()) return Out;
+
+    TString NameString = rkSearchString.ToUpper();
+
+    // Check if this is an asset ID
+    TString IDString = rkSearchString;
+    IDString.RemoveWhitespace();
+
+    if (IDString.StartsWith("0x"))
+        IDString = IDString.ChopFront(2);
+
+    bool SearchIDs = (!IDString.IsEmpty() && IDString.Size() <= 16 && IDString.IsHexString());
+
+    std::lock_guard<std::mutex> Lock(mMutex);
+    std::vector<uint32> Matches;
+    FindMatches(NameString, 0, Matches);
+
+    if (SearchIDs)
+        FindMatches(IDString.ToUpper(), gkIDKeyFlag, Matches);
+
+    std::sort(Matches.begin(), Matches.end());
+    Matches.erase( std::unique(Matches.begin(), Matches.end()), Matches.end() );
+    Out.reserve(Matches.size());
+
+    for (uint32 EntryIdx : Matches)
+        Out.push_back(mEntries[EntryIdx].ID);
+
+    return Out;
+}
+
+// ************ PROTECTED ************
+void CResourceSearchIndex::AddPostings(uint32 EntryIdx, const TString& rkString, uint32 KeyFlag)
+{
+    std::vector<uint32> Trigrams;
+    GetTrigrams(rkString, KeyFlag, Trigrams);
+
+    for (uint32 Trigram : Trigrams)
+    {
+        uint32 *pListIdx = mTrigramLists.Find(Trigram);
+
+        if (!pListIdx)
+        {
+            mTrigramLists.Insert(Trigram, mPostings.size());
+            mPostings.push_back( std::vector<uint32>() );
+            pListIdx = mTrigramLists.Find(Trigram);
+        }
+
+        // An entry that's renamed back and forth may already be in the list
+        std::vector<uint32>& rList = mPostings[*pListIdx];
+
+        if (rList.empty() || rList.back() != EntryIdx)
+            rList.push_back(EntryIdx);
+    }
+
+    mNumLivePostings += Trigrams.size();
+}
+
+void CResourceSearchIndex::RebuildPostings()
+{
+    mTrigramLists.Clear();
+    mPostings.clear();
+    mNumLivePostings = 0;
+    mNumStalePostings = 0;
+
+    for (uint32 EntryIdx = 0; EntryIdx < mEntries.size(); EntryIdx++)
+    {
+        const SEntry& rkEntry = mEntries[EntryIdx];
+
+        if (rkEntry.Valid)
+        {
+            AddPostings(EntryIdx, rkEntry.Name, 0);
+            AddPostings(EntryIdx, rkEntry.IDString, gkIDKeyFlag);
+        }
+    }
+}
+
+void CResourceSearchIndex::FindMatches(const TString& rkSearchString, uint32 KeyFlag, std::vector<uint32>& rOutMatches) const
+{
+    bool SearchIDs = (KeyFlag == gkIDKeyFlag);
+
+    // Search strings too short to have a trigram are checked against every entry
+    if (rkSearchString.Size() < 3)
+    {
+        for (uint32 EntryIdx = 0; EntryIdx < mEntries.size(); EntryIdx++)
+        {
+            const SEntry& rkEntry = mEntries[EntryIdx];
+
+            if (rkEntry.Valid && (SearchIDs ? rkEntry.IDString : rkEntry.Name).Contains(rkSearchString))
+                rOutMatches.push_back(EntryIdx);
+        }
+
+        return;
+    }
+
+    // Any entry containing the search string is listed under every one of its trigrams, so only the shortest list needs checking
+    std::vector<uint32> Trigrams;
+    GetTrigrams(rkSearchString, KeyFlag, Trigrams);
+    const std::vector<uint32> *pkCandidates = nullptr;
+
+    for (uint32 Trigram : Trigrams)
+    {
+        const uint32 *pkListIdx = mTrigramLists.Find(Trigram);
+        if (!pkListIdx) return;
+
+        const std::vector<uint32>& rkList = mPostings[*pkListIdx];
+
+        if (!pkCandidates || rkList.size() < pkCandidates->size())
+            pkCandidates = &rkList;
+    }
+
+    for (uint32 EntryIdx : *pkCandidates)
+    {
+        const SEntry& rkEntry = mEntries[EntryIdx];
+
+        if (rkEntry.Valid && (SearchIDs ? rkEntry.IDString : rkEntry.Name).Contains(rkSearchString))
+            rOutMatches.push_back(EntryIdx);
+    }
+}
+
+void CResourceSearchIndex::GetTrigrams(const TString& rkString, uint32 KeyFlag, std::vector<uint32>& rOutTrigrams)
+{
+    if (rkString.Size() < 3) return;
+
+    const uint8 *pkChars = (const uint8*) rkString.CString();
+    uint32 FirstIdx = rOutTrigrams.size();
+
+    for (uint32 CharIdx = 0; CharIdx + 2 < rkString.Size(); CharIdx++)
+        rOutTrigrams.push_back( KeyFlag | (pkChars[CharIdx] << 16) | (pkChars[CharIdx + 1] << 8) | pkChars[CharIdx + 2] );
+
+    std::sort(rOutTrigrams.begin() + FirstIdx, rOutTrigrams.end());
+    rOutTrigrams.erase( std::unique(rOutTrigrams.begin() + FirstIdx, rOutTrigrams.end()), rOutTrigrams.end() );
+}
+
+TString CResourceSearchIndex::IDToHexString(uint64 ID, uint32 IDLength)
+{
+    static const char skHexDigits[] = "0123456789ABCDEF";
+    char Buffer[17];
+    uint32 NumDigits = (IDLength < 8 ? IDLength * 2 : 16);
+
+    for (uint32 DigitIdx = 0; DigitIdx < NumDigits; DigitIdx++)
+        Buffer[DigitIdx] = skHexDigits[(ID >> ((NumDigits - DigitIdx - 1) * 4)) & 0xF];
+
+    Buffer[NumDigits] = 0;
+    return TString(Buffer);
+}
@@ -0,0 +1,58 @@
+#ifndef CRESOURCESEARCHINDEX_H
+#define CRESOURCESEARCHINDEX_H
+
+#include "Core/TFlatHashMap.h"
+#include <Common/BasicTypes.h>
+#include <Common/TString.h>
+#include <mutex>
+#include <vector>
+
+/* Trigram index over resource names and asset IDs, used to search the resource browser without testing every
+ * entry in the store. Each entry's uppercase name and its asset ID written out in hex are split into every
+ * three-character substring they contain, and each trigram maps to the list of entries containing it. A search
+ * only has to check the entries listed under the rarest trigram of the search string; shorter search strings
+ * fall back on checking every entry.
+ *
+ * Renaming an entry adds it to the lists for its new trigrams and leaves its old postings in place, since every
+ * candidate is checked against its current name anyway. The lists are rebuilt once stale postings outnumber the
+ * live ones. Entries are keyed by their ID as a 64-bit integer. The index is locked internally so it can be
+ * searched from a worker thread while entries are being renamed. */
+class CResourceSearchIndex
+{
+    struct SEntry
+    {
+        uint64 ID;
+        TString Name;       // Uppercase
+        TString IDString;   // Uppercase hex, padded to the full length of the ID
+        bool Valid;
+    };
+
+    std::vector<SEntry> mEntries;
+    TFlatHashMap<uint64, uint32> mEntryIndices;
+    TFlatHashMap<uint32, uint32> mTrigramLists;
+    std::vector< std::vector<uint32> > mPostings;
+    uint32 mNumLivePostings;
+    uint32 mNumStalePostings;
+    mutable std::mutex mMutex;
+
+public:
+    CResourceSearchIndex();
+    void Reserve(uint32 NumEntries);
+    // Adds the entry, or updates it if it's already in the index; IDLength is in bytes
+    void SetEntry(uint64 ID, uint32 IDLength, const TString& rkUppercaseName);
+    void RemoveEntry(uint64 ID);
+    void Clear();
+
+    // Returns the IDs of every entry whose name contains the search string, or whose ID contains it as hex digits
+    std::vector<uint64> Search(const TString& rkSearchString) const;
+
+protected:
+    void AddPostings(uint32 EntryIdx, const TString& rkString, uint32 KeyFlag);
+    void RebuildPostings();
+    void FindMatches(const TString& rkSearchString, uint32 KeyFlag, std::vector<uint32>& rOutMatches) const;
+
+    static void GetTrigrams(const TString& rkString, uint32 KeyFlag, std::vector<uint32>& rOutTrigrams);
+    static TString IDToHexString(uint64 ID, uint32 IDLength);
+};
+
+#endif // CRESOURCESEARCHINDEX_H
@@ -1,15 +1,23 @@
 #include "CResourceStore.h"
+#include "CAsyncLoader.h"
+#include "CDependencyIndex.h"
 #include "CGameExporter.h"
 #include "CGameProject.h"
+#include "CPackage.h"
+#include "CResourceDatabaseCache.h"
 #include "CResourceIterator.h"
+#include "CResourceSearchIndex.h"
 #include "Core/IUIRelay.h"
+#include "Core/ParallelUtil.h"
 #include "Core/Resource/CResource.h"
 #include <Common/Macros.h>
 #include <Common/FileUtil.h>
 #include <Common/Log.h>
+#include <Common/Math/MathUtil.h>
 #include <Common/Serialization/Binary.h>
 #include <Common/Serialization/XML.h>
 #include <tinyxml2.h>
+#include <algorithm>
 
 using namespace tinyxml2;
 CResourceStore *gpResourceStore = nullptr;
@@ -19,6 +27,10 @@ CResourceStore *gpEditorStore = nullptr;
 CResourceStore::CResourceStore(const TString& rkDatabasePath)
     : mpProj(nullptr)
     , mGame(EGame::Prime)
+    , mPathIndexDirty(false)
+    , mpDependencyIndex(std::make_unique<CDependencyIndex>())
+    , mpSearchIndex(std::make_unique<CResourceSearchIndex>())
+    , mpAsyncLoader(std::make_unique<CAsyncLoader>())
     , mDatabaseCacheDirty(false)
 {
     mpDatabaseRoot = new CVirtualDirectory(this);
@@ -31,6 +43,10 @@ CResourceStore::CResourceStore(CGameProject *pProject)
     : mpProj(nullptr)
     , mGame(EGame::Invalid)
     , mpDatabaseRoot(nullptr)
+    , mPathIndexDirty(false)
+    , mpDependencyIndex(std::make_unique<CDependencyIndex>())
+    , mpSearchIndex(std::make_unique<CResourceSearchIndex>())
+    , mpAsyncLoader(std::make_unique<CAsyncLoader>())
     , mDatabaseCacheDirty(false)
 {
     SetProject(pProject);
@@ -38,6 +54,8 @@ CResourceStore::CResourceStore(CGameProject *pProject)
 
 CResourceStore::~CResourceStore()
 {
+    // Entries can't be deleted while they're loading on the async loader
+    mpAsyncLoader->Shutdown();
     CloseProject();
     DestroyUnreferencedResources();
 
@@ -45,6 +63,37 @@ CResourceStore::~CResourceStore()
         delete It->second;
 }
 
+void ParallelGetDirectoryContents(const TString& rkRootDir, TStringList& rOutFiles, TStringList& rOutDirectories)
+{
+    // Helper function for BuildFromDirectory. Walks the tree a level at a time, listing every directory on a level in parallel.
+    std::vector<TString> Level(1, rkRootDir);
+
+    while (!Level.empty())
+    {
+        std::vector<TStringList> Files(Level.size());
+        std::vector<TStringList> Subdirectories(Level.size());
+
+        ParallelUtil::ParallelFor(Level.size(), [&](uint32 DirIdx)
+        {
+            FileUtil::GetDirectoryContents(Level[DirIdx], Files[DirIdx], false, true, false);
+            FileUtil::GetDirectoryContents(Level[DirIdx], Subdirectories[DirIdx], false, false, true);
+        });
+
+        Level.clear();
+
+        for (uint32 DirIdx = 0; DirIdx < Files.size(); DirIdx++)
+        {
+            rOutFiles.splice(rOutFiles.end(), Files[DirIdx]);
+
+            for (auto Iter = Subdirectories[DirIdx].begin(); Iter != Subdirectories[DirIdx].end(); Iter++)
+            {
+                rOutDirectories.push_back(*Iter);
+                Level.push_back(*Iter);
+            }
+        }
+    }
+}
+
 void RecursiveGetListOfEmptyDirectories(CVirtualDirectory *pDir, TStringList& rOutList)
 {
     // Helper function for SerializeResourceDatabase
@@ -70,16 +119,22 @@ bool CResourceStore::SerializeDatabaseCache(IArchive& rArc)
 
         if (rArc.IsReader())
         {
+            mEntryIDIndex.Reserve(ResourceCount);
+            mpSearchIndex->Reserve(ResourceCount);
+            mPathIndexDirty = true;
+
             for (uint32 ResIdx = 0; ResIdx < ResourceCount; ResIdx++)
             {
                 if (rArc.ParamBegin("Resource", 0))
                 {
                     CResourceEntry *pEntry = CResourceEntry::BuildFromArchive(this, rArc);
                     ASSERT( FindEntry(pEntry->ID()) == nullptr );
-                    mResourceEntries[pEntry->ID()] = pEntry;
+                    AddEntry(pEntry);
                     rArc.ParamEnd();
                 }
             }
+
+            RebuildDependencyIndex();
         }
         else
         {
@@ -104,16 +159,7 @@ bool CResourceStore::SerializeDatabaseCache(IArchive& rArc)
     rArc << SerialParameter("EmptyDirectories", EmptyDirectories);
 
     if (rArc.IsReader())
-    {
-        for (auto Iter = EmptyDirectories.begin(); Iter != EmptyDirectories.end(); Iter++)
-        {
-            // Don't create empty virtual directories that don't actually exist in the filesystem
-            TString AbsPath = ResourcesDir() + *Iter;
-
-            if (FileUtil::Exists(AbsPath))
-                CreateVirtualDirectory(*Iter);
-        }
-    }
+        CreateEmptyDirectories(EmptyDirectories);
 
     return true;
 }
@@ -127,6 +173,32 @@ bool CResourceStore::LoadDatabaseCache()
         mpDatabaseRoot = new CVirtualDirectory(this);
 
     // Load the resource database
+    mpDatabaseCache = std::make_unique<CResourceDatabaseCache>(Path, mGame);
+    std::vector<CResourceEntry*> Entries;
+    TStringList EmptyDirectories;
+
+    if (mpDatabaseCache->Load(this, Entries, EmptyDirectories))
+    {
+        mEntryIDIndex.Reserve(Entries.size());
+        mpSearchIndex->Reserve(Entries.size());
+        mPathIndexDirty = true;
+
+        for (CResourceEntry *pEntry : Entries)
+        {
+            ASSERT( FindEntry(pEntry->ID()) == nullptr );
+            AddEntry(pEntry);
+        }
+
+        CreateEmptyDirectories(EmptyDirectories);
+
+        if (mpProj)
+            ASSERT(mpProj->Game() == mpDatabaseCache->Game());
+
+        mGame = mpDatabaseCache->Game();
+        return true;
+    }
+
+    // Fall back to the previous database format
     CBasicBinaryReader Reader(Path, FOURCC('CACH'));
 
     if (!Reader.IsValid() || !SerializeDatabaseCache(Reader))
@@ -143,6 +215,11 @@ bool CResourceStore::LoadDatabaseCache()
         // Database is succesfully loaded at this point
         if (mpProj)
             ASSERT(mpProj->Game() == Reader.Game());
+
+        // Convert it to the current format right away, so it can be mapped the next time it's loaded
+        mGame = Reader.Game();
+        mpDatabaseCache = std::make_unique<CResourceDatabaseCache>(Path, mGame);
+        SaveDatabaseCache();
     }
 
     mGame = Reader.Game();
@@ -151,14 +228,15 @@ bool CResourceStore::LoadDatabaseCache()
 
 bool CResourceStore::SaveDatabaseCache()
 {
-    TString Path = DatabasePath();
+    if (!mpDatabaseCache || mpDatabaseCache->Game() != mGame)
+        mpDatabaseCache = std::make_unique<CResourceDatabaseCache>(DatabasePath(), mGame);
 
-    CBasicBinaryWriter Writer(Path, FOURCC('CACH'), 0, mGame);
+    TStringList EmptyDirectories;
+    RecursiveGetListOfEmptyDirectories(mpDatabaseRoot, EmptyDirectories);
 
-    if (!Writer.IsValid())
+    if (!mpDatabaseCache->Save(mResourceEntries, EmptyDirectories))
         return false;
 
-    SerializeDatabaseCache(Writer);
     mDatabaseCacheDirty = false;
     return true;
 }
@@ -215,8 +293,11 @@ void CResourceStore::CloseProject()
         It = mResourceEntries.erase(It);
     }
 
+    ClearEntryIndices();
+
     delete mpDatabaseRoot;
     mpDatabaseRoot = nullptr;
+    mpDatabaseCache.reset();
     mpProj = nullptr;
     mGame = EGame::Invalid;
 }
@@ -259,14 +340,78 @@ TString CResourceStore::DefaultResourceDirPath() const
 CResourceEntry* CResourceStore::FindEntry(const CAssetID& rkID) const
 {
     if (!rkID.IsValid()) return nullptr;
-    auto Found = mResourceEntries.find(rkID);
-    if (Found == mResourceEntries.end()) return nullptr;
-    else return Found->second;
+    CResourceEntry* const* ppEntry = mEntryIDIndex.Find(rkID.ToLongLong());
+    return (ppEntry ? *ppEntry : nullptr);
 }
 
 CResourceEntry* CResourceStore::FindEntry(const TString& rkPath) const
 {
-    return (mpDatabaseRoot ? mpDatabaseRoot->FindChildResource(rkPath) : nullptr);
+    if (!mpDatabaseRoot) return nullptr;
+    ConditionalRebuildPathIndex();
+
+    CResourceEntry* const* ppEntry = mEntryPathIndex.Find( ResourcePathKey(rkPath) );
+    if (!ppEntry || !*ppEntry) return nullptr;
+
+    // Guard against hash collisions by checking the name; on a mismatch, fall back to searching the directory tree
+    CResourceEntry *pEntry = *ppEntry;
+    TString Name = rkPath.GetFileName(false);
+
+    if (Name.CaseInsensitiveCompare(pEntry->Name()))
+        return pEntry;
+    else
+        return mpDatabaseRoot->FindChildResource(rkPath);
+}
+
+void CResourceStore::GetReferencers(const CAssetID& rkID, bool Recursive, std::vector<CResourceEntry*>& rOutEntries) const
+{
+    // Recursive includes resources that only reference this asset through other resources
+    uint64 Key = rkID.ToLongLong();
+    std::vector<uint64> Referencers;
+
+    if (Recursive)
+    {
+        std::set<uint64> AllReferencers = mpDependencyIndex->AllReferencers(Key);
+        Referencers.assign(AllReferencers.begin(), AllReferencers.end());
+    }
+    else
+        Referencers = mpDependencyIndex->Referencers(Key);
+
+    rOutEntries.reserve(rOutEntries.size() + Referencers.size());
+    EIDLength IDLength = CAssetID::GameIDLength(mGame);
+
+    for (uint64 ReferencerID : Referencers)
+    {
+        CResourceEntry *pEntry = FindEntry( CAssetID(ReferencerID, IDLength) );
+        if (pEntry) rOutEntries.push_back(pEntry);
+    }
+}
+
+void CResourceStore::GetPackagesContainingAsset(const CAssetID& rkID, std::vector<CPackage*>& rOutPackages) const
+{
+    if (!mpProj) return;
+
+    // Packages are built by walking the dependencies of their named resources, so only packages with a named
+    // resource that references the asset can contain it. Those candidates are checked against the package contents.
+    std::set<uint64> Referencers = mpDependencyIndex->AllReferencers(rkID.ToLongLong());
+    Referencers.insert(rkID.ToLongLong());
+
+    for (uint32 PkgIdx = 0; PkgIdx < mpProj->NumPackages(); PkgIdx++)
+    {
+        CPackage *pPackage = mpProj->PackageByIndex(PkgIdx);
+
+        for (uint32 ResIdx = 0; ResIdx < pPackage->NumNamedResources(); ResIdx++)
+        {
+            const SNamedResource& rkRes = pPackage->NamedResourceByIndex(ResIdx);
+
+            if (Referencers.find(rkRes.ID.ToLongLong()) != Referencers.end())
+            {
+                if (pPackage->ContainsAsset(rkID))
+                    rOutPackages.push_back(pPackage);
+
+                break;
+            }
+        }
+    }
 }
 
 bool CResourceStore::AreAllEntriesValid() const
@@ -290,10 +435,14 @@ void CResourceStore::ClearDatabase()
     for (auto Iter = mResourceEntries.begin(); Iter != mResourceEntries.end(); Iter++)
         delete Iter->second;
     mResourceEntries.clear();
+    ClearEntryIndices();
 
     delete mpDatabaseRoot;
     mpDatabaseRoot = new CVirtualDirectory(this);
 
+    if (mpDatabaseCache)
+        mpDatabaseCache->Invalidate();
+
     mDatabaseCacheDirty = true;
 }
 
@@ -303,19 +452,48 @@ bool CResourceStore::BuildFromDirectory(bool ShouldGenerateCacheFile)
 
     // Get list of resources
     TString ResDir = ResourcesDir();
-    TStringList ResourceList;
-    FileUtil::GetDirectoryContents(ResDir, ResourceList);
+    TStringList FileList, DirectoryList;
+    ParallelGetDirectoryContents(ResDir, FileList, DirectoryList);
+
+    // Create every virtual directory up front, so entries can be built without modifying the directory tree
+    for (auto Iter = DirectoryList.begin(); Iter != DirectoryList.end(); Iter++)
+        CreateVirtualDirectory( Iter->ChopFront(ResDir.Size()) );
+
+    // Sort the file list so entries can check their cooked/raw files exist without going to the filesystem
+    std::vector<TString> Files;
+    std::vector<TString> MetadataFiles;
+    Files.reserve(FileList.size());
 
-    for (auto Iter = ResourceList.begin(); Iter != ResourceList.end(); Iter++)
+    for (auto Iter = FileList.begin(); Iter != FileList.end(); Iter++)
     {
-        TString Path = *Iter;
-        TString RelPath = Path.ChopFront( ResDir.Size() );
+        TString RelPath = Iter->ChopFront( ResDir.Size() );
 
-        if (FileUtil::IsFile(Path) && Path.EndsWith(".rsmeta"))
+        if (RelPath.EndsWith(".rsmeta"))
+            MetadataFiles.push_back(RelPath);
+
+        Files.push_back(RelPath);
+    }
+
+    std::sort(Files.begin(), Files.end());
+
+    // Load metadata in parallel. Each job builds a batch of entries that's added to the store afterwards.
+    const uint32 kBatchSize = 256;
+    uint32 NumBatches = (MetadataFiles.size() + kBatchSize - 1) / kBatchSize;
+    std::vector< std::vector<CResourceEntry*> > Batches(NumBatches);
+
+    ParallelUtil::ParallelFor(NumBatches, [&](uint32 BatchIdx)
+    {
+        std::vector<CResourceEntry*>& rBatch = Batches[BatchIdx];
+        uint32 FirstFile = BatchIdx * kBatchSize;
+        uint32 LastFile = Math::Min<uint32>(FirstFile + kBatchSize, MetadataFiles.size());
+
+        for (uint32 FileIdx = FirstFile; FileIdx < LastFile; FileIdx++)
         {
+            const TString& rkRelPath = MetadataFiles[FileIdx];
+
             // Determine resource name
-            TString DirPath = RelPath.GetFileDirectory();
-            TString CookedFilename = RelPath.GetFileName(false); // This call removes the .rsmeta extension
+            TString DirPath = rkRelPath.GetFileDirectory();
+            TString CookedFilename = rkRelPath.GetFileName(false); // This call removes the .rsmeta extension
             TString ResName = CookedFilename.GetFileName(false); // This call removes the cooked extension
             ASSERT( IsValidResourcePath(DirPath, ResName) );
 
@@ -325,23 +503,43 @@ bool CResourceStore::BuildFromDirectory(bool ShouldGenerateCacheFile)
 
             if (!pTypeInfo)
             {
-                errorf("Found resource but couldn't register because failed to identify resource type: %s", *RelPath);
+                errorf("Found resource but couldn't register because failed to identify resource type: %s", *rkRelPath);
                 continue;
             }
 
+            // Make sure we're valid
+            TString CookedPath = DirPath + CookedFilename;
+            ASSERT( std::binary_search(Files.begin(), Files.end(), CookedPath) ||
+                    std::binary_search(Files.begin(), Files.end(), CookedPath + ".rsraw") );
+
             // Create resource entry
-            CResourceEntry *pEntry = CResourceEntry::BuildFromDirectory(this, pTypeInfo, DirPath, ResName);
+            CVirtualDirectory *pDir = GetVirtualDirectory(DirPath, false);
+            CResourceEntry *pEntry = (pDir ? CResourceEntry::BuildFromMetadata(this, pTypeInfo, pDir, ResName) : nullptr);
 
+            if (pEntry)
+                rBatch.push_back(pEntry);
+            else
+                errorf("Found resource but couldn't register because failed to load metadata: %s", *rkRelPath);
+        }
+    });
+
+    // Add entries to the store
+    mEntryIDIndex.Reserve(MetadataFiles.size());
+    mpSearchIndex->Reserve(MetadataFiles.size());
+    mPathIndexDirty = true;
+
+    for (const std::vector<CResourceEntry*>& rkBatch : Batches)
+    {
+        for (CResourceEntry *pEntry : rkBatch)
+        {
             // Validate the entry
             CAssetID ID = pEntry->ID();
-            ASSERT( mResourceEntries.find(ID) == mResourceEntries.end() );
+            ASSERT( FindEntry(ID) == nullptr );
             ASSERT( ID.Length() == CAssetID::GameIDLength(mGame) );
 
-            mResourceEntries[ID] = pEntry;
+            pEntry->Directory()->AddChild("", pEntry);
+            AddEntry(pEntry);
         }
-
-        else if (FileUtil::IsDirectory(Path))
-            CreateVirtualDirectory(RelPath);
     }
 
     // Generate new cache file
@@ -397,7 +595,7 @@ CResourceEntry* CResourceStore::RegisterResource(const CAssetID& rkID, EResource
         if (IsValidResourcePath(rkDir, rkName))
         {
             pEntry = CResourceEntry::CreateNewResource(this, rkID, rkDir, rkName, Type);
-            mResourceEntries[rkID] = pEntry;
+            AddEntry(pEntry);
         }
 
         else
@@ -487,6 +685,8 @@ void CResourceStore::TrackLoadedResource(CResourceEntry *pEntry)
 void CResourceStore::DestroyUnreferencedResources()
 {
     // This can be updated to avoid the do-while loop when reference lookup is implemented.
+    // Async loads add to the loaded resource list, so hold off any loads until we're done.
+    std::lock_guard<std::recursive_mutex> Lock(CResourceEntry::LoadMutex());
     uint32 NumDeleted;
 
     do
@@ -509,12 +709,31 @@ void CResourceStore::DestroyUnreferencedResources()
     } while (NumDeleted > 0);
 }
 
+void CResourceStore::UpdateEntryPath(CResourceEntry *pEntry, const TString& rkOldPath)
+{
+    // Called when an entry is moved or renamed
+    mpSearchIndex->SetEntry(pEntry->ID().ToLongLong(), pEntry->ID().Length(), pEntry->UppercaseName());
+    if (mPathIndexDirty) return;
+
+    uint64 OldKey = ResourcePathKey(rkOldPath);
+    CResourceEntry **ppOldEntry = mEntryPathIndex.Find(OldKey);
+
+    if (ppOldEntry && *ppOldEntry == pEntry)
+        *ppOldEntry = nullptr;
+
+    mEntryPathIndex.Insert( ResourcePathKey(pEntry->CookedAssetPath(true)), pEntry );
+}
+
 bool CResourceStore::DeleteResourceEntry(CResourceEntry *pEntry)
 {
     CAssetID ID = pEntry->ID();
+    TString Path = pEntry->CookedAssetPath(true);
+    mpAsyncLoader->RemoveEntry(pEntry);
 
     if (pEntry->IsLoaded())
     {
+        std::lock_guard<std::recursive_mutex> Lock(CResourceEntry::LoadMutex());
+
         if (!pEntry->Unload())
             return false;
 
@@ -526,9 +745,24 @@ bool CResourceStore::DeleteResourceEntry(CResourceEntry *pEntry)
     if (pEntry->Directory())
         pEntry->Directory()->RemoveChildResource(pEntry);
 
+    if (mpDatabaseCache)
+        mpDatabaseCache->RemoveEntry(pEntry);
+
+    mpDependencyIndex->RemoveReferences(ID.ToLongLong());
+    mpSearchIndex->RemoveEntry(ID.ToLongLong());
+
     auto It = mResourceEntries.find(ID);
     ASSERT(It != mResourceEntries.end());
     mResourceEntries.erase(It);
+    mEntryIDIndex.Insert(ID.ToLongLong(), nullptr);
+
+    if (!mPathIndexDirty)
+    {
+        CResourceEntry **ppPathEntry = mEntryPathIndex.Find( ResourcePathKey(Path) );
+
+        if (ppPathEntry && *ppPathEntry == pEntry)
+            *ppPathEntry = nullptr;
+    }
 
     delete pEntry;
     return true;
@@ -624,3 +858,94 @@ TString CResourceStore::StaticDefaultResourceDirPath(EGame Game)
 {
     return (Game < EGame::CorruptionProto ? "Uncategorized/" : "uncategorized/");
 }
+
+uint64 CResourceStore::ResourcePathKey(const TString& rkPath)
+{
+    // 64-bit FNV-1a over the path with case and slashes folded, so it matches the directory tree's case-insensitive lookups
+    uint64 Hash = 0xCBF29CE484222325ULL;
+    const char *pkStr = *rkPath;
+
+    for (uint32 CharIdx = 0; CharIdx < rkPath.Size(); CharIdx++)
+    {
+        char Chr = pkStr[CharIdx];
+        if (Chr >= 'a' && Chr <= 'z') Chr -= 0x20;
+        else if (Chr == '\\') Chr = '/';
+        Hash = (Hash ^ (uint8) Chr) * 0x100000001B3ULL;
+    }
+
+    return Hash;
+}
+
+// ************ PROTECTED ************
+void CResourceStore::CreateEmptyDirectories(const TStringList& rkEmptyDirectories)
+{
+    for (auto Iter = rkEmptyDirectories.begin(); Iter != rkEmptyDirectories.end(); Iter++)
+    {
+        // Don't create empty virtual directories that don't actually exist in the filesystem
+        TString AbsPath = ResourcesDir() + *Iter;
+
+        if (FileUtil::Exists(AbsPath))
+            CreateVirtualDirectory(*Iter);
+    }
+}
+
+void CResourceStore::AddEntry(CResourceEntry *pEntry)
+{
+    mResourceEntries[pEntry->ID()] = pEntry;
+    mEntryIDIndex.Insert(pEntry->ID().ToLongLong(), pEntry);
+    mpSearchIndex->SetEntry(pEntry->ID().ToLongLong(), pEntry->ID().Length(), pEntry->UppercaseName());
+
+    if (!mPathIndexDirty)
+        mEntryPathIndex.Insert( ResourcePathKey(pEntry->CookedAssetPath(true)), pEntry );
+}
+
+void CResourceStore::ClearEntryIndices()
+{
+    mEntryIDIndex.Clear();
+    mEntryPathIndex.Clear();
+    mpDependencyIndex->Clear();
+    mpSearchIndex->Clear();
+    mPathIndexDirty = false;
+}
+
+void CResourceStore::ConditionalRebuildPathIndex() const
+{
+    if (!mPathIndexDirty) return;
+
+    std::lock_guard<std::mutex> Lock(mPathIndexMutex);
+    if (!mPathIndexDirty) return;
+
+    mEntryPathIndex.Clear();
+    mEntryPathIndex.Reserve(mResourceEntries.size());
+
+    for (auto Iter = mResourceEntries.begin(); Iter != mResourceEntries.end(); Iter++)
+    {
+        CResourceEntry *pEntry = Iter->second;
+        mEntryPathIndex.Insert( ResourcePathKey(pEntry->CookedAssetPath(true)), pEntry );
+    }
+
+    mPathIndexDirty = false;
+}
+
+void CResourceStore::RebuildDependencyIndex()
+{
+    // Used when entries are loaded with their dependency trees, rather than from the resource database
+    std::vector<CResourceEntry*> Entries;
+    Entries.reserve(mResourceEntries.size());
+
+    for (auto Iter = mResourceEntries.begin(); Iter != mResourceEntries.end(); Iter++)
+        Entries.push_back(Iter->second);
+
+    std::vector< std::vector<uint64> > References(Entries.size());
+
+    ParallelUtil::ParallelFor(Entries.size(), [&](uint32 EntryIdx)
+    {
+        CResourceEntry *pEntry = Entries[EntryIdx];
+        References[EntryIdx] = CDependencyIndex::FlattenReferences(pEntry->ID().ToLongLong(), pEntry->Dependencies());
+    });
+
+    mpDependencyIndex->Clear();
+
+    for (uint32 EntryIdx = 0; EntryIdx < Entries.size(); EntryIdx++)
+        mpDependencyIndex->SetReferences(Entries[EntryIdx]->ID().ToLongLong(), References[EntryIdx]);
+}
@@ -2,17 +2,27 @@
 #define CRESOURCESTORE_H
 
 #include "CVirtualDirectory.h"
+#include "Core/TFlatHashMap.h"
 #include "Core/Resource/EResType.h"
 #include <Common/CAssetID.h>
 #include <Common/CFourCC.h>
 #include <Common/FileUtil.h>
 #include <Common/TString.h>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <vector>
 
+class CAsyncLoader;
 class CGameExporter;
 class CGameProject;
 class CResource;
+class CDependencyIndex;
+class CPackage;
+class CResourceDatabaseCache;
+class CResourceSearchIndex;
 
 enum class EDatabaseVersion
 {
@@ -32,6 +42,19 @@ class CResourceStore
     CVirtualDirectory *mpDatabaseRoot;
     std::map<CAssetID, CResourceEntry*> mResourceEntries;
     std::map<CAssetID, CResourceEntry*> mLoadedResources;
+
+    // Hash indices for entry lookups; mResourceEntries is still used for iteration so the order stays stable.
+    // The path index is keyed on the case-folded relative cooked path, and is rebuilt lazily after bulk changes.
+    // Removed entries are left in both indices with a null value.
+    TFlatHashMap<uint64, CResourceEntry*> mEntryIDIndex;
+    mutable TFlatHashMap<uint64, CResourceEntry*> mEntryPathIndex;
+    mutable std::atomic<bool> mPathIndexDirty;
+    mutable std::mutex mPathIndexMutex;
+
+    std::unique_ptr<CResourceDatabaseCache> mpDatabaseCache;
+    std::unique_ptr<CDependencyIndex> mpDependencyIndex;
+    std::unique_ptr<CResourceSearchIndex> mpSearchIndex;
+    std::unique_ptr<CAsyncLoader> mpAsyncLoader;
     bool mDatabaseCacheDirty;
 
     // Directory paths
@@ -55,8 +78,11 @@ public:
 
     bool IsResourceRegistered(const CAssetID& rkID) const;
     CResourceEntry* RegisterResource(const CAssetID& rkID, EResourceType Type, const TString& rkDir, const TString& rkName);
+    void UpdateEntryPath(CResourceEntry *pEntry, const TString& rkOldPath);
     CResourceEntry* FindEntry(const CAssetID& rkID) const;
     CResourceEntry* FindEntry(const TString& rkPath) const;
+    void GetReferencers(const CAssetID& rkID, bool Recursive, std::vector<CResourceEntry*>& rOutEntries) const;
+    void GetPackagesContainingAsset(const CAssetID& rkID, std::vector<CPackage*>& rOutPackages) const;
     bool AreAllEntriesValid() const;
     void ClearDatabase();
     bool BuildFromDirectory(bool ShouldGenerateCacheFile);
@@ -74,6 +100,7 @@ public:
 
     static bool IsValidResourcePath(const TString& rkPath, const TString& rkName);
     static TString StaticDefaultResourceDirPath(EGame Game);
+    static uint64 ResourcePathKey(const TString& rkPath);
 
     // Accessors
     inline CGameProject* Project() const            { return mpProj; }
@@ -82,12 +109,24 @@ public:
     inline TString ResourcesDir() const             { return IsEditorStore() ? DatabaseRootPath() : DatabaseRootPath() + "Resources/"; }
     inline TString DatabasePath() const             { return DatabaseRootPath() + "ResourceDatabaseCache.bin"; }
     inline CVirtualDirectory* RootDirectory() const { return mpDatabaseRoot; }
+    inline CResourceDatabaseCache* DatabaseCache() const { return mpDatabaseCache.get(); }
+    inline CDependencyIndex* DependencyIndex() const { return mpDependencyIndex.get(); }
+    inline CResourceSearchIndex* SearchIndex() const { return mpSearchIndex.get(); }
+    inline CAsyncLoader* AsyncLoader() const        { return mpAsyncLoader.get(); }
     inline uint32 NumTotalResources() const         { return mResourceEntries.size(); }
     inline uint32 NumLoadedResources() const        { return mLoadedResources.size(); }
     inline bool IsCacheDirty() const                { return mDatabaseCacheDirty; }
 
     inline void SetCacheDirty()                     { mDatabaseCacheDirty = true; }
+    inline void SetPathIndexDirty()                 { mPathIndexDirty = true; }
     inline bool IsEditorStore() const               { return mpProj == nullptr; }
+
+protected:
+    void CreateEmptyDirectories(const TStringList& rkEmptyDirectories);
+    void AddEntry(CResourceEntry *pEntry);
+    void ClearEntryIndices();
+    void ConditionalRebuildPathIndex() const;
+    void RebuildDependencyIndex();
 };
 
 extern CResourceStore *gpResourceStore;
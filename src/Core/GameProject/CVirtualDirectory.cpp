@@ -276,7 +276,8 @@ bool CVirtualDirectory::Rename(const TString& rkNewName)
             if (FileUtil::MoveDirectory(AbsPath, NewPath))
             {
                 mName = rkNewName;
-                mpStore->SetCacheDirty();
+                SetResourcesCacheDirty();
+                mpStore->SetPathIndexDirty();
                 mpParent->SortSubdirectories();
                 return true;
             }
@@ -364,7 +365,8 @@ bool CVirtualDirectory::SetParent(CVirtualDirectory *pParent)
     {
         mpParent = pParent;
         mpParent->AddChild(this);
-        mpStore->SetCacheDirty();
+        SetResourcesCacheDirty();
+        mpStore->SetPathIndexDirty();
         return true;
     }
     else
@@ -375,6 +377,18 @@ bool CVirtualDirectory::SetParent(CVirtualDirectory *pParent)
     }
 }
 
+void CVirtualDirectory::SetResourcesCacheDirty()
+{
+    // Resource database records store the full directory path, so every resource under a moved directory needs updating
+    for (CResourceEntry *pEntry : mResources)
+        pEntry->SetCacheDirty();
+
+    for (CVirtualDirectory *pSubdir : mSubdirectories)
+        pSubdir->SetResourcesCacheDirty();
+
+    mpStore->SetCacheDirty();
+}
+
 // ************ STATIC ************
 bool CVirtualDirectory::IsValidDirectoryName(const TString& rkName)
 {
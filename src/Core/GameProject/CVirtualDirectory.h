@@ -42,6 +42,7 @@ public:
     void DeleteEmptySubdirectories();
     bool CreateFilesystemDirectory();
     bool SetParent(CVirtualDirectory *pParent);
+    void SetResourcesCacheDirty();
 
     static bool IsValidDirectoryName(const TString& rkName);
     static bool IsValidDirectoryPath(TString Path);
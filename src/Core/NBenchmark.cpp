@@ -0,0 +1,1038 @@
+#include "NBenchmark.h"
+#include "Core/GameProject/CGameProject.h"
+#include "Core/GameProject/CResourceDatabaseCache.h"
+#include "Core/GameProject/CResourceEntry.h"
+#include "Core/GameProject/CResourceIterator.h"
+#include "Core/GameProject/CResourceStore.h"
+#include "Core/IProgressNotifier.h"
+#include "Core/Render/CBoneTransformData.h"
+#include "Core/Resource/Animation/CAnimation.h"
+#include "Core/Resource/Animation/CAnimSet.h"
+#include "Core/Resource/Animation/CSkeleton.h"
+#include "Core/Resource/Factory/CAnimationLoader.h"
+#include "Core/Resource/Factory/NTexelDecode.h"
+#include "Core/Resource/Model/CBasicModel.h"
+#include "Core/Resource/Model/CModel.h"
+#include "Core/Resource/Script/NGameList.h"
+#include "Core/Resource/Script/NPropertyMap.h"
+#include "Core/Resource/Script/Property/CPropertyNameGenerator.h"
+#include <Common/CTimer.h>
+#include <Common/FileIO.h>
+#include <Common/FileUtil.h>
+#include <Common/Hash/CCRC32.h>
+#include <Common/Log.h>
+#include <Common/Math/MathUtil.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <random>
+#include <unordered_map>
+
+namespace NBenchmark
+{
+
+bool DistancesMatch(std::pair<bool,float> A, std::pair<bool,float> B)
+{
+    if (A.first != B.first) return false;
+    if (!A.first) return true;
+    return fabsf(A.second - B.second) <= 0.001f * Math::Max(1.f, fabsf(A.second));
+}
+
+// ************ RAY CAST ************
+bool RayCast(CBasicModel *pModel, uint32 NumRays /*= 10000*/, uint32 Seed /*= 0*/)
+{
+    ASSERT(pModel);
+    uint32 NumSurfaces = pModel->GetSurfaceCount();
+
+    // Gather triangles for the brute force path up front so it's only timing the intersection tests
+    std::vector< std::vector<CVector3f> > SurfaceTriangles(NumSurfaces);
+    uint32 NumTriangles = 0;
+
+    for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
+    {
+        pModel->GetSurface(iSurf)->GetTriangles(SurfaceTriangles[iSurf]);
+        NumTriangles += SurfaceTriangles[iSurf].size() / 3;
+    }
+
+    // Generate rays from a sphere around the model towards random points inside its bounds
+    CAABox Bounds = pModel->AABox();
+    CVector3f Center = Bounds.Center();
+    CVector3f Extent = Bounds.Max() - Bounds.Min();
+    float Radius = Math::Max(Bounds.Min().Distance(Bounds.Max()), 1.f);
+
+    std::mt19937 Random(Seed);
+    std::uniform_real_distribution<float> Unit(0.f, 1.f);
+    std::vector<CRay> Rays;
+    Rays.reserve(NumRays);
+
+    for (uint32 iRay = 0; iRay < NumRays; iRay++)
+    {
+        float Z = Unit(Random) * 2.f - 1.f;
+        float Angle = Unit(Random) * 6.2831853f;
+        float XY = sqrtf(1.f - Z * Z);
+        CVector3f Origin = Center + CVector3f(XY * cosf(Angle), XY * sinf(Angle), Z) * Radius;
+        CVector3f Target = Bounds.Min() + CVector3f(Unit(Random) * Extent.X, Unit(Random) * Extent.Y, Unit(Random) * Extent.Z);
+        Rays.push_back( CRay(Origin, (Target - Origin).Normalized()) );
+    }
+
+    // Brute force
+    std::vector< std::pair<bool,float> > BruteResults(NumRays);
+    double BruteStart = CTimer::GlobalTime();
+
+    for (uint32 iRay = 0; iRay < NumRays; iRay++)
+    {
+        std::pair<bool,float> Best(false, 0.f);
+
+        for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
+        {
+            const std::vector<CVector3f>& rkTris = SurfaceTriangles[iSurf];
+
+            for (uint32 iTri = 0; iTri < rkTris.size(); iTri += 3)
+            {
+                std::pair<bool,float> Result = Math::RayTriangleIntersection(Rays[iRay], rkTris[iTri], rkTris[iTri+1], rkTris[iTri+2], false);
+
+                if (Result.first && (!Best.first || Result.second < Best.second))
+                    Best = Result;
+            }
+        }
+
+        BruteResults[iRay] = Best;
+    }
+
+    double BruteTime = CTimer::GlobalTime() - BruteStart;
+
+    // BVH build; rebuild from scratch so the cost is measured even if the model was picked before
+    double BuildStart = CTimer::GlobalTime();
+
+    for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
+    {
+        SSurface *pSurf = pModel->GetSurface(iSurf);
+        pSurf->pTriangleBVH.reset();
+        pSurf->TriangleBVH();
+    }
+
+    double BuildTime = CTimer::GlobalTime() - BuildStart;
+
+    // BVH traversal
+    std::vector< std::pair<bool,float> > BVHResults(NumRays);
+    double BVHStart = CTimer::GlobalTime();
+
+    for (uint32 iRay = 0; iRay < NumRays; iRay++)
+    {
+        std::pair<bool,float> Best(false, 0.f);
+
+        for (uint32 iSurf = 0; iSurf < NumSurfaces; iSurf++)
+        {
+            std::pair<bool,float> Result = pModel->GetSurface(iSurf)->TriangleBVH().IntersectsRay(Rays[iRay], false);
+
+            if (Result.first && (!Best.first || Result.second < Best.second))
+                Best = Result;
+        }
+
+        BVHResults[iRay] = Best;
+    }
+
+    double BVHTime = CTimer::GlobalTime() - BVHStart;
+
+    // Compare
+    uint32 NumHits = 0, NumMismatches = 0;
+
+    for (uint32 iRay = 0; iRay < NumRays; iRay++)
+    {
+        if (BruteResults[iRay].first) NumHits++;
+        if (!DistancesMatch(BruteResults[iRay], BVHResults[iRay])) NumMismatches++;
+    }
+
+    debugf("Ray cast benchmark: %s (%d surfaces, %d triangles, %d rays, %d hits)", *pModel->Source(), NumSurfaces, NumTriangles, NumRays, NumHits);
+    debugf("    Brute force:  %.3f ms", BruteTime * 1000.0);
+    debugf("    BVH build:    %.3f ms", BuildTime * 1000.0);
+    debugf("    BVH:          %.3f ms (%.1fx)", BVHTime * 1000.0, (BVHTime > 0.0 ? BruteTime / BVHTime : 0.0));
+
+    if (NumMismatches > 0)
+        warnf("Ray cast benchmark: %d rays gave different results between brute force and BVH", NumMismatches);
+
+    return NumMismatches == 0;
+}
+
+// ************ PROPERTY NAME GENERATION ************
+bool PropertyNameGeneration(uint32 MaxWords /*= 2*/, uint32 NumTargets /*= 100*/, uint32 Seed /*= 0*/)
+{
+    CPropertyNameGenerator Generator;
+    Generator.Warmup();
+
+    const uint32 kNumWords = Generator.NumWords();
+    if (kNumWords == 0 || MaxWords == 0) return false;
+
+    // Make up some target names out of the word list so there's something to find
+    static const char* skTypeNames[] = { "int", "float", "bool", "Vector", "Color", "asset", "string", "struct" };
+    const uint32 kNumTypes = sizeof(skTypeNames) / sizeof(skTypeNames[0]);
+
+    std::mt19937 Random(Seed);
+    SPropertyNameGenerationParameters Params;
+    Params.MaxWords = MaxWords;
+    Params.Casing = ENameCasing::PascalCase;
+    Params.Mode = ENameGenerationMode::Forward;
+    Params.ExcludeAccuratelyNamedProperties = false;
+    Params.TestIntsAsChoices = false;
+    Params.PrintToLog = false;
+
+    for (uint32 iType = 0; iType < kNumTypes; iType++)
+        Params.TypeNames.push_back(skTypeNames[iType]);
+
+    for (uint32 iTarget = 0; iTarget < NumTargets; iTarget++)
+    {
+        TString Name;
+        uint32 NumNameWords = 1 + (Random() % MaxWords);
+
+        for (uint32 iWord = 0; iWord < NumNameWords; iWord++)
+            Name += Generator.GetWord(Random() % kNumWords);
+
+        const char* pkType = skTypeNames[Random() % kNumTypes];
+        Params.ValidIdPairs.push_back( SPropertyIdTypePair { NPropertyMap::CalculatePropertyID(*Name, pkType), pkType } );
+    }
+
+    // Brute force with CCRC32 on one thread, caching the hash of each word prefix the same way the generator used to
+    std::unordered_map<uint32, const char*> TargetMap;
+
+    for (const SPropertyIdTypePair& rkPair : Params.ValidIdPairs)
+        TargetMap[rkPair.ID] = rkPair.pkType;
+
+    auto BruteForce = [&](auto IsMatch, uint64& rOutHashes, double& rOutTime) -> uint32
+    {
+        uint64 BruteHashes = 0;
+        uint32 BruteMatches = 0;
+        double BruteStart = CTimer::GlobalTime();
+
+        for (uint32 NumNameWords = 1; NumNameWords <= MaxWords; NumNameWords++)
+        {
+            std::vector<uint32> WordIndices(NumNameWords, 0);
+            std::vector<CCRC32> Hashes(NumNameWords);
+            uint32 RecalcIndex = 0;
+
+            while (true)
+            {
+                for (; RecalcIndex < NumNameWords; RecalcIndex++)
+                {
+                    Hashes[RecalcIndex] = (RecalcIndex > 0 ? Hashes[RecalcIndex - 1] : CCRC32());
+                    Hashes[RecalcIndex].Hash( *Generator.GetWord(WordIndices[RecalcIndex]) );
+                }
+
+                for (uint32 iType = 0; iType < kNumTypes; iType++)
+                {
+                    CCRC32 FullHash = Hashes.back();
+                    FullHash.Hash(skTypeNames[iType]);
+
+                    if (IsMatch(FullHash.Digest(), skTypeNames[iType]))
+                        BruteMatches++;
+                }
+
+                BruteHashes += kNumTypes;
+
+                // Increment the last word and carry into the ones before it
+                int WordIdx = NumNameWords - 1;
+
+                while (WordIdx >= 0 && ++WordIndices[WordIdx] >= kNumWords)
+                {
+                    WordIndices[WordIdx] = 0;
+                    WordIdx--;
+                }
+
+                if (WordIdx < 0) break;
+                RecalcIndex = WordIdx;
+            }
+        }
+
+        rOutHashes = BruteHashes;
+        rOutTime = CTimer::GlobalTime() - BruteStart;
+        return BruteMatches;
+    };
+
+    uint64 BruteHashes = 0;
+    double BruteTime = 0.0;
+    uint32 BruteMatches = BruteForce([&](uint32 ID, const char* pkType)
+    {
+        auto Find = TargetMap.find(ID);
+        return Find != TargetMap.end() && strcmp(Find->second, pkType) == 0;
+    }, BruteHashes, BruteTime);
+
+    debugf("Property name generation benchmark: %d words, up to %d per name, %d targets", kNumWords, MaxWords, NumTargets);
+    debugf("    CCRC32:             %.3f s, %.0f hashes/sec (%d matches)", BruteTime, (BruteTime > 0.0 ? BruteHashes / BruteTime : 0.0), BruteMatches);
+
+    // Generator, in each mode. Hashes/sec counts every name covered, so meet in the middle is effectively checking
+    // a full last word's worth of names per lookup.
+    bool AllMatch = true;
+    const ENameGenerationMode kModes[] = { ENameGenerationMode::Forward, ENameGenerationMode::MeetInTheMiddle };
+    const char* kModeNames[] = { "Forward", "Meet in the middle" };
+
+    for (uint32 iMode = 0; iMode < 2; iMode++)
+    {
+        Params.Mode = kModes[iMode];
+        Generator.Generate(Params, gpNullProgress);
+        double GeneratorTime = Generator.LastRunTime();
+        uint32 GeneratorMatches = Generator.GetOutput().size();
+
+        debugf("    %-18s  %.3f s, %.0f hashes/sec (%d matches)", kModeNames[iMode], GeneratorTime,
+               (GeneratorTime > 0.0 ? Generator.NumHashesTested() / GeneratorTime : 0.0), GeneratorMatches);
+
+        if (BruteMatches != GeneratorMatches)
+        {
+            warnf("Property name generation benchmark: CCRC32 found %d matches but %s found %d", BruteMatches, kModeNames[iMode], GeneratorMatches);
+            AllMatch = false;
+        }
+    }
+
+    // Without an ID pool, every hash is a candidate for any ID in the property map. The brute force path checks each
+    // one with IsValidPropertyID by type name, like the generator used to; the generator batches its candidates.
+    uint64 MapBruteHashes = 0;
+    double MapBruteTime = 0.0;
+    uint32 MapBruteMatches = BruteForce([](uint32 ID, const char* pkType)
+    {
+        return NPropertyMap::IsValidPropertyID(ID, pkType);
+    }, MapBruteHashes, MapBruteTime);
+
+    Params.ValidIdPairs.clear();
+    Params.Mode = ENameGenerationMode::Forward;
+    Generator.Generate(Params, gpNullProgress);
+    double MapGeneratorTime = Generator.LastRunTime();
+    uint32 MapGeneratorMatches = Generator.GetOutput().size();
+
+    debugf("    Property map, CCRC32:     %.3f s, %.0f hashes/sec (%d matches)", MapBruteTime,
+           (MapBruteTime > 0.0 ? MapBruteHashes / MapBruteTime : 0.0), MapBruteMatches);
+    debugf("    Property map, generator:  %.3f s, %.0f hashes/sec (%d matches)", MapGeneratorTime,
+           (MapGeneratorTime > 0.0 ? Generator.NumHashesTested() / MapGeneratorTime : 0.0), MapGeneratorMatches);
+
+    if (MapBruteMatches != MapGeneratorMatches)
+    {
+        warnf("Property name generation benchmark: CCRC32 found %d property map matches but the generator found %d", MapBruteMatches, MapGeneratorMatches);
+        AllMatch = false;
+    }
+
+    return AllMatch;
+}
+
+// ************ PROPERTY MAP LOOKUP ************
+bool PropertyMapLookup(uint32 NumLookups /*= 1000000*/, uint32 Seed /*= 0*/)
+{
+    // Gather every ID/type pair in the map, along with a copy of the map in its old layout: a std::map keyed by type hash and
+    // ID, with the type name hashed on every lookup
+    struct SEntry
+    {
+        uint32 ID;
+        TString TypeName;
+        NPropertyMap::STypeHandle Type;
+    };
+    std::vector<SEntry> Entries;
+    std::map<uint64, bool> OldMap;
+
+    for (NPropertyMap::CIterator Iter; Iter; ++Iter)
+    {
+        Entries.push_back( SEntry { Iter.ID(), Iter.TypeName(), Iter.Type() } );
+
+        bool IsValid = false;
+        NPropertyMap::IsValidPropertyID(Iter.ID(), Iter.Type(), &IsValid);
+        OldMap[ ((uint64) Iter.Type().Hash << 32) | Iter.ID() ] = IsValid;
+    }
+
+    if (Entries.empty()) return false;
+
+    // Half the lookups are IDs from the map; the other half are random IDs that will almost always miss
+    std::mt19937 Random(Seed);
+    std::vector<NPropertyMap::SPropertyIDQuery> Queries(NumLookups);
+    std::vector<const char*> QueryTypeNames(NumLookups);
+
+    for (uint32 iQuery = 0; iQuery < NumLookups; iQuery++)
+    {
+        const SEntry& rkEntry = Entries[Random() % Entries.size()];
+        uint32 ID = (Random() & 1) ? rkEntry.ID : (uint32) Random();
+        Queries[iQuery] = { ID, rkEntry.Type };
+        QueryTypeNames[iQuery] = *rkEntry.TypeName;
+    }
+
+    auto ToStatus = [](bool InMap, bool IsValid)
+    {
+        if (!InMap) return NPropertyMap::EPropertyIDStatus::NotInMap;
+        return IsValid ? NPropertyMap::EPropertyIDStatus::NamedCorrectly : NPropertyMap::EPropertyIDStatus::InMap;
+    };
+
+    // Old layout
+    std::vector<NPropertyMap::EPropertyIDStatus> OldResults(NumLookups);
+    double OldStart = CTimer::GlobalTime();
+
+    for (uint32 iQuery = 0; iQuery < NumLookups; iQuery++)
+    {
+        uint64 Key = ((uint64) CCRC32::StaticHashString(QueryTypeNames[iQuery]) << 32) | Queries[iQuery].ID;
+        auto Find = OldMap.find(Key);
+        OldResults[iQuery] = ToStatus(Find != OldMap.end(), Find != OldMap.end() && Find->second);
+    }
+
+    double OldTime = CTimer::GlobalTime() - OldStart;
+
+    // Flat index, looked up by type name
+    std::vector<NPropertyMap::EPropertyIDStatus> NameResults(NumLookups);
+    double NameStart = CTimer::GlobalTime();
+
+    for (uint32 iQuery = 0; iQuery < NumLookups; iQuery++)
+    {
+        bool IsValid = false;
+        bool InMap = NPropertyMap::IsValidPropertyID(Queries[iQuery].ID, QueryTypeNames[iQuery], &IsValid);
+        NameResults[iQuery] = ToStatus(InMap, IsValid);
+    }
+
+    double NameTime = CTimer::GlobalTime() - NameStart;
+
+    // Flat index, looked up by interned type handle
+    std::vector<NPropertyMap::EPropertyIDStatus> HandleResults(NumLookups);
+    double HandleStart = CTimer::GlobalTime();
+
+    for (uint32 iQuery = 0; iQuery < NumLookups; iQuery++)
+    {
+        bool IsValid = false;
+        bool InMap = NPropertyMap::IsValidPropertyID(Queries[iQuery].ID, Queries[iQuery].Type, &IsValid);
+        HandleResults[iQuery] = ToStatus(InMap, IsValid);
+    }
+
+    double HandleTime = CTimer::GlobalTime() - HandleStart;
+
+    // Bulk verify
+    std::vector<NPropertyMap::EPropertyIDStatus> BulkResults;
+    double BulkStart = CTimer::GlobalTime();
+    NPropertyMap::VerifyPropertyIDs(Queries, BulkResults);
+    double BulkTime = CTimer::GlobalTime() - BulkStart;
+
+    uint32 NumMismatches = 0;
+
+    for (uint32 iQuery = 0; iQuery < NumLookups; iQuery++)
+    {
+        if (NameResults[iQuery] != OldResults[iQuery] || HandleResults[iQuery] != OldResults[iQuery] || BulkResults[iQuery] != OldResults[iQuery])
+            NumMismatches++;
+    }
+
+    debugf("Property map lookup benchmark: %d entries, %d lookups", (uint32) Entries.size(), NumLookups);
+    debugf("    std::map + hash:    %.3f ms", OldTime * 1000.0);
+    debugf("    Index by name:      %.3f ms (%.1fx)", NameTime * 1000.0, (NameTime > 0.0 ? OldTime / NameTime : 0.0));
+    debugf("    Index by handle:    %.3f ms (%.1fx)", HandleTime * 1000.0, (HandleTime > 0.0 ? OldTime / HandleTime : 0.0));
+    debugf("    Bulk verify:        %.3f ms (%.1fx)", BulkTime * 1000.0, (BulkTime > 0.0 ? OldTime / BulkTime : 0.0));
+
+    if (NumMismatches > 0)
+        warnf("Property map lookup benchmark: %d lookups gave different results between the std::map and the flat index", NumMismatches);
+
+    return NumMismatches == 0;
+}
+
+// ************ TEMPLATE LOAD ************
+struct STemplateSummary
+{
+    uint32 NumScriptTemplates;
+    uint32 NumProperties;
+    uint64 Checksum;
+};
+
+void SummarizeProperty(IProperty* pProperty, STemplateSummary& rSummary)
+{
+    rSummary.NumProperties++;
+    rSummary.Checksum = (rSummary.Checksum * 31) + pProperty->ID();
+    rSummary.Checksum = (rSummary.Checksum * 31) + (uint32) pProperty->Type();
+    rSummary.Checksum = (rSummary.Checksum * 31) + pProperty->Name().Hash32();
+
+    for (uint32 ChildIdx = 0; ChildIdx < pProperty->NumChildren(); ChildIdx++)
+        SummarizeProperty(pProperty->ChildByIndex(ChildIdx), rSummary);
+}
+
+STemplateSummary LoadAndSummarizeTemplates(double& rOutTime)
+{
+    double StartTime = CTimer::GlobalTime();
+    NGameList::LoadAllGameTemplates();
+    rOutTime = CTimer::GlobalTime() - StartTime;
+
+    STemplateSummary Summary = { 0, 0, 0 };
+
+    for (int GameIdx = 0; GameIdx < (int) EGame::Max; GameIdx++)
+    {
+        CGameTemplate* pGame = NGameList::GetGameTemplate( (EGame) GameIdx );
+        if (!pGame) continue;
+
+        for (uint32 TemplateIdx = 0; TemplateIdx < pGame->NumScriptTemplates(); TemplateIdx++)
+        {
+            CScriptTemplate* pTemplate = pGame->TemplateByIndex(TemplateIdx);
+            Summary.NumScriptTemplates++;
+            SummarizeProperty(pTemplate->Properties(), Summary);
+        }
+    }
+
+    return Summary;
+}
+
+bool TemplateLoad()
+{
+    // Load once to find the cache files and warm up the OS file cache
+    std::vector<TString> CachePaths;
+    double WarmupTime = 0.0;
+
+    NGameList::Shutdown();
+    LoadAndSummarizeTemplates(WarmupTime);
+
+    for (int GameIdx = 0; GameIdx < (int) EGame::Max; GameIdx++)
+    {
+        CGameTemplate* pGame = NGameList::GetGameTemplate( (EGame) GameIdx );
+
+        if (pGame && pGame->TemplateCache())
+            CachePaths.push_back( pGame->TemplateCache()->Path() );
+    }
+
+    NGameList::Shutdown();
+
+    // From XML, with the caches deleted. This includes writing the new caches.
+    for (const TString& rkPath : CachePaths)
+    {
+        if (FileUtil::Exists(rkPath))
+            FileUtil::DeleteFile(rkPath);
+    }
+
+    double XMLTime = 0.0;
+    STemplateSummary XMLSummary = LoadAndSummarizeTemplates(XMLTime);
+    NGameList::Shutdown();
+
+    // From the caches written by the previous load
+    double CacheTime = 0.0;
+    STemplateSummary CacheSummary = LoadAndSummarizeTemplates(CacheTime);
+
+    bool Match = (XMLSummary.NumScriptTemplates == CacheSummary.NumScriptTemplates &&
+                  XMLSummary.NumProperties == CacheSummary.NumProperties &&
+                  XMLSummary.Checksum == CacheSummary.Checksum);
+
+    debugf("Template load benchmark: %d script templates, %d properties", XMLSummary.NumScriptTemplates, XMLSummary.NumProperties);
+    debugf("    XML:    %.3f ms", XMLTime * 1000.0);
+    debugf("    Cache:  %.3f ms (%.1fx)", CacheTime * 1000.0, (CacheTime > 0.0 ? XMLTime / CacheTime : 0.0));
+
+    if (!Match)
+        warnf("Template load benchmark: templates loaded from the cache don't match the ones loaded from XML");
+
+    return Match;
+}
+
+// ************ RESOURCE STORE BUILD ************
+std::map<CAssetID, TString> SummarizeEntries(const std::vector<CResourceEntry*>& rkEntries)
+{
+    std::map<CAssetID, TString> Summary;
+
+    for (CResourceEntry *pEntry : rkEntries)
+        Summary[pEntry->ID()] = pEntry->CookedAssetPath(true) + TString::Format(" %08X", (uint32) pEntry->ResourceType());
+
+    return Summary;
+}
+
+std::vector<CResourceEntry*> SerialBuildFromDirectory(CResourceStore& rStore)
+{
+    // The previous implementation of CResourceStore::BuildFromDirectory
+    std::vector<CResourceEntry*> Entries;
+    TString ResDir = rStore.ResourcesDir();
+    TStringList ResourceList;
+    FileUtil::GetDirectoryContents(ResDir, ResourceList);
+
+    for (auto Iter = ResourceList.begin(); Iter != ResourceList.end(); Iter++)
+    {
+        TString Path = *Iter;
+        TString RelPath = Path.ChopFront( ResDir.Size() );
+
+        if (FileUtil::IsFile(Path) && Path.EndsWith(".rsmeta"))
+        {
+            TString DirPath = RelPath.GetFileDirectory();
+            TString CookedFilename = RelPath.GetFileName(false);
+            TString ResName = CookedFilename.GetFileName(false);
+            CResTypeInfo *pTypeInfo = CResTypeInfo::TypeForCookedExtension( rStore.Game(), CFourCC(CookedFilename.GetFileExtension()) );
+
+            if (pTypeInfo)
+                Entries.push_back( CResourceEntry::BuildFromDirectory(&rStore, pTypeInfo, DirPath, ResName) );
+        }
+
+        else if (FileUtil::IsDirectory(Path))
+            rStore.CreateVirtualDirectory(RelPath);
+    }
+
+    return Entries;
+}
+
+bool ResourceStoreBuild(const TString& rkDir, uint32 NumAssets /*= 50000*/, uint32 Seed /*= 0*/)
+{
+    TString Dir = FileUtil::MakeAbsolute(rkDir);
+    if (!Dir.EndsWith("/") && !Dir.EndsWith("\\")) Dir += '/';
+
+    if (FileUtil::Exists(Dir))
+        FileUtil::DeleteDirectory(Dir, false);
+
+    FileUtil::MakeDirectory(Dir);
+
+    // The stores below are editor-style stores rooted at Dir. Write an empty database first, so opening them doesn't prompt to rebuild.
+    TString DatabasePath = Dir + "ResourceDatabaseCache.bin";
+    {
+        CResourceDatabaseCache EmptyDatabase(DatabasePath, EGame::Prime);
+        EmptyDatabase.Save(std::map<CAssetID, CResourceEntry*>(), TStringList());
+    }
+
+    // Generate the tree; roughly 100 assets per directory, with a cooked file and metadata for each asset
+    const EResourceType kTypes[] = { EResourceType::Texture, EResourceType::Model, EResourceType::StringTable,
+                                     EResourceType::Scan, EResourceType::AnimSet };
+    const uint32 kNumTypes = sizeof(kTypes) / sizeof(kTypes[0]);
+    uint32 NumDirs = Math::Max<uint32>(NumAssets / 100, 1);
+    uint32 NumGenerated = 0;
+    std::mt19937 Random(Seed);
+
+    double GenerateStart = CTimer::GlobalTime();
+    {
+        CResourceStore GenStore(DatabasePath);
+
+        for (uint32 AssetIdx = 0; AssetIdx < NumAssets; AssetIdx++)
+        {
+            // Multiplying by an odd constant gives every asset a unique, scattered ID
+            CAssetID ID( (uint64) ((AssetIdx + 1) * 2654435761u), k32Bit );
+            if (!ID.IsValid()) continue;
+
+            uint32 DirIdx = Random() % NumDirs;
+            TString AssetDir = TString::Format("Area%02d/Group%03d/", DirIdx % 16, DirIdx);
+            TString AssetName = TString::Format("Asset_%06d", AssetIdx);
+            CResourceEntry *pEntry = GenStore.RegisterResource(ID, kTypes[Random() % kNumTypes], AssetDir, AssetName);
+            if (!pEntry) continue;
+
+            CFileOutStream Cooked(pEntry->CookedAssetPath(), EEndian::BigEndian);
+            Cooked.WriteLong(0);
+            pEntry->SaveMetadata(true);
+            NumGenerated++;
+        }
+    }
+    double GenerateTime = CTimer::GlobalTime() - GenerateStart;
+
+    // Previous serial implementation
+    double SerialTime = 0.0;
+    std::map<CAssetID, TString> SerialSummary;
+    {
+        CResourceStore Store(DatabasePath);
+        double StartTime = CTimer::GlobalTime();
+        std::vector<CResourceEntry*> Entries = SerialBuildFromDirectory(Store);
+        SerialTime = CTimer::GlobalTime() - StartTime;
+
+        SerialSummary = SummarizeEntries(Entries);
+
+        for (CResourceEntry *pEntry : Entries)
+            delete pEntry;
+    }
+
+    // Parallel BuildFromDirectory
+    double ParallelTime = 0.0;
+    std::map<CAssetID, TString> ParallelSummary;
+    {
+        CResourceStore Store(DatabasePath);
+        double StartTime = CTimer::GlobalTime();
+        Store.BuildFromDirectory(false);
+        ParallelTime = CTimer::GlobalTime() - StartTime;
+
+        std::vector<CResourceEntry*> Entries;
+
+        for (CResourceIterator It(&Store); It; ++It)
+            Entries.push_back(*It);
+
+        ParallelSummary = SummarizeEntries(Entries);
+    }
+
+    FileUtil::DeleteDirectory(Dir, false);
+
+    bool Match = (SerialSummary == ParallelSummary && SerialSummary.size() == NumGenerated);
+
+    debugf("Resource store build benchmark: %d assets in %d directories (generated in %.3f ms)", NumGenerated, NumDirs, GenerateTime * 1000.0);
+    debugf("    Serial:     %.3f ms", SerialTime * 1000.0);
+    debugf("    Parallel:   %.3f ms (%.1fx)", ParallelTime * 1000.0, (ParallelTime > 0.0 ? SerialTime / ParallelTime : 0.0));
+
+    if (!Match)
+        warnf("Resource store build benchmark: the parallel build found different entries than the serial build");
+
+    return Match;
+}
+
+// ************ TEXEL DECODE ************
+bool TexelDecode(uint32 Width /*= 1024*/, uint32 Height /*= 1024*/, uint32 NumIterations /*= 10*/, uint32 Seed /*= 0*/)
+{
+    // Output texel sizes match what CTextureDecoder uses for each format. CMPR is decoded in units of 4x4 sub-blocks.
+    struct SFormat
+    {
+        ETexelFormat Format;
+        const char *pkName;
+        uint32 PixelStride;
+    };
+    static const SFormat skFormats[] = {
+        { ETexelFormat::GX_I4,      "I4",       2 },
+        { ETexelFormat::GX_I8,      "I8",       2 },
+        { ETexelFormat::GX_IA4,     "IA4",      2 },
+        { ETexelFormat::GX_IA8,     "IA8",      2 },
+        { ETexelFormat::GX_RGB565,  "RGB565",   2 },
+        { ETexelFormat::GX_RGB5A3,  "RGB5A3",   4 },
+        { ETexelFormat::GX_RGBA8,   "RGBA8",    4 },
+        { ETexelFormat::GX_CMPR,    "CMPR",     8 }
+    };
+    static const char *skInstructionSetNames[] = { "Scalar", "SSE2", "AVX2" };
+
+    NTexelDecode::SetMaxInstructionSet(NTexelDecode::EInstructionSet::AVX2);
+    NTexelDecode::EInstructionSet Supported = NTexelDecode::ActiveInstructionSet();
+
+    std::mt19937 Random(Seed);
+    uint32 NumMismatches = 0;
+
+    debugf("Texel decode benchmark: %dx%d, %d iterations, best supported instruction set is %s",
+           Width, Height, NumIterations, skInstructionSetNames[(int) Supported]);
+
+    for (const SFormat& rkFormat : skFormats)
+    {
+        uint32 DecodeW = (rkFormat.Format == ETexelFormat::GX_CMPR ? Width / 4 : Width);
+        uint32 DecodeH = (rkFormat.Format == ETexelFormat::GX_CMPR ? Height / 4 : Height);
+
+        std::vector<uint8> Source(NTexelDecode::SourceSize(rkFormat.Format, DecodeW, DecodeH));
+
+        for (uint8& rByte : Source)
+            rByte = (uint8) Random();
+
+        std::vector<uint8> Reference;
+        double ScalarTime = 0.0;
+
+        for (int iSet = 0; iSet <= (int) Supported; iSet++)
+        {
+            NTexelDecode::SetMaxInstructionSet((NTexelDecode::EInstructionSet) iSet);
+            std::vector<uint8> Output(DecodeW * DecodeH * rkFormat.PixelStride);
+            double Start = CTimer::GlobalTime();
+
+            for (uint32 iIter = 0; iIter < NumIterations; iIter++)
+                NTexelDecode::PartialDecode(rkFormat.Format, Source.data(), Output.data(), DecodeW, DecodeH, rkFormat.PixelStride, nullptr);
+
+            double Time = CTimer::GlobalTime() - Start;
+
+            if (iSet == 0)
+            {
+                Reference = std::move(Output);
+                ScalarTime = Time;
+                debugf("    %-8s %-8s %.3f ms", rkFormat.pkName, skInstructionSetNames[iSet], Time * 1000.0);
+            }
+            else
+            {
+                bool Match = (memcmp(Output.data(), Reference.data(), Reference.size()) == 0);
+                debugf("    %-8s %-8s %.3f ms (%.1fx)", rkFormat.pkName, skInstructionSetNames[iSet], Time * 1000.0, (Time > 0.0 ? ScalarTime / Time : 0.0));
+
+                if (!Match)
+                {
+                    warnf("Texel decode benchmark: %s output from the %s path doesn't match the scalar path", rkFormat.pkName, skInstructionSetNames[iSet]);
+                    NumMismatches++;
+                }
+            }
+        }
+    }
+
+    NTexelDecode::SetMaxInstructionSet(NTexelDecode::EInstructionSet::AVX2);
+    return NumMismatches == 0;
+}
+
+// ************ ANIMATION EVALUATION ************
+struct SDenseKeys
+{
+    std::vector<CAnimation::TScaleChannel> Scales;
+    std::vector<CAnimation::TRotationChannel> Rotations;
+    std::vector<CAnimation::TTranslationChannel> Translations;
+};
+
+void EvaluateDenseTransform(CAnimation *pAnim, const SDenseKeys& rkKeys, float Time, uint32 BoneID, CVector3f *pOutTranslation, CQuaternion *pOutRotation, CVector3f *pOutScale)
+{
+    // The previous implementation of CAnimation::EvaluateTransform, interpolating the full precision keys
+    float Duration = pAnim->Duration();
+    float TickInterval = pAnim->TickInterval();
+    uint32 NumKeys = pAnim->NumKeys();
+    if (Duration == 0.f) return;
+
+    if (Time >= Duration) Time = Duration;
+    if (Time >= FLT_EPSILON) Time -= FLT_EPSILON;
+    float t = fmodf(Time, TickInterval) / TickInterval;
+    uint32 LowKey = (uint32) (Time / TickInterval);
+    if (LowKey == (NumKeys - 1)) LowKey = NumKeys - 2;
+
+    const CAnimation::SBoneChannelInfo& rkInfo = pAnim->BoneChannelInfo(BoneID);
+
+    if (rkInfo.ScaleChannelIdx != 0xFF && pOutScale)
+        *pOutScale = Math::Lerp<CVector3f>(rkKeys.Scales[rkInfo.ScaleChannelIdx][LowKey], rkKeys.Scales[rkInfo.ScaleChannelIdx][LowKey + 1], t);
+
+    if (rkInfo.RotationChannelIdx != 0xFF && pOutRotation)
+        *pOutRotation = rkKeys.Rotations[rkInfo.RotationChannelIdx][LowKey].Slerp(rkKeys.Rotations[rkInfo.RotationChannelIdx][LowKey + 1], t);
+
+    if (rkInfo.TranslationChannelIdx != 0xFF && pOutTranslation)
+        *pOutTranslation = Math::Lerp<CVector3f>(rkKeys.Translations[rkInfo.TranslationChannelIdx][LowKey], rkKeys.Translations[rkInfo.TranslationChannelIdx][LowKey + 1], t);
+}
+
+void DenseUpdateTransform(CBone *pBone, CBoneTransformData& rData, const SBoneTransformInfo& rkParentTransform, CAnimation *pAnim, const SDenseKeys& rkKeys, float Time)
+{
+    // The previous implementation of CSkeleton::UpdateTransform on the unquantized keys
+    SBoneTransformInfo TransformInfo;
+    TransformInfo.Position = pBone->LocalPosition();
+    EvaluateDenseTransform(pAnim, rkKeys, Time, pBone->ID(), &TransformInfo.Position, &TransformInfo.Rotation, &TransformInfo.Scale);
+
+    TransformInfo.Position = rkParentTransform.Position + (rkParentTransform.Rotation * (rkParentTransform.Scale * TransformInfo.Position));
+    TransformInfo.Rotation = rkParentTransform.Rotation * TransformInfo.Rotation;
+
+    CTransform4f& rTransform = rData[pBone->ID()];
+    rTransform.SetIdentity();
+    rTransform.Scale(TransformInfo.Scale);
+    rTransform.Rotate(TransformInfo.Rotation);
+    rTransform.Translate(TransformInfo.Position);
+    rTransform *= pBone->InvBindMatrix();
+
+    for (uint32 iChild = 0; iChild < pBone->NumChildren(); iChild++)
+        DenseUpdateTransform(pBone->ChildByIndex(iChild), rData, TransformInfo, pAnim, rkKeys, Time);
+}
+
+void RecursiveUpdateTransform(CBone *pBone, CBoneTransformData& rData, const SBoneTransformInfo& rkParentTransform, CAnimation *pAnim, float Time)
+{
+    // The previous implementation of CSkeleton::UpdateTransform, evaluating the animation one bone at a time
+    SBoneTransformInfo TransformInfo;
+    TransformInfo.Position = pBone->LocalPosition();
+
+    if (pAnim)
+        pAnim->EvaluateTransform(Time, pBone->ID(), &TransformInfo.Position, &TransformInfo.Rotation, &TransformInfo.Scale);
+
+    TransformInfo.Position = rkParentTransform.Position + (rkParentTransform.Rotation * (rkParentTransform.Scale * TransformInfo.Position));
+    TransformInfo.Rotation = rkParentTransform.Rotation * TransformInfo.Rotation;
+
+    CTransform4f& rTransform = rData[pBone->ID()];
+    rTransform.SetIdentity();
+    rTransform.Scale(TransformInfo.Scale);
+    rTransform.Rotate(TransformInfo.Rotation);
+    rTransform.Translate(TransformInfo.Position);
+    rTransform *= pBone->InvBindMatrix();
+
+    for (uint32 iChild = 0; iChild < pBone->NumChildren(); iChild++)
+        RecursiveUpdateTransform(pBone->ChildByIndex(iChild), rData, TransformInfo, pAnim, Time);
+}
+
+bool PointsMatch(const CVector3f& rkA, const CVector3f& rkB)
+{
+    return rkA.Distance(rkB) <= 0.001f * Math::Max(1.f, rkA.Magnitude());
+}
+
+bool AnimationEvaluation(CSkeleton *pSkel, CAnimation *pAnim, uint32 NumActors /*= 500*/, uint32 NumFrames /*= 60*/, uint32 Seed /*= 0*/)
+{
+    ASSERT(pSkel && pSkel->RootBone() && pAnim);
+
+    // Every actor plays the animation from a random start time, advancing one tick per frame
+    std::mt19937 Random(Seed);
+    std::uniform_real_distribution<float> StartTime(0.f, pAnim->Duration());
+    std::vector<float> StartTimes(NumActors);
+
+    for (uint32 iActor = 0; iActor < NumActors; iActor++)
+        StartTimes[iActor] = StartTime(Random);
+
+    auto ActorTime = [&](uint32 Actor, uint32 Frame) -> float
+    {
+        float Duration = pAnim->Duration();
+        float Time = StartTimes[Actor] + Frame * pAnim->TickInterval();
+        return (Duration > 0.f ? fmodf(Time, Duration) : 0.f);
+    };
+
+    // Reread the unquantized keys from the cooked file as a reference for the quantized ones
+    SDenseKeys DenseKeys;
+    bool HasDenseKeys = false;
+
+    if (pAnim->Entry())
+    {
+        CFileInStream File(pAnim->Entry()->CookedAssetPath(), EEndian::BigEndian);
+
+        if (File.IsValid())
+            HasDenseKeys = CAnimationLoader::LoadUnquantizedKeys(File, pAnim->Game(), DenseKeys.Scales, DenseKeys.Rotations, DenseKeys.Translations);
+    }
+
+    if (!HasDenseKeys)
+        warnf("Animation evaluation benchmark: couldn't read the unquantized keys for %s; skipping the quantization error check", *pAnim->Source());
+
+    std::vector<CBoneTransformData> DenseData(NumActors, CBoneTransformData(pSkel));
+    std::vector<CBoneTransformData> RecursiveData(NumActors, CBoneTransformData(pSkel));
+    std::vector<CBoneTransformData> BatchData(NumActors, CBoneTransformData(pSkel));
+
+    // Per-bone recursive evaluation of the unquantized keys
+    double DenseTime = 0.0;
+
+    if (HasDenseKeys)
+    {
+        double DenseStart = CTimer::GlobalTime();
+
+        for (uint32 iFrame = 0; iFrame < NumFrames; iFrame++)
+        {
+            for (uint32 iActor = 0; iActor < NumActors; iActor++)
+                DenseUpdateTransform(pSkel->RootBone(), DenseData[iActor], SBoneTransformInfo(), pAnim, DenseKeys, ActorTime(iActor, iFrame));
+        }
+
+        DenseTime = CTimer::GlobalTime() - DenseStart;
+    }
+
+    // Per-bone recursive evaluation
+    double RecursiveStart = CTimer::GlobalTime();
+
+    for (uint32 iFrame = 0; iFrame < NumFrames; iFrame++)
+    {
+        for (uint32 iActor = 0; iActor < NumActors; iActor++)
+            RecursiveUpdateTransform(pSkel->RootBone(), RecursiveData[iActor], SBoneTransformInfo(), pAnim, ActorTime(iActor, iFrame));
+    }
+
+    double RecursiveTime = CTimer::GlobalTime() - RecursiveStart;
+
+    // Batched evaluation
+    double BatchStart = CTimer::GlobalTime();
+
+    for (uint32 iFrame = 0; iFrame < NumFrames; iFrame++)
+    {
+        for (uint32 iActor = 0; iActor < NumActors; iActor++)
+            pSkel->UpdateTransform(BatchData[iActor], pAnim, ActorTime(iActor, iFrame), false);
+    }
+
+    double BatchTime = CTimer::GlobalTime() - BatchStart;
+
+    // Compare the final frame; check a point offset from each bone as well, so rotations are compared too
+    uint32 NumMismatches = 0;
+
+    uint32 MaxBoneID = pSkel->MaxBoneID();
+
+    for (uint32 iActor = 0; iActor < NumActors; iActor++)
+    {
+        for (uint32 BoneID = 0; BoneID <= MaxBoneID; BoneID++)
+        {
+            CBone *pBone = pSkel->BoneByID(BoneID);
+            if (!pBone) continue;
+
+            CVector3f Offset = pBone->Position() + CVector3f::skOne;
+            const CTransform4f& rkRecursive = RecursiveData[iActor][pBone->ID()];
+            const CTransform4f& rkBatch = BatchData[iActor][pBone->ID()];
+
+            if (!PointsMatch(rkRecursive * pBone->Position(), rkBatch * pBone->Position()) || !PointsMatch(rkRecursive * Offset, rkBatch * Offset))
+            {
+                NumMismatches++;
+                break;
+            }
+        }
+    }
+
+    // Quantization error in each bone's local transform, over every time that was evaluated
+    float MaxTranslationError = 0.f;
+    float MaxRotationError = 0.f;
+
+    if (HasDenseKeys)
+    {
+        for (uint32 iFrame = 0; iFrame < NumFrames; iFrame++)
+        {
+            for (uint32 iActor = 0; iActor < NumActors; iActor++)
+            {
+                float Time = ActorTime(iActor, iFrame);
+
+                for (uint32 BoneID = 0; BoneID <= MaxBoneID; BoneID++)
+                {
+                    if (!pSkel->BoneByID(BoneID)) continue;
+
+                    CVector3f DenseTranslation = CVector3f::skZero, QuantizedTranslation = CVector3f::skZero;
+                    CQuaternion DenseRotation, QuantizedRotation;
+                    EvaluateDenseTransform(pAnim, DenseKeys, Time, BoneID, &DenseTranslation, &DenseRotation, nullptr);
+                    pAnim->EvaluateTransform(Time, BoneID, &QuantizedTranslation, &QuantizedRotation, nullptr);
+
+                    float Dot = DenseRotation.X * QuantizedRotation.X + DenseRotation.Y * QuantizedRotation.Y +
+                                DenseRotation.Z * QuantizedRotation.Z + DenseRotation.W * QuantizedRotation.W;
+                    float Angle = 2.f * acosf(Math::Min(fabsf(Dot), 1.f));
+
+                    MaxTranslationError = Math::Max(MaxTranslationError, DenseTranslation.Distance(QuantizedTranslation));
+                    MaxRotationError = Math::Max(MaxRotationError, Math::RadiansToDegrees(Angle));
+                }
+            }
+        }
+    }
+
+    uint32 DenseSize = pAnim->NumKeys() * (pAnim->NumScaleChannels() * sizeof(CVector3f) +
+                                           pAnim->NumRotationChannels() * sizeof(CQuaternion) +
+                                           pAnim->NumTranslationChannels() * sizeof(CVector3f));
+
+    debugf("Animation evaluation benchmark: %s on %s (%d bones, %d keys, %d actors, %d frames)",
+           *pAnim->Source(), *pSkel->Source(), pSkel->NumBones(), pAnim->NumKeys(), NumActors, NumFrames);
+    debugf("    Key data:   %d bytes (%d bytes unquantized)", pAnim->KeyDataSize(), DenseSize);
+
+    if (HasDenseKeys)
+    {
+        debugf("    Unquantized: %.3f ms (recursive, full precision keys)", DenseTime * 1000.0);
+        debugf("    Max error:   %f translation, %f degrees rotation (quantized vs full precision keys)", MaxTranslationError, MaxRotationError);
+    }
+
+    debugf("    Recursive:  %.3f ms", RecursiveTime * 1000.0);
+    debugf("    Batched:    %.3f ms (%.1fx)", BatchTime * 1000.0, (BatchTime > 0.0 ? RecursiveTime / BatchTime : 0.0));
+
+    if (NumMismatches > 0)
+        warnf("Animation evaluation benchmark: %d actors posed differently between the recursive and batched paths", NumMismatches);
+
+    return NumMismatches == 0;
+}
+
+// ************ RUN ALL ************
+bool RunAll(const TString& rkProjectPath /*= ""*/)
+{
+    static const uint32 skMaxAssets = 5;
+    uint32 NumRun = 0, NumFailed = 0;
+
+    auto Run = [&NumRun, &NumFailed](bool Passed)
+    {
+        NumRun++;
+        if (!Passed) NumFailed++;
+    };
+
+    // These don't need any assets
+    Run( TemplateLoad() );
+    Run( PropertyMapLookup() );
+    Run( PropertyNameGeneration() );
+    Run( ResourceStoreBuild("BenchmarkStore/") );
+    Run( TexelDecode() );
+
+    if (!rkProjectPath.IsEmpty())
+    {
+        CNullProgressNotifier Progress;
+        CGameProject *pProject = CGameProject::LoadProject(rkProjectPath, &Progress);
+
+        if (!pProject)
+        {
+            errorf("Benchmarks: failed to load project: %s", *rkProjectPath);
+            NumFailed++;
+        }
+        else
+        {
+            CResourceStore *pOldStore = gpResourceStore;
+            gpResourceStore = pProject->ResourceStore();
+            uint32 NumModels = 0, NumAnimSets = 0;
+
+            for (TResourceIterator<EResourceType::Model> It; It && NumModels < skMaxAssets; ++It)
+            {
+                TResPtr<CModel> pModel = It->Load();
+
+                if (pModel && pModel->GetTriangleCount() > 0)
+                {
+                    Run( RayCast(pModel) );
+                    NumModels++;
+                }
+            }
+
+            for (TResourceIterator<EResourceType::AnimSet> It; It && NumAnimSets < skMaxAssets; ++It)
+            {
+                TResPtr<CAnimSet> pSet = It->Load();
+                if (!pSet || pSet->NumCharacters() == 0) continue;
+
+                CSkeleton *pSkel = pSet->Character(0)->pSkeleton;
+                CAnimation *pAnim = pSet->FindAnimationAsset(0);
+
+                if (pSkel && pSkel->RootBone() && pAnim)
+                {
+                    Run( AnimationEvaluation(pSkel, pAnim) );
+                    NumAnimSets++;
+                }
+            }
+
+            gpResourceStore = pOldStore;
+            delete pProject;
+        }
+    }
+
+    debugf("Benchmarks: %d run, %d failed", NumRun, NumFailed);
+    return NumFailed == 0;
+}
+
+}
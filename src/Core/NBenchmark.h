@@ -0,0 +1,49 @@
+#ifndef NBENCHMARK_H
+#define NBENCHMARK_H
+
+#include <Common/BasicTypes.h>
+#include <Common/TString.h>
+
+class CAnimation;
+class CBasicModel;
+class CSkeleton;
+
+// Microbenchmarks for Core's hot paths. Each one times the optimized path against the straightforward
+// implementation it replaced, checks the two agree, and logs the results. Returns false on a mismatch.
+namespace NBenchmark
+{
+    // Casts random rays through the model's bounds, comparing a per-triangle loop against the surface BVHs
+    bool RayCast(CBasicModel *pModel, uint32 NumRays = 10000, uint32 Seed = 0);
+
+    // Brute forces names of up to MaxWords words from the word list against a pool of random target IDs, comparing a
+    // single-threaded CCRC32 loop against each CPropertyNameGenerator mode. Reports hashes per second for all of them.
+    bool PropertyNameGeneration(uint32 MaxWords = 2, uint32 NumTargets = 100, uint32 Seed = 0);
+
+    // Checks random ID/type pairs against the property map, comparing the old std::map layout (hashing the type name on every
+    // lookup) against the flat index by type name, by interned type handle, and through VerifyPropertyIDs.
+    bool PropertyMapLookup(uint32 NumLookups = 1000000, uint32 Seed = 0);
+
+    // Loads every game's templates from XML and then from the template cache, timing both and checking they produce the same
+    // script templates and property trees. This shuts down the game list first, so nothing can be holding on to templates.
+    bool TemplateLoad();
+
+    // Generates a synthetic resource tree of NumAssets assets under rkDir, then builds a resource store from it with the previous
+    // serial directory walk and with the parallel BuildFromDirectory, checking they find the same entries. rkDir is deleted afterwards.
+    bool ResourceStoreBuild(const TString& rkDir, uint32 NumAssets = 50000, uint32 Seed = 0);
+
+    // Decodes a random Width x Height mipmap in every GX format that has SIMD kernels NumIterations times with the scalar, SSE2 and AVX2
+    // block decoders, checking the outputs are byte-identical to the scalar path. Instruction sets the CPU doesn't support are skipped.
+    bool TexelDecode(uint32 Width = 1024, uint32 Height = 1024, uint32 NumIterations = 10, uint32 Seed = 0);
+
+    // Poses NumActors copies of the skeleton at random points in the animation for NumFrames frames, comparing the previous
+    // recursive per-bone evaluation against the batched pose evaluation, and logs the animation's key data size. The full
+    // precision keys are reread from the cooked file to time the original evaluation and report the maximum quantization error.
+    bool AnimationEvaluation(CSkeleton *pSkel, CAnimation *pAnim, uint32 NumActors = 500, uint32 NumFrames = 60, uint32 Seed = 0);
+
+    // Runs every benchmark with its default settings; this is what the editor's --benchmark switch calls. The ray cast and animation
+    // benchmarks need assets, so they run on the first few models and animation sets in the project at rkProjectPath, and are skipped
+    // if no project is given. Template loading resets the game list, so this must be called before anything else has a project open.
+    bool RunAll(const TString& rkProjectPath = "");
+}
+
+#endif // NBENCHMARK_H
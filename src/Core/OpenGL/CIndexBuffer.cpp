@@ -1,4 +1,5 @@
 #include "CIndexBuffer.h"
+#include "Core/Render/CGraphics.h"
 
 CIndexBuffer::CIndexBuffer()
     : mBuffered(false)
@@ -69,6 +70,7 @@ void CIndexBuffer::DrawElements()
 {
     Bind();
     glDrawElements(mPrimitiveType, mIndices.size(), GL_UNSIGNED_SHORT, (void*) 0);
+    CGraphics::sFrameStats.NumDrawCalls++;
     Unbind();
 }
 
@@ -76,6 +78,7 @@ void CIndexBuffer::DrawElements(uint Offset, uint Size)
 {
     Bind();
     glDrawElements(mPrimitiveType, Size, GL_UNSIGNED_SHORT, (char*)0 + (Offset * 2));
+    CGraphics::sFrameStats.NumDrawCalls++;
     Unbind();
 }
 
@@ -204,6 +204,7 @@ void CShader::SetCurrent()
     {
         glUseProgram(mProgram);
         spCurrentShader = this;
+        CGraphics::sFrameStats.NumShaderBinds++;
 
         glUniformBlockBinding(mProgram, mMVPBlockIndex, CGraphics::MVPBlockBindingPoint());
         glUniformBlockBinding(mProgram, mVertexBlockIndex, CGraphics::VertexBlockBindingPoint());
@@ -102,6 +102,98 @@ uint16 CVertexBuffer::AddIfUnique(const CVertex& rkVtx, uint16 Start)
     return AddVertex(rkVtx);
 }
 
+uint16 CVertexBuffer::AddVertex(const CVertexArray& rkVertices, uint32 Index)
+{
+    if (mPositions.size() == 0xFFFF) throw std::overflow_error("VBO contains too many vertices");
+
+    // Attributes the source array doesn't have get default values, the same as a default-initialized CVertex would
+    FVertexDescription SrcDesc = rkVertices.VertexDesc();
+
+    if (mVtxDesc & EVertexAttribute::Position)
+        mPositions.push_back( (SrcDesc & EVertexAttribute::Position) ? rkVertices.Position(Index) : CVector3f::skZero );
+
+    if (mVtxDesc & EVertexAttribute::Normal)
+        mNormals.push_back( (SrcDesc & EVertexAttribute::Normal) ? rkVertices.Normal(Index) : CVector3f::skZero );
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        if (mVtxDesc & (EVertexAttribute::Color0 << iClr))
+            mColors[iClr].push_back( (SrcDesc & (EVertexAttribute::Color0 << iClr)) ? rkVertices.Color(iClr, Index) : CColor::skTransparentBlack );
+
+    for (uint32 iTex = 0; iTex < 8; iTex++)
+        if (mVtxDesc & (EVertexAttribute::Tex0 << iTex))
+            mTexCoords[iTex].push_back( (SrcDesc & (EVertexAttribute::Tex0 << iTex)) ? rkVertices.TexCoord(iTex, Index) : CVector2f(0.f, 0.f) );
+
+    // Same as AddVertex(const CVertex&): matrix indices go into the texcoord stream of the same slot
+    for (uint32 iMtx = 0; iMtx < 8; iMtx++)
+        if (mVtxDesc & (EVertexAttribute::PosMtx << iMtx))
+            mTexCoords[iMtx].push_back( CVector2f((float) ((SrcDesc & (EVertexAttribute::PosMtx << iMtx)) ? rkVertices.MatrixIndex(iMtx, Index) : 0)) );
+
+    if (mVtxDesc.HasAnyFlags(EVertexAttribute::BoneIndices | EVertexAttribute::BoneWeights) && mpSkin)
+    {
+        const SVertexWeights& rkWeights = mpSkin->WeightsForVertex(rkVertices.ArrayPosition(Index));
+        if (mVtxDesc & EVertexAttribute::BoneIndices) mBoneIndices.push_back(rkWeights.Indices);
+        if (mVtxDesc & EVertexAttribute::BoneWeights) mBoneWeights.push_back(rkWeights.Weights);
+    }
+
+    return (mPositions.size() - 1);
+}
+
+uint16 CVertexBuffer::AddIfUnique(const CVertexArray& rkVertices, uint32 Index, uint16 Start)
+{
+    FVertexDescription SrcDesc = rkVertices.VertexDesc();
+
+    // Attributes the source array doesn't have are compared against their default values
+    const CVector3f& rkPosition = (SrcDesc & EVertexAttribute::Position) ? rkVertices.Position(Index) : CVector3f::skZero;
+    const CVector3f& rkNormal = (SrcDesc & EVertexAttribute::Normal) ? rkVertices.Normal(Index) : CVector3f::skZero;
+    const SVertexWeights *pkWeights = nullptr;
+
+    if (mpSkin && mVtxDesc.HasAnyFlags(EVertexAttribute::BoneIndices | EVertexAttribute::BoneWeights))
+        pkWeights = &mpSkin->WeightsForVertex(rkVertices.ArrayPosition(Index));
+
+    for (uint32 iVert = Start; iVert < mPositions.size(); iVert++)
+    {
+        if ((mVtxDesc & EVertexAttribute::Position) && rkPosition != mPositions[iVert]) continue;
+        if ((mVtxDesc & EVertexAttribute::Normal) && rkNormal != mNormals[iVert]) continue;
+
+        bool Unique = false;
+
+        for (uint32 iClr = 0; iClr < 2 && !Unique; iClr++)
+        {
+            if (mVtxDesc & (EVertexAttribute::Color0 << iClr))
+            {
+                CColor Color = (SrcDesc & (EVertexAttribute::Color0 << iClr)) ? rkVertices.Color(iClr, Index) : CColor::skTransparentBlack;
+                Unique = (Color != mColors[iClr][iVert]);
+            }
+        }
+
+        for (uint32 iTex = 0; iTex < 8 && !Unique; iTex++)
+        {
+            if (mVtxDesc & (EVertexAttribute::Tex0 << iTex))
+            {
+                CVector2f Tex = (SrcDesc & (EVertexAttribute::Tex0 << iTex)) ? rkVertices.TexCoord(iTex, Index) : CVector2f(0.f, 0.f);
+                Unique = (Tex != mTexCoords[iTex][iVert]);
+            }
+        }
+
+        if (!Unique && pkWeights)
+        {
+            for (uint32 iWgt = 0; iWgt < 4; iWgt++)
+            {
+                if ( ((mVtxDesc & EVertexAttribute::BoneIndices) && (pkWeights->Indices[iWgt] != mBoneIndices[iVert][iWgt])) ||
+                     ((mVtxDesc & EVertexAttribute::BoneWeights) && (pkWeights->Weights[iWgt] != mBoneWeights[iVert][iWgt])) )
+                {
+                    Unique = true;
+                    break;
+                }
+            }
+        }
+
+        if (!Unique) return (uint16) iVert;
+    }
+
+    return AddVertex(rkVertices, Index);
+}
+
 void CVertexBuffer::Reserve(uint16 Size)
 {
     uint32 ReserveSize = mPositions.size() + Size;
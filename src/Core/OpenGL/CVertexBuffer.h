@@ -4,6 +4,7 @@
 #include "Core/Resource/TResPtr.h"
 #include "Core/Resource/Animation/CSkin.h"
 #include "Core/Resource/Model/CVertex.h"
+#include "Core/Resource/Model/CVertexArray.h"
 #include "Core/Resource/Model/EVertexAttribute.h"
 #include <vector>
 #include <GL/glew.h>
@@ -27,6 +28,8 @@ public:
     ~CVertexBuffer();
     uint16 AddVertex(const CVertex& rkVtx);
     uint16 AddIfUnique(const CVertex& rkVtx, uint16 Start);
+    uint16 AddVertex(const CVertexArray& rkVertices, uint32 Index);
+    uint16 AddIfUnique(const CVertexArray& rkVertices, uint32 Index, uint16 Start);
     void Reserve(uint16 Size);
     void Clear();
     void Buffer();
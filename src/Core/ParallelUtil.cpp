@@ -0,0 +1,106 @@
+#include "ParallelUtil.h"
+#include <Common/Common.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ParallelUtil
+{
+    // Set on threads spawned by ParallelFor so nested calls don't oversubscribe the CPU
+    static thread_local bool gIsWorkerThread = false;
+
+    uint32 DefaultThreadCount()
+    {
+        uint32 NumThreads = std::thread::hardware_concurrency();
+        return (NumThreads > 0 ? NumThreads : 1);
+    }
+
+    bool IsWorkerThread()
+    {
+        return gIsWorkerThread;
+    }
+
+    bool ParallelFor(uint32 Count,
+                     const std::function<void(uint32)>& Func,
+                     uint32 NumThreads /*= 0*/,
+                     const std::function<bool(uint32)>& PollFunc /*= nullptr*/)
+    {
+        if (NumThreads == 0)
+            NumThreads = DefaultThreadCount();
+
+        if (NumThreads > Count)
+            NumThreads = Count;
+
+        // Serial path - run everything on the calling thread
+        if (NumThreads <= 1 || gIsWorkerThread)
+        {
+            for (uint32 Index = 0; Index < Count; Index++)
+            {
+                if (PollFunc && !PollFunc(Index))
+                    return false;
+
+                Func(Index);
+            }
+
+            return true;
+        }
+
+        // Parallel path - workers pull indices until they run out or we're told to stop
+        std::atomic<uint32> NextIndex(0);
+        std::atomic<uint32> NumCompleted(0);
+        std::atomic<bool> Stop(false);
+        uint32 NumActiveWorkers = NumThreads;
+        std::mutex Mutex;
+        std::condition_variable Condition;
+
+        std::vector<std::thread> Workers;
+        Workers.reserve(NumThreads);
+
+        for (uint32 ThreadIdx = 0; ThreadIdx < NumThreads; ThreadIdx++)
+        {
+            Workers.emplace_back([&]()
+            {
+                gIsWorkerThread = true;
+
+                while (!Stop)
+                {
+                    uint32 Index = NextIndex++;
+                    if (Index >= Count) break;
+
+                    Func(Index);
+                    NumCompleted++;
+                }
+
+                std::lock_guard<std::mutex> Lock(Mutex);
+                NumActiveWorkers--;
+                Condition.notify_all();
+            });
+        }
+
+        // Poll progress on the calling thread while the workers run
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+
+            while (NumActiveWorkers > 0)
+            {
+                Condition.wait_for(Lock, std::chrono::milliseconds(25));
+
+                if (PollFunc && !Stop)
+                {
+                    Lock.unlock();
+                    if (!PollFunc(NumCompleted)) Stop = true;
+                    Lock.lock();
+                }
+            }
+        }
+
+        for (std::thread& rWorker : Workers)
+            rWorker.join();
+
+        return !Stop;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef PARALLELUTIL_H
+#define PARALLELUTIL_H
+
+#include <Common/BasicTypes.h>
+#include <functional>
+
+namespace ParallelUtil
+{
+    // Number of worker threads to use when the caller doesn't specify one (hardware concurrency, at least 1)
+    uint32 DefaultThreadCount();
+
+    // Whether the calling thread is a ParallelFor worker. Nested ParallelFor calls run serially on the worker.
+    bool IsWorkerThread();
+
+    // Runs Func(Index) for every index in [0, Count) across NumThreads threads (0 = DefaultThreadCount).
+    // Indices are handed out in increasing order, but may complete in any order.
+    // If PollFunc is provided, it is called periodically on the calling thread with the number of
+    // completed items; returning false stops any items that haven't been started yet from running.
+    // Returns false if the run was stopped by PollFunc.
+    bool ParallelFor(uint32 Count,
+                     const std::function<void(uint32)>& Func,
+                     uint32 NumThreads = 0,
+                     const std::function<bool(uint32)>& PollFunc = nullptr);
+}
+
+#endif // PARALLELUTIL_H
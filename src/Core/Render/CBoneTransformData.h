@@ -8,8 +8,13 @@
 
 class CBoneTransformData
 {
+    friend class CSkeleton;
     std::vector<CTransform4f> mBoneMatrices;
 
+    // Scratch space for CSkeleton::UpdateTransform, kept here so updating a pose doesn't allocate
+    CAnimationPose mPose;
+    std::vector<SBoneTransformInfo> mBoneTransforms;
+
 public:
     CBoneTransformData()                                            { }
     CBoneTransformData(CSkeleton *pSkel)                            { ResizeToSkeleton(pSkel); }
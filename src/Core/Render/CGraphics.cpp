@@ -19,6 +19,7 @@ CGraphics::SMVPBlock    CGraphics::sMVPBlock;
 CGraphics::SVertexBlock CGraphics::sVertexBlock;
 CGraphics::SPixelBlock  CGraphics::sPixelBlock;
 CGraphics::SLightBlock  CGraphics::sLightBlock;
+CGraphics::SFrameStats  CGraphics::sFrameStats = { 0, 0, 0 };
 
 CGraphics::ELightingMode CGraphics::sLightMode;
 uint32 CGraphics::sNumLights;
@@ -87,6 +87,16 @@ public:
     static float sWorldLightMultiplier;
     static CLight sDefaultDirectionalLights[3];
 
+    // Frame statistics; counted as GL calls are made, and reset by CRenderer at the start of each frame.
+    // Every draw call goes through CIndexBuffer::DrawElements, which is where draw calls are counted.
+    struct SFrameStats
+    {
+        uint32 NumDrawCalls;
+        uint32 NumShaderBinds;
+        uint32 NumTextureBinds;
+    };
+    static SFrameStats sFrameStats;
+
     // Functions
     static void Initialize();
     static void Shutdown();
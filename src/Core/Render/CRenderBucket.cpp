@@ -3,6 +3,7 @@
 #include "CGraphics.h"
 #include "CRenderer.h"
 #include <algorithm>
+#include <cstring>
 
 // ************ CSubBucket ************
 void CRenderBucket::CSubBucket::Add(const SRenderablePtr& rkPtr)
@@ -17,18 +18,27 @@ void CRenderBucket::CSubBucket::Add(const SRenderablePtr& rkPtr)
 
 void CRenderBucket::CSubBucket::Sort(const CCamera* pkCamera, bool DebugVisualization)
 {
-    std::stable_sort(mRenderables.begin(), mRenderables.begin() + mSize,
-                     [&, pkCamera](const SRenderablePtr& rkLeft, const SRenderablePtr& rkRight) -> bool
+    if (mSize > 1)
     {
         CVector3f CamPos = pkCamera->Position();
         CVector3f CamDir = pkCamera->Direction();
+        mSortEntries.resize(mSize);
 
-        CVector3f DistL = rkLeft.AABox.ClosestPointAlongVector(CamDir) - CamPos;
-        CVector3f DistR = rkRight.AABox.ClosestPointAlongVector(CamDir) - CamPos;
-        float DotL = DistL.Dot(CamDir);
-        float DotR = DistR.Dot(CamDir);
-        return (DotL > DotR);
-    });
+        for (uint32 iPtr = 0; iPtr < mSize; iPtr++)
+        {
+            mSortEntries[iPtr].Key = SortKey(mRenderables[iPtr], CamPos, CamDir);
+            mSortEntries[iPtr].Index = iPtr;
+        }
+
+        RadixSort(mSortEntries, mSortScratch);
+
+        mSortedRenderables.resize(mRenderables.size());
+
+        for (uint32 iPtr = 0; iPtr < mSize; iPtr++)
+            mSortedRenderables[iPtr] = mRenderables[mSortEntries[iPtr].Index];
+
+        mRenderables.swap(mSortedRenderables);
+    }
 
     if (DebugVisualization)
     {
@@ -52,6 +62,85 @@ void CRenderBucket::CSubBucket::Sort(const CCamera* pkCamera, bool DebugVisualiz
     }
 }
 
+// ************ CSubBucket - PROTECTED ************
+// Maps a float to an unsigned integer with the same ordering
+static inline uint32 FloatSortBits(float Value)
+{
+    uint32 Bits;
+    memcpy(&Bits, &Value, sizeof(float));
+    return (Bits & 0x80000000 ? ~Bits : Bits | 0x80000000);
+}
+
+uint64 CRenderBucket::CSubBucket::SortKey(const SRenderablePtr& rkPtr, const CVector3f& rkCamPos, const CVector3f& rkCamDir) const
+{
+    CVector3f Dist = rkPtr.AABox.ClosestPointAlongVector(rkCamDir) - rkCamPos;
+    uint32 Depth = FloatSortBits(Dist.Dot(rkCamDir));
+
+    // Back to front
+    if (mTransparent)
+        return (uint64) ~Depth;
+
+    // Bit 63: selection outlines, which need to draw over their meshes
+    // Bits 62-16: shader bits and the upper texture bits of the state key
+    // Bits 15-0: coarse depth, front to back. Renderables without a state key (billboards, gizmos, debug
+    // geometry) leave it out, so they keep the order they were added in.
+    uint64 Selection = (rkPtr.Command == ERenderCommand::DrawSelection ? 1 : 0);
+    uint64 CoarseDepth = (rkPtr.StateKey != 0 ? Depth >> 16 : 0);
+    return (Selection << 63) | ((rkPtr.StateKey >> 17) << 16) | CoarseDepth;
+}
+
+void CRenderBucket::CSubBucket::RadixSort(std::vector<SSortEntry>& rEntries, std::vector<SSortEntry>& rScratch)
+{
+    // LSD radix sort on 8-bit digits. It's stable, so renderables with equal keys keep the order they were added in.
+    uint32 Count = rEntries.size();
+    if (Count < 2) return;
+
+    uint32 Histograms[8][256];
+    memset(Histograms, 0, sizeof(Histograms));
+
+    for (uint32 iEntry = 0; iEntry < Count; iEntry++)
+    {
+        uint64 Key = rEntries[iEntry].Key;
+
+        for (uint32 iDigit = 0; iDigit < 8; iDigit++)
+            Histograms[iDigit][(Key >> (iDigit * 8)) & 0xFF]++;
+    }
+
+    rScratch.resize(Count);
+    SSortEntry *pSrc = rEntries.data();
+    SSortEntry *pDst = rScratch.data();
+
+    for (uint32 iDigit = 0; iDigit < 8; iDigit++)
+    {
+        uint32 Shift = iDigit * 8;
+        uint32 *pOffsets = Histograms[iDigit];
+
+        // Skip digits that are the same in every key, like the upper half of depth-only keys
+        if (pOffsets[(pSrc[0].Key >> Shift) & 0xFF] == Count)
+            continue;
+
+        uint32 Offset = 0;
+
+        for (uint32 iBin = 0; iBin < 256; iBin++)
+        {
+            uint32 BinCount = pOffsets[iBin];
+            pOffsets[iBin] = Offset;
+            Offset += BinCount;
+        }
+
+        for (uint32 iEntry = 0; iEntry < Count; iEntry++)
+        {
+            uint32 Bin = (pSrc[iEntry].Key >> Shift) & 0xFF;
+            pDst[pOffsets[Bin]++] = pSrc[iEntry];
+        }
+
+        std::swap(pSrc, pDst);
+    }
+
+    if (pSrc != rEntries.data())
+        rEntries.swap(rScratch);
+}
+
 void CRenderBucket::CSubBucket::Clear()
 {
     mEstSize = mSize;
@@ -92,6 +181,7 @@ void CRenderBucket::Clear()
 
 void CRenderBucket::Draw(const SViewInfo& rkViewInfo)
 {
+    mOpaqueSubBucket.Sort(rkViewInfo.pCamera, false);
     mOpaqueSubBucket.Draw(rkViewInfo);
     mTransparentSubBucket.Sort(rkViewInfo.pCamera, mEnableDepthSortDebugVisualization);
     mTransparentSubBucket.Draw(rkViewInfo);
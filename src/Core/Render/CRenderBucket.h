@@ -14,22 +14,41 @@ class CRenderBucket
 {
     bool mEnableDepthSortDebugVisualization;
 
+    /* Renderables are sorted by a key computed once per renderable. Transparent keys are the depth
+     * along the camera direction, back to front. Opaque keys group renderables by the GL state they bind
+     * (SRenderablePtr::StateKey) so shader and material setup can be skipped between them, then order
+     * them front to back by coarse depth; selection outlines always go last. */
     class CSubBucket
     {
+        struct SSortEntry
+        {
+            uint64 Key;
+            uint32 Index;
+        };
+
         std::vector<SRenderablePtr> mRenderables;
+        std::vector<SRenderablePtr> mSortedRenderables;
+        std::vector<SSortEntry> mSortEntries;
+        std::vector<SSortEntry> mSortScratch;
         uint32 mEstSize;
         uint32 mSize;
+        bool mTransparent;
 
     public:
-        CSubBucket()
+        CSubBucket(bool Transparent)
             : mEstSize(0)
             , mSize(0)
+            , mTransparent(Transparent)
         {}
 
         void Add(const SRenderablePtr &rkPtr);
         void Sort(const CCamera *pkCamera, bool DebugVisualization);
         void Clear();
         void Draw(const SViewInfo& rkViewInfo);
+
+    protected:
+        uint64 SortKey(const SRenderablePtr& rkPtr, const CVector3f& rkCamPos, const CVector3f& rkCamDir) const;
+        static void RadixSort(std::vector<SSortEntry>& rEntries, std::vector<SSortEntry>& rScratch);
     };
 
     CSubBucket mOpaqueSubBucket;
@@ -38,6 +57,8 @@ class CRenderBucket
 public:
     CRenderBucket()
         : mEnableDepthSortDebugVisualization(false)
+        , mOpaqueSubBucket(false)
+        , mTransparentSubBucket(true)
     {}
 
     void Add(const SRenderablePtr& rkPtr, bool Transparent);
@@ -23,6 +23,7 @@ CRenderer::CRenderer()
     , mInitialized(false)
     , mContextIndex(-1)
 {
+    mLastFrameStats = { 0, 0, 0 };
     sNumRenderers++;
 }
 
@@ -284,13 +285,14 @@ void CRenderer::RenderSky(CModel *pSkyboxModel, const SViewInfo& rkViewInfo)
     pSkyboxModel->Draw(mOptions, 0);
 }
 
-void CRenderer::AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup /*= eMidground*/)
+void CRenderer::AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup /*= eMidground*/, uint64 StateKey /*= 0*/)
 {
     SRenderablePtr Ptr;
     Ptr.pRenderable = pRenderable;
     Ptr.ComponentIndex = ComponentIndex;
     Ptr.AABox = rkAABox;
     Ptr.Command = Command;
+    Ptr.StateKey = StateKey;
 
     switch (DepthGroup)
     {
@@ -317,6 +319,7 @@ void CRenderer::BeginFrame()
     if (!mInitialized) Init();
 
     CGraphics::SetActiveContext(mContextIndex);
+    CGraphics::sFrameStats = { 0, 0, 0 };
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &mDefaultFramebuffer);
 
     mSceneFramebuffer.SetMultisamplingEnabled(true);
@@ -335,7 +338,7 @@ void CRenderer::EndFrame()
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mDefaultFramebuffer);
     glViewport(0, 0, mViewportWidth, mViewportHeight);
     glBlitFramebuffer(0, 0, mViewportWidth, mViewportHeight, 0, 0, mViewportWidth, mViewportHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    gDrawCount = 0;
+    mLastFrameStats = CGraphics::sFrameStats;
 }
 
 void CRenderer::ClearDepthBuffer()
@@ -352,5 +355,3 @@ void CRenderer::InitFramebuffer()
     glDepthMask(GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
-
-uint32 gDrawCount;
@@ -70,6 +70,8 @@ class CRenderer
     CRenderBucket mForegroundBucket;
     CRenderBucket mUIBucket;
 
+    CGraphics::SFrameStats mLastFrameStats;
+
     // Static Members
     static uint32 sNumRenderers;
 
@@ -89,12 +91,13 @@ public:
     void SetBloom(EBloomMode BloomMode);
     void SetClearColor(const CColor& rkClear);
     void SetViewportSize(uint32 Width, uint32 Height);
+    inline const CGraphics::SFrameStats& LastFrameStats() const { return mLastFrameStats; }
 
     // Render
     void RenderBuckets(const SViewInfo& rkViewInfo);
     void RenderBloom();
     void RenderSky(CModel *pSkyboxModel, const SViewInfo& rkViewInfo);
-    void AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup = EDepthGroup::Midground);
+    void AddMesh(IRenderable *pRenderable, int ComponentIndex, const CAABox& rkAABox, bool Transparent, ERenderCommand Command, EDepthGroup DepthGroup = EDepthGroup::Midground, uint64 StateKey = 0);
     void BeginFrame();
     void EndFrame();
     void ClearDepthBuffer();
@@ -104,6 +107,4 @@ private:
     void InitFramebuffer();
 };
 
-extern uint32 gDrawCount;
-
 #endif // RENDERMANAGER_H
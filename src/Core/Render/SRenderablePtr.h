@@ -12,6 +12,7 @@ struct SRenderablePtr
     uint32 ComponentIndex;
     CAABox AABox;
     ERenderCommand Command;
+    uint64 StateKey; // Identifies the GL state the draw binds (see CMaterial::StateSortKey); 0 if unknown
 };
 
 #endif // SRENDERABLEPTR_H
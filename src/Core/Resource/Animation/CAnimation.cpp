@@ -1,12 +1,63 @@
 #include "CAnimation.h"
 #include <Common/Math/CTransform4f.h>
 #include <Common/Math/MathUtil.h>
+#include <cfloat>
+#include <cmath>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define ANIM_USE_SSE 1
+    #include <emmintrin.h>
+#else
+    #define ANIM_USE_SSE 0
+#endif
+
+static const float gkRotationScale = 32767.f;
+static const float gkVectorKeyMax = 65535.f;
+
+// ************ HELPERS ************
+static inline uint32 ChannelStride(uint32 NumChannels)
+{
+    return (NumChannels + 3) & ~3;
+}
+
+static inline float VectorComponent(const CVector3f& rkVec, uint32 Comp)
+{
+    return (Comp == 0 ? rkVec.X : (Comp == 1 ? rkVec.Y : rkVec.Z));
+}
+
+static inline float QuatComponent(const CQuaternion& rkQuat, uint32 Comp)
+{
+    return (Comp == 0 ? rkQuat.X : (Comp == 1 ? rkQuat.Y : (Comp == 2 ? rkQuat.Z : rkQuat.W)));
+}
+
+// Slerp weights for two rotations; adjacent keys are usually close enough together that sin() loses
+// precision, so those just get linear weights
+static inline void SlerpWeights(float CosTheta, float Interp, float& rOutLow, float& rOutHigh)
+{
+    float Theta = acosf( Math::Clamp(-1.f, 1.f, CosTheta) );
+    float SinTheta = sinf(Theta);
+
+    if (SinTheta < 0.001f)
+    {
+        rOutLow = 1.f - Interp;
+        rOutHigh = Interp;
+    }
+    else
+    {
+        float InvSinTheta = 1.f / SinTheta;
+        rOutLow = sinf((1.f - Interp) * Theta) * InvSinTheta;
+        rOutHigh = sinf(Interp * Theta) * InvSinTheta;
+    }
+}
+
+// ************ CAnimation ************
 CAnimation::CAnimation(CResourceEntry *pEntry /*= 0*/)
     : CResource(pEntry)
     , mDuration(0.f)
     , mTickInterval(0.0333333f)
     , mNumKeys(0)
+    , mNumRotationChannels(0)
+    , mRotationStride(0)
 {
     for (uint32 iBone = 0; iBone < 100; iBone++)
     {
@@ -27,13 +78,10 @@ void CAnimation::EvaluateTransform(float Time, uint32 BoneID, CVector3f *pOutTra
 {
     const bool kInterpolate = true;
     if (!pOutTranslation && !pOutRotation && !pOutScale) return;
-    if (mDuration == 0.f) return;
 
-    if (Time >= mDuration) Time = mDuration;
-    if (Time >= FLT_EPSILON) Time -= FLT_EPSILON;
-    float t = fmodf(Time, mTickInterval) / mTickInterval;
-    uint32 LowKey = (uint32) (Time / mTickInterval);
-    if (LowKey == (mNumKeys - 1)) LowKey = mNumKeys - 2;
+    uint32 LowKey, HighKey;
+    float t;
+    if (!KeyRange(Time, LowKey, HighKey, t)) return;
 
     uint8 ScaleChannel = mBoneInfo[BoneID].ScaleChannelIdx;
     uint8 RotChannel = mBoneInfo[BoneID].RotationChannelIdx;
@@ -41,27 +89,274 @@ void CAnimation::EvaluateTransform(float Time, uint32 BoneID, CVector3f *pOutTra
 
     if (ScaleChannel != 0xFF && pOutScale)
     {
-        const CVector3f& rkLow = mScaleChannels[ScaleChannel][LowKey];
-        const CVector3f& rkHigh = mScaleChannels[ScaleChannel][LowKey + 1];
-        *pOutScale = (kInterpolate ? Math::Lerp<CVector3f>(rkLow, rkHigh, t) : rkLow);
+        CVector3f Low = DequantizeVector(mScaleKeys, ScaleChannel, LowKey);
+        CVector3f High = DequantizeVector(mScaleKeys, ScaleChannel, HighKey);
+        *pOutScale = (kInterpolate ? Math::Lerp<CVector3f>(Low, High, t) : Low);
     }
 
     if (RotChannel != 0xFF && pOutRotation)
     {
-        const CQuaternion& rkLow = mRotationChannels[RotChannel][LowKey];
-        const CQuaternion& rkHigh = mRotationChannels[RotChannel][LowKey + 1];
-        *pOutRotation = (kInterpolate ? rkLow.Slerp(rkHigh, t) : rkLow);
+        CQuaternion Low = DequantizeRotation(RotChannel, LowKey);
+        CQuaternion High = DequantizeRotation(RotChannel, HighKey);
+        *pOutRotation = (kInterpolate ? Low.Slerp(High, t) : Low);
     }
 
     if (TransChannel != 0xFF && pOutTranslation)
     {
-        const CVector3f& rkLow = mTranslationChannels[TransChannel][LowKey];
-        const CVector3f& rkHigh = mTranslationChannels[TransChannel][LowKey + 1];
-        *pOutTranslation = (kInterpolate ? Math::Lerp<CVector3f>(rkLow, rkHigh, t) : rkLow);
+        CVector3f Low = DequantizeVector(mTranslationKeys, TransChannel, LowKey);
+        CVector3f High = DequantizeVector(mTranslationKeys, TransChannel, HighKey);
+        *pOutTranslation = (kInterpolate ? Math::Lerp<CVector3f>(Low, High, t) : Low);
     }
 }
 
+bool CAnimation::EvaluatePose(float Time, CAnimationPose& rOutPose) const
+{
+    uint32 LowKey, HighKey;
+    float t;
+    if (!KeyRange(Time, LowKey, HighKey, t)) return false;
+
+    rOutPose.mScaleStride = mScaleKeys.Stride;
+    rOutPose.mRotationStride = mRotationStride;
+    rOutPose.mTranslationStride = mTranslationKeys.Stride;
+    rOutPose.mScales.resize(mScaleKeys.Stride * 3);
+    rOutPose.mRotations.resize(mRotationStride * 4);
+    rOutPose.mTranslations.resize(mTranslationKeys.Stride * 3);
+
+    EvaluateVectorChannels(mScaleKeys, LowKey, HighKey, t, rOutPose.mScales.data());
+    EvaluateRotationChannels(LowKey, HighKey, t, rOutPose.mRotations.data());
+    EvaluateVectorChannels(mTranslationKeys, LowKey, HighKey, t, rOutPose.mTranslations.data());
+    return true;
+}
+
 bool CAnimation::HasTranslation(uint32 BoneID) const
 {
     return (mBoneInfo[BoneID].TranslationChannelIdx != 0xFF);
 }
+
+uint32 CAnimation::KeyDataSize() const
+{
+    return (mScaleKeys.Keys.size() + mTranslationKeys.Keys.size()) * sizeof(uint16) +
+           (mScaleKeys.Base.size() + mTranslationKeys.Base.size()) * sizeof(float) * 2 +
+           mRotationKeys.size() * sizeof(int16);
+}
+
+// ************ PROTECTED ************
+void CAnimation::SetKeys(const std::vector<TScaleChannel>& rkScales, const std::vector<TRotationChannel>& rkRotations, const std::vector<TTranslationChannel>& rkTranslations)
+{
+    QuantizeVectorChannels(rkScales, mNumKeys, mScaleKeys);
+    QuantizeVectorChannels(rkTranslations, mNumKeys, mTranslationKeys);
+
+    mNumRotationChannels = rkRotations.size();
+    mRotationStride = ChannelStride(mNumRotationChannels);
+    mRotationKeys.assign(mNumKeys * 4 * mRotationStride, 0);
+
+    // Padding channels are left as zero; set their W to 1 so they still hold valid rotations
+    for (uint32 iKey = 0; iKey < mNumKeys; iKey++)
+    {
+        int16 *pW = &mRotationKeys[(iKey * 4 + 3) * mRotationStride];
+
+        for (uint32 iChan = mNumRotationChannels; iChan < mRotationStride; iChan++)
+            pW[iChan] = (int16) gkRotationScale;
+    }
+
+    for (uint32 iChan = 0; iChan < mNumRotationChannels; iChan++)
+    {
+        const TRotationChannel& rkChannel = rkRotations[iChan];
+        if (rkChannel.empty()) continue;
+
+        for (uint32 iKey = 0; iKey < mNumKeys; iKey++)
+        {
+            // Channels that are shorter than the animation hold their last key
+            const CQuaternion& rkKey = rkChannel[Math::Min<uint32>(iKey, rkChannel.size() - 1)];
+
+            for (uint32 iComp = 0; iComp < 4; iComp++)
+            {
+                float Value = Math::Clamp(-1.f, 1.f, QuatComponent(rkKey, iComp));
+                mRotationKeys[(iKey * 4 + iComp) * mRotationStride + iChan] = (int16) std::lround(Value * gkRotationScale);
+            }
+        }
+    }
+}
+
+bool CAnimation::KeyRange(float Time, uint32& rOutLowKey, uint32& rOutHighKey, float& rOutInterp) const
+{
+    if (mDuration == 0.f || mNumKeys == 0) return false;
+
+    if (Time >= mDuration) Time = mDuration;
+    if (Time >= FLT_EPSILON) Time -= FLT_EPSILON;
+    rOutInterp = fmodf(Time, mTickInterval) / mTickInterval;
+    rOutLowKey = (uint32) (Time / mTickInterval);
+
+    if (rOutLowKey + 1 >= mNumKeys)
+        rOutLowKey = (mNumKeys >= 2 ? mNumKeys - 2 : 0);
+
+    rOutHighKey = Math::Min(rOutLowKey + 1, mNumKeys - 1);
+    return true;
+}
+
+void CAnimation::QuantizeVectorChannels(const std::vector<TScaleChannel>& rkSource, uint32 NumKeys, SVectorChannels& rOut)
+{
+    rOut.NumChannels = rkSource.size();
+    rOut.Stride = ChannelStride(rOut.NumChannels);
+    rOut.Base.assign(rOut.Stride * 3, 0.f);
+    rOut.Step.assign(rOut.Stride * 3, 0.f);
+    rOut.Keys.assign(NumKeys * 3 * rOut.Stride, 0);
+
+    for (uint32 iChan = 0; iChan < rOut.NumChannels; iChan++)
+    {
+        const TScaleChannel& rkChannel = rkSource[iChan];
+        if (rkChannel.empty()) continue;
+
+        for (uint32 iComp = 0; iComp < 3; iComp++)
+        {
+            float Min = FLT_MAX;
+            float Max = -FLT_MAX;
+
+            for (uint32 iKey = 0; iKey < rkChannel.size(); iKey++)
+            {
+                float Value = VectorComponent(rkChannel[iKey], iComp);
+                Min = Math::Min(Min, Value);
+                Max = Math::Max(Max, Value);
+            }
+
+            float Step = (Max - Min) / gkVectorKeyMax;
+            rOut.Base[iComp * rOut.Stride + iChan] = Min;
+            rOut.Step[iComp * rOut.Stride + iChan] = Step;
+
+            for (uint32 iKey = 0; iKey < NumKeys; iKey++)
+            {
+                const CVector3f& rkKey = rkChannel[Math::Min<uint32>(iKey, rkChannel.size() - 1)];
+                float Key = (Step > 0.f ? (VectorComponent(rkKey, iComp) - Min) / Step : 0.f);
+                rOut.Keys[(iKey * 3 + iComp) * rOut.Stride + iChan] = (uint16) Math::Clamp(0.f, gkVectorKeyMax, Key + 0.5f);
+            }
+        }
+    }
+}
+
+void CAnimation::EvaluateRotationChannels(uint32 LowKey, uint32 HighKey, float Interp, float *pOut) const
+{
+    const uint32 Stride = mRotationStride;
+    if (Stride == 0) return;
+
+    const int16 *pkLow = &mRotationKeys[LowKey * 4 * Stride];
+    const int16 *pkHigh = &mRotationKeys[HighKey * 4 * Stride];
+
+#if ANIM_USE_SSE
+    const __m128 kScale = _mm_set1_ps(1.f / gkRotationScale);
+
+    for (uint32 iChan = 0; iChan < Stride; iChan += 4)
+    {
+        __m128 Low[4], High[4];
+
+        for (uint32 iComp = 0; iComp < 4; iComp++)
+        {
+            // Sign extend to 32 bits by shifting the value down from the top half
+            __m128i RawLow = _mm_loadl_epi64((const __m128i*) &pkLow[iComp * Stride + iChan]);
+            __m128i RawHigh = _mm_loadl_epi64((const __m128i*) &pkHigh[iComp * Stride + iChan]);
+            Low[iComp] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(RawLow, RawLow), 16)), kScale);
+            High[iComp] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(RawHigh, RawHigh), 16)), kScale);
+        }
+
+        __m128 Dot = _mm_add_ps( _mm_add_ps(_mm_mul_ps(Low[0], High[0]), _mm_mul_ps(Low[1], High[1])),
+                                 _mm_add_ps(_mm_mul_ps(Low[2], High[2]), _mm_mul_ps(Low[3], High[3])) );
+
+        alignas(16) float Dots[4];
+        alignas(16) float LowWeights[4];
+        alignas(16) float HighWeights[4];
+        _mm_store_ps(Dots, Dot);
+
+        for (uint32 iLane = 0; iLane < 4; iLane++)
+            SlerpWeights(Dots[iLane], Interp, LowWeights[iLane], HighWeights[iLane]);
+
+        __m128 LowWeight = _mm_load_ps(LowWeights);
+        __m128 HighWeight = _mm_load_ps(HighWeights);
+
+        for (uint32 iComp = 0; iComp < 4; iComp++)
+            _mm_storeu_ps(&pOut[iComp * Stride + iChan], _mm_add_ps(_mm_mul_ps(Low[iComp], LowWeight), _mm_mul_ps(High[iComp], HighWeight)));
+    }
+
+#else
+    const float kScale = 1.f / gkRotationScale;
+
+    for (uint32 iChan = 0; iChan < Stride; iChan++)
+    {
+        float Low[4], High[4];
+        float Dot = 0.f;
+
+        for (uint32 iComp = 0; iComp < 4; iComp++)
+        {
+            Low[iComp] = pkLow[iComp * Stride + iChan] * kScale;
+            High[iComp] = pkHigh[iComp * Stride + iChan] * kScale;
+            Dot += Low[iComp] * High[iComp];
+        }
+
+        float LowWeight, HighWeight;
+        SlerpWeights(Dot, Interp, LowWeight, HighWeight);
+
+        for (uint32 iComp = 0; iComp < 4; iComp++)
+            pOut[iComp * Stride + iChan] = Low[iComp] * LowWeight + High[iComp] * HighWeight;
+    }
+#endif
+}
+
+void CAnimation::EvaluateVectorChannels(const SVectorChannels& rkChannels, uint32 LowKey, uint32 HighKey, float Interp, float *pOut)
+{
+    // Interpolating the quantized keys before scaling them gives the same result as scaling first, since it's all linear
+    const uint32 Stride = rkChannels.Stride;
+    if (Stride == 0) return;
+
+    for (uint32 iComp = 0; iComp < 3; iComp++)
+    {
+        const uint16 *pkLow = &rkChannels.Keys[(LowKey * 3 + iComp) * Stride];
+        const uint16 *pkHigh = &rkChannels.Keys[(HighKey * 3 + iComp) * Stride];
+        const float *pkBase = &rkChannels.Base[iComp * Stride];
+        const float *pkStep = &rkChannels.Step[iComp * Stride];
+        float *pCompOut = &pOut[iComp * Stride];
+
+#if ANIM_USE_SSE
+        const __m128i kZero = _mm_setzero_si128();
+        const __m128 kInterp = _mm_set1_ps(Interp);
+
+        for (uint32 iChan = 0; iChan < Stride; iChan += 4)
+        {
+            __m128 Low = _mm_cvtepi32_ps( _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*) &pkLow[iChan]), kZero) );
+            __m128 High = _mm_cvtepi32_ps( _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*) &pkHigh[iChan]), kZero) );
+            __m128 Key = _mm_add_ps(Low, _mm_mul_ps(_mm_sub_ps(High, Low), kInterp));
+            __m128 Value = _mm_add_ps(_mm_loadu_ps(&pkBase[iChan]), _mm_mul_ps(Key, _mm_loadu_ps(&pkStep[iChan])));
+            _mm_storeu_ps(&pCompOut[iChan], Value);
+        }
+#else
+        for (uint32 iChan = 0; iChan < Stride; iChan++)
+        {
+            float Low = (float) pkLow[iChan];
+            float High = (float) pkHigh[iChan];
+            pCompOut[iChan] = pkBase[iChan] + (Low + (High - Low) * Interp) * pkStep[iChan];
+        }
+#endif
+    }
+}
+
+CVector3f CAnimation::DequantizeVector(const SVectorChannels& rkChannels, uint32 Channel, uint32 Key)
+{
+    const uint32 Stride = rkChannels.Stride;
+    float Comps[3];
+
+    for (uint32 iComp = 0; iComp < 3; iComp++)
+    {
+        uint32 Index = iComp * Stride + Channel;
+        Comps[iComp] = rkChannels.Base[Index] + rkChannels.Keys[(Key * 3 + iComp) * Stride + Channel] * rkChannels.Step[Index];
+    }
+
+    return CVector3f(Comps[0], Comps[1], Comps[2]);
+}
+
+CQuaternion CAnimation::DequantizeRotation(uint32 Channel, uint32 Key) const
+{
+    const int16 *pkKey = &mRotationKeys[Key * 4 * mRotationStride + Channel];
+    CQuaternion Out;
+    Out.X = pkKey[0] / gkRotationScale;
+    Out.Y = pkKey[mRotationStride] / gkRotationScale;
+    Out.Z = pkKey[mRotationStride * 2] / gkRotationScale;
+    Out.W = pkKey[mRotationStride * 3] / gkRotationScale;
+    return Out;
+}
@@ -8,29 +8,91 @@
 #include <Common/Math/CVector3f.h>
 #include <vector>
 
+// Every channel of an animation evaluated at one point in time. Components are stored in separate
+// arrays (all X values, then all Y values...) padded to a multiple of four channels, which is the
+// layout CAnimation::EvaluatePose writes in.
+class CAnimationPose
+{
+    friend class CAnimation;
+
+    uint32 mScaleStride;
+    uint32 mRotationStride;
+    uint32 mTranslationStride;
+    std::vector<float> mScales;
+    std::vector<float> mRotations;
+    std::vector<float> mTranslations;
+
+public:
+    CAnimationPose()
+        : mScaleStride(0), mRotationStride(0), mTranslationStride(0) {}
+
+    inline CVector3f Scale(uint32 Channel) const
+    {
+        const float *pkComps = &mScales[Channel];
+        return CVector3f(pkComps[0], pkComps[mScaleStride], pkComps[mScaleStride * 2]);
+    }
+
+    inline CQuaternion Rotation(uint32 Channel) const
+    {
+        const float *pkComps = &mRotations[Channel];
+        CQuaternion Out;
+        Out.X = pkComps[0];
+        Out.Y = pkComps[mRotationStride];
+        Out.Z = pkComps[mRotationStride * 2];
+        Out.W = pkComps[mRotationStride * 3];
+        return Out;
+    }
+
+    inline CVector3f Translation(uint32 Channel) const
+    {
+        const float *pkComps = &mTranslations[Channel];
+        return CVector3f(pkComps[0], pkComps[mTranslationStride], pkComps[mTranslationStride * 2]);
+    }
+};
+
 class CAnimation : public CResource
 {
     DECLARE_RESOURCE_TYPE(Animation)
     friend class CAnimationLoader;
 
+public:
     typedef std::vector<CVector3f> TScaleChannel;
     typedef std::vector<CQuaternion> TRotationChannel;
     typedef std::vector<CVector3f> TTranslationChannel;
 
-    float mDuration;
-    float mTickInterval;
-    uint32 mNumKeys;
-
-    std::vector<TScaleChannel> mScaleChannels;
-    std::vector<TRotationChannel> mRotationChannels;
-    std::vector<TTranslationChannel> mTranslationChannels;
-
     struct SBoneChannelInfo
     {
         uint8 ScaleChannelIdx;
         uint8 RotationChannelIdx;
         uint8 TranslationChannelIdx;
     };
+
+private:
+    float mDuration;
+    float mTickInterval;
+    uint32 mNumKeys;
+
+    // Keys are stored quantized to 16 bits per component. Each key is one row holding that key for every
+    // channel, with components split into separate arrays the same way as in CAnimationPose, so evaluating
+    // every channel at once is a straight pass over two rows. Scale and translation keys are relative to
+    // the channel's range (Value = Base + Key * Step); rotation keys are signed normalized.
+    struct SVectorChannels
+    {
+        uint32 NumChannels;
+        uint32 Stride;
+        std::vector<float> Base; // Components split the same way as the keys
+        std::vector<float> Step;
+        std::vector<uint16> Keys;
+
+        SVectorChannels() : NumChannels(0), Stride(0) {}
+    };
+    SVectorChannels mScaleKeys;
+    SVectorChannels mTranslationKeys;
+
+    uint32 mNumRotationChannels;
+    uint32 mRotationStride;
+    std::vector<int16> mRotationKeys;
+
     SBoneChannelInfo mBoneInfo[100];
 
     TResPtr<CAnimEventData> mpEventData;
@@ -39,12 +101,27 @@ public:
     CAnimation(CResourceEntry *pEntry = 0);
     CDependencyTree* BuildDependencyTree() const;
     void EvaluateTransform(float Time, uint32 BoneID, CVector3f *pOutTranslation, CQuaternion *pOutRotation, CVector3f *pOutScale) const;
+    bool EvaluatePose(float Time, CAnimationPose& rOutPose) const;
     bool HasTranslation(uint32 BoneID) const;
+    uint32 KeyDataSize() const;
+
+    inline float Duration() const                                       { return mDuration; }
+    inline uint32 NumKeys() const                                       { return mNumKeys; }
+    inline float TickInterval() const                                   { return mTickInterval; }
+    inline CAnimEventData* EventData() const                            { return mpEventData; }
+    inline uint32 NumScaleChannels() const                              { return mScaleKeys.NumChannels; }
+    inline uint32 NumRotationChannels() const                           { return mNumRotationChannels; }
+    inline uint32 NumTranslationChannels() const                        { return mTranslationKeys.NumChannels; }
+    inline const SBoneChannelInfo& BoneChannelInfo(uint32 BoneID) const { return mBoneInfo[BoneID]; }
 
-    inline float Duration() const               { return mDuration; }
-    inline uint32 NumKeys() const               { return mNumKeys; }
-    inline float TickInterval() const           { return mTickInterval; }
-    inline CAnimEventData* EventData() const    { return mpEventData; }
+protected:
+    void SetKeys(const std::vector<TScaleChannel>& rkScales, const std::vector<TRotationChannel>& rkRotations, const std::vector<TTranslationChannel>& rkTranslations);
+    bool KeyRange(float Time, uint32& rOutLowKey, uint32& rOutHighKey, float& rOutInterp) const;
+    static void QuantizeVectorChannels(const std::vector<TScaleChannel>& rkSource, uint32 NumKeys, SVectorChannels& rOut);
+    void EvaluateRotationChannels(uint32 LowKey, uint32 HighKey, float Interp, float *pOut) const;
+    static void EvaluateVectorChannels(const SVectorChannels& rkChannels, uint32 LowKey, uint32 HighKey, float Interp, float *pOut);
+    static CVector3f DequantizeVector(const SVectorChannels& rkChannels, uint32 Channel, uint32 Key);
+    CQuaternion DequantizeRotation(uint32 Channel, uint32 Key) const;
 };
 
 #endif // CANIMATION_H
@@ -12,35 +12,6 @@ CBone::CBone(CSkeleton *pSkel)
 {
 }
 
-void CBone::UpdateTransform(CBoneTransformData& rData, const SBoneTransformInfo& rkParentTransform, CAnimation *pAnim, float Time, bool AnchorRoot)
-{
-    // Get transform data
-    SBoneTransformInfo TransformInfo;
-    TransformInfo.Position = mLocalPosition;
-
-    if (pAnim)
-        pAnim->EvaluateTransform(Time, mID, &TransformInfo.Position, &TransformInfo.Rotation, &TransformInfo.Scale);
-
-    if (AnchorRoot && IsRoot())
-        TransformInfo.Position = CVector3f::skZero;
-
-    // Apply parent transform
-    TransformInfo.Position = rkParentTransform.Position + (rkParentTransform.Rotation * (rkParentTransform.Scale * TransformInfo.Position));
-    TransformInfo.Rotation = rkParentTransform.Rotation * TransformInfo.Rotation;
-
-    // Calculate transform
-    CTransform4f& rTransform = rData[mID];
-    rTransform.SetIdentity();
-    rTransform.Scale(TransformInfo.Scale);
-    rTransform.Rotate(TransformInfo.Rotation);
-    rTransform.Translate(TransformInfo.Position);
-    rTransform *= mInvBind;
-
-    // Calculate children
-    for (uint32 iChild = 0; iChild < mChildren.size(); iChild++)
-        mChildren[iChild]->UpdateTransform(rData, TransformInfo, pAnim, Time, AnchorRoot);
-}
-
 CVector3f CBone::TransformedPosition(const CBoneTransformData& rkData) const
 {
     return rkData[mID] * Position();
@@ -112,7 +83,47 @@ uint32 CSkeleton::MaxBoneID() const
 void CSkeleton::UpdateTransform(CBoneTransformData& rData, CAnimation *pAnim, float Time, bool AnchorRoot)
 {
     ASSERT(rData.NumTrackedBones() >= MaxBoneID());
-    mpRootBone->UpdateTransform(rData, SBoneTransformInfo(), pAnim, Time, AnchorRoot);
+
+    // Evaluate every channel of the animation at once, then apply the pose bone by bone. Parents come
+    // before their children in the linear bone list, so each parent's transform is ready when it's needed.
+    CAnimationPose& rPose = rData.mPose;
+    bool HasPose = (pAnim && pAnim->EvaluatePose(Time, rPose));
+    rData.mBoneTransforms.resize(mLinearBones.size());
+
+    for (uint32 iBone = 0; iBone < mLinearBones.size(); iBone++)
+    {
+        const SLinearBone& rkBone = mLinearBones[iBone];
+        SBoneTransformInfo& rInfo = rData.mBoneTransforms[iBone];
+        rInfo = SBoneTransformInfo();
+        rInfo.Position = rkBone.LocalPosition;
+
+        if (HasPose)
+        {
+            const CAnimation::SBoneChannelInfo& rkChannels = pAnim->BoneChannelInfo(rkBone.ID);
+            if (rkChannels.ScaleChannelIdx != 0xFF)         rInfo.Scale = rPose.Scale(rkChannels.ScaleChannelIdx);
+            if (rkChannels.RotationChannelIdx != 0xFF)      rInfo.Rotation = rPose.Rotation(rkChannels.RotationChannelIdx);
+            if (rkChannels.TranslationChannelIdx != 0xFF)   rInfo.Position = rPose.Translation(rkChannels.TranslationChannelIdx);
+        }
+
+        if (AnchorRoot && rkBone.IsRoot)
+            rInfo.Position = CVector3f::skZero;
+
+        // Apply parent transform
+        if (rkBone.ParentIndex >= 0)
+        {
+            const SBoneTransformInfo& rkParent = rData.mBoneTransforms[rkBone.ParentIndex];
+            rInfo.Position = rkParent.Position + (rkParent.Rotation * (rkParent.Scale * rInfo.Position));
+            rInfo.Rotation = rkParent.Rotation * rInfo.Rotation;
+        }
+
+        // Calculate transform
+        CTransform4f& rTransform = rData[rkBone.ID];
+        rTransform.SetIdentity();
+        rTransform.Scale(rInfo.Scale);
+        rTransform.Rotate(rInfo.Rotation);
+        rTransform.Translate(rInfo.Position);
+        rTransform *= rkBone.InvBind;
+    }
 }
 
 void CSkeleton::Draw(FRenderOptions /*Options*/, const CBoneTransformData *pkData)
@@ -180,3 +191,35 @@ std::pair<int32,float> CSkeleton::RayIntersect(const CRay& rkRay, const CBoneTra
 
     return Out;
 }
+
+// ************ PROTECTED ************
+void CSkeleton::LinearizeBones()
+{
+    mLinearBones.clear();
+    if (!mpRootBone) return;
+
+    mLinearBones.reserve(mBones.size());
+    std::vector< std::pair<CBone*, int32> > Stack;
+    Stack.push_back( std::make_pair(mpRootBone, -1) );
+
+    while (!Stack.empty())
+    {
+        CBone *pBone = Stack.back().first;
+        int32 ParentIndex = Stack.back().second;
+        Stack.pop_back();
+
+        SLinearBone Bone;
+        Bone.ID = pBone->ID();
+        Bone.ParentIndex = ParentIndex;
+        Bone.IsRoot = pBone->IsRoot();
+        Bone.LocalPosition = pBone->LocalPosition();
+        Bone.InvBind = pBone->InvBindMatrix();
+        mLinearBones.push_back(Bone);
+
+        // Push children in reverse so they come out in order
+        int32 Index = (int32) mLinearBones.size() - 1;
+
+        for (uint32 iChild = pBone->NumChildren(); iChild > 0; iChild--)
+            Stack.push_back( std::make_pair(pBone->ChildByIndex(iChild - 1), Index) );
+    }
+}
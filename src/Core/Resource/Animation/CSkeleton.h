@@ -30,6 +30,17 @@ class CSkeleton : public CResource
     CBone *mpRootBone;
     std::vector<CBone*> mBones;
 
+    // Bones in parent-first order, so a pose can be applied to the whole skeleton in one pass
+    struct SLinearBone
+    {
+        uint32 ID;
+        int32 ParentIndex;
+        bool IsRoot;
+        CVector3f LocalPosition;
+        CTransform4f InvBind;
+    };
+    std::vector<SLinearBone> mLinearBones;
+
     static const float skSphereRadius;
 
 public:
@@ -45,6 +56,9 @@ public:
 
     inline uint32 NumBones() const  { return mBones.size(); }
     inline CBone* RootBone() const  { return mpRootBone; }
+
+protected:
+    void LinearizeBones();
 };
 
 class CBone
@@ -65,7 +79,6 @@ class CBone
 
 public:
     CBone(CSkeleton *pSkel);
-    void UpdateTransform(CBoneTransformData& rData, const SBoneTransformInfo& rkParentTransform, CAnimation *pAnim, float Time, bool AnchorRoot);
     CVector3f TransformedPosition(const CBoneTransformData& rkData) const;
     CQuaternion TransformedRotation(const CBoneTransformData& rkData) const;
     bool IsRoot() const;
@@ -80,6 +93,7 @@ public:
     inline CVector3f LocalPosition() const              { return mLocalPosition; }
     inline CQuaternion Rotation() const                 { return mRotation; }
     inline CQuaternion LocalRotation() const            { return mLocalRotation; }
+    inline const CTransform4f& InvBindMatrix() const    { return mInvBind; }
     inline TString Name() const                         { return mName; }
     inline bool IsSelected() const                      { return mSelected; }
 
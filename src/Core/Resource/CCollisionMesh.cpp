@@ -48,12 +48,8 @@ void CCollisionMesh::BufferGL()
     for (uint32 iTri = 0; iTri < SortedTris.size(); iTri++)
     {
         uint16 Verts[3];
-
         CCollisionFace *pFace = &SortedTris[iTri];
-        CCollisionLine *pLineA = GetLine(pFace->Lines[0]);
-        CCollisionLine *pLineB = GetLine(pFace->Lines[1]);
-        Verts[0] = pLineA->Vertices[0];
-        Verts[1] = pLineA->Vertices[1];
+        GetFaceVertices(*pFace, Verts);
 
         // Check if we've reached a new material
         if (pFace->MaterialIdx != CurMat)
@@ -65,21 +61,6 @@ void CCollisionMesh::BufferGL()
             }
         }
 
-        // We have two vertex indices; the last one is one of the ones on line B, but we're not sure which one
-        if ((pLineB->Vertices[0] != Verts[0]) &&
-            (pLineB->Vertices[0] != Verts[1]))
-            Verts[2] = pLineB->Vertices[0];
-        else
-            Verts[2] = pLineB->Vertices[1];
-
-        // Some faces have a property that indicates they need to be inverted
-        if (GetMaterial(pFace->MaterialIdx) & eCF_FlippedTri)
-        {
-            uint16 V0 = Verts[0];
-            Verts[0] = Verts[2];
-            Verts[2] = V0;
-        }
-
         // Generate vertices - we don't share vertices between triangles in order to get the generated normals looking correct
         CCollisionVertex& rVert0 = mCollisionVertices[Verts[0]];
         CCollisionVertex& rVert1 = mCollisionVertices[Verts[1]];
@@ -167,3 +148,26 @@ CCollisionMesh::CCollisionFace* CCollisionMesh::GetFace(uint16 Index)
 {
     return &mCollisionFaces[Index];
 }
+
+void CCollisionMesh::GetFaceVertices(const CCollisionFace& rkFace, uint16 *pOutVerts)
+{
+    CCollisionLine *pLineA = GetLine(rkFace.Lines[0]);
+    CCollisionLine *pLineB = GetLine(rkFace.Lines[1]);
+    pOutVerts[0] = pLineA->Vertices[0];
+    pOutVerts[1] = pLineA->Vertices[1];
+
+    // We have two vertex indices; the last one is one of the ones on line B, but we're not sure which one
+    if ((pLineB->Vertices[0] != pOutVerts[0]) &&
+        (pLineB->Vertices[0] != pOutVerts[1]))
+        pOutVerts[2] = pLineB->Vertices[0];
+    else
+        pOutVerts[2] = pLineB->Vertices[1];
+
+    // Some faces have a property that indicates they need to be inverted
+    if (GetMaterial(rkFace.MaterialIdx) & eCF_FlippedTri)
+    {
+        uint16 V0 = pOutVerts[0];
+        pOutVerts[0] = pOutVerts[2];
+        pOutVerts[2] = V0;
+    }
+}
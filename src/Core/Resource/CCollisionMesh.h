@@ -71,6 +71,7 @@ class CCollisionMesh
     CCollisionVertex *GetVertex(uint16 Index);
     CCollisionLine *GetLine(uint16 Index);
     CCollisionFace *GetFace(uint16 Index);
+    void GetFaceVertices(const CCollisionFace& rkFace, uint16 *pOutVerts);
 
 public:
     CCollisionMesh();
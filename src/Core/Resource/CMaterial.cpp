@@ -270,6 +270,24 @@ uint64 CMaterial::HashParameters()
     return mParametersHash;
 }
 
+uint64 CMaterial::StateSortKey()
+{
+    // Shader and blend setup in the upper half, bound textures in the lower half, so sorting by
+    // this groups draws that can skip SetCurrent's setup, then draws that also share textures
+    CFNV1A TexHash(CFNV1A::k64Bit);
+
+    for (uint32 iPass = 0; iPass < mPasses.size(); iPass++)
+    {
+        CTexture *pTexture = mPasses[iPass]->Texture();
+        TexHash.HashData(&pTexture, sizeof(CTexture*));
+    }
+
+    CTexture *pIndTexture = mpIndirectTexture;
+    TexHash.HashData(&pIndTexture, sizeof(CTexture*));
+
+    return (HashParameters() & 0xFFFFFFFF00000000ULL) | (TexHash.GetHash64() & 0xFFFFFFFFULL);
+}
+
 void CMaterial::Update()
 {
     mRecalcHash = true;
@@ -88,6 +88,7 @@ public:
     void ClearShader();
     bool SetCurrent(FRenderOptions Options);
     uint64 HashParameters();
+    uint64 StateSortKey();
     void Update();
     void SetNumPasses(uint32 NumPasses);
 
@@ -1,6 +1,7 @@
 #include "CResTypeInfo.h"
 #include <Common/Macros.h>
 #include <algorithm>
+#include <mutex>
 
 std::unordered_map<EResourceType, CResTypeInfo*> CResTypeInfo::smTypeMap;
 
@@ -58,8 +59,11 @@ CResTypeInfo* CResTypeInfo::TypeForCookedExtension(EGame Game, CFourCC Ext)
 {
     // Extensions can vary between games, but we're not likely to be calling this function for different games very often.
     // So, to speed things up a little, cache the lookup results in a map.
+    // The cache is locked, since resource entries can be built from multiple threads at once.
     static EGame sCachedGame = EGame::Invalid;
     static std::map<CFourCC, CResTypeInfo*> sCachedTypeMap;
+    static std::mutex sCacheMutex;
+    std::lock_guard<std::mutex> Lock(sCacheMutex);
     Ext = Ext.ToUpper();
 
     // When the game changes, our cache is invalidated, so clear it
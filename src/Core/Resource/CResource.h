@@ -10,6 +10,7 @@
 #include <Common/CFourCC.h>
 #include <Common/TString.h>
 #include <Common/Serialization/IArchive.h>
+#include <atomic>
 
 // This macro creates functions that allow us to easily identify this resource type.
 // Must be included on every CResource subclass.
@@ -32,7 +33,7 @@ class CResource
     DECLARE_RESOURCE_TYPE(Resource)
 
     CResourceEntry *mpEntry;
-    int mRefCount;
+    std::atomic<int> mRefCount; // Dependencies shared between resources can be referenced from async loads
 
 public:
     CResource(CResourceEntry *pEntry = 0)
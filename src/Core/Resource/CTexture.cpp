@@ -1,4 +1,5 @@
 #include "CTexture.h"
+#include "Core/Render/CGraphics.h"
 
 CTexture::CTexture(CResourceEntry *pEntry /*= 0*/)
     : CResource(pEntry)
@@ -124,6 +125,7 @@ void CTexture::Bind(uint32 GLTextureUnit)
 
     GLenum BindTarget = (mEnableMultisampling ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D);
     glBindTexture(BindTarget, mTextureID);
+    CGraphics::sFrameStats.NumTextureBinds++;
 }
 
 void CTexture::Resize(uint32 Width, uint32 Height)
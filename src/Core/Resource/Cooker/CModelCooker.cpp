@@ -15,7 +15,6 @@ void CModelCooker::GenerateSurfaceData()
     mNumMatSets = mpModel->mMaterialSets.size();
     mNumSurfaces = mpModel->mSurfaces.size();
     mNumVertices = mpModel->mVertexCount;
-    mVertices.resize(mNumVertices);
 
     // Get vertex attributes
     mVtxAttribs = EVertexAttribute::None;
@@ -26,6 +25,10 @@ void CModelCooker::GenerateSurfaceData()
         mVtxAttribs |= pMat->VtxDesc();
     }
 
+    // Positions, normals and colors are always written, whether the materials use them or not
+    mVertices.SetVertexDesc(mVtxAttribs | EVertexAttribute::Position | EVertexAttribute::Normal | EVertexAttribute::Color0);
+    mVertices.Resize(mNumVertices);
+
     // Get vertices
     uint32 MaxIndex = 0;
 
@@ -36,20 +39,21 @@ void CModelCooker::GenerateSurfaceData()
         for (uint32 iPrim = 0; iPrim < NumPrimitives; iPrim++)
         {
             SSurface::SPrimitive *pPrim = &mpModel->mSurfaces[iSurf]->Primitives[iPrim];
-            uint32 NumVerts = pPrim->Vertices.size();
+            uint32 NumVerts = pPrim->Vertices.Size();
 
             for (uint32 iVtx = 0; iVtx < NumVerts; iVtx++)
             {
-                uint32 VertIndex = pPrim->Vertices[iVtx].ArrayPosition;
-                mVertices[VertIndex] = pPrim->Vertices[iVtx];
+                uint32 VertIndex = pPrim->Vertices.ArrayPosition(iVtx);
+                if (VertIndex >= mVertices.Size()) mVertices.Resize(VertIndex + 1);
+                mVertices.CopyVertex(VertIndex, pPrim->Vertices, iVtx);
 
                 if (VertIndex > MaxIndex) MaxIndex = VertIndex;
             }
         }
     }
 
-    mVertices.resize(MaxIndex + 1);
-    mNumVertices = mVertices.size();
+    mVertices.Resize(MaxIndex + 1);
+    mNumVertices = mVertices.Size();
 }
 
 void CModelCooker::WriteEditorModel(IOutputStream& /*rOut*/)
@@ -93,21 +97,21 @@ void CModelCooker::WriteModelPrime(IOutputStream& rOut)
 
     // Vertices
     for (uint32 iPos = 0; iPos < mNumVertices; iPos++)
-        mVertices[iPos].Position.Write(rOut);
+        mVertices.Position(iPos).Write(rOut);
 
     rOut.WriteToBoundary(32, 0);
     SectionMgr.AddSize(rOut);
 
     // Normals
     for (uint32 iNrm = 0; iNrm < mNumVertices; iNrm++)
-        mVertices[iNrm].Normal.Write(rOut);
+        mVertices.Normal(iNrm).Write(rOut);
 
     rOut.WriteToBoundary(32, 0);
     SectionMgr.AddSize(rOut);
 
     // Colors
     for (uint32 iColor = 0; iColor < mNumVertices; iColor++)
-        mVertices[iColor].Color[0].Write(rOut);
+        mVertices.Color(0, iColor).Write(rOut);
 
     rOut.WriteToBoundary(32, 0);
     SectionMgr.AddSize(rOut);
@@ -120,7 +124,7 @@ void CModelCooker::WriteModelPrime(IOutputStream& rOut)
         if (HasTexSlot)
         {
             for (uint32 iTex = 0; iTex < mNumVertices; iTex++)
-                mVertices[iTex].Tex[iTexSlot].Write(rOut);
+                mVertices.TexCoord(iTexSlot, iTex).Write(rOut);
         }
     }
 
@@ -162,13 +166,12 @@ void CModelCooker::WriteModelPrime(IOutputStream& rOut)
         for (uint32 iPrim = 0; iPrim < pSurface->Primitives.size(); iPrim++)
         {
             SSurface::SPrimitive *pPrimitive = &pSurface->Primitives[iPrim];
+            const CVertexArray& rkVerts = pPrimitive->Vertices;
             rOut.WriteByte((uint8) pPrimitive->Type);
-            rOut.WriteShort((uint16) pPrimitive->Vertices.size());
+            rOut.WriteShort((uint16) rkVerts.Size());
 
-            for (uint32 iVert = 0; iVert < pPrimitive->Vertices.size(); iVert++)
+            for (uint32 iVert = 0; iVert < rkVerts.Size(); iVert++)
             {
-                CVertex *pVert = &pPrimitive->Vertices[iVert];
-
                 if (mVersion == EGame::Echoes)
                 {
                     for (uint32 iMtxAttribs = 0; iMtxAttribs < 8; iMtxAttribs++)
@@ -176,12 +179,13 @@ void CModelCooker::WriteModelPrime(IOutputStream& rOut)
                         uint MatrixBit = ((uint) (EVertexAttribute::PosMtx) << iMtxAttribs);
                         if (VtxAttribs & MatrixBit)
                         {
-                            rOut.WriteByte(pVert->MatrixIndices[iMtxAttribs]);
+                            bool HasMatrix = rkVerts.HasAttribute((EVertexAttribute) MatrixBit);
+                            rOut.WriteByte(HasMatrix ? rkVerts.MatrixIndex(iMtxAttribs, iVert) : 0);
                         }
                     }
                 }
 
-                uint16 VertexIndex = (uint16) pVert->ArrayPosition;
+                uint16 VertexIndex = (uint16) rkVerts.ArrayPosition(iVert);
 
                 if (VtxAttribs & EVertexAttribute::Position)
                     rOut.WriteShort(VertexIndex);
@@ -13,7 +13,7 @@ class CModelCooker
     uint32 mNumSurfaces;
     uint32 mNumVertices;
     uint8 mVertexFormat;
-    std::vector<CVertex> mVertices;
+    CVertexArray mVertices;
     FVertexDescription mVtxAttribs;
 
     CModelCooker();
@@ -1,14 +1,468 @@
 #include "CTextureEncoder.h"
+#include "Core/ParallelUtil.h"
 #include <Common/Log.h>
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+#include <cmath>
+
+// ************ TEXEL ENCODING ************
+// All block formats written by the encoder use 32 bytes per block, except RGBA8 which uses 64.
+void GetEncodeBlockLayout(ETexelFormat Format, uint32& rOutBlockWidth, uint32& rOutBlockHeight, uint32& rOutBlockSize)
+{
+    switch (Format)
+    {
+    case ETexelFormat::GX_I8:   rOutBlockWidth = 8; rOutBlockHeight = 4; rOutBlockSize = 32; break;
+    case ETexelFormat::GX_CMPR: rOutBlockWidth = 8; rOutBlockHeight = 8; rOutBlockSize = 32; break;
+    case ETexelFormat::GX_RGBA8: rOutBlockWidth = 4; rOutBlockHeight = 4; rOutBlockSize = 64; break;
+    default:                    rOutBlockWidth = 4; rOutBlockHeight = 4; rOutBlockSize = 32; break;
+    }
+}
+
+inline void WriteBE16(uint8 *pDst, uint16 Value)
+{
+    pDst[0] = (uint8) (Value >> 8);
+    pDst[1] = (uint8) (Value & 0xFF);
+}
+
+inline uint8 QuantizeChannel(uint8 Value, uint32 MaxValue)
+{
+    return (uint8) ((Value * MaxValue + 127) / 255);
+}
+
+inline uint8 Luminance(const uint8 *pkTexel)
+{
+    // Rec. 601 weights; the weights add up to 256, so grey input is preserved exactly
+    return (uint8) ((pkTexel[0] * 77 + pkTexel[1] * 150 + pkTexel[2] * 29 + 128) >> 8);
+}
+
+inline uint16 EncodeRGB565(const uint8 *pkTexel)
+{
+    return (uint16) ((QuantizeChannel(pkTexel[0], 31) << 11) | (QuantizeChannel(pkTexel[1], 63) << 5) | QuantizeChannel(pkTexel[2], 31));
+}
+
+inline uint16 EncodeRGB5A3(const uint8 *pkTexel)
+{
+    uint8 Alpha = QuantizeChannel(pkTexel[3], 7);
+
+    // Anything that would round to fully opaque gets the extra color precision of RGB5 instead
+    if (Alpha == 7)
+        return (uint16) (0x8000 | (QuantizeChannel(pkTexel[0], 31) << 10) | (QuantizeChannel(pkTexel[1], 31) << 5) | QuantizeChannel(pkTexel[2], 31));
+    else
+        return (uint16) ((Alpha << 12) | (QuantizeChannel(pkTexel[0], 15) << 8) | (QuantizeChannel(pkTexel[1], 15) << 4) | QuantizeChannel(pkTexel[2], 15));
+}
+
+// Reads a block of texels from an image, clamping to the edges of the image so
+// textures that aren't a multiple of the block size are padded with their edge texels.
+void FetchBlock(const uint8 *pkImage, uint32 Width, uint32 Height, uint32 X, uint32 Y, uint32 BlockWidth, uint32 BlockHeight, uint8 *pOutTexels)
+{
+    for (uint32 iRow = 0; iRow < BlockHeight; iRow++)
+    {
+        uint32 SrcY = Math::Min(Y + iRow, Height - 1);
+
+        for (uint32 iCol = 0; iCol < BlockWidth; iCol++)
+        {
+            uint32 SrcX = Math::Min(X + iCol, Width - 1);
+            const uint8 *pkSrc = pkImage + ((SrcY * Width) + SrcX) * 4;
+            uint8 *pDst = pOutTexels + ((iRow * BlockWidth) + iCol) * 4;
+            pDst[0] = pkSrc[0];
+            pDst[1] = pkSrc[1];
+            pDst[2] = pkSrc[2];
+            pDst[3] = pkSrc[3];
+        }
+    }
+}
+
+// ************ CMPR ENCODING ************
+// CMPR sub-blocks are 4x4 texels with two RGB565 endpoints. If the first endpoint is greater, the
+// block has two interpolated colors at 1/3 and 2/3; otherwise it has one color at 1/2, and index 3 is transparent.
+struct SCMPRFit
+{
+    uint16 Colors[2];
+    uint8 Indices[16];
+    bool ThreeColor;
+    uint32 Error;
+};
+
+inline void ExpandRGB565(uint16 Color, int32 *pOut)
+{
+    uint32 R = (Color >> 11) & 0x1F, G = (Color >> 5) & 0x3F, B = Color & 0x1F;
+    pOut[0] = (int32) ((R << 3) | (R >> 2));
+    pOut[1] = (int32) ((G << 2) | (G >> 4));
+    pOut[2] = (int32) ((B << 3) | (B >> 2));
+}
+
+inline uint16 QuantizeRGB565(const float *pkColor)
+{
+    int32 R = (int32) std::lround(Math::Clamp(0.f, 255.f, pkColor[0]) * 31.f / 255.f);
+    int32 G = (int32) std::lround(Math::Clamp(0.f, 255.f, pkColor[1]) * 63.f / 255.f);
+    int32 B = (int32) std::lround(Math::Clamp(0.f, 255.f, pkColor[2]) * 31.f / 255.f);
+    return (uint16) ((R << 11) | (G << 5) | B);
+}
+
+// Picks the nearest palette entry for every opaque texel and returns the total squared error
+uint32 AssignCMPRIndices(const uint8 *pkTexels, const bool *pkOpaque, SCMPRFit& rFit)
+{
+    int32 Palette[4][3];
+    ExpandRGB565(rFit.Colors[0], Palette[0]);
+    ExpandRGB565(rFit.Colors[1], Palette[1]);
+    uint32 NumColors = (rFit.ThreeColor ? 3 : 4);
+
+    for (uint32 iChan = 0; iChan < 3; iChan++)
+    {
+        if (rFit.ThreeColor)
+            Palette[2][iChan] = (Palette[0][iChan] + Palette[1][iChan]) / 2;
+        else
+        {
+            Palette[2][iChan] = (Palette[0][iChan] * 2 + Palette[1][iChan]) / 3;
+            Palette[3][iChan] = (Palette[0][iChan] + Palette[1][iChan] * 2) / 3;
+        }
+    }
+
+    uint32 TotalError = 0;
+
+    for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        if (!pkOpaque[iTexel])
+        {
+            rFit.Indices[iTexel] = 3;
+            continue;
+        }
+
+        const uint8 *pkTexel = pkTexels + iTexel * 4;
+        uint32 BestError = 0xFFFFFFFF;
+
+        for (uint32 iColor = 0; iColor < NumColors; iColor++)
+        {
+            int32 DR = pkTexel[0] - Palette[iColor][0];
+            int32 DG = pkTexel[1] - Palette[iColor][1];
+            int32 DB = pkTexel[2] - Palette[iColor][2];
+            uint32 Error = (uint32) (DR*DR + DG*DG + DB*DB);
+
+            if (Error < BestError)
+            {
+                BestError = Error;
+                rFit.Indices[iTexel] = (uint8) iColor;
+            }
+        }
+
+        TotalError += BestError;
+    }
+
+    rFit.Error = TotalError;
+    return TotalError;
+}
+
+// Solves for the endpoints that best reproduce the opaque texels given their current indices.
+// Returns false if the indices don't constrain both endpoints.
+bool RefineCMPREndpoints(const uint8 *pkTexels, const bool *pkOpaque, const SCMPRFit& rkFit, float *pOutA, float *pOutB)
+{
+    static const float skWeights4[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+    static const float skWeights3[3] = { 1.f, 0.f, 0.5f };
+    const float *pkWeights = (rkFit.ThreeColor ? skWeights3 : skWeights4);
+
+    float AA = 0.f, AB = 0.f, BB = 0.f;
+    float AX[3] = { 0.f, 0.f, 0.f };
+    float BX[3] = { 0.f, 0.f, 0.f };
+
+    for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        if (!pkOpaque[iTexel]) continue;
+
+        float WA = pkWeights[rkFit.Indices[iTexel]];
+        float WB = 1.f - WA;
+        AA += WA * WA;
+        AB += WA * WB;
+        BB += WB * WB;
+
+        for (uint32 iChan = 0; iChan < 3; iChan++)
+        {
+            AX[iChan] += WA * pkTexels[iTexel * 4 + iChan];
+            BX[iChan] += WB * pkTexels[iTexel * 4 + iChan];
+        }
+    }
+
+    float Det = (AA * BB) - (AB * AB);
+    if (std::fabs(Det) < 1e-6f) return false;
+
+    float InvDet = 1.f / Det;
+
+    for (uint32 iChan = 0; iChan < 3; iChan++)
+    {
+        pOutA[iChan] = (AX[iChan] * BB - BX[iChan] * AB) * InvDet;
+        pOutB[iChan] = (BX[iChan] * AA - AX[iChan] * AB) * InvDet;
+    }
+    return true;
+}
+
+// Finds the initial pair of endpoints for the opaque texels in a sub-block
+void ChooseCMPREndpoints(const uint8 *pkTexels, const bool *pkOpaque, ETextureEncodeQuality Quality, float *pOutA, float *pOutB)
+{
+    float Min[3] = { 255.f, 255.f, 255.f };
+    float Max[3] = { 0.f, 0.f, 0.f };
+    float Mean[3] = { 0.f, 0.f, 0.f };
+    uint32 NumOpaque = 0;
+
+    for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        if (!pkOpaque[iTexel]) continue;
+
+        for (uint32 iChan = 0; iChan < 3; iChan++)
+        {
+            float Value = pkTexels[iTexel * 4 + iChan];
+            Min[iChan] = Math::Min(Min[iChan], Value);
+            Max[iChan] = Math::Max(Max[iChan], Value);
+            Mean[iChan] += Value;
+        }
+        NumOpaque++;
+    }
+
+    for (uint32 iChan = 0; iChan < 3; iChan++)
+        Mean[iChan] /= NumOpaque;
+
+    // Covariance of the block's colors
+    float Cov[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }; // RR RG RB GG GB BB
+
+    for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        if (!pkOpaque[iTexel]) continue;
+
+        float R = pkTexels[iTexel * 4 + 0] - Mean[0];
+        float G = pkTexels[iTexel * 4 + 1] - Mean[1];
+        float B = pkTexels[iTexel * 4 + 2] - Mean[2];
+        Cov[0] += R*R; Cov[1] += R*G; Cov[2] += R*B;
+        Cov[3] += G*G; Cov[4] += G*B; Cov[5] += B*B;
+    }
+
+    if (Quality == ETextureEncodeQuality::Fast)
+    {
+        // Bounding box diagonal. Flip the channels that are anti-correlated with the channel that varies the most.
+        uint32 MainChan = 0;
+        if (Max[1] - Min[1] > Max[MainChan] - Min[MainChan]) MainChan = 1;
+        if (Max[2] - Min[2] > Max[MainChan] - Min[MainChan]) MainChan = 2;
+
+        static const uint32 skCovIndex[3][3] = { {0, 1, 2}, {1, 3, 4}, {2, 4, 5} };
+
+        for (uint32 iChan = 0; iChan < 3; iChan++)
+        {
+            bool Flip = (Cov[skCovIndex[MainChan][iChan]] < 0.f);
+            pOutA[iChan] = (Flip ? Min[iChan] : Max[iChan]);
+            pOutB[iChan] = (Flip ? Max[iChan] : Min[iChan]);
+        }
+        return;
+    }
+
+    // Principal axis via power iteration, starting from the bounding box diagonal
+    float Axis[3] = { Max[0] - Min[0], Max[1] - Min[1], Max[2] - Min[2] };
+    uint32 NumIterations = (Quality == ETextureEncodeQuality::High ? 8 : 4);
+
+    for (uint32 iIter = 0; iIter < NumIterations; iIter++)
+    {
+        float NewAxis[3] = {
+            Cov[0] * Axis[0] + Cov[1] * Axis[1] + Cov[2] * Axis[2],
+            Cov[1] * Axis[0] + Cov[3] * Axis[1] + Cov[4] * Axis[2],
+            Cov[2] * Axis[0] + Cov[4] * Axis[1] + Cov[5] * Axis[2]
+        };
+
+        float Length = Math::Max(Math::Max(std::fabs(NewAxis[0]), std::fabs(NewAxis[1])), std::fabs(NewAxis[2]));
+        if (Length < 1e-6f) break;
+
+        for (uint32 iChan = 0; iChan < 3; iChan++)
+            Axis[iChan] = NewAxis[iChan] / Length;
+    }
+
+    float LengthSq = Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2];
+
+    if (LengthSq < 1e-6f)
+    {
+        // Single color block
+        for (uint32 iChan = 0; iChan < 3; iChan++)
+            pOutA[iChan] = pOutB[iChan] = Mean[iChan];
+        return;
+    }
+
+    float MinProj = 0.f, MaxProj = 0.f;
+
+    for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        if (!pkOpaque[iTexel]) continue;
+
+        float Proj = ((pkTexels[iTexel * 4 + 0] - Mean[0]) * Axis[0] +
+                      (pkTexels[iTexel * 4 + 1] - Mean[1]) * Axis[1] +
+                      (pkTexels[iTexel * 4 + 2] - Mean[2]) * Axis[2]) / LengthSq;
+        MinProj = Math::Min(MinProj, Proj);
+        MaxProj = Math::Max(MaxProj, Proj);
+    }
+
+    for (uint32 iChan = 0; iChan < 3; iChan++)
+    {
+        pOutA[iChan] = Mean[iChan] + Axis[iChan] * MaxProj;
+        pOutB[iChan] = Mean[iChan] + Axis[iChan] * MinProj;
+    }
+}
+
+// Fits a sub-block in either 4-color or 3-color mode, refining the endpoints as the quality setting allows
+SCMPRFit FitCMPRSubBlock(const uint8 *pkTexels, const bool *pkOpaque, bool ThreeColor, ETextureEncodeQuality Quality)
+{
+    float A[3], B[3];
+    ChooseCMPREndpoints(pkTexels, pkOpaque, Quality, A, B);
+
+    SCMPRFit Best;
+    Best.Colors[0] = QuantizeRGB565(A);
+    Best.Colors[1] = QuantizeRGB565(B);
+    Best.ThreeColor = ThreeColor;
+    AssignCMPRIndices(pkTexels, pkOpaque, Best);
+
+    uint32 NumRefinements = (Quality == ETextureEncodeQuality::Fast ? 0 : Quality == ETextureEncodeQuality::Default ? 1 : 8);
+
+    for (uint32 iRefine = 0; iRefine < NumRefinements && Best.Error > 0; iRefine++)
+    {
+        if (!RefineCMPREndpoints(pkTexels, pkOpaque, Best, A, B))
+            break;
+
+        SCMPRFit Fit;
+        Fit.Colors[0] = QuantizeRGB565(A);
+        Fit.Colors[1] = QuantizeRGB565(B);
+        Fit.ThreeColor = ThreeColor;
+
+        if (AssignCMPRIndices(pkTexels, pkOpaque, Fit) >= Best.Error)
+            break;
+
+        Best = Fit;
+    }
+
+    return Best;
+}
+
+// Encodes one 4x4 sub-block (RGBA8 input, 16 texels) to 8 bytes of CMPR data
+void EncodeSubBlockCMPR(const uint8 *pkTexels, ETextureEncodeQuality Quality, uint8 *pOut)
+{
+    // Texels below half alpha are encoded as transparent, which requires 3-color mode
+    bool Opaque[16];
+    bool HasTransparency = false;
+    uint32 NumOpaque = 0;
+
+    for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        Opaque[iTexel] = (pkTexels[iTexel * 4 + 3] >= 0x80);
+        HasTransparency |= !Opaque[iTexel];
+        if (Opaque[iTexel]) NumOpaque++;
+    }
+
+    SCMPRFit Fit;
+
+    if (NumOpaque == 0)
+    {
+        Fit.Colors[0] = Fit.Colors[1] = 0;
+        Fit.ThreeColor = true;
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++) Fit.Indices[iTexel] = 3;
+    }
+    else
+    {
+        Fit = FitCMPRSubBlock(pkTexels, Opaque, HasTransparency, Quality);
+
+        if (!HasTransparency && Quality == ETextureEncodeQuality::High && Fit.Error > 0)
+        {
+            SCMPRFit ThreeColorFit = FitCMPRSubBlock(pkTexels, Opaque, true, Quality);
+            if (ThreeColorFit.Error < Fit.Error) Fit = ThreeColorFit;
+        }
+    }
+
+    // The mode is selected by the order of the endpoints, so swap them into the right order for the mode we want.
+    // Equal endpoints always decode as 3-color mode; that's fine since every texel will be the same color anyway.
+    if (!Fit.ThreeColor && Fit.Colors[0] == Fit.Colors[1])
+    {
+        Fit.ThreeColor = true;
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+            if (Fit.Indices[iTexel] != 3 || Opaque[iTexel]) Fit.Indices[iTexel] = 0;
+    }
+
+    bool NeedSwap = (Fit.ThreeColor ? Fit.Colors[0] > Fit.Colors[1] : Fit.Colors[0] < Fit.Colors[1]);
+
+    if (NeedSwap)
+    {
+        std::swap(Fit.Colors[0], Fit.Colors[1]);
+        static const uint8 skSwap4[4] = { 1, 0, 3, 2 };
+        static const uint8 skSwap3[4] = { 1, 0, 2, 3 };
+        const uint8 *pkSwap = (Fit.ThreeColor ? skSwap3 : skSwap4);
+
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+            Fit.Indices[iTexel] = pkSwap[Fit.Indices[iTexel]];
+    }
+
+    WriteBE16(pOut + 0, Fit.Colors[0]);
+    WriteBE16(pOut + 2, Fit.Colors[1]);
+
+    for (uint32 iRow = 0; iRow < 4; iRow++)
+    {
+        const uint8 *pkRow = Fit.Indices + iRow * 4;
+        pOut[4 + iRow] = (uint8) ((pkRow[0] << 6) | (pkRow[1] << 4) | (pkRow[2] << 2) | pkRow[3]);
+    }
+}
+
+// Encodes one GX block of the given format; pkTexels contains the block's texels as RGBA8
+void EncodeBlock(ETexelFormat Format, const uint8 *pkTexels, ETextureEncodeQuality Quality, uint8 *pOut)
+{
+    switch (Format)
+    {
+    case ETexelFormat::GX_I8:
+        for (uint32 iTexel = 0; iTexel < 32; iTexel++)
+            pOut[iTexel] = Luminance(pkTexels + iTexel * 4);
+        break;
+
+    case ETexelFormat::GX_IA8:
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            pOut[iTexel * 2 + 0] = pkTexels[iTexel * 4 + 3];
+            pOut[iTexel * 2 + 1] = Luminance(pkTexels + iTexel * 4);
+        }
+        break;
+
+    case ETexelFormat::GX_RGB565:
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+            WriteBE16(pOut + iTexel * 2, EncodeRGB565(pkTexels + iTexel * 4));
+        break;
+
+    case ETexelFormat::GX_RGB5A3:
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+            WriteBE16(pOut + iTexel * 2, EncodeRGB5A3(pkTexels + iTexel * 4));
+        break;
+
+    case ETexelFormat::GX_RGBA8:
+        // Alpha/red pairs for the whole block, followed by green/blue pairs
+        for (uint32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            pOut[iTexel * 2 + 0]      = pkTexels[iTexel * 4 + 3];
+            pOut[iTexel * 2 + 1]      = pkTexels[iTexel * 4 + 0];
+            pOut[iTexel * 2 + 0 + 32] = pkTexels[iTexel * 4 + 1];
+            pOut[iTexel * 2 + 1 + 32] = pkTexels[iTexel * 4 + 2];
+        }
+        break;
+
+    case ETexelFormat::GX_CMPR:
+        // Four 4x4 sub-blocks in the order top left, top right, bottom left, bottom right
+        for (uint32 iSub = 0; iSub < 4; iSub++)
+        {
+            uint8 SubTexels[16 * 4];
+            FetchBlock(pkTexels, 8, 8, (iSub % 2) * 4, (iSub / 2) * 4, 4, 4, SubTexels);
+            EncodeSubBlockCMPR(SubTexels, Quality, pOut + iSub * 8);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
 
 CTextureEncoder::CTextureEncoder()
     : mpTexture(nullptr)
+    , mQuality(ETextureEncodeQuality::Default)
 {
 }
 
 void CTextureEncoder::WriteTXTR(IOutputStream& rTXTR)
 {
-    // Only DXT1->CMPR supported at the moment
+    // Lossless DXT1->CMPR repack; RGBA8 sources are encoded by EncodeImageData instead
     rTXTR.WriteLong((uint) mOutputFormat);
     rTXTR.WriteShort(mpTexture->mWidth);
     rTXTR.WriteShort(mpTexture->mHeight);
@@ -40,6 +494,58 @@ void CTextureEncoder::WriteTXTR(IOutputStream& rTXTR)
     }
 }
 
+void CTextureEncoder::EncodeImageData(IOutputStream& rTXTR)
+{
+    uint32 BlockWidth, BlockHeight, BlockSize;
+    GetEncodeBlockLayout(mOutputFormat, BlockWidth, BlockHeight, BlockSize);
+
+    // Every row of blocks in every mipmap is an independent job, written straight to its final location in the image data
+    struct SBlockRowJob
+    {
+        uint32 MipIdx;
+        uint32 BlockY;
+        uint32 OutOffset;
+    };
+    std::vector<SBlockRowJob> Jobs;
+    uint32 ImageDataSize = 0;
+
+    for (uint32 iMip = 0; iMip < mMips.size(); iMip++)
+    {
+        const SMipImage& rkMip = mMips[iMip];
+        uint32 BlocksX = (rkMip.Width + BlockWidth - 1) / BlockWidth;
+        uint32 BlocksY = (rkMip.Height + BlockHeight - 1) / BlockHeight;
+
+        for (uint32 iRow = 0; iRow < BlocksY; iRow++)
+        {
+            Jobs.push_back( SBlockRowJob { iMip, iRow * BlockHeight, ImageDataSize } );
+            ImageDataSize += BlocksX * BlockSize;
+        }
+    }
+
+    std::vector<uint8> ImageData(ImageDataSize);
+
+    ParallelUtil::ParallelFor(Jobs.size(), [&](uint32 JobIdx)
+    {
+        const SBlockRowJob& rkJob = Jobs[JobIdx];
+        const SMipImage& rkMip = mMips[rkJob.MipIdx];
+        uint8 *pOut = ImageData.data() + rkJob.OutOffset;
+        uint8 BlockTexels[8 * 8 * 4];
+
+        for (uint32 BlockX = 0; BlockX < rkMip.Width; BlockX += BlockWidth)
+        {
+            FetchBlock(rkMip.pkData, rkMip.Width, rkMip.Height, BlockX, rkJob.BlockY, BlockWidth, BlockHeight, BlockTexels);
+            EncodeBlock(mOutputFormat, BlockTexels, mQuality, pOut);
+            pOut += BlockSize;
+        }
+    });
+
+    rTXTR.WriteLong((uint) mOutputFormat);
+    rTXTR.WriteShort((uint16) mMips[0].Width);
+    rTXTR.WriteShort((uint16) mMips[0].Height);
+    rTXTR.WriteLong(mMips.size());
+    rTXTR.WriteBytes(ImageData.data(), ImageData.size());
+}
+
 void CTextureEncoder::DetermineBestOutputFormat()
 {
     // todo
@@ -74,10 +580,162 @@ void CTextureEncoder::EncodeTXTR(IOutputStream& rTXTR, CTexture *pTex)
     Encoder.WriteTXTR(rTXTR);
 }
 
-void CTextureEncoder::EncodeTXTR(IOutputStream& rTXTR, CTexture *pTex, ETexelFormat /*OutputFormat*/)
+void CTextureEncoder::EncodeTXTR(IOutputStream& rTXTR, CTexture *pTex, ETexelFormat OutputFormat, ETextureEncodeQuality Quality /*= ETextureEncodeQuality::Default*/)
+{
+    // DXT1 can be converted to CMPR losslessly, so it doesn't go through the encoder
+    if (pTex->mTexelFormat == ETexelFormat::DXT1 && OutputFormat == ETexelFormat::GX_CMPR)
+    {
+        EncodeTXTR(rTXTR, pTex);
+        return;
+    }
+
+    if (pTex->mTexelFormat != ETexelFormat::RGBA8 || !pTex->mBufferExists)
+    {
+        errorf("Unsupported texel format for encoding");
+        return;
+    }
+
+    if (!CanEncode(OutputFormat))
+    {
+        errorf("Unsupported output format for encoding: %d", (int) OutputFormat);
+        return;
+    }
+
+    // A texture with a single image (such as an imported DDS without mipmaps) gets a full mipmap chain generated for it
+    if (pTex->mNumMipMaps <= 1)
+    {
+        EncodeTXTR(rTXTR, pTex->mpImgDataBuffer, pTex->Width(), pTex->Height(), OutputFormat, 0, Quality);
+        return;
+    }
+
+    // Otherwise use the texture's own mipmaps rather than regenerating them
+    CTextureEncoder Encoder;
+    Encoder.mpTexture = pTex;
+    Encoder.mSourceFormat = ETexelFormat::RGBA8;
+    Encoder.mOutputFormat = OutputFormat;
+    Encoder.mQuality = Quality;
+
+    uint32 MipW = pTex->Width(), MipH = pTex->Height(), MipOffset = 0;
+
+    for (uint32 iMip = 0; iMip < pTex->mNumMipMaps && MipW > 0 && MipH > 0; iMip++)
+    {
+        Encoder.mMips.push_back( SMipImage { pTex->mpImgDataBuffer + MipOffset, MipW, MipH } );
+        MipOffset += MipW * MipH * 4;
+        MipW /= 2;
+        MipH /= 2;
+    }
+
+    Encoder.EncodeImageData(rTXTR);
+}
+
+bool CTextureEncoder::EncodeTXTR(IOutputStream& rTXTR, const uint8 *pkRGBA, uint32 Width, uint32 Height, ETexelFormat OutputFormat,
+                                 uint32 NumMipMaps /*= 0*/, ETextureEncodeQuality Quality /*= ETextureEncodeQuality::Default*/)
+{
+    if (!CanEncode(OutputFormat))
+    {
+        errorf("Unsupported output format for encoding: %d", (int) OutputFormat);
+        return false;
+    }
+
+    if (Width == 0 || Height == 0 || Width > 0xFFFF || Height > 0xFFFF)
+    {
+        errorf("Invalid texture dimensions for encoding: %dx%d", Width, Height);
+        return false;
+    }
+
+    uint32 MaxMipMaps = FullMipChainLength(Width, Height);
+    if (NumMipMaps == 0 || NumMipMaps > MaxMipMaps)
+        NumMipMaps = MaxMipMaps;
+
+    // Generate the mipmap chain; each level is filtered from the one above it
+    std::vector< std::vector<uint8> > MipData(NumMipMaps - 1);
+
+    CTextureEncoder Encoder;
+    Encoder.mSourceFormat = ETexelFormat::RGBA8;
+    Encoder.mOutputFormat = OutputFormat;
+    Encoder.mQuality = Quality;
+    Encoder.mMips.push_back( SMipImage { pkRGBA, Width, Height } );
+
+    for (uint32 iMip = 1; iMip < NumMipMaps; iMip++)
+    {
+        const SMipImage& rkPrev = Encoder.mMips.back();
+        GenerateMipMap(rkPrev.pkData, rkPrev.Width, rkPrev.Height, MipData[iMip - 1]);
+        Encoder.mMips.push_back( SMipImage { MipData[iMip - 1].data(), Math::Max(rkPrev.Width / 2, 1u), Math::Max(rkPrev.Height / 2, 1u) } );
+    }
+
+    Encoder.EncodeImageData(rTXTR);
+    return true;
+}
+
+bool CTextureEncoder::CanEncode(ETexelFormat OutputFormat)
 {
-    // todo: support for encoding a specific format
-    EncodeTXTR(rTXTR, pTex);
+    switch (OutputFormat)
+    {
+    case ETexelFormat::GX_I8:
+    case ETexelFormat::GX_IA8:
+    case ETexelFormat::GX_RGB565:
+    case ETexelFormat::GX_RGB5A3:
+    case ETexelFormat::GX_RGBA8:
+    case ETexelFormat::GX_CMPR:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+uint32 CTextureEncoder::FullMipChainLength(uint32 Width, uint32 Height)
+{
+    // Mipmaps go down until either dimension reaches 1
+    uint32 NumMips = 1;
+
+    while (Width > 1 && Height > 1)
+    {
+        Width /= 2;
+        Height /= 2;
+        NumMips++;
+    }
+
+    return NumMips;
+}
+
+void CTextureEncoder::GenerateMipMap(const uint8 *pkSrc, uint32 SrcWidth, uint32 SrcHeight, std::vector<uint8>& rOutMip)
+{
+    uint32 DstWidth = Math::Max(SrcWidth / 2, 1u);
+    uint32 DstHeight = Math::Max(SrcHeight / 2, 1u);
+    rOutMip.resize(DstWidth * DstHeight * 4);
+
+    for (uint32 DstY = 0; DstY < DstHeight; DstY++)
+    {
+        for (uint32 DstX = 0; DstX < DstWidth; DstX++)
+        {
+            // 2x2 box filter. Colors are weighted by alpha so transparent texels don't bleed their color into visible ones.
+            uint32 Color[3] = { 0, 0, 0 };
+            uint32 PlainColor[3] = { 0, 0, 0 };
+            uint32 Alpha = 0;
+
+            for (uint32 iSample = 0; iSample < 4; iSample++)
+            {
+                uint32 SrcX = Math::Min(DstX * 2 + (iSample % 2), SrcWidth - 1);
+                uint32 SrcY = Math::Min(DstY * 2 + (iSample / 2), SrcHeight - 1);
+                const uint8 *pkTexel = pkSrc + ((SrcY * SrcWidth) + SrcX) * 4;
+
+                for (uint32 iChan = 0; iChan < 3; iChan++)
+                {
+                    Color[iChan] += pkTexel[iChan] * pkTexel[3];
+                    PlainColor[iChan] += pkTexel[iChan];
+                }
+                Alpha += pkTexel[3];
+            }
+
+            uint8 *pDst = rOutMip.data() + ((DstY * DstWidth) + DstX) * 4;
+
+            for (uint32 iChan = 0; iChan < 3; iChan++)
+                pDst[iChan] = (uint8) (Alpha > 0 ? (Color[iChan] + Alpha / 2) / Alpha : (PlainColor[iChan] + 2) / 4);
+
+            pDst[3] = (uint8) ((Alpha + 2) / 4);
+        }
+    }
 }
 
 ETexelFormat CTextureEncoder::GetGXFormat(ETexelFormat Format)
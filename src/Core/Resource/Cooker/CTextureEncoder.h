@@ -3,23 +3,50 @@
 
 #include "Core/Resource/CTexture.h"
 #include "Core/Resource/TResPtr.h"
+#include <vector>
 
-// Class contains basic functionality right now - only supports directly converting DXT1 to CMPR
-// More advanced functions (including actual encoding!) coming later
+// How much effort the CMPR encoder puts into choosing endpoints for each block.
+// The other formats are a straight conversion, so they aren't affected by this.
+enum class ETextureEncodeQuality
+{
+    Fast,       // Endpoints taken from the bounding box of the block's colors
+    Default,    // Endpoints fit along the principal axis of the block's colors, refined once
+    High        // Principal axis fit refined until it stops improving; also tries 3-color mode on opaque blocks
+};
+
+// Encodes textures to TXTR. RGBA8 images can be encoded to CMPR, RGB5A3, RGB565, RGBA8, I8 and IA8,
+// and DXT1 textures can be converted directly to CMPR without re-encoding.
 class CTextureEncoder
 {
     TResPtr<CTexture> mpTexture;
     ETexelFormat mSourceFormat;
     ETexelFormat mOutputFormat;
+    ETextureEncodeQuality mQuality;
+
+    // Source images for each mipmap, as tightly packed RGBA8
+    struct SMipImage
+    {
+        const uint8 *pkData;
+        uint32 Width;
+        uint32 Height;
+    };
+    std::vector<SMipImage> mMips;
 
     CTextureEncoder();
     void WriteTXTR(IOutputStream& rTXTR);
+    void EncodeImageData(IOutputStream& rTXTR);
     void DetermineBestOutputFormat();
     void ReadSubBlockCMPR(IInputStream& rSource, IOutputStream& rDest);
 
 public:
     static void EncodeTXTR(IOutputStream& rTXTR, CTexture *pTex);
-    static void EncodeTXTR(IOutputStream& rTXTR, CTexture *pTex, ETexelFormat OutputFormat);
+    static void EncodeTXTR(IOutputStream& rTXTR, CTexture *pTex, ETexelFormat OutputFormat, ETextureEncodeQuality Quality = ETextureEncodeQuality::Default);
+    static bool EncodeTXTR(IOutputStream& rTXTR, const uint8 *pkRGBA, uint32 Width, uint32 Height, ETexelFormat OutputFormat,
+                           uint32 NumMipMaps = 0, ETextureEncodeQuality Quality = ETextureEncodeQuality::Default);
+
+    static bool CanEncode(ETexelFormat OutputFormat);
+    static uint32 FullMipChainLength(uint32 Width, uint32 Height);
+    static void GenerateMipMap(const uint8 *pkSrc, uint32 SrcWidth, uint32 SrcHeight, std::vector<uint8>& rOutMip);
     static ETexelFormat GetGXFormat(ETexelFormat Format);
     static ETexelFormat GetFormat(ETexelFormat Format);
 };
@@ -164,37 +164,37 @@ void CAnimationLoader::ReadUncompressedANIM()
     if (mGame == EGame::Echoes)
     {
         mpInput->Seek(0x4, SEEK_CUR); // Skipping scale key count
-        mpAnim->mScaleChannels.resize(NumScaleChannels);
+        mScaleChannels.resize(NumScaleChannels);
 
         for (uint32 iScale = 0; iScale < NumScaleChannels; iScale++)
         {
-            mpAnim->mScaleChannels[iScale].resize(mpAnim->mNumKeys);
+            mScaleChannels[iScale].resize(mpAnim->mNumKeys);
 
             for (uint32 iKey = 0; iKey < mpAnim->mNumKeys; iKey++)
-                mpAnim->mScaleChannels[iScale][iKey] = CVector3f(*mpInput);
+                mScaleChannels[iScale][iKey] = CVector3f(*mpInput);
         }
     }
 
     mpInput->Seek(0x4, SEEK_CUR); // Skipping rotation key count
-    mpAnim->mRotationChannels.resize(NumRotationChannels);
+    mRotationChannels.resize(NumRotationChannels);
 
     for (uint32 iRot = 0; iRot < NumRotationChannels; iRot++)
     {
-        mpAnim->mRotationChannels[iRot].resize(mpAnim->mNumKeys);
+        mRotationChannels[iRot].resize(mpAnim->mNumKeys);
 
         for (uint32 iKey = 0; iKey < mpAnim->mNumKeys; iKey++)
-            mpAnim->mRotationChannels[iRot][iKey] = CQuaternion(*mpInput);
+            mRotationChannels[iRot][iKey] = CQuaternion(*mpInput);
     }
 
     mpInput->Seek(0x4, SEEK_CUR); // Skipping translation key count
-    mpAnim->mTranslationChannels.resize(NumTranslationChannels);
+    mTranslationChannels.resize(NumTranslationChannels);
 
     for (uint32 iTrans = 0; iTrans < NumTranslationChannels; iTrans++)
     {
-        mpAnim->mTranslationChannels[iTrans].resize(mpAnim->mNumKeys);
+        mTranslationChannels[iTrans].resize(mpAnim->mNumKeys);
 
         for (uint32 iKey = 0; iKey < mpAnim->mNumKeys; iKey++)
-            mpAnim->mTranslationChannels[iTrans][iKey] = CVector3f(*mpInput);
+            mTranslationChannels[iTrans][iKey] = CVector3f(*mpInput);
     }
 
     if (mGame == EGame::Prime)
@@ -242,9 +242,9 @@ void CAnimationLoader::ReadCompressedANIM()
 
     // Read bone channel descriptors
     mCompressedChannels.resize(NumBoneChannels);
-    mpAnim->mScaleChannels.resize(NumBoneChannels);
-    mpAnim->mRotationChannels.resize(NumBoneChannels);
-    mpAnim->mTranslationChannels.resize(NumBoneChannels);
+    mScaleChannels.resize(NumBoneChannels);
+    mRotationChannels.resize(NumBoneChannels);
+    mTranslationChannels.resize(NumBoneChannels);
 
     for (uint32 iChan = 0; iChan < NumBoneChannels; iChan++)
     {
@@ -318,23 +318,23 @@ void CAnimationLoader::ReadCompressedAnimationData()
         // Set initial rotation/translation/scale
         if (rChan.NumRotationKeys > 0)
         {
-            mpAnim->mRotationChannels[iChan].reserve(rChan.NumRotationKeys + 1);
+            mRotationChannels[iChan].reserve(rChan.NumRotationKeys + 1);
             CQuaternion Rotation = DequantizeRotation(false, rChan.Rotation[0], rChan.Rotation[1], rChan.Rotation[2]);
-            mpAnim->mRotationChannels[iChan].push_back(Rotation);
+            mRotationChannels[iChan].push_back(Rotation);
         }
 
         if (rChan.NumTranslationKeys > 0)
         {
-            mpAnim->mTranslationChannels[iChan].reserve(rChan.NumTranslationKeys + 1);
+            mTranslationChannels[iChan].reserve(rChan.NumTranslationKeys + 1);
             CVector3f Translate = CVector3f(rChan.Translation[0], rChan.Translation[1], rChan.Translation[2]) * mTranslationMultiplier;
-            mpAnim->mTranslationChannels[iChan].push_back(Translate);
+            mTranslationChannels[iChan].push_back(Translate);
         }
 
         if (rChan.NumScaleKeys > 0)
         {
-            mpAnim->mScaleChannels[iChan].reserve(rChan.NumScaleKeys + 1);
+            mScaleChannels[iChan].reserve(rChan.NumScaleKeys + 1);
             CVector3f Scale = CVector3f(rChan.Scale[0], rChan.Scale[1], rChan.Scale[2]) * mScaleMultiplier;
-            mpAnim->mScaleChannels[iChan].push_back(Scale);
+            mScaleChannels[iChan].push_back(Scale);
         }
     }
 
@@ -362,7 +362,7 @@ void CAnimationLoader::ReadCompressedAnimationData()
                 }
 
                 CQuaternion Rotation = DequantizeRotation(WSign, rChan.Rotation[0], rChan.Rotation[1], rChan.Rotation[2]);
-                mpAnim->mRotationChannels[iChan].push_back(Rotation);
+                mRotationChannels[iChan].push_back(Rotation);
             }
 
             // Read translation
@@ -376,7 +376,7 @@ void CAnimationLoader::ReadCompressedAnimationData()
                 }
 
                 CVector3f Translate = CVector3f(rChan.Translation[0], rChan.Translation[1], rChan.Translation[2]) * mTranslationMultiplier;
-                mpAnim->mTranslationChannels[iChan].push_back(Translate);
+                mTranslationChannels[iChan].push_back(Translate);
             }
 
             // Read scale
@@ -390,7 +390,7 @@ void CAnimationLoader::ReadCompressedAnimationData()
                 }
 
                 CVector3f Scale = CVector3f(rChan.Scale[0], rChan.Scale[1], rChan.Scale[2]) * mScaleMultiplier;
-                mpAnim->mScaleChannels[iChan].push_back(Scale);
+                mScaleChannels[iChan].push_back(Scale);
             }
         }
     }
@@ -423,23 +423,23 @@ void CAnimationLoader::ReadCompressedAnimationData()
 
                     if (HasRotationKeys)
                     {
-                        CQuaternion Left = mpAnim->mRotationChannels[iChan][FirstIndex];
-                        CQuaternion Right = mpAnim->mRotationChannels[iChan][LastIndex];
-                        mpAnim->mRotationChannels[iChan][KeyIndex] = Left.Slerp(Right, Interp);
+                        CQuaternion Left = mRotationChannels[iChan][FirstIndex];
+                        CQuaternion Right = mRotationChannels[iChan][LastIndex];
+                        mRotationChannels[iChan][KeyIndex] = Left.Slerp(Right, Interp);
                     }
 
                     if (HasTranslationKeys)
                     {
-                        CVector3f Left = mpAnim->mTranslationChannels[iChan][FirstIndex];
-                        CVector3f Right = mpAnim->mTranslationChannels[iChan][LastIndex];
-                        mpAnim->mTranslationChannels[iChan][KeyIndex] = Math::Lerp<CVector3f>(Left, Right, Interp);
+                        CVector3f Left = mTranslationChannels[iChan][FirstIndex];
+                        CVector3f Right = mTranslationChannels[iChan][LastIndex];
+                        mTranslationChannels[iChan][KeyIndex] = Math::Lerp<CVector3f>(Left, Right, Interp);
                     }
 
                     if (HasScaleKeys)
                     {
-                        CVector3f Left = mpAnim->mScaleChannels[iChan][FirstIndex];
-                        CVector3f Right = mpAnim->mScaleChannels[iChan][LastIndex];
-                        mpAnim->mScaleChannels[iChan][KeyIndex] = Math::Lerp<CVector3f>(Left, Right, Interp);
+                        CVector3f Left = mScaleChannels[iChan][FirstIndex];
+                        CVector3f Right = mScaleChannels[iChan][LastIndex];
+                        mScaleChannels[iChan][KeyIndex] = Math::Lerp<CVector3f>(Left, Right, Interp);
                     }
                 }
             }
@@ -486,5 +486,38 @@ CAnimation* CAnimationLoader::LoadANIM(IInputStream& rANIM, CResourceEntry *pEnt
     else
         Loader.ReadCompressedANIM();
 
+    // Keys are read into full precision channels, then quantized for storage
+    Loader.mpAnim->SetKeys(Loader.mScaleChannels, Loader.mRotationChannels, Loader.mTranslationChannels);
     return Loader.mpAnim;
 }
+
+bool CAnimationLoader::LoadUnquantizedKeys(IInputStream& rANIM, EGame Game,
+                                           std::vector<CAnimation::TScaleChannel>& rOutScales,
+                                           std::vector<CAnimation::TRotationChannel>& rOutRotations,
+                                           std::vector<CAnimation::TTranslationChannel>& rOutTranslations)
+{
+    if (Game > EGame::Echoes)
+        return false;
+
+    uint32 CompressionType = rANIM.ReadLong();
+
+    if (CompressionType != 0 && CompressionType != 2)
+        return false;
+
+    // The loader writes the header into an animation as it goes, so give it one to throw away afterwards
+    CAnimationLoader Loader;
+    Loader.mpAnim = new CAnimation();
+    Loader.mGame = Game;
+    Loader.mpInput = &rANIM;
+
+    if (CompressionType == 0)
+        Loader.ReadUncompressedANIM();
+    else
+        Loader.ReadCompressedANIM();
+
+    Loader.mpAnim.Delete();
+    rOutScales = std::move(Loader.mScaleChannels);
+    rOutRotations = std::move(Loader.mRotationChannels);
+    rOutTranslations = std::move(Loader.mTranslationChannels);
+    return true;
+}
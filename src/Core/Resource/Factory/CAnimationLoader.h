@@ -11,6 +11,11 @@ class CAnimationLoader
     IInputStream *mpInput;
     EGame mGame;
 
+    // Decompressed keys; these are quantized into the animation once loading is finished
+    std::vector<CAnimation::TScaleChannel> mScaleChannels;
+    std::vector<CAnimation::TRotationChannel> mRotationChannels;
+    std::vector<CAnimation::TTranslationChannel> mTranslationChannels;
+
     // Compression data
     std::vector<bool> mKeyFlags;
     float mTranslationMultiplier;
@@ -42,6 +47,12 @@ class CAnimationLoader
 
 public:
     static CAnimation* LoadANIM(IInputStream& rANIM, CResourceEntry *pEntry);
+
+    // Reads an ANIM's keys at full precision, without quantizing them; used to measure quantization error
+    static bool LoadUnquantizedKeys(IInputStream& rANIM, EGame Game,
+                                    std::vector<CAnimation::TScaleChannel>& rOutScales,
+                                    std::vector<CAnimation::TRotationChannel>& rOutRotations,
+                                    std::vector<CAnimation::TTranslationChannel>& rOutTranslations);
 };
 
 #endif // CANIMATIONLOADER_H
@@ -4,10 +4,12 @@
 #include "CMaterialLoader.h"
 #include "CScriptLoader.h"
 #include "Core/CompressionUtil.h"
+#include "Core/ParallelUtil.h"
 #include <Common/Log.h>
 
 #include <Common/CFourCC.h>
 
+#include <atomic>
 #include <iostream>
 
 CAreaLoader::CAreaLoader()
@@ -564,10 +566,18 @@ void CAreaLoader::Decompress()
     // It should be called at the beginning of the first compressed cluster.
     if (mVersion < EGame::Echoes) return;
 
-    // Decompress clusters
+    // Read clusters. Compressed clusters are collected so they can be decompressed together afterwards.
     mpDecmpBuffer = new uint8[mTotalDecmpSize];
     uint32 Offset = 0;
 
+    struct SPendingCluster
+    {
+        std::vector<uint8> CompressedBuf;
+        uint32 DstOffset;
+        uint32 DecompressedSize;
+    };
+    std::vector<SPendingCluster> PendingClusters;
+
     for (uint32 iClust = 0; iClust < mClusters.size(); iClust++)
     {
         SCompressedCluster *pClust = &mClusters[iClust];
@@ -585,17 +595,30 @@ void CAreaLoader::Decompress()
             if (StartOffset != 32)
                 mpMREA->Seek(StartOffset, SEEK_CUR);
 
-            std::vector<uint8> CompressedBuf(mClusters[iClust].CompressedSize);
-            mpMREA->ReadBytes(CompressedBuf.data(), CompressedBuf.size());
-
-            bool Success = CompressionUtil::DecompressSegmentedData(CompressedBuf.data(), CompressedBuf.size(), mpDecmpBuffer + Offset, pClust->DecompressedSize);
-            if (!Success)
-                throw "Failed to decompress MREA!";
+            SPendingCluster Cluster;
+            Cluster.CompressedBuf.resize(mClusters[iClust].CompressedSize);
+            Cluster.DstOffset = Offset;
+            Cluster.DecompressedSize = pClust->DecompressedSize;
+            mpMREA->ReadBytes(Cluster.CompressedBuf.data(), Cluster.CompressedBuf.size());
+            PendingClusters.push_back(std::move(Cluster));
 
             Offset += pClust->DecompressedSize;
         }
     }
 
+    // Clusters decompress into separate parts of the buffer, so they can be decompressed in parallel
+    std::atomic<bool> Failed(false);
+
+    ParallelUtil::ParallelFor(PendingClusters.size(), [&](uint32 ClusterIdx)
+    {
+        SPendingCluster& rCluster = PendingClusters[ClusterIdx];
+        bool Success = CompressionUtil::DecompressSegmentedData(rCluster.CompressedBuf.data(), rCluster.CompressedBuf.size(), mpDecmpBuffer + rCluster.DstOffset, rCluster.DecompressedSize);
+        if (!Success) Failed = true;
+    });
+
+    if (Failed)
+        throw "Failed to decompress MREA!";
+
     TString Source = mpMREA->GetSourceString();
     mpMREA = new CMemoryInStream(mpDecmpBuffer, mTotalDecmpSize, EEndian::BigEndian);
     mpMREA->SetSourceString(Source);
@@ -139,6 +139,8 @@ SSurface* CModelLoader::LoadSurface(IInputStream& rModel)
         SSurface::SPrimitive Prim;
         Prim.Type = EPrimitiveType(Flag & 0xF8);
         uint16 VertexCount = rModel.ReadShort();
+        Prim.Vertices.SetVertexDesc(pMat->VtxDesc());
+        Prim.Vertices.Reserve(VertexCount);
 
         for (uint16 iVtx = 0; iVtx < VertexCount; iVtx++)
         {
@@ -146,7 +148,7 @@ SSurface* CModelLoader::LoadSurface(IInputStream& rModel)
             FVertexDescription VtxDesc = pMat->VtxDesc();
 
             for (uint32 iMtxAttr = 0; iMtxAttr < 8; iMtxAttr++)
-                if (VtxDesc & ((uint) EVertexAttribute::PosMtx << iMtxAttr)) rModel.Seek(0x1, SEEK_CUR);
+                if (VtxDesc & ((uint) EVertexAttribute::PosMtx << iMtxAttr)) Vtx.MatrixIndices[iMtxAttr] = rModel.ReadByte();
 
             // Only thing to do here is check whether each attribute is present, and if so, read it.
             // A couple attributes have special considerations; normals can be floats or shorts, as can tex0, depending on vtxfmt.
@@ -204,7 +206,7 @@ SSurface* CModelLoader::LoadSurface(IInputStream& rModel)
                 }
             }
 
-            Prim.Vertices.push_back(Vtx);
+            Prim.Vertices.AddVertex(Vtx);
         } // Vertex array end
 
         // Update vertex/triangle count
@@ -311,6 +313,14 @@ SSurface* CModelLoader::LoadAssimpMesh(const aiMesh *pkMesh, CMaterialSet *pSet)
         pSurf->Primitives.resize(1);
         SSurface::SPrimitive& rPrim = pSurf->Primitives[0];
 
+        FVertexDescription VtxDesc = EVertexAttribute::Position;
+        if (pkMesh->HasNormals()) VtxDesc |= EVertexAttribute::Normal;
+
+        for (uint32 iTex = 0; iTex < pkMesh->GetNumUVChannels(); iTex++)
+            VtxDesc |= ((uint) EVertexAttribute::Tex0 << iTex);
+
+        rPrim.Vertices.SetVertexDesc(VtxDesc);
+
         // Check primitive type on first face
         uint32 NumIndices = pkMesh->mFaces[0].mNumIndices;
         if (NumIndices == 1) rPrim.Type = EPrimitiveType::Points;
@@ -371,7 +381,7 @@ SSurface* CModelLoader::LoadAssimpMesh(const aiMesh *pkMesh, CMaterialSet *pSet)
                     Vert.Tex[iTex] = CVector2f(AiTex.x, AiTex.y);
                 }
 
-                rPrim.Vertices.push_back(Vert);
+                rPrim.Vertices.AddVertex(Vert);
             }
         }
 
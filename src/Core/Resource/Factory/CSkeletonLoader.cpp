@@ -113,6 +113,7 @@ CSkeleton* CSkeletonLoader::LoadCINF(IInputStream& rCINF, CResourceEntry *pEntry
 
     Loader.SetLocalBoneCoords(pSkel->mpRootBone);
     Loader.CalculateBoneInverseBindMatrices();
+    pSkel->LinearizeBones();
 
     // Skip bone ID array
     uint32 NumBoneIDs = rCINF.ReadLong();
@@ -1,4 +1,5 @@
 #include "CTextureDecoder.h"
+#include "NTexelDecode.h"
 #include <Common/Log.h>
 #include <Common/CColor.h>
 
@@ -212,6 +213,7 @@ void CTextureDecoder::PartialDecodeGXTexture(IInputStream& TXTR)
     uint32 ImageStart = TXTR.Tell();
     TXTR.Seek(0x0, SEEK_END);
     uint32 ImageSize = TXTR.Tell() - ImageStart;
+    uint32 ImageEnd = TXTR.Tell();
     TXTR.Seek(ImageStart, SEEK_SET);
 
     mDataBufferSize = ImageSize * (gskOutputBpp[(int) mTexelFormat] / gskSourceBpp[(int) mTexelFormat]);
@@ -245,12 +247,36 @@ void CTextureDecoder::PartialDecodeGXTexture(IInputStream& TXTR)
     // This affects one texture that I know of - Echoes 3bb2c034.TXTR
     bool BreakEarly = false;
 
+    // Whole mipmaps are decoded straight from memory by the block decoders when possible.
+    // Anything they can't reproduce exactly (truncated or oddly sized mipmaps) goes through the per-texel path instead.
+    std::vector<uint8> PaletteLUT;
+    bool CanBlockDecode = NTexelDecode::SupportsPartialDecode(mTexelFormat, PixelStride) && BuildPartialDecodeLUT(PixelStride, PaletteLUT);
+    std::vector<uint8> MipData;
+
     for (uint32 iMip = 0; iMip < mNumMipMaps; iMip++)
     {
         if (MipW < BWidth) MipW = BWidth;
         if (MipH < BHeight) MipH = BHeight;
 
-        for (uint32 iBlockY = 0; iBlockY < MipH; iBlockY += BHeight)
+        uint32 MipSrcSize = NTexelDecode::SourceSize(mTexelFormat, MipW, MipH);
+        uint32 MipDstSize = MipW * MipH * PixelStride;
+        uint32 SrcPos = TXTR.Tell();
+
+        if (CanBlockDecode && (MipW % BWidth) == 0 && (MipH % BHeight) == 0 &&
+            SrcPos <= ImageEnd && MipSrcSize <= ImageEnd - SrcPos &&
+            MipOffset <= mDataBufferSize && MipDstSize <= mDataBufferSize - MipOffset)
+        {
+            MipData.resize(MipSrcSize);
+            TXTR.ReadBytes(MipData.data(), MipSrcSize);
+            NTexelDecode::PartialDecode(mTexelFormat, MipData.data(), mpDataBuffer + MipOffset, MipW, MipH, PixelStride, PaletteLUT.data());
+
+            // The per-texel path checks for the end of the file after every texel. RGBA8 is the exception, since
+            // it's always in the middle of a block when it checks, so it never stops there.
+            if (mTexelFormat != ETexelFormat::GX_RGBA8 && TXTR.EoF())
+                BreakEarly = true;
+        }
+
+        else for (uint32 iBlockY = 0; iBlockY < MipH; iBlockY += BHeight)
         {
             for (uint32 iBlockX = 0; iBlockX < MipW; iBlockX += BWidth)
             {
@@ -303,6 +329,7 @@ void CTextureDecoder::FullDecodeGXTexture(IInputStream& rTXTR)
     uint32 ImageStart = rTXTR.Tell();
     rTXTR.Seek(0x0, SEEK_END);
     uint32 ImageSize = rTXTR.Tell() - ImageStart;
+    uint32 ImageEnd = rTXTR.Tell();
     rTXTR.Seek(ImageStart, SEEK_SET);
 
     mDataBufferSize = ImageSize * (32 / gskSourceBpp[(int) mTexelFormat]);
@@ -327,9 +354,44 @@ void CTextureDecoder::FullDecodeGXTexture(IInputStream& rTXTR)
         MipH /= 4;
     }
 
+    // 8-bit formats and CMPR are decoded a whole mipmap at a time when possible; everything else is decoded per texel.
+    uint32 ColorLUT[256];
+    bool CanBlockDecode = true;
+
+    if (mTexelFormat == ETexelFormat::GX_I8)
+        for (uint32 iIdx = 0; iIdx < 256; iIdx++) ColorLUT[iIdx] = DecodePixelI8((uint8) iIdx).ToLongARGB();
+    else if (mTexelFormat == ETexelFormat::GX_IA4)
+        for (uint32 iIdx = 0; iIdx < 256; iIdx++) ColorLUT[iIdx] = DecodePixelIA4((uint8) iIdx).ToLongARGB();
+    else if (mTexelFormat == ETexelFormat::GX_C8)
+        for (uint32 iIdx = 0; iIdx < 256; iIdx++) ColorLUT[iIdx] = DecodePixelC8((uint8) iIdx, mPaletteInput).ToLongARGB();
+    else if (mTexelFormat != ETexelFormat::GX_CMPR)
+        CanBlockDecode = false;
+
+    auto CMPRPaletteFunc = [this](uint16 PaletteA, uint16 PaletteB, uint32 *pOutColors) {
+        DecodeCMPRPalette(PaletteA, PaletteB, pOutColors);
+    };
+    std::vector<uint8> MipData;
+
     for (uint32 iMip = 0; iMip < mNumMipMaps; iMip++)
     {
-        for (uint32 iBlockY = 0; iBlockY < MipH; iBlockY += BHeight)
+        uint32 MipSrcSize = NTexelDecode::SourceSize(mTexelFormat, MipW, MipH);
+        uint32 MipDstSize = MipW * MipH * (mTexelFormat == ETexelFormat::GX_CMPR ? 64 : 4);
+        uint32 SrcPos = rTXTR.Tell();
+
+        if (CanBlockDecode && (MipW % BWidth) == 0 && (MipH % BHeight) == 0 &&
+            SrcPos <= ImageEnd && MipSrcSize <= ImageEnd - SrcPos &&
+            MipOffset <= mDataBufferSize && MipDstSize <= mDataBufferSize - MipOffset)
+        {
+            MipData.resize(MipSrcSize);
+            rTXTR.ReadBytes(MipData.data(), MipSrcSize);
+
+            if (mTexelFormat == ETexelFormat::GX_CMPR)
+                NTexelDecode::FullDecodeCMPR(MipData.data(), mpDataBuffer + MipOffset, MipW, MipH, CMPRPaletteFunc);
+            else
+                NTexelDecode::FullDecode8(MipData.data(), mpDataBuffer + MipOffset, MipW, MipH, ColorLUT);
+        }
+
+        else for (uint32 iBlockY = 0; iBlockY < MipH; iBlockY += BHeight)
             for (uint32 iBlockX = 0; iBlockX < MipW; iBlockX += BWidth) {
                 for (uint32 iImgY = iBlockY; iImgY < iBlockY + BHeight; iImgY++) {
                     for (uint32 iImgX = iBlockX; iImgX < iBlockX + BWidth; iImgX++)
@@ -492,6 +554,49 @@ void CTextureDecoder::DecodeDDS(IInputStream& rDDS)
         mTexelFormat = ETexelFormat::GX_RGBA8;
 }
 
+bool CTextureDecoder::BuildPartialDecodeLUT(uint32 PixelStride, std::vector<uint8>& rOutLUT)
+{
+    // The lookup table is built by running every index through the per-texel decoder, so both paths always agree.
+    if (mTexelFormat == ETexelFormat::GX_C4)
+    {
+        rOutLUT.resize(16 * PixelStride);
+        CMemoryOutStream LUTOut(rOutLUT.data(), rOutLUT.size(), EEndian::SystemEndian);
+
+        for (uint32 iIdx = 0; iIdx < 16; iIdx++)
+        {
+            // ReadPixelsC4 outputs two texels; the high nibble is the first one
+            uint8 Pair[8];
+            uint8 Byte = (uint8) (iIdx << 4);
+            CMemoryInStream In(&Byte, 1, EEndian::BigEndian);
+            CMemoryOutStream PairOut(Pair, sizeof(Pair), EEndian::SystemEndian);
+            ReadPixelsC4(In, PairOut);
+            LUTOut.WriteBytes(Pair, PixelStride);
+        }
+    }
+
+    else if (mTexelFormat == ETexelFormat::GX_C8)
+    {
+        // An unknown palette format doesn't output anything, which only the per-texel path reproduces
+        if (mPaletteFormat != EGXPaletteFormat::IA8 && mPaletteFormat != EGXPaletteFormat::RGB565 && mPaletteFormat != EGXPaletteFormat::RGB5A3)
+            return false;
+
+        uint8 Indices[256];
+        for (uint32 iIdx = 0; iIdx < 256; iIdx++) Indices[iIdx] = (uint8) iIdx;
+
+        rOutLUT.resize(256 * PixelStride);
+        CMemoryInStream In(Indices, sizeof(Indices), EEndian::BigEndian);
+        CMemoryOutStream LUTOut(rOutLUT.data(), rOutLUT.size(), EEndian::SystemEndian);
+
+        for (uint32 iIdx = 0; iIdx < 256; iIdx++)
+            ReadPixelC8(In, LUTOut);
+
+        if (LUTOut.Tell() != rOutLUT.size())
+            return false;
+    }
+
+    return true;
+}
+
 // ************ READ PIXELS (PARTIAL DECODE) ************
 void CTextureDecoder::ReadPixelsI4(IInputStream& rSrc, IOutputStream& rDst)
 {
@@ -704,9 +809,29 @@ CColor CTextureDecoder::DecodePixelRGB5A3(uint16 Short)
 
 void CTextureDecoder::DecodeSubBlockCMPR(IInputStream& rSrc, IOutputStream& rDst, uint16 Width)
 {
-    CColor Palettes[4];
+    uint32 Palettes[4];
     uint16 PaletteA = rSrc.ReadShort();
     uint16 PaletteB = rSrc.ReadShort();
+    DecodeCMPRPalette(PaletteA, PaletteB, Palettes);
+
+    for (uint32 iBlockY = 0; iBlockY < 4; iBlockY++)
+    {
+        uint8 Byte = rSrc.ReadByte();
+
+        for (uint32 iBlockX = 0; iBlockX < 4; iBlockX++)
+        {
+            uint8 Shift = (uint8) (6 - (iBlockX * 2));
+            uint8 PaletteIndex = (Byte >> Shift) & 0x3;
+            rDst.WriteLong(Palettes[PaletteIndex]);
+        }
+
+        rDst.Seek((Width - 4) * 4, SEEK_CUR);
+    }
+}
+
+void CTextureDecoder::DecodeCMPRPalette(uint16 PaletteA, uint16 PaletteB, uint32 *pOutColors)
+{
+    CColor Palettes[4];
     Palettes[0] = DecodePixelRGB565(PaletteA);
     Palettes[1] = DecodePixelRGB565(PaletteB);
 
@@ -721,20 +846,8 @@ void CTextureDecoder::DecodeSubBlockCMPR(IInputStream& rSrc, IOutputStream& rDst
         Palettes[3] = CColor::skTransparentBlack;
     }
 
-    for (uint32 iBlockY = 0; iBlockY < 4; iBlockY++)
-    {
-        uint8 Byte = rSrc.ReadByte();
-
-        for (uint32 iBlockX = 0; iBlockX < 4; iBlockX++)
-        {
-            uint8 Shift = (uint8) (6 - (iBlockX * 2));
-            uint8 PaletteIndex = (Byte >> Shift) & 0x3;
-            CColor Pixel = Palettes[PaletteIndex];
-            rDst.WriteLong(Pixel.ToLongARGB());
-        }
-
-        rDst.Seek((Width - 4) * 4, SEEK_CUR);
-    }
+    for (uint32 iColor = 0; iColor < 4; iColor++)
+        pOutColors[iColor] = Palettes[iColor].ToLongARGB();
 }
 
 void CTextureDecoder::DecodeBlockBC1(IInputStream& rSrc, IOutputStream& rDst, uint32 Width)
@@ -46,6 +46,7 @@ class CTextureDecoder
     void PartialDecodeGXTexture(IInputStream& rTXTR);
     void FullDecodeGXTexture(IInputStream& rTXTR);
     void DecodeDDS(IInputStream& rDDS);
+    bool BuildPartialDecodeLUT(uint32 PixelStride, std::vector<uint8>& rOutLUT);
 
     // Decode Pixels (preserve compression)
     void ReadPixelsI4(IInputStream& rSrc, IOutputStream& rDst);
@@ -70,6 +71,7 @@ class CTextureDecoder
     CColor DecodePixelRGB5A3(uint16 Short);
     CColor DecodePixelRGBA8(IInputStream& rSrc, IOutputStream& rDst);
     void DecodeSubBlockCMPR(IInputStream& rSrc, IOutputStream& rDst, uint16 Width);
+    void DecodeCMPRPalette(uint16 PaletteA, uint16 PaletteB, uint32 *pOutColors);
 
     void DecodeBlockBC1(IInputStream& rSrc, IOutputStream& rDst, uint32 Width);
     void DecodeBlockBC2(IInputStream& rSrc, IOutputStream& rDst, uint32 Width);
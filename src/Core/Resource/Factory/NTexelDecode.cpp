@@ -0,0 +1,721 @@
+#include "NTexelDecode.h"
+#include <Common/Macros.h>
+#include <atomic>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define TEXEL_DECODE_X86 1
+    #include <emmintrin.h>
+    #include <immintrin.h>
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define TARGET_SSE2
+        #define TARGET_AVX2
+    #else
+        #define TARGET_SSE2 __attribute__((target("sse2")))
+        #define TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#else
+    #define TEXEL_DECODE_X86 0
+#endif
+
+/** NTexelDecode: Block decoders for GX texel formats */
+namespace NTexelDecode
+{
+
+/** Decodes one row of blocks. DstPitch is the size of one row of output texels in bytes. */
+typedef void (*FBlockRowFunc)(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8 *pkLUT, uint32 LUTStride);
+
+/** Upper limit on the instruction set, set by SetMaxInstructionSet */
+std::atomic<EInstructionSet> gMaxInstructionSet(EInstructionSet::AVX2);
+
+// ************ CPU DETECTION ************
+EInstructionSet DetectInstructionSet()
+{
+#if TEXEL_DECODE_X86
+#ifdef _MSC_VER
+    int Info[4];
+    __cpuid(Info, 0);
+    int MaxLeaf = Info[0];
+
+    __cpuid(Info, 1);
+    bool HasSSE2 = (Info[3] & (1 << 26)) != 0;
+    bool HasOSXSAVE = (Info[2] & (1 << 27)) != 0;
+    bool HasAVX = (Info[2] & (1 << 28)) != 0;
+
+    // AVX2 also needs the OS to save the upper halves of the YMM registers
+    if (MaxLeaf >= 7 && HasOSXSAVE && HasAVX && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(Info, 7, 0);
+        if (Info[1] & (1 << 5)) return EInstructionSet::AVX2;
+    }
+
+    return HasSSE2 ? EInstructionSet::SSE2 : EInstructionSet::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return EInstructionSet::AVX2;
+    if (__builtin_cpu_supports("sse2")) return EInstructionSet::SSE2;
+    return EInstructionSet::Scalar;
+#endif
+#else
+    return EInstructionSet::Scalar;
+#endif
+}
+
+EInstructionSet ActiveInstructionSet()
+{
+    static const EInstructionSet skSupported = DetectInstructionSet();
+    EInstructionSet Max = gMaxInstructionSet;
+    return (skSupported < Max ? skSupported : Max);
+}
+
+void SetMaxInstructionSet(EInstructionSet InstructionSet)
+{
+    gMaxInstructionSet = InstructionSet;
+}
+
+// ************ SCALAR ************
+inline uint16 ReadBE16(const uint8 *pkSrc)
+{
+    return (uint16) ((pkSrc[0] << 8) | pkSrc[1]);
+}
+
+/** Stores are done in native byte order, the same as the SystemEndian output stream the per-texel decoders write to */
+inline void Store16(uint8 *pDst, uint16 Value)
+{
+    memcpy(pDst, &Value, 2);
+}
+
+inline void Store32(uint8 *pDst, uint32 Value)
+{
+    memcpy(pDst, &Value, 4);
+}
+
+inline uint8 Extend3to8(uint32 In)  { In &= 0x7;  return (uint8) ((In << 5) | (In << 2) | (In >> 1)); }
+inline uint8 Extend4to8(uint32 In)  { In &= 0xF;  return (uint8) ((In << 4) | In); }
+inline uint8 Extend5to8(uint32 In)  { In &= 0x1F; return (uint8) ((In << 3) | (In >> 2)); }
+
+inline uint32 DecodeRGB5A3(uint16 Pixel)
+{
+    uint32 R, G, B, A;
+
+    if (Pixel & 0x8000)
+    {
+        B = Extend5to8(Pixel >> 10);
+        G = Extend5to8(Pixel >> 5);
+        R = Extend5to8(Pixel);
+        A = 255;
+    }
+    else
+    {
+        A = Extend3to8(Pixel >> 12);
+        B = Extend4to8(Pixel >> 8);
+        G = Extend4to8(Pixel >> 4);
+        R = Extend4to8(Pixel);
+    }
+
+    return (A << 24) | (R << 16) | (G << 8) | B;
+}
+
+/** Reverses the order of the four 2-bit indices in a CMPR index byte */
+inline uint8 ReverseCMPRIndices(uint8 Byte)
+{
+    return (uint8) (((Byte & 0x3) << 6) | ((Byte & 0xC) << 2) | ((Byte & 0x30) >> 2) | ((Byte & 0xC0) >> 6));
+}
+
+void ScalarI4(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Row = 0; Row < 8; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Byte = 0; Byte < 4; Byte++)
+            {
+                uint8 Pixels = pkSrc[Row * 4 + Byte];
+                pRow[Byte * 4 + 0] = pRow[Byte * 4 + 1] = Extend4to8(Pixels >> 4);
+                pRow[Byte * 4 + 2] = pRow[Byte * 4 + 3] = Extend4to8(Pixels);
+            }
+        }
+    }
+}
+
+void ScalarI8(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Row = 0; Row < 4; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Pixel = 0; Pixel < 8; Pixel++)
+                pRow[Pixel * 2] = pRow[Pixel * 2 + 1] = pkSrc[Row * 8 + Pixel];
+        }
+    }
+}
+
+void ScalarIA4(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Row = 0; Row < 4; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Pixel = 0; Pixel < 8; Pixel++)
+            {
+                uint8 Byte = pkSrc[Row * 8 + Pixel];
+                uint8 Alpha = Extend4to8(Byte >> 4);
+                uint8 Lum = Extend4to8(Byte);
+                Store16(pRow + Pixel * 2, (uint16) ((Lum << 8) | Alpha));
+            }
+        }
+    }
+}
+
+/** IA8 and RGB565 are both kept as-is, aside from the byte order */
+void ScalarSwap16(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 8)
+    {
+        for (uint32 Row = 0; Row < 4; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Pixel = 0; Pixel < 4; Pixel++)
+                Store16(pRow + Pixel * 2, ReadBE16(pkSrc + (Row * 4 + Pixel) * 2));
+        }
+    }
+}
+
+void ScalarC4(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8 *pkLUT, uint32 LUTStride)
+{
+    uint32 BlockDstSize = 8 * LUTStride;
+
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += BlockDstSize)
+    {
+        for (uint32 Row = 0; Row < 8; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Byte = 0; Byte < 4; Byte++)
+            {
+                uint8 Indices = pkSrc[Row * 4 + Byte];
+                memcpy(pRow + (Byte * 2 + 0) * LUTStride, pkLUT + (Indices >> 4) * LUTStride, LUTStride);
+                memcpy(pRow + (Byte * 2 + 1) * LUTStride, pkLUT + (Indices & 0xF) * LUTStride, LUTStride);
+            }
+        }
+    }
+}
+
+void ScalarC8(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8 *pkLUT, uint32 LUTStride)
+{
+    uint32 BlockDstSize = 8 * LUTStride;
+
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += BlockDstSize)
+    {
+        for (uint32 Row = 0; Row < 4; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Pixel = 0; Pixel < 8; Pixel++)
+                memcpy(pRow + Pixel * LUTStride, pkLUT + pkSrc[Row * 8 + Pixel] * LUTStride, LUTStride);
+        }
+    }
+}
+
+void ScalarRGB5A3(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Row = 0; Row < 4; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Pixel = 0; Pixel < 4; Pixel++)
+                Store32(pRow + Pixel * 4, DecodeRGB5A3( ReadBE16(pkSrc + (Row * 4 + Pixel) * 2) ));
+        }
+    }
+}
+
+void ScalarRGBA8(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    // Each block stores the AR pairs of all 16 texels, followed by the GB pairs
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 64, pDst += 16)
+    {
+        for (uint32 Row = 0; Row < 4; Row++)
+        {
+            uint8 *pRow = pDst + (Row * DstPitch);
+
+            for (uint32 Pixel = 0; Pixel < 4; Pixel++)
+            {
+                uint32 Offset = (Row * 4 + Pixel) * 2;
+                uint32 AR = ReadBE16(pkSrc + Offset);
+                uint32 GB = ReadBE16(pkSrc + 0x20 + Offset);
+                Store32(pRow + Pixel * 4, (AR << 16) | GB);
+            }
+        }
+    }
+}
+
+void ScalarCMPR(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    // Blocks are 2x2 sub-blocks, and each sub-block is treated as a single 8-byte texel
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pDst += 16)
+    {
+        for (uint32 SubBlock = 0; SubBlock < 4; SubBlock++, pkSrc += 8)
+        {
+            uint8 *pOut = pDst + ((SubBlock / 2) * DstPitch) + ((SubBlock % 2) * 8);
+            Store16(pOut + 0, ReadBE16(pkSrc + 0));
+            Store16(pOut + 2, ReadBE16(pkSrc + 2));
+
+            for (uint32 Byte = 4; Byte < 8; Byte++)
+                pOut[Byte] = ReverseCMPRIndices(pkSrc[Byte]);
+        }
+    }
+}
+
+// ************ SSE2 ************
+#if TEXEL_DECODE_X86
+TARGET_SSE2 inline __m128i ByteSwap16_SSE2(__m128i Value)
+{
+    return _mm_or_si128(_mm_slli_epi16(Value, 8), _mm_srli_epi16(Value, 8));
+}
+
+/** Expands 4-bit values (one per byte) to 8 bits */
+TARGET_SSE2 inline __m128i Extend4to8_SSE2(__m128i Value)
+{
+    return _mm_or_si128(Value, _mm_slli_epi16(Value, 4));
+}
+
+TARGET_SSE2 inline void StoreRow_SSE2(uint8 *pDst, __m128i Value)
+{
+    _mm_storeu_si128((__m128i*) pDst, Value);
+}
+
+TARGET_SSE2 void SSE2_I4(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    const __m128i kLowNibble = _mm_set1_epi8(0xF);
+
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        // Each 16-byte load holds four rows of eight texels
+        for (uint32 Half = 0; Half < 2; Half++)
+        {
+            __m128i Src = _mm_loadu_si128((const __m128i*) (pkSrc + Half * 16));
+            __m128i Hi = Extend4to8_SSE2( _mm_and_si128(_mm_srli_epi16(Src, 4), kLowNibble) );
+            __m128i Lo = Extend4to8_SSE2( _mm_and_si128(Src, kLowNibble) );
+
+            __m128i Rows01 = _mm_unpacklo_epi8(Hi, Lo);
+            __m128i Rows23 = _mm_unpackhi_epi8(Hi, Lo);
+            uint8 *pRow = pDst + (Half * 4 * DstPitch);
+
+            StoreRow_SSE2(pRow,                _mm_unpacklo_epi8(Rows01, Rows01));
+            StoreRow_SSE2(pRow + DstPitch,     _mm_unpackhi_epi8(Rows01, Rows01));
+            StoreRow_SSE2(pRow + DstPitch * 2, _mm_unpacklo_epi8(Rows23, Rows23));
+            StoreRow_SSE2(pRow + DstPitch * 3, _mm_unpackhi_epi8(Rows23, Rows23));
+        }
+    }
+}
+
+TARGET_SSE2 void SSE2_I8(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        __m128i Rows01 = _mm_loadu_si128((const __m128i*) pkSrc);
+        __m128i Rows23 = _mm_loadu_si128((const __m128i*) (pkSrc + 16));
+
+        StoreRow_SSE2(pDst,                _mm_unpacklo_epi8(Rows01, Rows01));
+        StoreRow_SSE2(pDst + DstPitch,     _mm_unpackhi_epi8(Rows01, Rows01));
+        StoreRow_SSE2(pDst + DstPitch * 2, _mm_unpacklo_epi8(Rows23, Rows23));
+        StoreRow_SSE2(pDst + DstPitch * 3, _mm_unpackhi_epi8(Rows23, Rows23));
+    }
+}
+
+TARGET_SSE2 void SSE2_IA4(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    const __m128i kLowNibble = _mm_set1_epi8(0xF);
+
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Half = 0; Half < 2; Half++)
+        {
+            __m128i Src = _mm_loadu_si128((const __m128i*) (pkSrc + Half * 16));
+            __m128i Alpha = Extend4to8_SSE2( _mm_and_si128(_mm_srli_epi16(Src, 4), kLowNibble) );
+            __m128i Lum = Extend4to8_SSE2( _mm_and_si128(Src, kLowNibble) );
+            uint8 *pRow = pDst + (Half * 2 * DstPitch);
+
+            StoreRow_SSE2(pRow,            _mm_unpacklo_epi8(Alpha, Lum));
+            StoreRow_SSE2(pRow + DstPitch, _mm_unpackhi_epi8(Alpha, Lum));
+        }
+    }
+}
+
+TARGET_SSE2 void SSE2_Swap16(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    // Rows of a 4x4 block are only 8 bytes, so two neighboring blocks are done together to get full 16-byte rows
+    uint32 Block = 0;
+
+    for (; Block + 1 < NumBlocks; Block += 2, pkSrc += 64, pDst += 16)
+    {
+        for (uint32 Half = 0; Half < 2; Half++)
+        {
+            __m128i Left = ByteSwap16_SSE2( _mm_loadu_si128((const __m128i*) (pkSrc + Half * 16)) );
+            __m128i Right = ByteSwap16_SSE2( _mm_loadu_si128((const __m128i*) (pkSrc + 32 + Half * 16)) );
+            uint8 *pRow = pDst + (Half * 2 * DstPitch);
+
+            StoreRow_SSE2(pRow,            _mm_unpacklo_epi64(Left, Right));
+            StoreRow_SSE2(pRow + DstPitch, _mm_unpackhi_epi64(Left, Right));
+        }
+    }
+
+    if (Block < NumBlocks)
+        ScalarSwap16(pkSrc, pDst, 1, DstPitch, nullptr, 0);
+}
+
+TARGET_SSE2 inline __m128i DecodeRGB5A3_SSE2(__m128i Pixels)
+{
+    // Pixels holds four 16-bit texels, zero-extended to 32 bits
+    const __m128i k5Bits = _mm_set1_epi32(0x1F);
+    const __m128i k4Bits = _mm_set1_epi32(0xF);
+    const __m128i k3Bits = _mm_set1_epi32(0x7);
+    const __m128i kOpaqueBit = _mm_set1_epi32(0x8000);
+    const __m128i kOpaqueAlpha = _mm_set1_epi32((int) 0xFF000000);
+
+    // RGB5
+    __m128i R5 = _mm_and_si128(Pixels, k5Bits);
+    __m128i G5 = _mm_and_si128(_mm_srli_epi32(Pixels, 5), k5Bits);
+    __m128i B5 = _mm_and_si128(_mm_srli_epi32(Pixels, 10), k5Bits);
+    R5 = _mm_or_si128(_mm_slli_epi32(R5, 3), _mm_srli_epi32(R5, 2));
+    G5 = _mm_or_si128(_mm_slli_epi32(G5, 3), _mm_srli_epi32(G5, 2));
+    B5 = _mm_or_si128(_mm_slli_epi32(B5, 3), _mm_srli_epi32(B5, 2));
+    __m128i Opaque = _mm_or_si128( _mm_or_si128(kOpaqueAlpha, _mm_slli_epi32(R5, 16)),
+                                   _mm_or_si128(_mm_slli_epi32(G5, 8), B5) );
+
+    // RGB4A3
+    __m128i R4 = _mm_and_si128(Pixels, k4Bits);
+    __m128i G4 = _mm_and_si128(_mm_srli_epi32(Pixels, 4), k4Bits);
+    __m128i B4 = _mm_and_si128(_mm_srli_epi32(Pixels, 8), k4Bits);
+    __m128i A3 = _mm_and_si128(_mm_srli_epi32(Pixels, 12), k3Bits);
+    R4 = _mm_or_si128(_mm_slli_epi32(R4, 4), R4);
+    G4 = _mm_or_si128(_mm_slli_epi32(G4, 4), G4);
+    B4 = _mm_or_si128(_mm_slli_epi32(B4, 4), B4);
+    A3 = _mm_or_si128( _mm_or_si128(_mm_slli_epi32(A3, 5), _mm_slli_epi32(A3, 2)), _mm_srli_epi32(A3, 1) );
+    __m128i Translucent = _mm_or_si128( _mm_or_si128(_mm_slli_epi32(A3, 24), _mm_slli_epi32(R4, 16)),
+                                        _mm_or_si128(_mm_slli_epi32(G4, 8), B4) );
+
+    __m128i IsOpaque = _mm_cmpeq_epi32(_mm_and_si128(Pixels, kOpaqueBit), kOpaqueBit);
+    return _mm_or_si128(_mm_and_si128(IsOpaque, Opaque), _mm_andnot_si128(IsOpaque, Translucent));
+}
+
+TARGET_SSE2 void SSE2_RGB5A3(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    const __m128i kZero = _mm_setzero_si128();
+
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Half = 0; Half < 2; Half++)
+        {
+            __m128i Src = ByteSwap16_SSE2( _mm_loadu_si128((const __m128i*) (pkSrc + Half * 16)) );
+            uint8 *pRow = pDst + (Half * 2 * DstPitch);
+
+            StoreRow_SSE2(pRow,            DecodeRGB5A3_SSE2( _mm_unpacklo_epi16(Src, kZero) ));
+            StoreRow_SSE2(pRow + DstPitch, DecodeRGB5A3_SSE2( _mm_unpackhi_epi16(Src, kZero) ));
+        }
+    }
+}
+
+TARGET_SSE2 void SSE2_RGBA8(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 64, pDst += 16)
+    {
+        for (uint32 Half = 0; Half < 2; Half++)
+        {
+            // Byte swapping gives RA and BG pairs; interleaving them gives BGRA, which is ARGB in native order
+            __m128i RA = ByteSwap16_SSE2( _mm_loadu_si128((const __m128i*) (pkSrc + Half * 16)) );
+            __m128i BG = ByteSwap16_SSE2( _mm_loadu_si128((const __m128i*) (pkSrc + 0x20 + Half * 16)) );
+            uint8 *pRow = pDst + (Half * 2 * DstPitch);
+
+            StoreRow_SSE2(pRow,            _mm_unpacklo_epi16(BG, RA));
+            StoreRow_SSE2(pRow + DstPitch, _mm_unpackhi_epi16(BG, RA));
+        }
+    }
+}
+
+TARGET_SSE2 void SSE2_CMPR(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    // Each half of a 16-byte load is one sub-block: two endpoint colors, then four index bytes
+    const __m128i kColorMask = _mm_set_epi32(0, -1, 0, -1);
+    const __m128i kBits01 = _mm_set1_epi8(0x03);
+    const __m128i kBits23 = _mm_set1_epi8(0x0C);
+    const __m128i kBits45 = _mm_set1_epi8(0x30);
+    const __m128i kBits67 = _mm_set1_epi8((char) 0xC0);
+
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        for (uint32 Half = 0; Half < 2; Half++)
+        {
+            __m128i Src = _mm_loadu_si128((const __m128i*) (pkSrc + Half * 16));
+            __m128i Colors = ByteSwap16_SSE2(Src);
+            __m128i Indices = _mm_or_si128(
+                        _mm_or_si128( _mm_slli_epi16(_mm_and_si128(Src, kBits01), 6), _mm_slli_epi16(_mm_and_si128(Src, kBits23), 2) ),
+                        _mm_or_si128( _mm_srli_epi16(_mm_and_si128(Src, kBits45), 2), _mm_srli_epi16(_mm_and_si128(Src, kBits67), 6) ) );
+
+            __m128i Out = _mm_or_si128(_mm_and_si128(kColorMask, Colors), _mm_andnot_si128(kColorMask, Indices));
+            StoreRow_SSE2(pDst + (Half * DstPitch), Out);
+        }
+    }
+}
+
+// ************ AVX2 ************
+TARGET_AVX2 inline __m256i ByteSwap16_AVX2(__m256i Value)
+{
+    return _mm256_or_si256(_mm256_slli_epi16(Value, 8), _mm256_srli_epi16(Value, 8));
+}
+
+TARGET_AVX2 inline __m256i DecodeRGB5A3_AVX2(__m256i Pixels)
+{
+    const __m256i k5Bits = _mm256_set1_epi32(0x1F);
+    const __m256i k4Bits = _mm256_set1_epi32(0xF);
+    const __m256i k3Bits = _mm256_set1_epi32(0x7);
+    const __m256i kOpaqueBit = _mm256_set1_epi32(0x8000);
+    const __m256i kOpaqueAlpha = _mm256_set1_epi32((int) 0xFF000000);
+
+    __m256i R5 = _mm256_and_si256(Pixels, k5Bits);
+    __m256i G5 = _mm256_and_si256(_mm256_srli_epi32(Pixels, 5), k5Bits);
+    __m256i B5 = _mm256_and_si256(_mm256_srli_epi32(Pixels, 10), k5Bits);
+    R5 = _mm256_or_si256(_mm256_slli_epi32(R5, 3), _mm256_srli_epi32(R5, 2));
+    G5 = _mm256_or_si256(_mm256_slli_epi32(G5, 3), _mm256_srli_epi32(G5, 2));
+    B5 = _mm256_or_si256(_mm256_slli_epi32(B5, 3), _mm256_srli_epi32(B5, 2));
+    __m256i Opaque = _mm256_or_si256( _mm256_or_si256(kOpaqueAlpha, _mm256_slli_epi32(R5, 16)),
+                                      _mm256_or_si256(_mm256_slli_epi32(G5, 8), B5) );
+
+    __m256i R4 = _mm256_and_si256(Pixels, k4Bits);
+    __m256i G4 = _mm256_and_si256(_mm256_srli_epi32(Pixels, 4), k4Bits);
+    __m256i B4 = _mm256_and_si256(_mm256_srli_epi32(Pixels, 8), k4Bits);
+    __m256i A3 = _mm256_and_si256(_mm256_srli_epi32(Pixels, 12), k3Bits);
+    R4 = _mm256_or_si256(_mm256_slli_epi32(R4, 4), R4);
+    G4 = _mm256_or_si256(_mm256_slli_epi32(G4, 4), G4);
+    B4 = _mm256_or_si256(_mm256_slli_epi32(B4, 4), B4);
+    A3 = _mm256_or_si256( _mm256_or_si256(_mm256_slli_epi32(A3, 5), _mm256_slli_epi32(A3, 2)), _mm256_srli_epi32(A3, 1) );
+    __m256i Translucent = _mm256_or_si256( _mm256_or_si256(_mm256_slli_epi32(A3, 24), _mm256_slli_epi32(R4, 16)),
+                                           _mm256_or_si256(_mm256_slli_epi32(G4, 8), B4) );
+
+    __m256i IsOpaque = _mm256_cmpeq_epi32(_mm256_and_si256(Pixels, kOpaqueBit), kOpaqueBit);
+    return _mm256_blendv_epi8(Translucent, Opaque, IsOpaque);
+}
+
+TARGET_AVX2 void AVX2_RGB5A3(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 32, pDst += 16)
+    {
+        // One load covers the whole block; each 256-bit result is two rows, one per 128-bit lane
+        __m256i Src = ByteSwap16_AVX2( _mm256_loadu_si256((const __m256i*) pkSrc) );
+        __m256i Rows01 = DecodeRGB5A3_AVX2( _mm256_cvtepu16_epi32(_mm256_castsi256_si128(Src)) );
+        __m256i Rows23 = DecodeRGB5A3_AVX2( _mm256_cvtepu16_epi32(_mm256_extracti128_si256(Src, 1)) );
+
+        _mm_storeu_si128((__m128i*) (pDst),                _mm256_castsi256_si128(Rows01));
+        _mm_storeu_si128((__m128i*) (pDst + DstPitch),     _mm256_extracti128_si256(Rows01, 1));
+        _mm_storeu_si128((__m128i*) (pDst + DstPitch * 2), _mm256_castsi256_si128(Rows23));
+        _mm_storeu_si128((__m128i*) (pDst + DstPitch * 3), _mm256_extracti128_si256(Rows23, 1));
+    }
+}
+
+TARGET_AVX2 void AVX2_RGBA8(const uint8 *pkSrc, uint8 *pDst, uint32 NumBlocks, uint32 DstPitch, const uint8*, uint32)
+{
+    for (uint32 Block = 0; Block < NumBlocks; Block++, pkSrc += 64, pDst += 16)
+    {
+        __m256i RA = ByteSwap16_AVX2( _mm256_loadu_si256((const __m256i*) pkSrc) );
+        __m256i BG = ByteSwap16_AVX2( _mm256_loadu_si256((const __m256i*) (pkSrc + 0x20)) );
+
+        // Unpacking works within 128-bit lanes, so the low halves hold rows 0 and 2 and the high halves hold rows 1 and 3
+        __m256i Rows02 = _mm256_unpacklo_epi16(BG, RA);
+        __m256i Rows13 = _mm256_unpackhi_epi16(BG, RA);
+
+        _mm_storeu_si128((__m128i*) (pDst),                _mm256_castsi256_si128(Rows02));
+        _mm_storeu_si128((__m128i*) (pDst + DstPitch),     _mm256_castsi256_si128(Rows13));
+        _mm_storeu_si128((__m128i*) (pDst + DstPitch * 2), _mm256_extracti128_si256(Rows02, 1));
+        _mm_storeu_si128((__m128i*) (pDst + DstPitch * 3), _mm256_extracti128_si256(Rows13, 1));
+    }
+}
+#endif
+
+// ************ DISPATCH ************
+void GetBlockLayout(ETexelFormat Format, uint32& rOutBlockWidth, uint32& rOutBlockHeight, uint32& rOutBlockSize)
+{
+    switch (Format)
+    {
+    case ETexelFormat::GX_I4:
+    case ETexelFormat::GX_C4:
+        rOutBlockWidth = 8; rOutBlockHeight = 8; rOutBlockSize = 32;
+        break;
+    case ETexelFormat::GX_I8:
+    case ETexelFormat::GX_IA4:
+    case ETexelFormat::GX_C8:
+        rOutBlockWidth = 8; rOutBlockHeight = 4; rOutBlockSize = 32;
+        break;
+    case ETexelFormat::GX_RGBA8:
+        rOutBlockWidth = 4; rOutBlockHeight = 4; rOutBlockSize = 64;
+        break;
+    case ETexelFormat::GX_CMPR:
+        rOutBlockWidth = 2; rOutBlockHeight = 2; rOutBlockSize = 32;
+        break;
+    default:
+        rOutBlockWidth = 4; rOutBlockHeight = 4; rOutBlockSize = 32;
+        break;
+    }
+}
+
+uint32 SourceSize(ETexelFormat Format, uint32 Width, uint32 Height)
+{
+    uint32 BlockWidth, BlockHeight, BlockSize;
+    GetBlockLayout(Format, BlockWidth, BlockHeight, BlockSize);
+    return (Width / BlockWidth) * (Height / BlockHeight) * BlockSize;
+}
+
+bool SupportsPartialDecode(ETexelFormat Format, uint32 PixelStride)
+{
+    switch (Format)
+    {
+    case ETexelFormat::GX_I4:
+    case ETexelFormat::GX_I8:
+    case ETexelFormat::GX_IA4:
+    case ETexelFormat::GX_IA8:
+    case ETexelFormat::GX_RGB565:
+    case ETexelFormat::GX_RGB5A3:
+    case ETexelFormat::GX_RGBA8:
+    case ETexelFormat::GX_CMPR:
+        return true;
+
+    // With 2-byte output texels, the per-texel C4 decoder writes each pair of texels over the previous pair.
+    // That can't be reproduced one block at a time, so only 4-byte C4 output is handled here.
+    case ETexelFormat::GX_C4:
+        return PixelStride == 4;
+
+    case ETexelFormat::GX_C8:
+        return PixelStride == 2 || PixelStride == 4;
+
+    default:
+        return false;
+    }
+}
+
+FBlockRowFunc PartialDecodeFunc(ETexelFormat Format)
+{
+    EInstructionSet InstructionSet = ActiveInstructionSet();
+    (void) InstructionSet;
+
+#if TEXEL_DECODE_X86
+    if (InstructionSet >= EInstructionSet::AVX2)
+    {
+        if (Format == ETexelFormat::GX_RGB5A3)  return &AVX2_RGB5A3;
+        if (Format == ETexelFormat::GX_RGBA8)   return &AVX2_RGBA8;
+    }
+
+    if (InstructionSet >= EInstructionSet::SSE2)
+    {
+        switch (Format)
+        {
+        case ETexelFormat::GX_I4:       return &SSE2_I4;
+        case ETexelFormat::GX_I8:       return &SSE2_I8;
+        case ETexelFormat::GX_IA4:      return &SSE2_IA4;
+        case ETexelFormat::GX_IA8:      return &SSE2_Swap16;
+        case ETexelFormat::GX_RGB565:   return &SSE2_Swap16;
+        case ETexelFormat::GX_RGB5A3:   return &SSE2_RGB5A3;
+        case ETexelFormat::GX_RGBA8:    return &SSE2_RGBA8;
+        case ETexelFormat::GX_CMPR:     return &SSE2_CMPR;
+        default: break;
+        }
+    }
+#endif
+
+    // C4/C8 are table lookups, so they always use the scalar path
+    switch (Format)
+    {
+    case ETexelFormat::GX_I4:       return &ScalarI4;
+    case ETexelFormat::GX_I8:       return &ScalarI8;
+    case ETexelFormat::GX_IA4:      return &ScalarIA4;
+    case ETexelFormat::GX_IA8:      return &ScalarSwap16;
+    case ETexelFormat::GX_C4:       return &ScalarC4;
+    case ETexelFormat::GX_C8:       return &ScalarC8;
+    case ETexelFormat::GX_RGB565:   return &ScalarSwap16;
+    case ETexelFormat::GX_RGB5A3:   return &ScalarRGB5A3;
+    case ETexelFormat::GX_RGBA8:    return &ScalarRGBA8;
+    case ETexelFormat::GX_CMPR:     return &ScalarCMPR;
+    default:                        return nullptr;
+    }
+}
+
+void PartialDecode(ETexelFormat Format, const uint8 *pkSrc, uint8 *pDst, uint32 Width, uint32 Height, uint32 PixelStride, const uint8 *pkLUT)
+{
+    ASSERT( SupportsPartialDecode(Format, PixelStride) );
+    FBlockRowFunc DecodeFunc = PartialDecodeFunc(Format);
+
+    uint32 BlockWidth, BlockHeight, BlockSize;
+    GetBlockLayout(Format, BlockWidth, BlockHeight, BlockSize);
+    ASSERT( (Width % BlockWidth) == 0 && (Height % BlockHeight) == 0 );
+
+    uint32 NumBlocksX = Width / BlockWidth;
+    uint32 DstPitch = Width * PixelStride;
+
+    for (uint32 BlockY = 0; BlockY < Height; BlockY += BlockHeight)
+    {
+        DecodeFunc(pkSrc, pDst + (BlockY * DstPitch), NumBlocksX, DstPitch, pkLUT, PixelStride);
+        pkSrc += NumBlocksX * BlockSize;
+    }
+}
+
+void FullDecode8(const uint8 *pkSrc, uint8 *pDst, uint32 Width, uint32 Height, const uint32 *pkLUT)
+{
+    ASSERT( (Width % 8) == 0 && (Height % 4) == 0 );
+    uint32 DstPitch = Width * 4;
+
+    for (uint32 BlockY = 0; BlockY < Height; BlockY += 4)
+    {
+        for (uint32 BlockX = 0; BlockX < Width; BlockX += 8)
+        {
+            for (uint32 Row = 0; Row < 4; Row++)
+            {
+                uint8 *pRow = pDst + ((BlockY + Row) * DstPitch) + (BlockX * 4);
+
+                for (uint32 Pixel = 0; Pixel < 8; Pixel++)
+                    Store32(pRow + Pixel * 4, pkLUT[*pkSrc++]);
+            }
+        }
+    }
+}
+
+void FullDecodeCMPR(const uint8 *pkSrc, uint8 *pDst, uint32 Width, uint32 Height, const FCMPRPaletteFunc& PaletteFunc)
+{
+    ASSERT( (Width % 2) == 0 && (Height % 2) == 0 );
+    uint32 DstPitch = Width * 4 * 4;
+
+    for (uint32 BlockY = 0; BlockY < Height; BlockY += 2)
+    {
+        for (uint32 BlockX = 0; BlockX < Width; BlockX += 2)
+        {
+            for (uint32 SubBlock = 0; SubBlock < 4; SubBlock++, pkSrc += 8)
+            {
+                uint32 SubX = BlockX + (SubBlock % 2);
+                uint32 SubY = BlockY + (SubBlock / 2);
+                uint8 *pOut = pDst + (SubY * 4 * DstPitch) + (SubX * 16);
+
+                uint32 Palette[4];
+                PaletteFunc(ReadBE16(pkSrc), ReadBE16(pkSrc + 2), Palette);
+
+                for (uint32 Row = 0; Row < 4; Row++)
+                {
+                    uint8 Indices = pkSrc[4 + Row];
+                    uint8 *pRow = pOut + (Row * DstPitch);
+
+                    for (uint32 Pixel = 0; Pixel < 4; Pixel++)
+                        Store32(pRow + Pixel * 4, Palette[(Indices >> (6 - Pixel * 2)) & 0x3]);
+                }
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef NTEXELDECODE_H
+#define NTEXELDECODE_H
+
+#include "Core/Resource/ETexelFormat.h"
+#include <Common/BasicTypes.h>
+#include <functional>
+
+/**
+ * Block decoders for GX texel formats that work on raw memory instead of going through
+ * IInputStream/IOutputStream one texel at a time. Each function decodes one whole mipmap.
+ * Source data is big endian and tiled the same way it is in a TXTR; output is written in
+ * the same layout and byte order as the per-texel decoders in CTextureDecoder produce.
+ *
+ * Width and height must be multiples of the format's block size. CMPR dimensions are in
+ * 4x4 sub-blocks rather than texels, the same as in CTextureDecoder.
+ */
+namespace NTexelDecode
+{
+
+enum class EInstructionSet
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/** Returns the best instruction set supported by this CPU, limited by SetMaxInstructionSet */
+EInstructionSet ActiveInstructionSet();
+
+/** Limits which instruction set the decoders may use; mainly useful for comparing the different code paths */
+void SetMaxInstructionSet(EInstructionSet InstructionSet);
+
+/** Returns the block size and number of source bytes per block for a GX format */
+void GetBlockLayout(ETexelFormat Format, uint32& rOutBlockWidth, uint32& rOutBlockHeight, uint32& rOutBlockSize);
+
+/** Number of bytes of tiled source data in a mipmap of the given size */
+uint32 SourceSize(ETexelFormat Format, uint32 Width, uint32 Height);
+
+/**
+ * Partial decode (preserves compression). PixelStride is the size of one output texel.
+ * C4 and C8 are decoded through pkLUT, which holds the output texel for each index
+ * (16 or 256 entries, PixelStride bytes each).
+ */
+bool SupportsPartialDecode(ETexelFormat Format, uint32 PixelStride);
+void PartialDecode(ETexelFormat Format, const uint8 *pkSrc, uint8 *pDst, uint32 Width, uint32 Height, uint32 PixelStride, const uint8 *pkLUT);
+
+/** Full decode to 32-bit ARGB of 8-bit formats (I8, IA4, C8); pkLUT holds the output color for each byte value */
+void FullDecode8(const uint8 *pkSrc, uint8 *pDst, uint32 Width, uint32 Height, const uint32 *pkLUT);
+
+/** Full decode of CMPR to 32-bit ARGB; PaletteFunc computes the four colors of a sub-block from its two RGB565 endpoints */
+typedef std::function<void(uint16 PaletteA, uint16 PaletteB, uint32 *pOutColors)> FCMPRPaletteFunc;
+void FullDecodeCMPR(const uint8 *pkSrc, uint8 *pDst, uint32 Width, uint32 Height, const FCMPRPaletteFunc& PaletteFunc);
+
+}
+
+#endif // NTEXELDECODE_H
@@ -4,6 +4,7 @@
 #include "Core/Resource/Area/CGameArea.h"
 #include "Core/OpenGL/GLCommon.h"
 #include <Common/Macros.h>
+#include <Common/Hash/CFNV1A.h>
 
 CModel::CModel(CResourceEntry *pEntry /*= 0*/)
     : CBasicModel(pEntry)
@@ -67,11 +68,11 @@ void CModel::BufferGL()
             {
                 SSurface::SPrimitive *pPrim = &pSurf->Primitives[iPrim];
                 CIndexBuffer *pIBO = InternalGetIBO(iSurf, pPrim->Type);
-                pIBO->Reserve(pPrim->Vertices.size() + 1); // Allocate enough space for this primitive, plus the restart index
+                pIBO->Reserve(pPrim->Vertices.Size() + 1); // Allocate enough space for this primitive, plus the restart index
 
-                std::vector<uint16> Indices(pPrim->Vertices.size());
-                for (uint32 iVert = 0; iVert < pPrim->Vertices.size(); iVert++)
-                    Indices[iVert] = mVBO.AddIfUnique(pPrim->Vertices[iVert], VBOStartOffset);
+                std::vector<uint16> Indices(pPrim->Vertices.Size());
+                for (uint32 iVert = 0; iVert < pPrim->Vertices.Size(); iVert++)
+                    Indices[iVert] = mVBO.AddIfUnique(pPrim->Vertices, iVert, VBOStartOffset);
 
                 // then add the indices to the IBO. We convert some primitives to strips to minimize draw calls.
                 switch (pPrim->Type)
@@ -257,6 +258,23 @@ CMaterial* CModel::GetMaterialBySurface(uint32 MatSet, uint32 Surface)
     return GetMaterialByIndex(MatSet, mSurfaces[Surface]->MaterialID);
 }
 
+uint64 CModel::StateSortKey(uint32 MatSet)
+{
+    // Instances of a model draw the same sequence of materials, so group whole-model draws by the shader
+    // of the first material, then by model
+    if (mSurfaces.empty()) return 0;
+
+    CMaterial *pMat = GetMaterialBySurface(MatSet, 0);
+    uint64 ShaderBits = (pMat ? pMat->StateSortKey() & 0xFFFFFFFF00000000ULL : 0);
+
+    CModel *pThis = this;
+    CFNV1A ModelHash(CFNV1A::k64Bit);
+    ModelHash.HashData(&pThis, sizeof(CModel*));
+    ModelHash.HashLong(MatSet);
+
+    return ShaderBits | (ModelHash.GetHash64() & 0xFFFFFFFFULL);
+}
+
 bool CModel::HasTransparency(uint32 MatSet)
 {
     if (MatSet >= mMaterialSets.size())
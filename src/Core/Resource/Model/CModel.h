@@ -42,6 +42,7 @@ public:
     bool HasTransparency(uint32 MatSet);
     bool IsSurfaceTransparent(uint32 Surface, uint32 MatSet);
     bool IsLightmapped() const;
+    uint64 StateSortKey(uint32 MatSet);
 
     inline bool IsSkinned() const       { return (mpSkin != nullptr); }
 
@@ -48,12 +48,12 @@ void CStaticModel::BufferGL()
             {
                 SSurface::SPrimitive *pPrim = &pSurf->Primitives[iPrim];
                 CIndexBuffer *pIBO = InternalGetIBO(pPrim->Type);
-                pIBO->Reserve(pPrim->Vertices.size() + 1); // Allocate enough space for this primitive, plus the restart index
+                pIBO->Reserve(pPrim->Vertices.Size() + 1); // Allocate enough space for this primitive, plus the restart index
 
                 // Next step: add new vertices to the VBO and create a small index buffer for the current primitive
-                std::vector<uint16> Indices(pPrim->Vertices.size());
-                for (uint32 iVert = 0; iVert < pPrim->Vertices.size(); iVert++)
-                    Indices[iVert] = mVBO.AddIfUnique(pPrim->Vertices[iVert], VBOStartOffset);
+                std::vector<uint16> Indices(pPrim->Vertices.Size());
+                for (uint32 iVert = 0; iVert < pPrim->Vertices.Size(); iVert++)
+                    Indices[iVert] = mVBO.AddIfUnique(pPrim->Vertices, iVert, VBOStartOffset);
 
                 // then add the indices to the IBO. We convert some primitives to strips to minimize draw calls.
                 switch (pPrim->Type)
@@ -116,13 +116,7 @@ void CStaticModel::Draw(FRenderOptions Options)
     glLineWidth(1.f);
 
     for (uint32 iIBO = 0; iIBO < mIBOs.size(); iIBO++)
-    {
-        CIndexBuffer *pIBO = &mIBOs[iIBO];
-        pIBO->Bind();
-        glDrawElements(pIBO->GetPrimitiveType(), pIBO->GetSize(), GL_UNSIGNED_SHORT, (void*) 0);
-        pIBO->Unbind();
-        gDrawCount++;
-    }
+        mIBOs[iIBO].DrawElements();
 
     mVBO.Unbind();
 }
@@ -146,7 +140,6 @@ void CStaticModel::DrawSurface(FRenderOptions Options, uint32 Surface)
 
         // Now we have both, so we can draw
         mIBOs[iIBO].DrawElements(Offset, Size);
-        gDrawCount++;
     }
 
     mVBO.Unbind();
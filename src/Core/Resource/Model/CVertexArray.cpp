@@ -0,0 +1,160 @@
+#include "CVertexArray.h"
+
+CVertexArray::CVertexArray()
+    : mVtxDesc(EVertexAttribute::Position)
+    , mNumVertices(0)
+{
+}
+
+CVertexArray::CVertexArray(FVertexDescription Desc)
+    : mVtxDesc(Desc)
+    , mNumVertices(0)
+{
+}
+
+void CVertexArray::SetVertexDesc(FVertexDescription Desc)
+{
+    Clear();
+    mVtxDesc = Desc;
+}
+
+void CVertexArray::Reserve(uint32 NumVertices)
+{
+    mArrayPositions.reserve(NumVertices);
+
+    if (mVtxDesc & EVertexAttribute::Position) mPositions.reserve(NumVertices);
+    if (mVtxDesc & EVertexAttribute::Normal)   mNormals.reserve(NumVertices);
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        if (mVtxDesc & (EVertexAttribute::Color0 << iClr)) mColors[iClr].reserve(NumVertices);
+
+    for (uint32 iTex = 0; iTex < 8; iTex++)
+        if (mVtxDesc & (EVertexAttribute::Tex0 << iTex)) mTexCoords[iTex].reserve(NumVertices);
+
+    for (uint32 iMtx = 0; iMtx < 8; iMtx++)
+        if (mVtxDesc & (EVertexAttribute::PosMtx << iMtx)) mMatrixIndices[iMtx].reserve(NumVertices);
+}
+
+void CVertexArray::Resize(uint32 NumVertices)
+{
+    mArrayPositions.resize(NumVertices, 0);
+
+    if (mVtxDesc & EVertexAttribute::Position) mPositions.resize(NumVertices, CVector3f::skZero);
+    if (mVtxDesc & EVertexAttribute::Normal)   mNormals.resize(NumVertices, CVector3f::skZero);
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        if (mVtxDesc & (EVertexAttribute::Color0 << iClr)) mColors[iClr].resize(NumVertices, CColor::skTransparentBlack);
+
+    for (uint32 iTex = 0; iTex < 8; iTex++)
+        if (mVtxDesc & (EVertexAttribute::Tex0 << iTex)) mTexCoords[iTex].resize(NumVertices, CVector2f(0.f, 0.f));
+
+    for (uint32 iMtx = 0; iMtx < 8; iMtx++)
+        if (mVtxDesc & (EVertexAttribute::PosMtx << iMtx)) mMatrixIndices[iMtx].resize(NumVertices, 0);
+
+    mNumVertices = NumVertices;
+}
+
+void CVertexArray::Clear()
+{
+    mNumVertices = 0;
+    mArrayPositions.clear();
+    mPositions.clear();
+    mNormals.clear();
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        mColors[iClr].clear();
+
+    for (uint32 iSlot = 0; iSlot < 8; iSlot++)
+    {
+        mTexCoords[iSlot].clear();
+        mMatrixIndices[iSlot].clear();
+    }
+}
+
+uint32 CVertexArray::AddVertex(const CVertex& rkVtx)
+{
+    Resize(mNumVertices + 1);
+    SetVertex(mNumVertices - 1, rkVtx);
+    return mNumVertices - 1;
+}
+
+void CVertexArray::SetVertex(uint32 Index, const CVertex& rkVtx)
+{
+    mArrayPositions[Index] = rkVtx.ArrayPosition;
+
+    if (mVtxDesc & EVertexAttribute::Position) mPositions[Index] = rkVtx.Position;
+    if (mVtxDesc & EVertexAttribute::Normal)   mNormals[Index] = rkVtx.Normal;
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        if (mVtxDesc & (EVertexAttribute::Color0 << iClr)) mColors[iClr][Index] = rkVtx.Color[iClr];
+
+    for (uint32 iTex = 0; iTex < 8; iTex++)
+        if (mVtxDesc & (EVertexAttribute::Tex0 << iTex)) mTexCoords[iTex][Index] = rkVtx.Tex[iTex];
+
+    for (uint32 iMtx = 0; iMtx < 8; iMtx++)
+        if (mVtxDesc & (EVertexAttribute::PosMtx << iMtx)) mMatrixIndices[iMtx][Index] = rkVtx.MatrixIndices[iMtx];
+}
+
+void CVertexArray::CopyVertex(uint32 DstIndex, const CVertexArray& rkSrc, uint32 SrcIndex)
+{
+    // Attributes that the source array doesn't have are reset to their defaults
+    FVertexDescription SrcDesc = rkSrc.mVtxDesc;
+    mArrayPositions[DstIndex] = rkSrc.mArrayPositions[SrcIndex];
+
+    if (mVtxDesc & EVertexAttribute::Position)
+        mPositions[DstIndex] = (SrcDesc & EVertexAttribute::Position) ? rkSrc.mPositions[SrcIndex] : CVector3f::skZero;
+
+    if (mVtxDesc & EVertexAttribute::Normal)
+        mNormals[DstIndex] = (SrcDesc & EVertexAttribute::Normal) ? rkSrc.mNormals[SrcIndex] : CVector3f::skZero;
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        if (mVtxDesc & (EVertexAttribute::Color0 << iClr))
+            mColors[iClr][DstIndex] = (SrcDesc & (EVertexAttribute::Color0 << iClr)) ? rkSrc.mColors[iClr][SrcIndex] : CColor::skTransparentBlack;
+
+    for (uint32 iTex = 0; iTex < 8; iTex++)
+        if (mVtxDesc & (EVertexAttribute::Tex0 << iTex))
+            mTexCoords[iTex][DstIndex] = (SrcDesc & (EVertexAttribute::Tex0 << iTex)) ? rkSrc.mTexCoords[iTex][SrcIndex] : CVector2f(0.f, 0.f);
+
+    for (uint32 iMtx = 0; iMtx < 8; iMtx++)
+        if (mVtxDesc & (EVertexAttribute::PosMtx << iMtx))
+            mMatrixIndices[iMtx][DstIndex] = (SrcDesc & (EVertexAttribute::PosMtx << iMtx)) ? rkSrc.mMatrixIndices[iMtx][SrcIndex] : 0;
+}
+
+CVertex CVertexArray::Vertex(uint32 Index) const
+{
+    CVertex Vtx;
+    Vtx.ArrayPosition = mArrayPositions[Index];
+    Vtx.Position = (mVtxDesc & EVertexAttribute::Position) ? mPositions[Index] : CVector3f::skZero;
+    Vtx.Normal = (mVtxDesc & EVertexAttribute::Normal) ? mNormals[Index] : CVector3f::skZero;
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        Vtx.Color[iClr] = (mVtxDesc & (EVertexAttribute::Color0 << iClr)) ? mColors[iClr][Index] : CColor::skTransparentBlack;
+
+    for (uint32 iTex = 0; iTex < 8; iTex++)
+        Vtx.Tex[iTex] = (mVtxDesc & (EVertexAttribute::Tex0 << iTex)) ? mTexCoords[iTex][Index] : CVector2f(0.f, 0.f);
+
+    for (uint32 iMtx = 0; iMtx < 8; iMtx++)
+        Vtx.MatrixIndices[iMtx] = (mVtxDesc & (EVertexAttribute::PosMtx << iMtx)) ? mMatrixIndices[iMtx][Index] : 0;
+
+    Vtx.BoneIndices.fill(0);
+    Vtx.BoneWeights.fill(0.f);
+    return Vtx;
+}
+
+uint32 CVertexArray::MemoryUsage() const
+{
+    uint32 Size = mArrayPositions.capacity() * sizeof(uint32);
+    Size += mPositions.capacity() * sizeof(CVector3f);
+    Size += mNormals.capacity() * sizeof(CVector3f);
+
+    for (uint32 iClr = 0; iClr < 2; iClr++)
+        Size += mColors[iClr].capacity() * sizeof(CColor);
+
+    for (uint32 iSlot = 0; iSlot < 8; iSlot++)
+    {
+        Size += mTexCoords[iSlot].capacity() * sizeof(CVector2f);
+        Size += mMatrixIndices[iSlot].capacity() * sizeof(uint8);
+    }
+
+    return Size;
+}
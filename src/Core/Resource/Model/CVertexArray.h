@@ -0,0 +1,97 @@
+#ifndef CVERTEXARRAY_H
+#define CVERTEXARRAY_H
+
+#include "CVertex.h"
+#include "EVertexAttribute.h"
+#include <Common/Macros.h>
+#include <vector>
+
+/**
+ * Structure-of-arrays vertex storage. Only the attributes in the vertex description are stored,
+ * each in its own tightly packed array, so a surface that only uses position/normal/uv0 doesn't
+ * pay for colors, eight sets of UVs and matrix indices on every vertex the way CVertex does.
+ * The array position (the vertex's index in the source model file) is always stored.
+ *
+ * Reading an attribute that isn't in the description is an error; use HasAttribute to check first.
+ * CVertex is still used to pass individual vertices around.
+ */
+class CVertexArray
+{
+    FVertexDescription mVtxDesc;
+    uint32 mNumVertices;
+
+    std::vector<uint32> mArrayPositions;
+    std::vector<CVector3f> mPositions;
+    std::vector<CVector3f> mNormals;
+    std::vector<CColor> mColors[2];
+    std::vector<CVector2f> mTexCoords[8];
+    std::vector<uint8> mMatrixIndices[8];
+
+public:
+    CVertexArray();
+    explicit CVertexArray(FVertexDescription Desc);
+
+    void SetVertexDesc(FVertexDescription Desc);
+    void Reserve(uint32 NumVertices);
+    void Resize(uint32 NumVertices);
+    void Clear();
+
+    uint32 AddVertex(const CVertex& rkVtx);
+    void SetVertex(uint32 Index, const CVertex& rkVtx);
+    void CopyVertex(uint32 DstIndex, const CVertexArray& rkSrc, uint32 SrcIndex);
+    CVertex Vertex(uint32 Index) const;
+    uint32 MemoryUsage() const;
+
+    // Accessors
+    inline FVertexDescription VertexDesc() const    { return mVtxDesc; }
+    inline uint32 Size() const                      { return mNumVertices; }
+    inline bool IsEmpty() const                     { return mNumVertices == 0; }
+
+    inline bool HasAttribute(EVertexAttribute Attrib) const
+    {
+        return mVtxDesc.HasFlag(Attrib);
+    }
+
+    inline uint32 ArrayPosition(uint32 Index) const
+    {
+        return mArrayPositions[Index];
+    }
+
+    inline const CVector3f& Position(uint32 Index) const
+    {
+        ASSERT(mVtxDesc & EVertexAttribute::Position);
+        return mPositions[Index];
+    }
+
+    inline const CVector3f& Normal(uint32 Index) const
+    {
+        ASSERT(mVtxDesc & EVertexAttribute::Normal);
+        return mNormals[Index];
+    }
+
+    inline const CColor& Color(uint32 Slot, uint32 Index) const
+    {
+        ASSERT(mVtxDesc & (EVertexAttribute::Color0 << Slot));
+        return mColors[Slot][Index];
+    }
+
+    inline const CVector2f& TexCoord(uint32 Slot, uint32 Index) const
+    {
+        ASSERT(mVtxDesc & (EVertexAttribute::Tex0 << Slot));
+        return mTexCoords[Slot][Index];
+    }
+
+    inline uint8 MatrixIndex(uint32 Slot, uint32 Index) const
+    {
+        ASSERT(mVtxDesc & (EVertexAttribute::PosMtx << Slot));
+        return mMatrixIndices[Slot][Index];
+    }
+
+    // Direct access to the whole position array, for code that walks every vertex (like ray tests)
+    inline const std::vector<CVector3f>& Positions() const
+    {
+        return mPositions;
+    }
+};
+
+#endif // CVERTEXARRAY_H
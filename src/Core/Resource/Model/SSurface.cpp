@@ -5,78 +5,21 @@
 
 std::pair<bool,float> SSurface::IntersectsRay(const CRay& rkRay, bool AllowBackfaces, float LineThreshold)
 {
-    bool Hit = false;
-    float HitDist;
+    // Triangles
+    std::pair<bool,float> Result = TriangleBVH().IntersectsRay(rkRay, AllowBackfaces);
+    bool Hit = Result.first;
+    float HitDist = Result.second;
 
+    // Lines
     for (uint32 iPrim = 0; iPrim < Primitives.size(); iPrim++)
     {
         SPrimitive *pPrim = &Primitives[iPrim];
-        uint32 NumVerts = pPrim->Vertices.size();
+        uint32 NumVerts = pPrim->Vertices.Size();
+        if (!pPrim->Vertices.HasAttribute(EVertexAttribute::Position)) continue;
 
-        // Triangles
-        if ((pPrim->Type == EPrimitiveType::Triangles) || (pPrim->Type == EPrimitiveType::TriangleFan) || (pPrim->Type == EPrimitiveType::TriangleStrip))
-        {
-            uint32 NumTris;
-
-            if (pPrim->Type == EPrimitiveType::Triangles)
-                NumTris = NumVerts / 3;
-            else
-                NumTris = NumVerts - 2;
-
-            for (uint32 iTri = 0; iTri < NumTris; iTri++)
-            {
-                CVector3f VtxA, VtxB, VtxC;
-
-                // Get the three vertices that make up the current tri
-                if (pPrim->Type == EPrimitiveType::Triangles)
-                {
-                    uint32 VertIndex = iTri * 3;
-                    VtxA = pPrim->Vertices[VertIndex].Position;
-                    VtxB = pPrim->Vertices[VertIndex+1].Position;
-                    VtxC = pPrim->Vertices[VertIndex+2].Position;
-                }
-
-                else if (pPrim->Type == EPrimitiveType::TriangleFan)
-                {
-                    VtxA = pPrim->Vertices[0].Position;
-                    VtxB = pPrim->Vertices[iTri+1].Position;
-                    VtxC = pPrim->Vertices[iTri+2].Position;
-                }
-
-                else if (pPrim->Type == EPrimitiveType::TriangleStrip)
-                {
-                    if (iTri & 0x1)
-                    {
-                        VtxA = pPrim->Vertices[iTri+2].Position;
-                        VtxB = pPrim->Vertices[iTri+1].Position;
-                        VtxC = pPrim->Vertices[iTri].Position;
-                    }
-
-                    else
-                    {
-                        VtxA = pPrim->Vertices[iTri].Position;
-                        VtxB = pPrim->Vertices[iTri+1].Position;
-                        VtxC = pPrim->Vertices[iTri+2].Position;
-                    }
-                }
-
-                // Intersection test
-                std::pair<bool,float> TriResult = Math::RayTriangleIntersection(rkRay, VtxA, VtxB, VtxC, AllowBackfaces);
-
-                if (TriResult.first)
-                {
-                    if ((!Hit) || (TriResult.second < HitDist))
-                    {
-                        Hit = true;
-                        HitDist = TriResult.second;
-                    }
-                }
-            }
-        }
-
-        // Lines
         if ((pPrim->Type == EPrimitiveType::Lines) || (pPrim->Type == EPrimitiveType::LineStrip))
         {
+            const std::vector<CVector3f>& rkPositions = pPrim->Vertices.Positions();
             uint32 NumLines;
 
             if (pPrim->Type == EPrimitiveType::Lines)
@@ -90,18 +33,18 @@ std::pair<bool,float> SSurface::IntersectsRay(const CRay& rkRay, bool AllowBackf
 
                 // Get the two vertices that make up the current line
                 uint32 Index = (pPrim->Type == EPrimitiveType::Lines ? iLine * 2 : iLine);
-                VtxA = pPrim->Vertices[Index].Position;
-                VtxB = pPrim->Vertices[Index+1].Position;
+                VtxA = rkPositions[Index];
+                VtxB = rkPositions[Index+1];
 
                 // Intersection test
-                std::pair<bool,float> Result = Math::RayLineIntersection(rkRay, VtxA, VtxB, LineThreshold);
+                std::pair<bool,float> LineResult = Math::RayLineIntersection(rkRay, VtxA, VtxB, LineThreshold);
 
-                if (Result.first)
+                if (LineResult.first)
                 {
-                    if ((!Hit) || (Result.second < HitDist))
+                    if ((!Hit) || (LineResult.second < HitDist))
                     {
                         Hit = true;
-                        HitDist = Result.second;
+                        HitDist = LineResult.second;
                     }
                 }
             }
@@ -110,3 +53,75 @@ std::pair<bool,float> SSurface::IntersectsRay(const CRay& rkRay, bool AllowBackf
 
     return std::pair<bool,float>(Hit, HitDist);
 }
+
+void SSurface::GetTriangles(std::vector<CVector3f>& rOutVertices) const
+{
+    // Outputs three vertices per triangle, wound the same way they're rendered
+    rOutVertices.clear();
+    rOutVertices.reserve(TriangleCount * 3);
+
+    for (uint32 iPrim = 0; iPrim < Primitives.size(); iPrim++)
+    {
+        const SPrimitive *pkPrim = &Primitives[iPrim];
+        uint32 NumVerts = pkPrim->Vertices.Size();
+        if (!pkPrim->Vertices.HasAttribute(EVertexAttribute::Position)) continue;
+
+        const std::vector<CVector3f>& rkPositions = pkPrim->Vertices.Positions();
+
+        if (pkPrim->Type == EPrimitiveType::Triangles)
+        {
+            uint32 NumTris = NumVerts / 3;
+            rOutVertices.insert(rOutVertices.end(), rkPositions.begin(), rkPositions.begin() + (NumTris * 3));
+        }
+
+        else if (pkPrim->Type == EPrimitiveType::TriangleFan)
+        {
+            for (uint32 iTri = 0; iTri + 2 < NumVerts; iTri++)
+            {
+                rOutVertices.push_back(rkPositions[0]);
+                rOutVertices.push_back(rkPositions[iTri+1]);
+                rOutVertices.push_back(rkPositions[iTri+2]);
+            }
+        }
+
+        else if (pkPrim->Type == EPrimitiveType::TriangleStrip)
+        {
+            for (uint32 iTri = 0; iTri + 2 < NumVerts; iTri++)
+            {
+                // Every other triangle in a strip is wound the opposite way
+                if (iTri & 0x1)
+                {
+                    rOutVertices.push_back(rkPositions[iTri+2]);
+                    rOutVertices.push_back(rkPositions[iTri+1]);
+                    rOutVertices.push_back(rkPositions[iTri]);
+                }
+
+                else
+                {
+                    rOutVertices.push_back(rkPositions[iTri]);
+                    rOutVertices.push_back(rkPositions[iTri+1]);
+                    rOutVertices.push_back(rkPositions[iTri+2]);
+                }
+            }
+        }
+    }
+}
+
+const CTriangleBVH& SSurface::TriangleBVH()
+{
+    if (!pTriangleBVH)
+    {
+        std::vector<CVector3f> Vertices;
+        GetTriangles(Vertices);
+
+        pTriangleBVH = std::make_unique<CTriangleBVH>();
+        pTriangleBVH->Reserve(Vertices.size() / 3);
+
+        for (uint32 iTri = 0; iTri < Vertices.size() / 3; iTri++)
+            pTriangleBVH->AddTriangle(Vertices[iTri*3], Vertices[iTri*3+1], Vertices[iTri*3+2], iTri);
+
+        pTriangleBVH->Build();
+    }
+
+    return *pTriangleBVH;
+}
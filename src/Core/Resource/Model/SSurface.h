@@ -1,15 +1,17 @@
 #ifndef SSURFACE_H
 #define SSURFACE_H
 
-#include "CVertex.h"
+#include "CVertexArray.h"
 #include "Core/Resource/CMaterialSet.h"
 #include "Core/OpenGL/GLCommon.h"
+#include "Core/CTriangleBVH.h"
 #include "Core/SRayIntersection.h"
 #include <Common/BasicTypes.h>
 #include <Common/Math/CAABox.h>
 #include <Common/Math/CRay.h>
 #include <Common/Math/CTransform4f.h>
 #include <Common/Math/CVector3f.h>
+#include <memory>
 #include <vector>
 
 // Should prolly be a class
@@ -26,10 +28,14 @@ struct SSurface
     struct SPrimitive
     {
         EPrimitiveType Type;
-        std::vector<CVertex> Vertices;
+        CVertexArray Vertices;
     };
     std::vector<SPrimitive> Primitives;
 
+    // Acceleration structure for ray tests against the surface's triangles. Built the first time the
+    // surface is ray tested, since most surfaces in an area are never picked.
+    std::unique_ptr<CTriangleBVH> pTriangleBVH;
+
     SSurface()
     {
         VertexCount = 0;
@@ -37,6 +43,8 @@ struct SSurface
     }
 
     std::pair<bool,float> IntersectsRay(const CRay& rkRay, bool AllowBackfaces = false, float LineThreshold = 0.02f);
+    void GetTriangles(std::vector<CVector3f>& rOutVertices) const;
+    const CTriangleBVH& TriangleBVH();
 };
 
 #endif // SSURFACE_H
@@ -6,9 +6,19 @@
 CGameTemplate::CGameTemplate()
     : mFullyLoaded(false)
     , mDirty(false)
+    , mStopPreload(false)
 {
 }
 
+CGameTemplate::~CGameTemplate()
+{
+    StopPreload();
+
+    // Cache anything that was loaded on demand since the last commit
+    if (mpTemplateCache)
+        mpTemplateCache->Commit();
+}
+
 void CGameTemplate::Serialize(IArchive& Arc)
 {
     Arc << SerialParameter("ScriptObjects", mScriptTemplates)
@@ -19,23 +29,29 @@ void CGameTemplate::Serialize(IArchive& Arc)
 
 void CGameTemplate::Load(const TString& kFilePath)
 {
-    CXMLReader Reader(kFilePath);
-    ASSERT(Reader.IsValid());
+    mSourceFile = kFilePath;
+    mpTemplateCache = std::make_unique<CTemplateCache>(GetGameDirectory() + "TemplateCache.bin");
 
-    mGame = Reader.Game();
-    Serialize(Reader);
+    std::unique_ptr<IArchive> pReader = mpTemplateCache->OpenReader(kFilePath);
+    ASSERT(pReader != nullptr);
 
-    mSourceFile = kFilePath;
+    mGame = pReader->Game();
+    Serialize(*pReader);
+    mpTemplateCache->Store(kFilePath, *pReader, [this](IArchive& Arc) { Serialize(Arc); });
     mFullyLoaded = true;
 
-    // Load all sub-templates
-    const TString gkGameRoot = GetGameDirectory();
+    // Script templates and property archetypes are loaded on demand; see TemplateByID and FindPropertyArchetype
+    mpTemplateCache->Commit();
+}
+
+/** Load every script template and property archetype that hasn't been loaded yet */
+void CGameTemplate::LoadAllTemplates()
+{
+    std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
 
     for (auto Iter = mScriptTemplates.begin(); Iter != mScriptTemplates.end(); Iter++)
     {
-        SScriptTemplatePath& ScriptPath = Iter->second;
-        TString AbsPath = gkGameRoot + ScriptPath.Path;
-        ScriptPath.pTemplate = std::make_shared<CScriptTemplate>(this, Iter->first, AbsPath);
+        Internal_LoadScriptTemplate(Iter->first, Iter->second);
     }
 
     for (auto Iter = mPropertyTemplates.begin(); Iter != mPropertyTemplates.end(); Iter++)
@@ -44,13 +60,47 @@ void CGameTemplate::Load(const TString& kFilePath)
         // may not be loaded yet.. so if this happens, the referenced property will be loaded,
         // meaning property templates can be loaded out of order, so we need to make sure
         // that we don't load any template more than once.
-        SPropertyTemplatePath& PropertyPath = Iter->second;
+        Internal_LoadPropertyTemplate(Iter->second);
+    }
 
-        if (!PropertyPath.pTemplate)
-        {
-            Internal_LoadPropertyTemplate(Iter->second);
-        }
+    // Save any templates that had to be loaded from XML so the next load can skip parsing them
+    mpTemplateCache->Commit();
+}
+
+/** Start loading the remaining script templates on a worker thread */
+void CGameTemplate::StartPreload()
+{
+    if (mPreloadThread.joinable())
+        return;
+
+    mStopPreload = false;
+    mPreloadThread = std::thread(&CGameTemplate::PreloadScriptTemplates, this);
+}
+
+/** Stop the preload thread, if it's running. Templates it didn't get to are still loaded on demand. */
+void CGameTemplate::StopPreload()
+{
+    if (mPreloadThread.joinable())
+    {
+        mStopPreload = true;
+        mPreloadThread.join();
+    }
+}
+
+void CGameTemplate::PreloadScriptTemplates()
+{
+    // The set of script templates never changes after the game template is loaded, so it's safe to
+    // iterate without holding the lock. Each template is loaded under the lock, one at a time, so a
+    // request from another thread never waits on more than one template. Property archetypes are
+    // loaded as the script templates reference them.
+    for (auto Iter = mScriptTemplates.begin(); Iter != mScriptTemplates.end() && !mStopPreload; Iter++)
+    {
+        std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
+        Internal_LoadScriptTemplate(Iter->first, Iter->second);
     }
+
+    std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
+    mpTemplateCache->Commit();
 }
 
 void CGameTemplate::Save()
@@ -62,6 +112,16 @@ void CGameTemplate::Save()
     mDirty = false;
 }
 
+/** Internal function for loading a script template from a file. */
+void CGameTemplate::Internal_LoadScriptTemplate(SObjId ObjectID, SScriptTemplatePath& Path)
+{
+    if (Path.pTemplate != nullptr) // don't load twice
+        return;
+
+    const TString kTemplateFilePath = GetGameDirectory() + Path.Path;
+    Path.pTemplate = std::make_shared<CScriptTemplate>(this, ObjectID, kTemplateFilePath);
+}
+
 /** Internal function for loading a property template from a file. */
 void CGameTemplate::Internal_LoadPropertyTemplate(SPropertyTemplatePath& Path)
 {
@@ -70,17 +130,22 @@ void CGameTemplate::Internal_LoadPropertyTemplate(SPropertyTemplatePath& Path)
 
     const TString kGameDir = GetGameDirectory();
     const TString kTemplateFilePath = kGameDir + Path.Path;
-    CXMLReader Reader(kTemplateFilePath);
-    ASSERT(Reader.IsValid());
+    std::unique_ptr<IArchive> pReader = mpTemplateCache->OpenReader(kTemplateFilePath);
+    ASSERT(pReader != nullptr);
 
-    Reader << SerialParameter("PropertyArchetype", Path.pTemplate);
+    *pReader << SerialParameter("PropertyArchetype", Path.pTemplate);
     ASSERT(Path.pTemplate != nullptr);
 
     Path.pTemplate->Initialize(nullptr, nullptr, 0);
+
+    mpTemplateCache->Store(kTemplateFilePath, *pReader, [&Path](IArchive& Arc) {
+        Arc << SerialParameter("PropertyArchetype", Path.pTemplate);
+    });
 }
 
 void CGameTemplate::SaveGameTemplates(bool ForceAll /*= false*/)
 {
+    std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
     const TString kGameDir = GetGameDirectory();
 
     if (mDirty || ForceAll)
@@ -130,7 +195,11 @@ CScriptTemplate* CGameTemplate::TemplateByID(uint32 ObjectID)
     auto it = mScriptTemplates.find(ObjectID);
 
     if (it != mScriptTemplates.end())
+    {
+        std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
+        Internal_LoadScriptTemplate(it->first, it->second);
         return it->second.pTemplate.get();
+    }
     else
         return nullptr;
 }
@@ -140,10 +209,17 @@ CScriptTemplate* CGameTemplate::TemplateByID(const CFourCC& ObjectID)
     return TemplateByID(ObjectID.ToLong());
 }
 
-CScriptTemplate* CGameTemplate::TemplateByIndex(uint32 Index)
+/** With Load = false, returns nullptr for templates that haven't been loaded yet instead of loading them */
+CScriptTemplate* CGameTemplate::TemplateByIndex(uint32 Index, bool Load /*= true*/)
 {
-    auto it = mScriptTemplates.begin();
-    return (std::next(it, Index))->second.pTemplate.get();
+    auto it = std::next(mScriptTemplates.begin(), Index);
+
+    std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
+
+    if (Load)
+        Internal_LoadScriptTemplate(it->first, it->second);
+
+    return it->second.pTemplate.get();
 }
 
 SState CGameTemplate::StateByID(uint32 StateID)
@@ -192,6 +268,7 @@ SMessage CGameTemplate::MessageByIndex(uint32 Index)
 
 IProperty* CGameTemplate::FindPropertyArchetype(const TString& kTypeName)
 {
+    std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
     auto Iter = mPropertyTemplates.find(kTypeName);
 
     if (Iter == mPropertyTemplates.end())
@@ -221,6 +298,8 @@ TString CGameTemplate::GetPropertyArchetypeFilePath(const TString& kTypeName)
 
 bool CGameTemplate::RenamePropertyArchetype(const TString& kTypeName, const TString& kNewTypeName)
 {
+    std::lock_guard<std::recursive_mutex> Lock(mLoadMutex);
+
     if( kTypeName != kNewTypeName )
     {
         // Fetch the property that we are going to be renaming.
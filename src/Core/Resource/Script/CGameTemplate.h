@@ -3,10 +3,14 @@
 
 #include "CLink.h"
 #include "CScriptTemplate.h"
+#include "CTemplateCache.h"
 #include "Core/Resource/Script/Property/Properties.h"
 #include <Common/BasicTypes.h>
 #include <Common/EGame.h>
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <thread>
 
 /** Serialization aid
  *  Retro switched from using integers to fourCCs to represent IDs in several cases (states/messages, object IDs).
@@ -92,7 +96,11 @@ struct SPropertyTemplatePath
     }
 };
 
-/** CGameTemplate - Per-game template data */
+/** CGameTemplate - Per-game template data
+ *  Script templates and property archetypes are loaded on demand, the first time they're requested.
+ *  StartPreload() loads the remaining script templates on a worker thread; every template load happens
+ *  under mLoadMutex, so lookups from other threads just wait for the template they need.
+ */
 class CGameTemplate
 {
     EGame mGame;
@@ -107,20 +115,38 @@ class CGameTemplate
     std::map<SObjId, TString> mStates;
     std::map<SObjId, TString> mMessages;
 
+    /** Binary cache of this game's template files */
+    std::unique_ptr<CTemplateCache> mpTemplateCache;
+
+    /** Background preloading */
+    std::recursive_mutex mLoadMutex;
+    std::thread mPreloadThread;
+    std::atomic<bool> mStopPreload;
+
+    /** Internal function for loading a script template from a file. */
+    void Internal_LoadScriptTemplate(SObjId ObjectID, SScriptTemplatePath& Path);
+
     /** Internal function for loading a property template from a file. */
     void Internal_LoadPropertyTemplate(SPropertyTemplatePath& Path);
 
+    /** Worker thread entry point for StartPreload() */
+    void PreloadScriptTemplates();
+
 public:
     CGameTemplate();
+    ~CGameTemplate();
     void Serialize(IArchive& Arc);
     void Load(const TString& kFilePath);
     void Save();
     void SaveGameTemplates(bool ForceAll = false);
+    void LoadAllTemplates();
+    void StartPreload();
+    void StopPreload();
 
     uint32 GameVersion(TString VersionName);
     CScriptTemplate* TemplateByID(uint32 ObjectID);
     CScriptTemplate* TemplateByID(const CFourCC& ObjectID);
-    CScriptTemplate* TemplateByIndex(uint32 Index);
+    CScriptTemplate* TemplateByIndex(uint32 Index, bool Load = true);
     SState StateByID(uint32 StateID);
     SState StateByID(const CFourCC& StateID);
     SState StateByIndex(uint32 Index);
@@ -138,6 +164,7 @@ public:
     inline uint32 NumStates() const             { return mStates.size(); }
     inline uint32 NumMessages() const           { return mMessages.size(); }
     inline bool IsLoadedSuccessfully()          { return mFullyLoaded; }
+    inline CTemplateCache* TemplateCache() const { return mpTemplateCache.get(); }
 };
 
 #endif // CGAMETEMPLATE_H
@@ -3,12 +3,15 @@
 #include "CGameTemplate.h"
 #include "Core/Resource/Animation/CAnimSet.h"
 
+static bool gDeferDisplayAssetLoads = false;
+
 CScriptObject::CScriptObject(uint32 InstanceID, CGameArea *pArea, CScriptLayer *pLayer, CScriptTemplate *pTemplate)
     : mpTemplate(pTemplate)
     , mpArea(pArea)
     , mpLayer(pLayer)
     , mVersion(0)
     , mInstanceID(InstanceID)
+    , mpDeferredDisplayAsset(nullptr)
     , mHasInGameModel(false)
     , mIsCheckingNearVisibleActivation(false)
 {
@@ -68,7 +71,11 @@ void CScriptObject::CopyProperties(CScriptObject* pObject)
 
 void CScriptObject::EvaluateDisplayAsset()
 {
-    mpDisplayAsset = mpTemplate->FindDisplayAsset(PropertyData(), mActiveCharIndex, mActiveAnimIndex, mHasInGameModel);
+    mpDisplayAsset = mpTemplate->FindDisplayAsset(PropertyData(), mActiveCharIndex, mActiveAnimIndex, mHasInGameModel,
+                                                  gDeferDisplayAssetLoads ? &mpDeferredDisplayAsset : nullptr);
+
+    if (!gDeferDisplayAssetLoads)
+        mpDeferredDisplayAsset = nullptr;
 }
 
 void CScriptObject::EvaluateCollisionModel()
@@ -82,6 +89,11 @@ void CScriptObject::EvaluateVolume()
     mVolumeScale = mpTemplate->VolumeScale(this);
 }
 
+void CScriptObject::SetDeferDisplayAssetLoads(bool Defer)
+{
+    gDeferDisplayAssetLoads = Defer;
+}
+
 bool CScriptObject::IsEditorProperty(IProperty *pProp)
 {
     return ( (pProp == mInstanceName.Property()) ||
@@ -39,6 +39,7 @@ class CScriptObject
     CStructRef mLightParameters;
 
     TResPtr<CResource> mpDisplayAsset;
+    CResourceEntry *mpDeferredDisplayAsset; // Display asset that's waiting to be streamed in
     TResPtr<CCollisionMeshGroup> mpCollision;
     uint32 mActiveCharIndex;
     uint32 mActiveAnimIndex;
@@ -60,6 +61,9 @@ public:
     void EvaluateCollisionModel();
     void EvaluateVolume();
     bool IsEditorProperty(IProperty *pProp);
+
+    // While enabled, display assets that aren't loaded yet are left for the scene to stream in instead of loaded immediately
+    static void SetDeferDisplayAssetLoads(bool Defer);
     void SetLayer(CScriptLayer *pLayer, uint32 NewLayerIndex = -1);
     uint32 LayerIndex() const;
     bool HasNearVisibleActivation() const;
@@ -88,6 +92,7 @@ public:
     bool HasInGameModel() const                 { return mHasInGameModel; }
     CStructRef LightParameters() const          { return mLightParameters; }
     CResource* DisplayAsset() const             { return mpDisplayAsset; }
+    CResourceEntry* DeferredDisplayAsset() const { return mpDeferredDisplayAsset; }
     uint32 ActiveCharIndex() const              { return mActiveCharIndex; }
     uint32 ActiveAnimIndex() const              { return mActiveAnimIndex; }
     CCollisionMeshGroup* Collision() const      { return mpCollision; }
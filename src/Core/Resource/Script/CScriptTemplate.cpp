@@ -46,9 +46,10 @@ CScriptTemplate::CScriptTemplate(CGameTemplate* pInGame, uint32 InObjectID, cons
     , mDirty(false)
 {
     // Load
-    CXMLReader Reader(kInFilePath);
-    ASSERT(Reader.IsValid());
-    Serialize(Reader);
+    CTemplateCache* pCache = mpGame->TemplateCache();
+    std::unique_ptr<IArchive> pReader = pCache->OpenReader(kInFilePath);
+    ASSERT(pReader != nullptr);
+    Serialize(*pReader);
 
     // Post load initialization
     mSourceFile = kInFilePath;
@@ -60,6 +61,8 @@ CScriptTemplate::CScriptTemplate(CGameTemplate* pInGame, uint32 InObjectID, cons
     if (!mScaleIDString.IsEmpty())              mpScaleProperty = TPropCast<CVectorProperty>( mpProperties->ChildByIDString(mScaleIDString) );
     if (!mActiveIDString.IsEmpty())             mpActiveProperty = TPropCast<CBoolProperty>( mpProperties->ChildByIDString(mActiveIDString) );
     if (!mLightParametersIDString.IsEmpty())    mpLightParametersProperty = TPropCast<CStructProperty>( mpProperties->ChildByIDString(mLightParametersIDString) );
+
+    pCache->Store(kInFilePath, *pReader, [this](IArchive& Arc) { Serialize(Arc); });
 }
 
 CScriptTemplate::~CScriptTemplate()
@@ -208,12 +211,27 @@ int32 CScriptTemplate::CheckVolumeConditions(CScriptObject *pObj, bool LogErrors
     return -1;
 }
 
-CResource* CScriptTemplate::FindDisplayAsset(void* pPropertyData, uint32& rOutCharIndex, uint32& rOutAnimIndex, bool& rOutIsInGame)
+// Returns whether a display asset should be skipped because it isn't loaded yet, and records the first one skipped
+static bool ShouldDeferAsset(CResourceEntry *pEntry, CResourceEntry **ppOutDeferredEntry)
+{
+    if (!ppOutDeferredEntry || !pEntry || pEntry->IsLoaded())
+        return false;
+
+    if (!*ppOutDeferredEntry)
+        *ppOutDeferredEntry = pEntry;
+
+    return true;
+}
+
+CResource* CScriptTemplate::FindDisplayAsset(void* pPropertyData, uint32& rOutCharIndex, uint32& rOutAnimIndex, bool& rOutIsInGame, CResourceEntry **ppOutDeferredEntry /*= nullptr*/)
 {
     rOutCharIndex = -1;
     rOutAnimIndex = -1;
     rOutIsInGame = false;
 
+    if (ppOutDeferredEntry)
+        *ppOutDeferredEntry = nullptr;
+
     for (auto it = mAssets.begin(); it != mAssets.end(); it++)
     {
         if (it->AssetType == SEditorAsset::EAssetType::Collision) continue;
@@ -232,6 +250,10 @@ CResource* CScriptTemplate::FindDisplayAsset(void* pPropertyData, uint32& rOutCh
             {
                 CAnimationSetProperty* pAnimSet = TPropCast<CAnimationSetProperty>(pProp);
                 CAnimationParameters Params = pAnimSet->Value(pPropertyData);
+
+                if (ShouldDeferAsset(gpResourceStore->FindEntry(Params.ID()), ppOutDeferredEntry))
+                    continue;
+
                 pRes = Params.AnimSet();
 
                 if (pRes)
@@ -248,7 +270,7 @@ CResource* CScriptTemplate::FindDisplayAsset(void* pPropertyData, uint32& rOutCh
                 CAssetProperty* pAsset = TPropCast<CAssetProperty>(pProp);
                 CAssetID ID = pAsset->Value(pPropertyData);
                 CResourceEntry *pEntry = gpResourceStore->FindEntry( ID );
-                if (pEntry) pRes = pEntry->Load();
+                if (pEntry && !ShouldDeferAsset(pEntry, ppOutDeferredEntry)) pRes = pEntry->Load();
             }
         }
 
@@ -141,7 +141,9 @@ public:
     // Property Fetching
     EVolumeShape VolumeShape(CScriptObject *pObj);
     float VolumeScale(CScriptObject *pObj);
-    CResource* FindDisplayAsset(void* pPropertyData, uint32& rOutCharIndex, uint32& rOutAnimIndex, bool& rOutIsInGame);
+    // If ppOutDeferredEntry is provided, property assets that aren't loaded yet are skipped instead of loaded,
+    // and the first one skipped is returned through it so the caller can stream it in.
+    CResource* FindDisplayAsset(void* pPropertyData, uint32& rOutCharIndex, uint32& rOutAnimIndex, bool& rOutIsInGame, CResourceEntry **ppOutDeferredEntry = nullptr);
     CCollisionMeshGroup* FindCollision(void* pPropertyData);
 
     // Accessors
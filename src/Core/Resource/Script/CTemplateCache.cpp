@@ -0,0 +1,183 @@
+#include "CTemplateCache.h"
+#include <Common/FileIO.h>
+#include <Common/FileUtil.h>
+#include <Common/Log.h>
+#include <Common/Macros.h>
+#include <Common/Serialization/Binary.h>
+#include <Common/Serialization/XML.h>
+
+const uint32 gkCacheMagic = FOURCC('TMPC');
+
+// Bump this whenever a template serializer changes in a way that affects the binary output
+const uint32 gkCacheVersion = 1;
+
+/** Binary reader over a cached entry; owns the stream the reader reads from */
+class CCachedTemplateReader : private CMemoryInStream, public CBinaryReader
+{
+public:
+    CCachedTemplateReader(const uint8 *pkData, uint32 Size, const CSerialVersion& rkVersion)
+        : CMemoryInStream(pkData, Size, EEndian::LittleEndian)
+        , CBinaryReader(static_cast<CMemoryInStream*>(this), rkVersion)
+    {}
+};
+
+CTemplateCache::CTemplateCache(const TString& rkPath)
+    : mPath(rkPath)
+    , mDirty(false)
+{
+    LoadPrevCache();
+}
+
+std::unique_ptr<IArchive> CTemplateCache::OpenReader(const TString& rkXMLPath)
+{
+    auto Find = mEntries.find(rkXMLPath);
+
+    if (Find != mEntries.end())
+    {
+        const SEntry& rkEntry = Find->second;
+
+        if (rkEntry.ModifiedTime == FileUtil::LastModifiedTime(rkXMLPath) &&
+            rkEntry.FileSize == FileUtil::FileSize(rkXMLPath))
+        {
+            CSerialVersion Version(IArchive::skCurrentArchiveVersion, rkEntry.FileVersion, rkEntry.Game);
+            return std::make_unique<CCachedTemplateReader>(rkEntry.pkData, rkEntry.DataSize, Version);
+        }
+    }
+
+    std::unique_ptr<CXMLReader> pReader = std::make_unique<CXMLReader>(rkXMLPath);
+
+    if (!pReader->IsValid())
+    {
+        errorf("Failed to open template file: %s", *rkXMLPath);
+        return nullptr;
+    }
+
+    return pReader;
+}
+
+void CTemplateCache::Store(const TString& rkXMLPath, const IArchive& rkReader, const std::function<void(IArchive&)>& Serialize)
+{
+    if (rkReader.IsBinaryFormat())
+        return;
+
+    CSerialVersion Version(IArchive::skCurrentArchiveVersion, rkReader.FileVersion(), rkReader.Game());
+    CVectorOutStream Data;
+    {
+        CBinaryWriter Writer(&Data, Version);
+        Serialize(Writer);
+    }
+
+    SEntry& rEntry = mEntries[rkXMLPath];
+    rEntry.ModifiedTime = FileUtil::LastModifiedTime(rkXMLPath);
+    rEntry.FileSize = FileUtil::FileSize(rkXMLPath);
+    rEntry.FileVersion = rkReader.FileVersion();
+    rEntry.Game = rkReader.Game();
+    rEntry.NewData.assign((const uint8*) Data.Data(), (const uint8*) Data.Data() + Data.Size());
+    rEntry.pkData = rEntry.NewData.data();
+    rEntry.DataSize = rEntry.NewData.size();
+    mDirty = true;
+}
+
+bool CTemplateCache::Commit()
+{
+    if (!mDirty) return true;
+
+    // Write the new cache before closing the previous one, since unchanged entries still point into its mapping
+    {
+        CFileOutStream Cache(TempPath(), EEndian::LittleEndian);
+
+        if (!Cache.IsValid())
+        {
+            warnf("Unable to open template cache for writing: %s", *TempPath());
+            return false;
+        }
+
+        Cache.WriteLong(gkCacheMagic);
+        Cache.WriteLong(gkCacheVersion);
+        Cache.WriteLong(IArchive::skCurrentArchiveVersion);
+        Cache.WriteLong(mEntries.size());
+
+        for (auto Iter = mEntries.begin(); Iter != mEntries.end(); Iter++)
+        {
+            const SEntry& rkEntry = Iter->second;
+            Cache.WriteSizedString(Iter->first);
+            Cache.WriteLongLong(rkEntry.ModifiedTime);
+            Cache.WriteLongLong(rkEntry.FileSize);
+            Cache.WriteShort(rkEntry.FileVersion);
+            Cache.WriteLong((uint32) rkEntry.Game);
+            Cache.WriteLong(rkEntry.DataSize);
+            Cache.WriteBytes(rkEntry.pkData, rkEntry.DataSize);
+        }
+    }
+
+    mEntries.clear();
+    mPrevCache.Close();
+
+    if (FileUtil::Exists(mPath))
+        FileUtil::DeleteFile(mPath);
+
+    if (!FileUtil::MoveFile(TempPath(), mPath))
+    {
+        warnf("Failed to save template cache: %s", *mPath);
+        FileUtil::DeleteFile(TempPath());
+        return false;
+    }
+
+    // Map the new cache so later lookups keep working
+    mDirty = false;
+    LoadPrevCache();
+    return true;
+}
+
+// ************ PROTECTED ************
+void CTemplateCache::LoadPrevCache()
+{
+    if (!FileUtil::Exists(mPath) || !mPrevCache.Open(mPath))
+        return;
+
+    CMemoryInStream Cache(mPrevCache.Data(), (uint32) mPrevCache.Size(), EEndian::LittleEndian);
+
+    if (Cache.Size() < 0x10)
+        return;
+
+    uint32 Magic = Cache.ReadLong();
+    uint32 Version = Cache.ReadLong();
+    uint32 ArchiveVersion = Cache.ReadLong();
+    uint32 NumEntries = Cache.ReadLong();
+
+    // An outdated cache is just ignored; every template will be loaded from XML and the cache rebuilt
+    if (Magic != gkCacheMagic || Version != gkCacheVersion || ArchiveVersion != IArchive::skCurrentArchiveVersion)
+    {
+        mPrevCache.Close();
+        return;
+    }
+
+    for (uint32 EntryIdx = 0; EntryIdx < NumEntries; EntryIdx++)
+    {
+        if (!mPrevCache.DataAt(Cache.Tell(), 4))
+            break;
+
+        // Path, then 0x1A bytes of entry header
+        uint32 PathLength = Cache.ReadLong();
+
+        if (!mPrevCache.DataAt(Cache.Tell(), (uint64) PathLength + 0x1A))
+            break;
+
+        TString Path = Cache.ReadString(PathLength);
+
+        SEntry Entry;
+        Entry.ModifiedTime = Cache.ReadLongLong();
+        Entry.FileSize = Cache.ReadLongLong();
+        Entry.FileVersion = Cache.ReadShort();
+        Entry.Game = (EGame) Cache.ReadLong();
+        Entry.DataSize = Cache.ReadLong();
+        Entry.pkData = mPrevCache.DataAt(Cache.Tell(), Entry.DataSize);
+
+        // Truncated file; keep whatever was read intact up to this point
+        if (!Entry.pkData)
+            break;
+
+        Cache.Seek(Entry.DataSize, SEEK_CUR);
+        mEntries[Path] = std::move(Entry);
+    }
+}
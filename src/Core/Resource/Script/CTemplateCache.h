@@ -0,0 +1,64 @@
+#ifndef CTEMPLATECACHE_H
+#define CTEMPLATECACHE_H
+
+#include "Core/CMappedFile.h"
+#include <Common/BasicTypes.h>
+#include <Common/EGame.h>
+#include <Common/TString.h>
+#include <Common/Serialization/IArchive.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+/* Binary snapshot of XML template files (game templates, script templates, property archetypes and the
+ * property map). Each file is stored as it serializes through CBinaryWriter once it's fully loaded, so a
+ * cache hit skips the XML parse entirely and reads the same data back through CBinaryReader.
+ *
+ * Entries are keyed by the XML file's path, last modified time and size; a file that has changed since
+ * it was cached is read from XML again and its entry replaced. The previous cache is memory mapped, and
+ * a new one is only written by Commit() if any entry was added. */
+class CTemplateCache
+{
+    struct SEntry
+    {
+        uint64 ModifiedTime;
+        uint64 FileSize;
+        uint16 FileVersion;
+        EGame Game;
+
+        // Points into the previous cache for entries loaded from it, or to NewData for new entries
+        const uint8 *pkData;
+        uint32 DataSize;
+        std::vector<uint8> NewData;
+    };
+
+    TString mPath;
+    CMappedFile mPrevCache;
+    std::map<TString, SEntry> mEntries;
+    bool mDirty;
+
+public:
+    CTemplateCache(const TString& rkPath);
+
+    // Opens a reader for the given XML file; a binary reader over the cached copy if it's up to date,
+    // otherwise an XML reader. Returns nullptr if the file can't be opened.
+    std::unique_ptr<IArchive> OpenReader(const TString& rkXMLPath);
+
+    // Caches a file after it's been loaded from XML. rkReader is the reader returned by OpenReader; nothing
+    // is stored if it read from the cache. Serialize is called with a binary writer, and should write the
+    // loaded object the same way it would be saved.
+    void Store(const TString& rkXMLPath, const IArchive& rkReader, const std::function<void(IArchive&)>& Serialize);
+
+    bool Commit();
+
+    inline TString Path() const             { return mPath; }
+    inline uint32 NumEntries() const        { return mEntries.size(); }
+    inline bool IsDirty() const             { return mDirty; }
+
+protected:
+    void LoadPrevCache();
+    inline TString TempPath() const         { return mPath + ".tmp"; }
+};
+
+#endif // CTEMPLATECACHE_H
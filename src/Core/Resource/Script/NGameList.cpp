@@ -111,7 +111,21 @@ void SaveGameList()
 void LoadAllGameTemplates()
 {
     for (int GameIdx = 0; GameIdx < (int) EGame::Max; GameIdx++)
-        GetGameTemplate( (EGame) GameIdx );
+    {
+        CGameTemplate* pGameTemplate = GetGameTemplate( (EGame) GameIdx );
+
+        if (pGameTemplate)
+            pGameTemplate->LoadAllTemplates();
+    }
+}
+
+/** Start loading a game's script templates in the background */
+void PreloadGameTemplate(EGame Game)
+{
+    CGameTemplate* pGameTemplate = GetGameTemplate(Game);
+
+    if (pGameTemplate)
+        pGameTemplate->StartPreload();
 }
 
 /** Resave templates. If ForceAll is false, only saves templates that have been modified. */
@@ -162,6 +176,13 @@ CGameTemplate* GetGameTemplate(EGame Game)
 /** Clean up game list resources. This needs to be called on app shutdown to ensure things are cleaned up in the right order. */
 void Shutdown()
 {
+    // Preload threads look up their own game template, so they need to be stopped before any template is destroyed
+    for (int GameIdx = 0; GameIdx < (int) EGame::Max; GameIdx++)
+    {
+        if (gGameList[GameIdx].pTemplate)
+            gGameList[GameIdx].pTemplate->StopPreload();
+    }
+
     for (int GameIdx = 0; GameIdx < (int) EGame::Max; GameIdx++)
     {
         gGameList[GameIdx].Name = "";
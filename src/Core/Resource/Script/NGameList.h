@@ -6,12 +6,15 @@
 namespace NGameList
 {
 
-/** Load all game templates into memory
+/** Load all game templates into memory, including every script template and property archetype.
  *  This normally isn't necessary to call, as game templates will be lazy-loaded the
  *  first time they are requested.
  */
 void LoadAllGameTemplates();
 
+/** Start loading a game's script templates in the background, so they're ready by the time they're needed */
+void PreloadGameTemplate(EGame Game);
+
 /** Load the game list into memory. This is normally not necessary to call. */
 void LoadGameList();
 
@@ -1,7 +1,10 @@
 #include "NPropertyMap.h"
 #include "NGameList.h"
+#include "CTemplateCache.h"
+#include "Core/TFlatHashMap.h"
 #include <Common/NBasics.h>
 #include <Common/Serialization/XML.h>
+#include <mutex>
 
 /** NPropertyMap: Namespace for property ID -> name mappings */
 namespace NPropertyMap
@@ -11,6 +14,9 @@ namespace NPropertyMap
 const char* gpkLegacyMapPath = "../templates/PropertyMapLegacy.xml";
 const char* gpkMapPath = "../templates/PropertyMap.xml";
 
+/** Path to the binary cache of the property map */
+const char* gpkMapCachePath = "../templates/PropertyMapCache.bin";
+
 /** Whether to do name lookups from the legacy map */
 const bool gkUseLegacyMapForNameLookups = false;
 
@@ -23,6 +29,11 @@ bool gMapIsDirty = false;
 /** Whether the map has been loaded */
 bool gMapIsLoaded = false;
 
+/** Guards the maps; templates can be loaded (and register their properties) on a preload thread.
+ *  Never call into a game template while holding this, as template loads lock in the opposite order.
+ */
+std::recursive_mutex gMapMutex;
+
 /** Mapping of typename hashes back to the original string */
 std::unordered_map<uint32, TString> gHashToTypeName;
 
@@ -124,6 +135,11 @@ struct SNameValue
  */
 std::map<SNameKey, SNameValue> gNameMap;
 
+/** Flat index into gNameMap for lookups, keyed by SNameKey::Key. std::map nodes never move, so the
+ *  pointers stay valid until the entry is erased; anything that erases or re-keys entries rebuilds the index.
+ */
+TFlatHashMap<uint64, SNameValue*> gNameIndex;
+
 /** Legacy map that only includes the ID in the key */
 std::map<uint32, TString> gLegacyNameMap;
 
@@ -141,9 +157,36 @@ SNameKey CreateKey(uint32 ID, const char* pkTypeName)
     return SNameKey( CCRC32::StaticHashString(pkTypeName), ID );
 }
 
+/** Internal: Returns the map entry for the given key, or nullptr if there isn't one. */
+inline SNameValue* FindName(const SNameKey& kKey)
+{
+    SNameValue** ppValue = gNameIndex.Find(kKey.Key);
+    return ppValue ? *ppValue : nullptr;
+}
+
+/** Internal: Adds an entry to the map and the index. */
+SNameValue* AddName(const SNameKey& kKey, const SNameValue& kValue)
+{
+    SNameValue& Value = gNameMap[kKey];
+    Value = kValue;
+    gNameIndex.Insert(kKey.Key, &Value);
+    return &Value;
+}
+
+/** Internal: Rebuilds the index after entries have been erased or re-keyed. */
+void RebuildIndex()
+{
+    gNameIndex.Clear();
+    gNameIndex.Reserve(gNameMap.size());
+
+    for (auto Iter = gNameMap.begin(); Iter != gNameMap.end(); Iter++)
+        gNameIndex.Insert(Iter->first.Key, &Iter->second);
+}
+
 /** Loads property names into memory */
 void LoadMap()
 {
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     ASSERT( !gMapIsLoaded );
     debugf("Loading property map");
 
@@ -155,9 +198,16 @@ void LoadMap()
     }
     else
     {
-        CXMLReader Reader(gpkMapPath);
-        ASSERT(Reader.IsValid());
-        Reader << SerialParameter("PropertyMap", gNameMap, SH_HexDisplay);
+        // Read the map from the binary cache if PropertyMap.xml hasn't changed since it was last cached
+        CTemplateCache Cache(gpkMapCachePath);
+        std::unique_ptr<IArchive> pReader = Cache.OpenReader(gpkMapPath);
+        ASSERT(pReader != nullptr);
+        *pReader << SerialParameter("PropertyMap", gNameMap, SH_HexDisplay);
+
+        Cache.Store(gpkMapPath, *pReader, [](IArchive& Arc) {
+            Arc << SerialParameter("PropertyMap", gNameMap, SH_HexDisplay);
+        });
+        Cache.Commit();
 
         // Iterate over the map and set up the valid flags
         for (auto Iter = gNameMap.begin(); Iter != gNameMap.end(); Iter++)
@@ -166,6 +216,8 @@ void LoadMap()
             SNameValue& Value = Iter->second;
             Value.IsValid = (CalculatePropertyID(*Value.Name, *gHashToTypeName[kKey.TypeHash]) == kKey.ID);
         }
+
+        RebuildIndex();
     }
 
     gMapIsLoaded = true;
@@ -197,6 +249,7 @@ void SaveMap(bool Force /*= false*/)
     {
         if( gkUseLegacyMapForUpdates )
         {
+            std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
             CXMLWriter Writer(gpkLegacyMapPath, "PropertyMap");
             ASSERT(Writer.IsValid());
             Writer << SerialParameter("PropertyMap", gLegacyNameMap, SH_HexDisplay);
@@ -206,6 +259,7 @@ void SaveMap(bool Force /*= false*/)
             // Make sure all game templates are loaded and clear out ID-type pairs that aren't used
             // This mostly occurs when type names are changed - unneeded pairings with the old type can be left in the map
             NGameList::LoadAllGameTemplates();
+            std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
 
             for (auto Iter = gNameMap.begin(); Iter != gNameMap.end(); Iter++)
             {
@@ -217,6 +271,8 @@ void SaveMap(bool Force /*= false*/)
                 }
             }
 
+            RebuildIndex();
+
             // Perform the actual save
             CXMLWriter Writer(gpkMapPath, "PropertyMap");
             ASSERT(Writer.IsValid());
@@ -229,6 +285,7 @@ void SaveMap(bool Force /*= false*/)
 /** Given a property ID and type, returns the name of the property */
 const char* GetPropertyName(IProperty* pInProperty)
 {
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     ConditionalLoadMap();
 
     if (gkUseLegacyMapForNameLookups)
@@ -238,9 +295,8 @@ const char* GetPropertyName(IProperty* pInProperty)
     }
     else
     {
-        SNameKey Key = CreateKey(pInProperty);
-        auto MapFind = gNameMap.find(Key);
-        return (MapFind == gNameMap.end() ? "Unknown" : *MapFind->second.Name);
+        SNameValue* pValue = FindName( CreateKey(pInProperty) );
+        return (pValue ? *pValue->Name : "Unknown");
     }
 }
 
@@ -249,12 +305,37 @@ const char* GetPropertyName(IProperty* pInProperty)
  */
 const char* GetPropertyName(uint32 ID, const char* pkTypeName)
 {
+    return GetPropertyName( ID, STypeHandle { CCRC32::StaticHashString(pkTypeName) } );
+}
+
+const char* GetPropertyName(uint32 ID, STypeHandle Type)
+{
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     // Does not support legacy map
     ConditionalLoadMap();
 
-    SNameKey Key = CreateKey(ID, pkTypeName);
-    auto MapFind = gNameMap.find(Key);
-    return MapFind == gNameMap.end() ? "Unknown" : *MapFind->second.Name;
+    SNameValue* pValue = FindName( SNameKey(Type.Hash, ID) );
+    return (pValue ? *pValue->Name : "Unknown");
+}
+
+/** Interns a type name, returning a handle that can be used for lookups without hashing the name again. */
+STypeHandle InternTypeName(const char* pkTypeName)
+{
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    uint32 TypeHash = CCRC32::StaticHashString(pkTypeName);
+
+    if (gHashToTypeName.find(TypeHash) == gHashToTypeName.end())
+        gHashToTypeName.emplace(TypeHash, TString(pkTypeName));
+
+    return STypeHandle { TypeHash };
+}
+
+/** Returns the type name that a handle was interned from. */
+const char* GetTypeName(STypeHandle Type)
+{
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    auto Find = gHashToTypeName.find(Type.Hash);
+    return (Find == gHashToTypeName.end() ? "Unknown" : *Find->second);
 }
 
 /** Calculate the property ID of a given name/type. */
@@ -269,43 +350,69 @@ uint32 CalculatePropertyID(const char* pkName, const char* pkTypeName)
 /** Returns whether the specified ID is in the map. */
 bool IsValidPropertyID(uint32 ID, const char* pkTypeName, bool* pOutIsValid /*= nullptr*/)
 {
-    SNameKey Key = CreateKey(ID, pkTypeName);
-    auto MapFind = gNameMap.find(Key);
+    return IsValidPropertyID( ID, STypeHandle { CCRC32::StaticHashString(pkTypeName) }, pOutIsValid );
+}
+
+bool IsValidPropertyID(uint32 ID, STypeHandle Type, bool* pOutIsValid /*= nullptr*/)
+{
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    SNameValue* pValue = FindName( SNameKey(Type.Hash, ID) );
 
-    if (MapFind != gNameMap.end())
+    if (pValue != nullptr)
     {
         if (pOutIsValid != nullptr)
         {
-            SNameValue& Value = MapFind->second;
-            *pOutIsValid = Value.IsValid;
+            *pOutIsValid = pValue->IsValid;
         }
         return true;
     }
     else return false;
 }
 
+/** Checks a batch of property IDs against the map. */
+void VerifyPropertyIDs(const std::vector<SPropertyIDQuery>& kQueries, std::vector<EPropertyIDStatus>& OutStatus)
+{
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    OutStatus.resize(kQueries.size());
+
+    for (uint32 QueryIdx = 0; QueryIdx < kQueries.size(); QueryIdx++)
+    {
+        const SPropertyIDQuery& kQuery = kQueries[QueryIdx];
+        SNameValue* pValue = FindName( SNameKey(kQuery.Type.Hash, kQuery.ID) );
+
+        if (!pValue)
+            OutStatus[QueryIdx] = EPropertyIDStatus::NotInMap;
+        else
+            OutStatus[QueryIdx] = (pValue->IsValid ? EPropertyIDStatus::NamedCorrectly : EPropertyIDStatus::InMap);
+    }
+}
+
 /** Retrieves a list of all properties that match the requested property ID. */
 void RetrievePropertiesWithID(uint32 ID, const char* pkTypeName, std::list<IProperty*>& OutList)
 {
-    SNameKey Key = CreateKey(ID, pkTypeName);
-    auto MapFind = gNameMap.find(Key);
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    SNameValue* pValue = FindName( CreateKey(ID, pkTypeName) );
 
-    if (MapFind != gNameMap.end())
+    if (pValue != nullptr)
     {
-        SNameValue& Value = MapFind->second;
-        OutList = Value.PropertyList;
+        OutList = pValue->PropertyList;
     }
 }
 
 /** Retrieves a list of all XML templates that contain a given property ID. */
 void RetrieveXMLsWithProperty(uint32 ID, const char* pkTypeName, std::set<TString>& OutSet)
 {
-    SNameKey Key = CreateKey(ID, pkTypeName);
-    auto MapFind = gNameMap.find(Key);
+    RetrieveXMLsWithProperty( ID, STypeHandle { CCRC32::StaticHashString(pkTypeName) }, OutSet );
+}
 
-    if (MapFind != gNameMap.end())
+void RetrieveXMLsWithProperty(uint32 ID, STypeHandle Type, std::set<TString>& OutSet)
+{
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    SNameValue* pValue = FindName( SNameKey(Type.Hash, ID) );
+
+    if (pValue != nullptr)
     {
-        SNameValue& NameValue = MapFind->second;
+        SNameValue& NameValue = *pValue;
 
         for (auto ListIter = NameValue.PropertyList.begin(); ListIter != NameValue.PropertyList.end(); ListIter++)
         {
@@ -318,6 +425,7 @@ void RetrieveXMLsWithProperty(uint32 ID, const char* pkTypeName, std::set<TStrin
 /** Updates the name of a given property in the map */
 void SetPropertyName(uint32 ID, const char* pkTypeName, const char* pkNewName)
 {
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     if( gkUseLegacyMapForUpdates )
     {
         auto Iter = gLegacyNameMap.find(ID);
@@ -330,12 +438,11 @@ void SetPropertyName(uint32 ID, const char* pkTypeName, const char* pkNewName)
     }
     else
     {
-        SNameKey Key = CreateKey(ID, pkTypeName);
-        auto MapFind = gNameMap.find(Key);
+        SNameValue* pValue = FindName( CreateKey(ID, pkTypeName) );
 
-        if (MapFind != gNameMap.end())
+        if (pValue != nullptr)
         {
-            SNameValue& Value = MapFind->second;
+            SNameValue& Value = *pValue;
 
             if (Value.Name != pkNewName)
             {
@@ -362,6 +469,7 @@ void SetPropertyName(uint32 ID, const char* pkTypeName, const char* pkNewName)
 /** Change a type name of a property. */
 void ChangeTypeName(IProperty* pProperty, const char* pkOldTypeName, const char* pkNewTypeName)
 {
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     uint32 OldTypeHash = CCRC32::StaticHashString(pkOldTypeName);
     uint32 NewTypeHash = CCRC32::StaticHashString(pkNewTypeName);
 
@@ -386,30 +494,28 @@ void ChangeTypeName(IProperty* pProperty, const char* pkOldTypeName, const char*
 
             // Disassociate this property from the old mapping.
             bool WasRegistered = false;
-            auto Find = gNameMap.find(OldKey);
+            SNameValue* pValue = FindName(OldKey);
 
-            if (Find != gNameMap.end())
+            if (pValue != nullptr)
             {
-                SNameValue& Value = Find->second;
-                WasRegistered = NBasics::ListRemoveOne(Value.PropertyList, pProperty);
+                WasRegistered = NBasics::ListRemoveOne(pValue->PropertyList, pProperty);
             }
 
             // Create a key for the new property and add it to the list.
-            Find = gNameMap.find(NewKey);
+            pValue = FindName(NewKey);
 
-            if (Find == gNameMap.end())
+            if (pValue == nullptr)
             {
                 SNameValue Value;
                 Value.Name = pProperty->Name();
                 Value.IsValid = ( CalculatePropertyID(*Value.Name, pkNewTypeName) == pProperty->ID() );
-                gNameMap[NewKey] = Value;
-                Find = gNameMap.find(NewKey);
+                pValue = AddName(NewKey, Value);
             }
-            ASSERT(Find != gNameMap.end());
+            ASSERT(pValue != nullptr);
 
             if (WasRegistered)
             {
-                Find->second.PropertyList.push_back(pProperty);
+                pValue->PropertyList.push_back(pProperty);
             }
 
             gMapIsDirty = true;
@@ -422,6 +528,7 @@ void ChangeTypeName(IProperty* pProperty, const char* pkOldTypeName, const char*
 /** Change a type name. */
 void ChangeTypeNameGlobally(const char* pkOldTypeName, const char* pkNewTypeName)
 {
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     uint32 OldTypeHash = CCRC32::StaticHashString(pkOldTypeName);
     uint32 NewTypeHash = CCRC32::StaticHashString(pkNewTypeName);
 
@@ -452,6 +559,7 @@ void ChangeTypeNameGlobally(const char* pkOldTypeName, const char* pkNewTypeName
         }
     }
 
+    RebuildIndex();
     RegisterTypeName(NewTypeHash, pkNewTypeName);
     gHashToTypeName[NewTypeHash] = pkNewTypeName;
 }
@@ -459,6 +567,7 @@ void ChangeTypeNameGlobally(const char* pkOldTypeName, const char* pkNewTypeName
 /** Registers a property in the name map. Should be called on all properties that use the map */
 void RegisterProperty(IProperty* pProperty)
 {
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
     ConditionalLoadMap();
 
     // Sanity checks to make sure we don't accidentally add non-hash property IDs to the map.
@@ -467,7 +576,7 @@ void RegisterProperty(IProperty* pProperty)
 
     // Just need to register the property in the list.
     SNameKey Key = CreateKey(pProperty);
-    auto MapFind = gNameMap.find(Key);
+    SNameValue* pValue = FindName(Key);
 
     if( gkUseLegacyMapForNameLookups )
     {
@@ -475,7 +584,7 @@ void RegisterProperty(IProperty* pProperty)
         // from the legacy map, and create an entry in gNameMap with it.
 
         //@todo this prob isn't the most efficient way to do this
-        if (MapFind == gNameMap.end())
+        if (pValue == nullptr)
         {
             auto LegacyMapFind = gLegacyNameMap.find( pProperty->ID() );
             ASSERT( LegacyMapFind != gLegacyNameMap.end() );
@@ -485,65 +594,58 @@ void RegisterProperty(IProperty* pProperty)
             Value.IsValid = ( CalculatePropertyID(*Value.Name, pProperty->HashableTypeName()) == pProperty->ID() );
             pProperty->SetName(Value.Name);
 
-            gNameMap[Key] = Value;
-            MapFind = gNameMap.find(Key);
-            ASSERT(MapFind != gNameMap.end());
-
+            pValue = AddName(Key, Value);
             RegisterTypeName(Key.TypeHash, pProperty->HashableTypeName());
         }
     }
     else
     {
         // If we didn't find the property name, check for int<->choice conversions
-        if (MapFind == gNameMap.end())
+        if (pValue == nullptr)
         {
             if (pProperty->Type() == EPropertyType::Int)
             {
                 uint32 ChoiceHash = CCRC32::StaticHashString("choice");
-                SNameKey ChoiceKey(ChoiceHash, pProperty->ID());
-                MapFind = gNameMap.find(ChoiceKey);
+                pValue = FindName( SNameKey(ChoiceHash, pProperty->ID()) );
             }
             else if (pProperty->Type() == EPropertyType::Choice)
             {
                 uint32 IntHash = CCRC32::StaticHashString("int");
-                SNameKey IntKey(IntHash, pProperty->ID());
-                MapFind = gNameMap.find(IntKey);
+                pValue = FindName( SNameKey(IntHash, pProperty->ID()) );
             }
         }
 
         // If we still didn't find it, register the property name in the map
-        if (MapFind == gNameMap.end())
+        if (pValue == nullptr)
         {
             SNameValue Value;
             Value.Name = "Unknown";
             Value.IsValid = false;
-            gNameMap[Key] = Value;
-            MapFind = gNameMap.find(Key);
+            pValue = AddName(Key, Value);
             RegisterTypeName(Key.TypeHash, pProperty->HashableTypeName());
         }
 
-        // We should have a valid iterator at this point no matter what.
-        ASSERT(MapFind != gNameMap.end());
-        pProperty->SetName( MapFind->second.Name );
+        // We should have a valid entry at this point no matter what.
+        ASSERT(pValue != nullptr);
+        pProperty->SetName( pValue->Name );
     }
 
-    MapFind->second.PropertyList.push_back(pProperty);
+    pValue->PropertyList.push_back(pProperty);
 
     // Update the property's Name field to match the mapped name.
-    pProperty->SetName( MapFind->second.Name );
+    pProperty->SetName( pValue->Name );
 }
 
 /** Unregisters a property from the name map. Should be called on all properties that use the map on destruction. */
 void UnregisterProperty(IProperty* pProperty)
 {
-    SNameKey Key = CreateKey(pProperty);
-    auto Iter = gNameMap.find(Key);
+    std::lock_guard<std::recursive_mutex> Lock(gMapMutex);
+    SNameValue* pValue = FindName( CreateKey(pProperty) );
 
-    if (Iter != gNameMap.end())
+    if (pValue != nullptr)
     {
         // Found the value, now remove the element from the list.
-        SNameValue& Value = Iter->second;
-        NBasics::ListRemoveOne(Value.PropertyList, pProperty);
+        NBasics::ListRemoveOne(pValue->PropertyList, pProperty);
     }
 }
 
@@ -551,12 +653,19 @@ void UnregisterProperty(IProperty* pProperty)
 class CIteratorImpl
 {
 public:
+    // The map is locked for as long as the iterator exists, so the template preload thread can't modify it mid-iteration
+    std::unique_lock<std::recursive_mutex> mLock;
     std::map<SNameKey, SNameValue>::const_iterator mIter;
+
+    CIteratorImpl()
+        : mLock(gMapMutex)
+    {}
 };
 
 CIterator::CIterator()
 {
     mpImpl = new CIteratorImpl;
+    ConditionalLoadMap();
     mpImpl->mIter = gNameMap.begin();
 }
 
@@ -575,6 +684,11 @@ const char* CIterator::Name() const
     return *mpImpl->mIter->second.Name;
 }
 
+STypeHandle CIterator::Type() const
+{
+    return STypeHandle { mpImpl->mIter->first.TypeHash };
+}
+
 const char* CIterator::TypeName() const
 {
     uint32 TypeHash = mpImpl->mIter->first.TypeHash;
@@ -3,11 +3,35 @@
 
 #include <Common/BasicTypes.h>
 #include "Core/Resource/Script/Property/IProperty.h"
+#include <vector>
 
 /** NPropertyMap: Namespace for property ID -> name mappings */
 namespace NPropertyMap
 {
 
+/** Handle for an interned type name. This is the type name hash used in map keys, so lookups
+ *  through a handle don't have to hash the type name again on every call.
+ */
+struct STypeHandle
+{
+    uint32 Hash;
+};
+
+/** Result of checking a property ID against the map */
+enum class EPropertyIDStatus : uint8
+{
+    NotInMap,       // No property with this ID and type
+    InMap,          // In the map, but its current name doesn't hash to the ID
+    NamedCorrectly  // In the map, and its current name hashes to the ID
+};
+
+/** Query for VerifyPropertyIDs */
+struct SPropertyIDQuery
+{
+    uint32 ID;
+    STypeHandle Type;
+};
+
 /** Loads property names into memory */
 void LoadMap();
 
@@ -21,6 +45,13 @@ const char* GetPropertyName(IProperty* pProperty);
  *  This requires you to provide the exact type string used in the hash.
  */
 const char* GetPropertyName(uint32 ID, const char* pkTypeName);
+const char* GetPropertyName(uint32 ID, STypeHandle Type);
+
+/** Interns a type name, returning a handle that can be used for lookups without hashing the name again. */
+STypeHandle InternTypeName(const char* pkTypeName);
+
+/** Returns the type name that a handle was interned from. */
+const char* GetTypeName(STypeHandle Type);
 
 /** Calculate the property ID of a given name/type. */
 uint32 CalculatePropertyID(const char* pkName, const char* pkTypeName);
@@ -30,12 +61,19 @@ uint32 CalculatePropertyID(const char* pkName, const char* pkTypeName);
  *  If the ID is valid and pOutIsValid is non-null, it will return whether the current name is correct.
  */
 bool IsValidPropertyID(uint32 ID, const char* pkTypeName, bool* pOutIsValid = nullptr);
+bool IsValidPropertyID(uint32 ID, STypeHandle Type, bool* pOutIsValid = nullptr);
+
+/** Checks a batch of property IDs against the map. This takes the map lock once for the whole batch,
+ *  rather than once per ID like IsValidPropertyID. OutStatus receives one entry per query.
+ */
+void VerifyPropertyIDs(const std::vector<SPropertyIDQuery>& kQueries, std::vector<EPropertyIDStatus>& OutStatus);
 
 /** Retrieves a list of all properties that match the requested property ID. */
 void RetrievePropertiesWithID(uint32 ID, const char* pkTypeName, std::list<IProperty*>& OutList);
 
 /** Retrieves a list of all XML templates that contain a given property ID. */
 void RetrieveXMLsWithProperty(uint32 ID, const char* pkTypeName, std::set<TString>& OutSet);
+void RetrieveXMLsWithProperty(uint32 ID, STypeHandle Type, std::set<TString>& OutSet);
 
 /** Updates the name of a given property in the map */
 void SetPropertyName(uint32 ID, const char* pkTypeName, const char* pkNewName);
@@ -52,7 +90,7 @@ void RegisterProperty(IProperty* pProperty);
 /** Unregisters a property from the name map. Should be called on all properties that use the map on destruction. */
 void UnregisterProperty(IProperty* pProperty);
 
-/** Class that allows for iteration through the name map */
+/** Class that allows for iteration through the name map. The map is locked to other threads while an iterator exists. */
 class CIterator
 {
     /** Private implementation */
@@ -64,6 +102,7 @@ public:
 
     uint32 ID() const;
     const char* Name() const;
+    STypeHandle Type() const;
     const char* TypeName() const;
 
     operator bool() const;
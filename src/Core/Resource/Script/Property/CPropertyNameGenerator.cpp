@@ -1,8 +1,16 @@
 #include "CPropertyNameGenerator.h"
 #include "IUIRelay.h"
+#include "Core/CRC32Util.h"
+#include "Core/ParallelUtil.h"
+#include "Core/TFlatHashSet.h"
 #include "Core/Resource/Script/CGameTemplate.h"
 #include "Core/Resource/Script/NPropertyMap.h"
-#include <Common/Hash/CCRC32.h>
+#include <Common/CTimer.h>
+#include <algorithm>
+
+/** Maximum size of the lookup table for meet in the middle generation. Each state costs 16 bytes in the table plus
+ *  up to 8 bytes in the hash set, so this caps the lookup table at around 200 MB */
+const uint64 gkMaxBackwardStates = 8 * 1024 * 1024;
 
 /** Default constructor */
 CPropertyNameGenerator::CPropertyNameGenerator()
@@ -10,35 +18,48 @@ CPropertyNameGenerator::CPropertyNameGenerator()
     , mWordListLoadFinished(false)
     , mIsRunning(false)
     , mFinishedRunning(false)
+    , mNumHashesTested(0)
+    , mLastRunTime(0.0)
 {
 }
 
 void CPropertyNameGenerator::Warmup()
 {
     // Clear output from previous runs
-    ASSERT(!mWordListLoadStarted || mWordListLoadFinished);
-    mWordListLoadFinished = false;
-    mWordListLoadStarted = true;
-    mWords.clear();
+    {
+        std::lock_guard<std::mutex> Lock(mWordListMutex);
+        ASSERT(!mWordListLoadStarted || mWordListLoadFinished);
+        mWordListLoadFinished = false;
+        mWordListLoadStarted = true;
+    }
 
     // Load the word list from the file
+    std::vector<SWord> Words;
     FILE* pListFile = fopen("../resources/WordList.txt", "r");
     ASSERT(pListFile);
 
-    while (!feof(pListFile))
+    char WordBuffer[64];
+
+    while (fgets(&WordBuffer[0], 64, pListFile))
     {
-        char WordBuffer[64];
-        fgets(&WordBuffer[0], 64, pListFile);
         WordBuffer[0] = TString::CharToUpper(WordBuffer[0]);
 
         SWord Word;
         Word.Word = TString(WordBuffer).Trimmed();
         Word.Usages = 0;
-        mWords.push_back(Word);
+
+        if (!Word.Word.IsEmpty())
+            Words.push_back(Word);
     }
 
     fclose(pListFile);
-    mWordListLoadFinished = true;
+
+    {
+        std::lock_guard<std::mutex> Lock(mWordListMutex);
+        mWords = std::move(Words);
+        mWordListLoadFinished = true;
+    }
+    mWordListCondition.notify_all();
 }
 
 void CPropertyNameGenerator::Generate(const SPropertyNameGenerationParameters& rkParams, IProgressNotifier* pProgress)
@@ -76,180 +97,539 @@ void CPropertyNameGenerator::Generate(const SPropertyNameGenerationParameters& r
 
     // If we haven't loaded the word list yet, load it.
     // If we are still loading the word list, wait until we're finished.
-    if (!mWordListLoadFinished)
     {
-        if (mWordListLoadStarted)
-            while (!mWordListLoadFinished) {}
-        else
+        std::unique_lock<std::mutex> Lock(mWordListMutex);
+
+        if (!mWordListLoadStarted)
+        {
+            Lock.unlock();
             Warmup();
+        }
+        else
+            mWordListCondition.wait(Lock, [this]() { return mWordListLoadFinished; });
+    }
+
+    // Everything below relies on CRC32Util producing the same hashes as CCRC32
+    if (!CRC32Util::MatchesCCRC32())
+    {
+        errorf("CRC32Util doesn't match CCRC32; can't generate property names");
+        mIsRunning = false;
+        mFinishedRunning = true;
+        return;
     }
 
     // Calculate the number of steps involved in this task.
-    const int kNumWords = mWords.size();
-    const int kMaxWords = rkParams.MaxWords;
-    int TestsDone = 0;
-    int TotalTests = 1;
+    const uint32 kNumWords = mWords.size();
+    const uint32 kNumTypes = mTypeNames.size();
+    const uint32 kMaxWords = rkParams.MaxWords;
+    double TotalTests = 0.0;
+    double NumCombinations = 1.0;
 
-    for (int i = 0; i < kMaxWords; i++)
-        TotalTests *= kNumWords;
+    for (uint32 i = 0; i < kMaxWords; i++)
+    {
+        NumCombinations *= kNumWords;
+        TotalTests += NumCombinations;
+    }
 
     pProgress->SetOneShotTask("Generating property names");
-    pProgress->Report(TestsDone, TotalTests);
+    pProgress->Report(0, 1);
+    double StartTime = CTimer::GlobalTime();
 
     // Configure params needed to run the name generation!
     bool WriteToLog = rkParams.PrintToLog;
     bool SaveResults = true;
 
+    // CRC32 is linear, so every name doesn't need to be hashed byte by byte. Appending a string to a
+    // hash is Advance(Hash, Length) ^ Hash(0, String), and Advance is a few table lookups (see CRC32Util).
+    // So we precalculate the zero-state hash of every word, as it appears after the first word of a name
+    // (with an underscore in front for snake case), and one advance table per distinct word length.
+    std::vector<uint32> WordHashes(kNumWords);
+    std::vector<uint32> WordLengthIndices(kNumWords);
+    std::vector<uint32> WordLengths;
+    std::vector<CRC32Util::CAdvanceTable> LengthTables;
+
+    for (uint32 WordIdx = 0; WordIdx < kNumWords; WordIdx++)
+    {
+        TString Word = mWords[WordIdx].Word;
+
+        if (rkParams.Casing == ENameCasing::Snake_Case)
+            Word = TString("_") + Word;
+
+        WordHashes[WordIdx] = CRC32Util::Hash(0, *Word, Word.Size());
+
+        auto Find = std::find(WordLengths.begin(), WordLengths.end(), Word.Size());
+        WordLengthIndices[WordIdx] = Find - WordLengths.begin();
+
+        if (Find == WordLengths.end())
+        {
+            WordLengths.push_back(Word.Size());
+            LengthTables.emplace_back(Word.Size());
+        }
+    }
+
+    // The suffix and type name go at the end of every name. Combined with the word hashes above, we can
+    // precalculate everything the last word of a name contributes to the final hash, for every type.
+    std::vector<uint32> TailHashes(kNumTypes);
+    std::vector<CRC32Util::CAdvanceTable> TailTables(kNumTypes);
+
+    for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+    {
+        TString Tail = rkParams.Suffix + mTypeNames[TypeIdx];
+        TailHashes[TypeIdx] = CRC32Util::Hash(0, *Tail, Tail.Size());
+        TailTables[TypeIdx].Init(Tail.Size());
+    }
+
+    std::vector<uint32> LastWordHashes(kNumWords * kNumTypes);
+
+    for (uint32 WordIdx = 0; WordIdx < kNumWords; WordIdx++)
+    {
+        for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+            LastWordHashes[WordIdx * kNumTypes + TypeIdx] = TailTables[TypeIdx].Apply(WordHashes[WordIdx]) ^ TailHashes[TypeIdx];
+    }
+
+    // The first word is hashed onto the prefix directly since it's handled differently for camel case.
     // The prefix only needs to be hashed this one time
-    CCRC32 PrefixHash;
-    PrefixHash.Hash( *rkParams.Prefix );
+    uint32 PrefixHash = CRC32Util::HashString( *rkParams.Prefix );
+    std::vector<uint32> FirstWordHashes(kNumWords);
 
-    // Use a stack to keep track of the current word we are on. We can use this
-    // to cache the hash of a word and then re-use it later instead of recaculating
-    // the same hashes over and over. Init the stack with the first word.
-    struct SWordCache
+    for (uint32 WordIdx = 0; WordIdx < kNumWords; WordIdx++)
     {
-        int WordIndex;
-        CCRC32 Hash;
-    };
-    std::vector<SWordCache> WordCache;
+        const char* pkWord = *mWords[WordIdx].Word;
+
+        // For camelcase, hash the first letter of the first word as lowercase
+        if (rkParams.Casing == ENameCasing::camelCase)
+        {
+            char FirstChar = TString::CharToLower( pkWord[0] );
+            uint32 State = CRC32Util::Hash(PrefixHash, &FirstChar, 1);
+            FirstWordHashes[WordIdx] = CRC32Util::Hash(State, &pkWord[1]);
+        }
+        else
+            FirstWordHashes[WordIdx] = CRC32Util::Hash(PrefixHash, pkWord);
+    }
+
+    // Interned type names, so candidates can be checked against the property map without rehashing the type
+    std::vector<NPropertyMap::STypeHandle> TypeHandles(kNumTypes);
+    std::vector<bool> IsChoiceType(kNumTypes);
+    const NPropertyMap::STypeHandle kIntHandle = NPropertyMap::InternTypeName("int");
+
+    for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+    {
+        TypeHandles[TypeIdx] = NPropertyMap::InternTypeName(*mTypeNames[TypeIdx]);
+        IsChoiceType[TypeIdx] = rkParams.TestIntsAsChoices && (mTypeNames[TypeIdx] == "choice");
+    }
 
-    SWordCache FirstWord { -1, CCRC32() };
-    WordCache.push_back(FirstWord);
+    // Flat set of every ID that could be a match. Candidates in the set still go through IsValidPropertyID
+    // to check the type, but they're rare enough that the full check doesn't cost anything.
+    TFlatHashSet<uint32> TargetIDs;
 
-    while ( true )
+    if (!mValidTypePairMap.empty())
+    {
+        TargetIDs.Reserve(mValidTypePairMap.size());
+
+        for (auto Iter = mValidTypePairMap.begin(); Iter != mValidTypePairMap.end(); Iter++)
+            TargetIDs.Insert(Iter->first);
+    }
+    else
     {
-        // Increment the current word, handle wrapping back to 0, and update cached hashes as needed.
-        int RecalcIndex = WordCache.size() - 1;
-        WordCache.back().WordIndex++;
+        // Only IDs of the types being tested can match
+        TFlatHashSet<uint32> TypeHashes;
+
+        for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+            TypeHashes.Insert(TypeHandles[TypeIdx].Hash);
+
+        if (rkParams.TestIntsAsChoices)
+            TypeHashes.Insert(kIntHandle.Hash);
+
+        for (NPropertyMap::CIterator Iter; Iter; ++Iter)
+        {
+            if (TypeHashes.Contains(Iter.Type().Hash))
+                TargetIDs.Insert(Iter.ID());
+        }
+    }
+
+    // Meet in the middle: since the steps above are all invertible, for every target ID we can work out
+    // the hash the name needs to have before each possible last word + suffix + type. Those go in a table
+    // sorted by hash, and then only the words before the last one need to be enumerated, with one lookup
+    // each instead of testing every last word. Each ID only gets states for its own type (and for choice,
+    // if it's an int being tested as a choice), since no other type can produce a valid match.
+    struct SBackwardState
+    {
+        uint32 Hash;
+        uint32 PropertyID;
+        uint32 WordIdx;
+        uint32 TypeIdx;
+    };
+    std::vector<SBackwardState> BackwardStates;
+    TFlatHashSet<uint32> BackwardHashes;
+    bool UseMeetInTheMiddle = (rkParams.Mode == ENameGenerationMode::MeetInTheMiddle);
+
+    if (UseMeetInTheMiddle)
+    {
+        struct SPoolID
+        {
+            uint32 PropertyID;
+            uint32 TypeIdx;
+        };
+        std::vector<SPoolID> PoolIDs;
+        PoolIDs.reserve(mValidTypePairMap.size());
+
+        uint32 ChoiceTypeIdx = std::find(mTypeNames.begin(), mTypeNames.end(), TString("choice")) - mTypeNames.begin();
+
+        for (auto Iter = mValidTypePairMap.begin(); Iter != mValidTypePairMap.end(); Iter++)
+        {
+            uint32 TypeIdx = std::find(mTypeNames.begin(), mTypeNames.end(), TString(Iter->second)) - mTypeNames.begin();
+            PoolIDs.push_back( SPoolID { Iter->first, TypeIdx } );
+
+            if (rkParams.TestIntsAsChoices && ChoiceTypeIdx < kNumTypes && strcmp(Iter->second, "int") == 0)
+                PoolIDs.push_back( SPoolID { Iter->first, ChoiceTypeIdx } );
+        }
+
+        uint64 NumStates = (uint64) PoolIDs.size() * kNumWords;
 
-        while (WordCache[RecalcIndex].WordIndex >= kNumWords)
+        if (PoolIDs.empty())
         {
-            WordCache[RecalcIndex].WordIndex = 0;
+            warnf("Meet in the middle name generation requires an ID pool; falling back to a forward search");
+            UseMeetInTheMiddle = false;
+        }
+        else if (NumStates > gkMaxBackwardStates)
+        {
+            warnf("ID pool is too large for meet in the middle name generation (%llu states, limit is %llu); falling back to a forward search",
+                  (unsigned long long) NumStates, (unsigned long long) gkMaxBackwardStates);
+            UseMeetInTheMiddle = false;
+        }
+        else
+        {
+            pProgress->Report("Preparing lookup table");
+
+            std::vector<CRC32Util::CAdvanceTable> InverseLengthTables(LengthTables.size());
+            std::vector<CRC32Util::CAdvanceTable> InverseTailTables(kNumTypes);
 
-            if (RecalcIndex > 0)
+            for (uint32 LengthIdx = 0; LengthIdx < LengthTables.size(); LengthIdx++)
+                InverseLengthTables[LengthIdx].Init(WordLengths[LengthIdx], true);
+
+            for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+                InverseTailTables[TypeIdx].Init((rkParams.Suffix + mTypeNames[TypeIdx]).Size(), true);
+
+            BackwardStates.resize(NumStates);
+
+            ParallelUtil::ParallelFor(PoolIDs.size(), [&](uint32 PoolIdx)
             {
-                RecalcIndex--;
-                WordCache[RecalcIndex].WordIndex++;
-            }
-            else
+                uint32 PropertyID = PoolIDs[PoolIdx].PropertyID;
+                uint32 TypeIdx = PoolIDs[PoolIdx].TypeIdx;
+                SBackwardState* pState = &BackwardStates[(uint64) PoolIdx * kNumWords];
+
+                // Undo the suffix/type, then the last word
+                uint32 BeforeTail = InverseTailTables[TypeIdx].Apply(PropertyID ^ TailHashes[TypeIdx]);
+
+                for (uint32 WordIdx = 0; WordIdx < kNumWords; WordIdx++)
+                {
+                    pState->Hash = InverseLengthTables[ WordLengthIndices[WordIdx] ].Apply(BeforeTail ^ WordHashes[WordIdx]);
+                    pState->PropertyID = PropertyID;
+                    pState->WordIdx = WordIdx;
+                    pState->TypeIdx = TypeIdx;
+                    pState++;
+                }
+            });
+
+            std::sort(BackwardStates.begin(), BackwardStates.end(), [](const SBackwardState& rkLeft, const SBackwardState& rkRight) {
+                return rkLeft.Hash < rkRight.Hash;
+            });
+
+            BackwardHashes.Reserve(BackwardStates.size());
+
+            for (const SBackwardState& rkState : BackwardStates)
+                BackwardHashes.Insert(rkState.Hash);
+        }
+    }
+
+    // Called with ResultMutex held for every candidate that turned out to be a valid property ID
+    std::mutex ResultMutex;
+
+    auto AddResult = [&](const std::vector<int>& rkWordIndices, const char* pkTypeName, NPropertyMap::STypeHandle Type, uint32 PropertyID)
+    {
+        SGeneratedPropertyName PropertyName;
+        NPropertyMap::RetrieveXMLsWithProperty(PropertyID, Type, PropertyName.XmlList);
+
+        // Generate a string with the complete name. (We wait to do this until now to avoid needless string allocation)
+        PropertyName.Name = rkParams.Prefix;
+
+        for (uint32 WordIdx = 0; WordIdx < rkWordIndices.size(); WordIdx++)
+        {
+            int Index = rkWordIndices[WordIdx];
+
+            if (WordIdx > 0 && rkParams.Casing == ENameCasing::Snake_Case)
             {
-                SWordCache NewWord { 0, CCRC32() };
-                WordCache.push_back(NewWord);
+                PropertyName.Name += "_";
             }
+
+            PropertyName.Name += mWords[Index].Word;
         }
 
-        // If we've hit the word limit, break out and end the name generation system.
-        if (WordCache.size() > kMaxWords)
-            break;
+        if (rkParams.Casing == ENameCasing::camelCase)
+        {
+            PropertyName.Name[0] = TString::CharToLower( PropertyName.Name[0] );
+        }
 
-        // Now that all words are updated, calculate the new hashes.
-        CCRC32 LastValidHash = (RecalcIndex > 0 ? WordCache[RecalcIndex-1].Hash : PrefixHash);
+        PropertyName.Name += rkParams.Suffix;
+        PropertyName.Type = pkTypeName;
+        PropertyName.ID = PropertyID;
 
-        for (; RecalcIndex < WordCache.size(); RecalcIndex++)
+        if (SaveResults)
         {
-            int Index = WordCache[RecalcIndex].WordIndex;
+            mGeneratedNames.push_back(PropertyName);
 
-            // For camelcase, hash the first letter of the first word as lowercase
-            if (RecalcIndex == 0 && rkParams.Casing == ENameCasing::camelCase)
+            // Check if we have too many saved results. This can cause memory issues and crashing.
+            // If we have too many saved results, then to avoid crashing we will force enable log output.
+            if (mGeneratedNames.size() > 9999)
             {
-                const char* pkWord = *mWords[Index].Word;
-                LastValidHash.Hash( TString::CharToLower( pkWord[0] ) );
-                LastValidHash.Hash( &pkWord[1] );
+                gpUIRelay->AsyncMessageBox("Warning", "There are over 10,000 results. Results will no longer print to the screen. Check the log for the remaining output.");
+                WriteToLog = true;
+                SaveResults = false;
             }
-            else
-            {
-                // Add an underscore for snake case
-                if (RecalcIndex > 0 && rkParams.Casing == ENameCasing::Snake_Case)
-                    LastValidHash.Hash("_");
+        }
 
-                LastValidHash.Hash( *mWords[Index].Word );
+        // Log this out
+        if ( WriteToLog )
+        {
+            TString DelimitedXmlList;
+
+            for (auto Iter = PropertyName.XmlList.begin(); Iter != PropertyName.XmlList.end(); Iter++)
+            {
+                DelimitedXmlList += *Iter + "\n";
             }
 
-            WordCache[RecalcIndex].Hash = LastValidHash;
+            debugf("%s [%s] : 0x%08X\n%s", *PropertyName.Name, *PropertyName.Type, PropertyName.ID, *DelimitedXmlList);
         }
+    };
+
+    // Names that hash to an ID in TargetIDs are collected per job, then checked in one batch, so the
+    // property map is locked once per batch rather than once per candidate.
+    struct SCandidate
+    {
+        std::vector<int> WordIndices;
+        uint32 TypeIdx;
+        uint32 PropertyID;
+    };
+    const uint32 kMaxCandidatesPerBatch = 256;
 
-        // We got our hash yay! Now hash the suffix and then we can test with each type name
-        CCRC32 BaseHash = LastValidHash;
-        BaseHash.Hash( *rkParams.Suffix );
+    auto FlushCandidates = [&](std::vector<SCandidate>& rCandidates)
+    {
+        if (rCandidates.empty())
+            return;
+
+        std::lock_guard<std::mutex> Lock(ResultMutex);
+
+        if (!mValidTypePairMap.empty())
+        {
+            for (const SCandidate& rkCandidate : rCandidates)
+            {
+                const char* pkTypeName = *mTypeNames[rkCandidate.TypeIdx];
 
-        for (int TypeIdx = 0; TypeIdx < mTypeNames.size(); TypeIdx++)
+                if (IsValidPropertyID(rkCandidate.PropertyID, pkTypeName, rkParams))
+                {
+                    bool IsInt = IsChoiceType[rkCandidate.TypeIdx] && strcmp(pkTypeName, "int") == 0;
+                    AddResult(rkCandidate.WordIndices, pkTypeName, IsInt ? kIntHandle : TypeHandles[rkCandidate.TypeIdx], rkCandidate.PropertyID);
+                }
+            }
+        }
+        else
         {
-            CCRC32 FullHash = BaseHash;
-            const char* pkTypeName = *mTypeNames[TypeIdx];
-            FullHash.Hash( pkTypeName );
-            uint32 PropertyID = FullHash.Digest();
+            // Check every candidate as its own type first, then check choices that weren't found as ints
+            std::vector<NPropertyMap::SPropertyIDQuery> Queries(rCandidates.size());
+            std::vector<NPropertyMap::EPropertyIDStatus> Status;
+            std::vector<NPropertyMap::EPropertyIDStatus> IntStatus;
+
+            for (uint32 CandidateIdx = 0; CandidateIdx < rCandidates.size(); CandidateIdx++)
+                Queries[CandidateIdx] = { rCandidates[CandidateIdx].PropertyID, TypeHandles[ rCandidates[CandidateIdx].TypeIdx ] };
 
-            // Check if this hash is a property ID
-            if (IsValidPropertyID(PropertyID, pkTypeName, rkParams))
+            NPropertyMap::VerifyPropertyIDs(Queries, Status);
+
+            if (rkParams.TestIntsAsChoices)
             {
-                SGeneratedPropertyName PropertyName;
-                NPropertyMap::RetrieveXMLsWithProperty(PropertyID, pkTypeName, PropertyName.XmlList);
+                for (NPropertyMap::SPropertyIDQuery& rQuery : Queries)
+                    rQuery.Type = kIntHandle;
+
+                NPropertyMap::VerifyPropertyIDs(Queries, IntStatus);
+            }
 
-                // Generate a string with the complete name. (We wait to do this until now to avoid needless string allocation)
-                PropertyName.Name = rkParams.Prefix;
+            for (uint32 CandidateIdx = 0; CandidateIdx < rCandidates.size(); CandidateIdx++)
+            {
+                const SCandidate& rkCandidate = rCandidates[CandidateIdx];
+                NPropertyMap::EPropertyIDStatus CandidateStatus = Status[CandidateIdx];
+                NPropertyMap::STypeHandle Type = TypeHandles[rkCandidate.TypeIdx];
+                const char* pkTypeName = *mTypeNames[rkCandidate.TypeIdx];
 
-                for (int WordIdx = 0; WordIdx < WordCache.size(); WordIdx++)
+                if (CandidateStatus == NPropertyMap::EPropertyIDStatus::NotInMap && IsChoiceType[rkCandidate.TypeIdx])
                 {
-                    int Index = WordCache[WordIdx].WordIndex;
+                    CandidateStatus = IntStatus[CandidateIdx];
+                    Type = kIntHandle;
+                    pkTypeName = "int";
+                }
 
-                    if (WordIdx > 0 && rkParams.Casing == ENameCasing::Snake_Case)
-                    {
-                        PropertyName.Name += "_";
-                    }
+                if (CandidateStatus == NPropertyMap::EPropertyIDStatus::NotInMap)
+                    continue;
 
-                    PropertyName.Name += mWords[Index].Word;
-                }
+                if (CandidateStatus == NPropertyMap::EPropertyIDStatus::NamedCorrectly && rkParams.ExcludeAccuratelyNamedProperties)
+                    continue;
+
+                AddResult(rkCandidate.WordIndices, pkTypeName, Type, rkCandidate.PropertyID);
+            }
+        }
+
+        rCandidates.clear();
+    };
+
+    // Split the work up by name length and first word. Names with only one word are all done in one job.
+    std::atomic<uint64> TestsDone(0);
+    std::atomic<bool> Canceled(false);
+    uint32 NumJobs = (kMaxWords > 0 ? 1 + (kMaxWords - 1) * kNumWords : 0);
+
+    auto RunJob = [&](uint32 JobIdx)
+    {
+        if (Canceled) return;
+        std::vector<SCandidate> Candidates;
+
+        if (JobIdx == 0)
+        {
+            std::vector<int> WordIndices(1);
 
-                if (rkParams.Casing == ENameCasing::camelCase)
+            for (uint32 WordIdx = 0; WordIdx < kNumWords; WordIdx++)
+            {
+                for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
                 {
-                    PropertyName.Name[0] = TString::CharToLower( PropertyName.Name[0] );
+                    uint32 PropertyID = TailTables[TypeIdx].Apply(FirstWordHashes[WordIdx]) ^ TailHashes[TypeIdx];
+
+                    if (TargetIDs.Contains(PropertyID))
+                    {
+                        WordIndices[0] = WordIdx;
+                        Candidates.push_back( SCandidate { WordIndices, TypeIdx, PropertyID } );
+                    }
                 }
+            }
+
+            FlushCandidates(Candidates);
+            TestsDone += kNumWords;
+            return;
+        }
+
+        const uint32 kNumNameWords = 2 + (JobIdx - 1) / kNumWords;
+        const uint32 kLastWord = kNumNameWords - 1;
+
+        // Hashes of the name up to and including each word. The words between the first and the last are
+        // enumerated like an odometer, and only the hashes after the word that changed are recalculated.
+        std::vector<int> WordIndices(kNumNameWords, 0);
+        std::vector<uint32> Hashes(kNumNameWords);
+        WordIndices[0] = (JobIdx - 1) % kNumWords;
+        Hashes[0] = FirstWordHashes[ WordIndices[0] ];
+
+        auto AppendWord = [&](uint32 Hash, uint32 WordIdx) -> uint32
+        {
+            return LengthTables[ WordLengthIndices[WordIdx] ].Apply(Hash) ^ WordHashes[WordIdx];
+        };
 
-                PropertyName.Name += rkParams.Suffix;
-                PropertyName.Type = pkTypeName;
-                PropertyName.ID = PropertyID;
+        for (uint32 WordIdx = 1; WordIdx < kLastWord; WordIdx++)
+            Hashes[WordIdx] = AppendWord(Hashes[WordIdx - 1], WordIndices[WordIdx]);
 
-                if (SaveResults)
+        // Base hash for each distinct last word length and type; combined with LastWordHashes to get the ID
+        std::vector<uint32> BaseHashes(LengthTables.size() * kNumTypes);
+
+        while (true)
+        {
+            uint32 PrefixWordsHash = Hashes[kLastWord - 1];
+
+            if (UseMeetInTheMiddle)
+            {
+                if (BackwardHashes.Contains(PrefixWordsHash))
                 {
-                    mGeneratedNames.push_back(PropertyName);
+                    auto Iter = std::lower_bound(BackwardStates.begin(), BackwardStates.end(), PrefixWordsHash,
+                        [](const SBackwardState& rkState, uint32 Hash) { return rkState.Hash < Hash; });
 
-                    // Check if we have too many saved results. This can cause memory issues and crashing.
-                    // If we have too many saved results, then to avoid crashing we will force enable log output.
-                    if (mGeneratedNames.size() > 9999)
+                    for (; Iter != BackwardStates.end() && Iter->Hash == PrefixWordsHash; Iter++)
                     {
-                        gpUIRelay->AsyncMessageBox("Warning", "There are over 10,000 results. Results will no longer print to the screen. Check the log for the remaining output.");
-                        WriteToLog = true;
-                        SaveResults = false;
+                        WordIndices[kLastWord] = Iter->WordIdx;
+                        Candidates.push_back( SCandidate { WordIndices, Iter->TypeIdx, Iter->PropertyID } );
                     }
                 }
+            }
+            else
+            {
+                for (uint32 LengthIdx = 0; LengthIdx < LengthTables.size(); LengthIdx++)
+                {
+                    uint32 Advanced = LengthTables[LengthIdx].Apply(PrefixWordsHash);
 
-                // Log this out
-                if ( WriteToLog )
+                    for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
+                        BaseHashes[LengthIdx * kNumTypes + TypeIdx] = TailTables[TypeIdx].Apply(Advanced);
+                }
+
+                for (uint32 WordIdx = 0; WordIdx < kNumWords; WordIdx++)
                 {
-                    TString DelimitedXmlList;
+                    const uint32* pkBase = &BaseHashes[ WordLengthIndices[WordIdx] * kNumTypes ];
+                    const uint32* pkLast = &LastWordHashes[ WordIdx * kNumTypes ];
 
-                    for (auto Iter = PropertyName.XmlList.begin(); Iter != PropertyName.XmlList.end(); Iter++)
+                    for (uint32 TypeIdx = 0; TypeIdx < kNumTypes; TypeIdx++)
                     {
-                        DelimitedXmlList += *Iter + "\n";
-                    }
+                        uint32 PropertyID = pkBase[TypeIdx] ^ pkLast[TypeIdx];
 
-                    debugf("%s [%s] : 0x%08X\n%s", *PropertyName.Name, *PropertyName.Type, PropertyName.ID, *DelimitedXmlList);
+                        if (TargetIDs.Contains(PropertyID))
+                        {
+                            WordIndices[kLastWord] = WordIdx;
+                            Candidates.push_back( SCandidate { WordIndices, TypeIdx, PropertyID } );
+                        }
+                    }
                 }
             }
-        }
 
-        // Every 250 tests, check with the progress notifier. Update the progress
-        // bar and check whether the user has requested to cancel the operation.
-        TestsDone++;
+            TestsDone += kNumWords;
 
-        if ( (TestsDone % 250) == 0 )
-        {
-            if (pProgress->ShouldCancel())
+            if (Candidates.size() >= kMaxCandidatesPerBatch)
+                FlushCandidates(Candidates);
+
+            if (Canceled)
+                break;
+
+            // Increment the middle words, handle wrapping back to 0, and update cached hashes as needed.
+            int RecalcIndex = kLastWord - 1;
+
+            while (RecalcIndex > 0)
+            {
+                if (++WordIndices[RecalcIndex] < (int) kNumWords)
+                    break;
+
+                WordIndices[RecalcIndex] = 0;
+                RecalcIndex--;
+            }
+
+            if (RecalcIndex <= 0)
                 break;
 
-            pProgress->Report(TestsDone, TotalTests);
+            for (uint32 WordIdx = RecalcIndex; WordIdx < kLastWord; WordIdx++)
+                Hashes[WordIdx] = AppendWord(Hashes[WordIdx - 1], WordIndices[WordIdx]);
         }
+
+        FlushCandidates(Candidates);
+    };
+
+    // Check with the progress notifier periodically. Update the progress bar
+    // and check whether the user has requested to cancel the operation.
+    ParallelUtil::ParallelFor(NumJobs, RunJob, 0, [&](uint32)
+    {
+        if (pProgress->ShouldCancel())
+        {
+            Canceled = true;
+            return false;
+        }
+
+        pProgress->Report((int) (TestsDone * 10000.0 / Math::Max(TotalTests, 1.0)), 10000);
+        return true;
+    });
+
+    mNumHashesTested = TestsDone * kNumTypes;
+    mLastRunTime = CTimer::GlobalTime() - StartTime;
+
+    if (rkParams.PrintToLog)
+    {
+        debugf("Tested %llu property names in %.2f seconds (%.0f hashes/sec)", (unsigned long long) mNumHashesTested, mLastRunTime,
+               (mLastRunTime > 0.0 ? mNumHashesTested / mLastRunTime : 0.0));
     }
 
     mIsRunning = false;
@@ -3,6 +3,9 @@
 
 #include "Core/IProgressNotifier.h"
 #include <Common/Common.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 /** Name casing parameter */
 enum class ENameCasing
@@ -12,6 +15,18 @@ enum class ENameCasing
     camelCase,
 };
 
+/** Search strategy */
+enum class ENameGenerationMode
+{
+    /** Hash every combination of words and check each one against the ID pool */
+    Forward,
+
+    /** Work backwards from every ID in the pool to the hash a name needs before its last word, then only enumerate
+     *  the words before the last one. Requires ValidIdPairs; much faster, at the cost of memory proportional to
+     *  the pool size times the word count. */
+    MeetInTheMiddle,
+};
+
 /** ID/type pairing for ID pool */
 struct SPropertyIdTypePair
 {
@@ -34,6 +49,9 @@ struct SPropertyNameGenerationParameters
     /** Name casing to use */
     ENameCasing Casing;
 
+    /** Search strategy to use */
+    ENameGenerationMode Mode;
+
     /** List of valid type suffixes */
     std::vector<TString> TypeNames;
 
@@ -62,6 +80,12 @@ struct SGeneratedPropertyName
 /** Generates property names and validates them against know property IDs. */
 class CPropertyNameGenerator
 {
+    /** Guards the word list load state */
+    std::mutex mWordListMutex;
+
+    /** Signaled when the word list finishes loading */
+    std::condition_variable mWordListCondition;
+
     /** Whether we have started loading the word list */
     bool mWordListLoadStarted;
 
@@ -69,10 +93,10 @@ class CPropertyNameGenerator
     bool mWordListLoadFinished;
 
     /** Whether the generation process is running */
-    bool mIsRunning;
+    std::atomic<bool> mIsRunning;
 
     /** Whether the generation process finished running */
-    bool mFinishedRunning;
+    std::atomic<bool> mFinishedRunning;
 
     /** List of valid property types to check against */
     std::vector<TString> mTypeNames;
@@ -91,8 +115,9 @@ class CPropertyNameGenerator
     /** List of output generated property names */
     std::list<SGeneratedPropertyName> mGeneratedNames;
 
-    /** List of word indices */
-    std::vector<int> mWordIndices;
+    /** Number of hashes checked and time taken by the last run */
+    uint64 mNumHashesTested;
+    double mLastRunTime;
 
 public:
     /** Default constructor */
@@ -117,6 +142,26 @@ public:
     {
         return mGeneratedNames;
     }
+
+    uint32 NumWords() const
+    {
+        return mWords.size();
+    }
+
+    const TString& GetWord(uint32 Index) const
+    {
+        return mWords[Index].Word;
+    }
+
+    uint64 NumHashesTested() const
+    {
+        return mNumHashesTested;
+    }
+
+    double LastRunTime() const
+    {
+        return mLastRunTime;
+    }
 };
 
 #endif // CPROPERTYNAMEGENERATOR_H
@@ -63,6 +63,22 @@ void CLightNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SView
     if (BoxResult.first) rTester.AddNode(this, 0, BoxResult.second);
 }
 
+bool CLightNode::SceneBounds(CAABox& rOutBounds) const
+{
+    CVector2f BillScale = BillboardScale();
+    float ScaleXY = (BillScale.X > BillScale.Y ? BillScale.X : BillScale.Y);
+
+    rOutBounds = AABox();
+    rOutBounds.ExpandBounds( CAABox(mPosition + CVector3f(-ScaleXY, -ScaleXY, -BillScale.Y),
+                                    mPosition + CVector3f( ScaleXY,  ScaleXY,  BillScale.Y)) );
+
+    // The radius sphere is drawn while selected
+    if (IsSelected() && mpLight->Type() == ELightType::Custom)
+        rOutBounds.ExpandBounds( (CAABox::skOne * 2.f * mpLight->GetRadius()) + mPosition );
+
+    return true;
+}
+
 SRayIntersection CLightNode::RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo)
 {
     // todo: come up with a better way to share this code between CScriptNode and CLightNode
@@ -136,6 +152,9 @@ void CLightNode::PropertyModified(IProperty* pProperty)
 
     if (pProperty->Name() == "Position")
         SetPosition( mpLight->Position() );
+
+    // The light's radius may have changed
+    MarkSceneBoundsChanged();
 }
 
 CLight* CLightNode::Light()
@@ -143,7 +162,7 @@ CLight* CLightNode::Light()
     return mpLight;
 }
 
-CVector2f CLightNode::BillboardScale()
+CVector2f CLightNode::BillboardScale() const
 {
     return AbsoluteScale().XZ() * 0.75f;
 }
@@ -14,12 +14,13 @@ public:
     void Draw(FRenderOptions Options, int ComponentIndex, ERenderCommand Command, const SViewInfo& ViewInfo);
     void DrawSelection();
     void RayAABoxIntersectTest(CRayCollisionTester& Tester, const SViewInfo& ViewInfo);
+    bool SceneBounds(CAABox& rOutBounds) const;
     SRayIntersection RayNodeIntersectTest(const CRay &Ray, uint32 AssetID, const SViewInfo& ViewInfo);
     CStructRef GetProperties() const;
     void PropertyModified(IProperty* pProperty);
     bool AllowsRotate() const { return false; }
     CLight* Light();
-    CVector2f BillboardScale();
+    CVector2f BillboardScale() const;
 
 protected:
     void CalculateTransform(CTransform4f& rOut) const;
@@ -38,7 +38,7 @@ void CModelNode::AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInfo
     // Transparent world models should have each surface processed separately
     if (mWorldModel && mpModel->HasTransparency(mActiveMatSet))
     {
-        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawOpaqueParts);
+        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawOpaqueParts, EDepthGroup::Midground, mpModel->StateSortKey(mActiveMatSet));
 
         for (uint32 iSurf = 0; iSurf < mpModel->GetSurfaceCount(); iSurf++)
         {
@@ -1,5 +1,8 @@
 #include "CScene.h"
 #include "CSceneIterator.h"
+#include "Core/GameProject/CAsyncLoader.h"
+#include "Core/GameProject/CResourceStore.h"
+#include "Core/Render/CCamera.h"
 #include "Core/Render/CGraphics.h"
 #include "Core/Resource/CPoiToWorld.h"
 #include "Core/Resource/Script/CScriptLayer.h"
@@ -9,7 +12,10 @@
 #include <Common/TString.h>
 #include <Common/Math/CRay.h>
 
+#include <algorithm>
+#include <cmath>
 #include <list>
+#include <map>
 #include <string>
 
 CScene::CScene()
@@ -60,6 +66,7 @@ CModelNode* CScene::CreateModelNode(CModel *pModel, uint32 NodeID /*= -1*/)
     CModelNode *pNode = new CModelNode(this, ID, mpAreaRootNode, pModel);
     mNodes[ENodeType::Model].push_back(pNode);
     mNodeMap[ID] = pNode;
+    AddNodeToTree(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -72,6 +79,7 @@ CStaticNode* CScene::CreateStaticNode(CStaticModel *pModel, uint32 NodeID /*= -1
     CStaticNode *pNode = new CStaticNode(this, ID, mpAreaRootNode, pModel);
     mNodes[ENodeType::Static].push_back(pNode);
     mNodeMap[ID] = pNode;
+    AddNodeToTree(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -84,6 +92,7 @@ CCollisionNode* CScene::CreateCollisionNode(CCollisionMeshGroup *pMesh, uint32 N
     CCollisionNode *pNode = new CCollisionNode(this, ID, mpAreaRootNode, pMesh);
     mNodes[ENodeType::Collision].push_back(pNode);
     mNodeMap[ID] = pNode;
+    AddNodeToTree(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -100,6 +109,7 @@ CScriptNode* CScene::CreateScriptNode(CScriptObject *pObj, uint32 NodeID /*= -1*
     mNodeMap[ID] = pNode;
     mScriptMap[InstanceID] = pNode;
     pNode->BuildLightList(mpArea);
+    AddNodeToTree(pNode);
 
     // AreaAttributes check
     switch (pObj->ObjectTypeID())
@@ -122,6 +132,7 @@ CLightNode* CScene::CreateLightNode(CLight *pLight, uint32 NodeID /*= -1*/)
     CLightNode *pNode = new CLightNode(this, ID, mpAreaRootNode, pLight);
     mNodes[ENodeType::Light].push_back(pNode);
     mNodeMap[ID] = pNode;
+    AddNodeToTree(pNode);
     mNumNodes++;
     return pNode;
 }
@@ -167,6 +178,7 @@ void CScene::DeleteNode(CSceneNode *pNode)
         }
     }
 
+    RemoveNodeFromTree(pNode);
     pNode->Unparent();
     delete pNode;
     mNumNodes--;
@@ -257,6 +269,17 @@ void CScene::PostLoad()
 
 void CScene::ClearScene()
 {
+    // Take nodes out of the node tree first, so nothing deleted below can queue itself for a tree update
+    for (auto MapIt = mNodes.begin(); MapIt != mNodes.end(); MapIt++)
+    {
+        for (auto it = MapIt->second.begin(); it != MapIt->second.end(); it++)
+            (*it)->_mInNodeTree = false;
+    }
+
+    mNodeTree.Clear();
+    mUnboundedNodes.clear();
+    mDirtyTreeNodes.clear();
+
     if (mpAreaRootNode)
     {
         mpAreaRootNode->Unparent();
@@ -284,10 +307,17 @@ void CScene::AddSceneToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInf
     FShowFlags ShowFlags = (rkViewInfo.GameMode ? gkGameModeShowFlags : rkViewInfo.ShowFlags);
     FNodeFlags NodeFlags = NodeFlagsForShowFlags(ShowFlags);
 
-    for (CSceneIterator It(this, NodeFlags, false); It; ++It)
+    UpdateNodeTree();
+    mTreeQueryResults.clear();
+    mNodeTree.FrustumQuery(rkViewInfo.ViewFrustum, mTreeQueryResults);
+    mTreeQueryResults.insert(mTreeQueryResults.end(), mUnboundedNodes.begin(), mUnboundedNodes.end());
+
+    for (uint32 iNode = 0; iNode < mTreeQueryResults.size(); iNode++)
     {
-        if (rkViewInfo.GameMode || It->IsVisible())
-            It->AddToRenderer(pRenderer, rkViewInfo);
+        CSceneNode *pNode = mTreeQueryResults[iNode];
+
+        if ((NodeFlags & pNode->NodeType()) && pNode->IsVisible())
+            pNode->AddToRenderer(pRenderer, rkViewInfo);
     }
 }
 
@@ -297,15 +327,59 @@ SRayIntersection CScene::SceneRayCast(const CRay& rkRay, const SViewInfo& rkView
     FNodeFlags NodeFlags = NodeFlagsForShowFlags(ShowFlags);
     CRayCollisionTester Tester(rkRay);
 
-    for (CSceneIterator It(this, NodeFlags, false); It; ++It)
+    UpdateNodeTree();
+    mTreeQueryResults.clear();
+    mNodeTree.RayQuery(rkRay, mTreeQueryResults);
+    mTreeQueryResults.insert(mTreeQueryResults.end(), mUnboundedNodes.begin(), mUnboundedNodes.end());
+
+    for (uint32 iNode = 0; iNode < mTreeQueryResults.size(); iNode++)
     {
-        if (It->IsVisible())
-            It->RayAABoxIntersectTest(Tester, rkViewInfo);
+        CSceneNode *pNode = mTreeQueryResults[iNode];
+
+        if ((NodeFlags & pNode->NodeType()) && pNode->IsVisible())
+            pNode->RayAABoxIntersectTest(Tester, rkViewInfo);
     }
 
     return Tester.TestNodes(rkViewInfo);
 }
 
+void CScene::UpdateStreamingPriorities(const CCamera& rkCamera)
+{
+    // This runs every tick, so skip the scan entirely once nothing is streaming in
+    if (!gpResourceStore || gpResourceStore->AsyncLoader()->NumPendingLoads() == 0)
+        return;
+
+    // Assets in view are loaded first, nearest to the camera first; everything else comes after, also by distance
+    static const int32 skOutOfViewPriority = 1 << 24;
+    const CFrustumPlanes& rkFrustum = rkCamera.FrustumPlanes();
+    CVector3f CameraPos = rkCamera.Position();
+    std::map<CResourceEntry*, int32> Priorities;
+
+    for (CSceneNode *pNode : mNodes[ENodeType::Script])
+    {
+        CScriptNode *pScript = static_cast<CScriptNode*>(pNode);
+        CResourceEntry *pEntry = pScript->StreamingAsset();
+        if (!pEntry) continue;
+
+        CAABox Box = pScript->AABox();
+        int32 Priority = (int32) std::min(Box.Center().Distance(CameraPos), (float) (skOutOfViewPriority - 1));
+
+        if (!rkFrustum.BoxInFrustum(Box))
+            Priority += skOutOfViewPriority;
+
+        // Instances that share an asset load it as soon as any one of them needs it
+        auto Iter = Priorities.find(pEntry);
+
+        if (Iter == Priorities.end())
+            Priorities[pEntry] = Priority;
+        else
+            Iter->second = std::min(Iter->second, Priority);
+    }
+
+    for (const auto& rkPair : Priorities)
+        rkPair.first->ResourceStore()->AsyncLoader()->SetPriority(rkPair.first, rkPair.second);
+}
+
 CSceneNode* CScene::NodeByID(uint32 NodeID)
 {
     auto it = mNodeMap.find(NodeID);
@@ -370,6 +444,96 @@ CGameArea* CScene::ActiveArea()
     return mpArea;
 }
 
+// ************ PROTECTED ************
+void CScene::AddNodeToTree(CSceneNode *pNode)
+{
+    // The node is placed in the tree on the next update, once it's been fully set up
+    pNode->_mInNodeTree = true;
+    pNode->MarkSceneBoundsChanged();
+}
+
+void CScene::RemoveNodeFromTree(CSceneNode *pNode)
+{
+    if (!pNode->_mInNodeTree) return;
+
+    if (pNode->_mTreeLeafID != -1)
+    {
+        mNodeTree.Remove(pNode->_mTreeLeafID);
+        pNode->_mTreeLeafID = -1;
+    }
+
+    if (pNode->_mUnboundedIndex != -1)
+        RemoveUnboundedNode(pNode);
+
+    if (pNode->_mSceneBoundsDirty)
+    {
+        mDirtyTreeNodes.erase( std::find(mDirtyTreeNodes.begin(), mDirtyTreeNodes.end(), pNode) );
+        pNode->_mSceneBoundsDirty = false;
+    }
+
+    pNode->_mInNodeTree = false;
+}
+
+void CScene::RemoveUnboundedNode(CSceneNode *pNode)
+{
+    uint32 Index = pNode->_mUnboundedIndex;
+    CSceneNode *pLast = mUnboundedNodes.back();
+    mUnboundedNodes[Index] = pLast;
+    pLast->_mUnboundedIndex = Index;
+    mUnboundedNodes.pop_back();
+    pNode->_mUnboundedIndex = -1;
+}
+
+void CScene::UpdateNodeTree()
+{
+    for (uint32 iNode = 0; iNode < mDirtyTreeNodes.size(); iNode++)
+    {
+        CSceneNode *pNode = mDirtyTreeNodes[iNode];
+        pNode->_mSceneBoundsDirty = false;
+
+        CAABox Bounds = CAABox::skZero;
+        bool Bounded = pNode->SceneBounds(Bounds);
+
+        if (Bounded)
+        {
+            // Infinite, inverted or NaN bounds can't go in the tree
+            CVector3f Min = Bounds.Min();
+            CVector3f Max = Bounds.Max();
+            Bounded = std::isfinite(Min.X) && std::isfinite(Min.Y) && std::isfinite(Min.Z) &&
+                      std::isfinite(Max.X) && std::isfinite(Max.Y) && std::isfinite(Max.Z) &&
+                      Min.X <= Max.X && Min.Y <= Max.Y && Min.Z <= Max.Z;
+        }
+
+        if (Bounded)
+        {
+            if (pNode->_mUnboundedIndex != -1)
+                RemoveUnboundedNode(pNode);
+
+            if (pNode->_mTreeLeafID == -1)
+                pNode->_mTreeLeafID = mNodeTree.Insert(pNode, Bounds);
+            else
+                mNodeTree.Move(pNode->_mTreeLeafID, Bounds);
+        }
+
+        else
+        {
+            if (pNode->_mTreeLeafID != -1)
+            {
+                mNodeTree.Remove(pNode->_mTreeLeafID);
+                pNode->_mTreeLeafID = -1;
+            }
+
+            if (pNode->_mUnboundedIndex == -1)
+            {
+                pNode->_mUnboundedIndex = mUnboundedNodes.size();
+                mUnboundedNodes.push_back(pNode);
+            }
+        }
+    }
+
+    mDirtyTreeNodes.clear();
+}
+
 // ************ STATIC ************
 FShowFlags CScene::ShowFlagsForNodeFlags(FNodeFlags NodeFlags)
 {
@@ -2,6 +2,7 @@
 #define CSCENE_H
 
 #include "CSceneNode.h"
+#include "CSceneNodeTree.h"
 #include "CRootNode.h"
 #include "CLightNode.h"
 #include "CModelNode.h"
@@ -24,6 +25,7 @@
 class CScene
 {
     friend class CSceneIterator;
+    friend class CSceneNode;
     
     bool mSplitTerrain;
     bool mRanPostLoad;
@@ -43,6 +45,12 @@ class CScene
     std::unordered_map<uint32, CSceneNode*> mNodeMap;
     std::unordered_map<uint32, CScriptNode*> mScriptMap;
 
+    // Node tree, for culling and ray casts. Nodes whose bounds can't be determined are kept separately and always tested.
+    CSceneNodeTree mNodeTree;
+    std::vector<CSceneNode*> mUnboundedNodes;
+    std::vector<CSceneNode*> mDirtyTreeNodes;
+    std::vector<CSceneNode*> mTreeQueryResults;
+
 public:
     CScene();
     ~CScene();
@@ -62,6 +70,7 @@ public:
     void ClearScene();
     void AddSceneToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInfo);
     SRayIntersection SceneRayCast(const CRay& rkRay, const SViewInfo& rkViewInfo);
+    void UpdateStreamingPriorities(const CCamera& rkCamera);
     CSceneNode* NodeByID(uint32 NodeID);
     CScriptNode* NodeForInstanceID(uint32 InstanceID);
     CScriptNode* NodeForInstance(CScriptObject *pObj);
@@ -72,6 +81,12 @@ public:
     // Static
     static FShowFlags ShowFlagsForNodeFlags(FNodeFlags NodeFlags);
     static FNodeFlags NodeFlagsForShowFlags(FShowFlags ShowFlags);
+
+protected:
+    void AddNodeToTree(CSceneNode *pNode);
+    void RemoveNodeFromTree(CSceneNode *pNode);
+    void RemoveUnboundedNode(CSceneNode *pNode);
+    void UpdateNodeTree();
 };
 
 #endif // CSCENE_H
@@ -1,4 +1,5 @@
 #include "CSceneNode.h"
+#include "CScene.h"
 #include "Core/GameProject/CResourceStore.h"
 #include "Core/Render/CRenderer.h"
 #include "Core/Render/CGraphics.h"
@@ -20,6 +21,10 @@ CSceneNode::CSceneNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent)
     , mRotation(CQuaternion::skIdentity)
     , mScale(CVector3f::skOne)
     , _mTransformDirty(true)
+    , _mInNodeTree(false)
+    , _mSceneBoundsDirty(false)
+    , _mTreeLeafID(-1)
+    , _mUnboundedIndex(-1)
     , _mInheritsPosition(true)
     , _mInheritsRotation(true)
     , _mInheritsScale(true)
@@ -58,6 +63,14 @@ void CSceneNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SView
         rTester.AddNode(this, -1, Result.second);
 }
 
+bool CSceneNode::SceneBounds(CAABox& rOutBounds) const
+{
+    // Default implementation for virtual function. Nodes that render or ray test anything outside
+    // their AABox need to include it here, or return false if it can't be bounded.
+    rOutBounds = AABox();
+    return true;
+}
+
 bool CSceneNode::IsVisible() const
 {
     // Default implementation for virtual function
@@ -217,13 +230,14 @@ void CSceneNode::LoadLights(const SViewInfo& rkViewInfo)
 void CSceneNode::AddModelToRenderer(CRenderer *pRenderer, CModel *pModel, uint32 MatSet)
 {
     ASSERT(pModel);
+    uint64 StateKey = pModel->StateSortKey(MatSet);
 
     if (!pModel->HasTransparency(MatSet))
-        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh);
+        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh, EDepthGroup::Midground, StateKey);
 
     else
     {
-        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawOpaqueParts);
+        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawOpaqueParts, EDepthGroup::Midground, StateKey);
         pRenderer->AddMesh(this, -1, AABox(), true, ERenderCommand::DrawTransparentParts);
     }
 }
@@ -342,6 +356,22 @@ void CSceneNode::MarkTransformChanged() const
     }
 
     _mTransformDirty = true;
+    MarkSceneBoundsChanged();
+}
+
+void CSceneNode::MarkSceneBoundsChanged() const
+{
+    // Child nodes are culled along with the node the scene tracks them under, so that node's bounds are the ones that changed
+    const CSceneNode *pkNode = this;
+
+    while (pkNode && !pkNode->_mInNodeTree)
+        pkNode = pkNode->mpParent;
+
+    if (pkNode && !pkNode->_mSceneBoundsDirty)
+    {
+        pkNode->_mSceneBoundsDirty = true;
+        pkNode->mpScene->mDirtyTreeNodes.push_back(const_cast<CSceneNode*>(pkNode));
+    }
 }
 
 const CTransform4f& CSceneNode::Transform() const
@@ -68,11 +68,19 @@ class CScene;
  */
 class CSceneNode : public IRenderable
 {
+    friend class CScene;
+
 private:
     mutable CTransform4f _mCachedTransform;
     mutable CAABox _mCachedAABox;
     mutable bool _mTransformDirty;
 
+    // Node tree bookkeeping; only used for nodes that CScene tracks in its node tree
+    bool _mInNodeTree;
+    mutable bool _mSceneBoundsDirty;
+    uint32 _mTreeLeafID;
+    uint32 _mUnboundedIndex;
+
     bool _mInheritsPosition;
     bool _mInheritsRotation;
     bool _mInheritsScale;
@@ -109,6 +117,7 @@ public:
     virtual void AddToRenderer(CRenderer* /*pRenderer*/, const SViewInfo& /*rkViewInfo*/) {}
     virtual void DrawSelection();
     virtual void RayAABoxIntersectTest(CRayCollisionTester& rTester, const SViewInfo& rkViewInfo);
+    virtual bool SceneBounds(CAABox& rOutBounds) const;
     virtual SRayIntersection RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo) = 0;
     virtual bool AllowsTranslate() const { return true; }
     virtual bool AllowsRotate() const { return true; }
@@ -141,6 +150,7 @@ public:
     const CTransform4f& Transform() const;
 protected:
     void MarkTransformChanged() const;
+    void MarkSceneBoundsChanged() const;
     void ForceRecalculateTransform() const;
     virtual void CalculateTransform(CTransform4f& rOut) const;
 
@@ -175,7 +185,7 @@ public:
     void SetScale(const CVector3f& rkScale)         { mScale = rkScale; MarkTransformChanged(); }
     void SetLightLayerIndex(uint32 Index)           { mLightLayerIndex = Index; }
     void SetMouseHovering(bool Hovering)            { mMouseHovering = Hovering; }
-    void SetSelected(bool Selected)                 { mSelected = Selected; }
+    void SetSelected(bool Selected)                 { mSelected = Selected; MarkSceneBoundsChanged(); }
     void SetVisible(bool Visible)                   { mVisible = Visible; }
 
     // Static
@@ -0,0 +1,348 @@
+#include "CSceneNodeTree.h"
+#include <Common/Macros.h>
+#include <Common/Math/MathUtil.h>
+#include <algorithm>
+
+// Leaves are expanded by this much on every side
+static const float gkLeafMargin = 0.5f;
+
+// A leaf whose box has grown this far past its node's bounds (after the node shrank) is refitted
+static const float gkLeafShrinkMargin = gkLeafMargin * 4.f;
+
+// ************ HELPERS ************
+static inline CVector3f BoxMin(const CVector3f& rkA, const CVector3f& rkB)
+{
+    return CVector3f(Math::Min(rkA.X, rkB.X), Math::Min(rkA.Y, rkB.Y), Math::Min(rkA.Z, rkB.Z));
+}
+
+static inline CVector3f BoxMax(const CVector3f& rkA, const CVector3f& rkB)
+{
+    return CVector3f(Math::Max(rkA.X, rkB.X), Math::Max(rkA.Y, rkB.Y), Math::Max(rkA.Z, rkB.Z));
+}
+
+static inline float BoxArea(const CVector3f& rkMin, const CVector3f& rkMax)
+{
+    CVector3f Extent = rkMax - rkMin;
+    return 2.f * (Extent.X * Extent.Y + Extent.Y * Extent.Z + Extent.Z * Extent.X);
+}
+
+static inline bool BoxContains(const CVector3f& rkOuterMin, const CVector3f& rkOuterMax, const CVector3f& rkMin, const CVector3f& rkMax)
+{
+    return rkOuterMin.X <= rkMin.X && rkOuterMin.Y <= rkMin.Y && rkOuterMin.Z <= rkMin.Z &&
+           rkOuterMax.X >= rkMax.X && rkOuterMax.Y >= rkMax.Y && rkOuterMax.Z >= rkMax.Z;
+}
+
+// ************ CSceneNodeTree ************
+CSceneNodeTree::CSceneNodeTree()
+    : mRoot(-1)
+    , mFreeList(-1)
+    , mNumLeaves(0)
+{
+}
+
+uint32 CSceneNodeTree::Insert(CSceneNode *pSceneNode, const CAABox& rkBounds)
+{
+    CVector3f Margin(gkLeafMargin, gkLeafMargin, gkLeafMargin);
+    uint32 LeafIdx = AllocateNode();
+    SNode& rLeaf = mNodes[LeafIdx];
+    rLeaf.Min = rkBounds.Min() - Margin;
+    rLeaf.Max = rkBounds.Max() + Margin;
+    rLeaf.pSceneNode = pSceneNode;
+
+    InsertLeaf(LeafIdx);
+    mNumLeaves++;
+    return LeafIdx;
+}
+
+void CSceneNodeTree::Remove(uint32 LeafID)
+{
+    ASSERT(LeafID < mNodes.size() && mNodes[LeafID].IsLeaf() && mNodes[LeafID].Height == 0);
+    RemoveLeaf(LeafID);
+    FreeNode(LeafID);
+    mNumLeaves--;
+}
+
+bool CSceneNodeTree::Move(uint32 LeafID, const CAABox& rkBounds)
+{
+    ASSERT(LeafID < mNodes.size() && mNodes[LeafID].IsLeaf() && mNodes[LeafID].Height == 0);
+    SNode& rLeaf = mNodes[LeafID];
+    CVector3f Min = rkBounds.Min();
+    CVector3f Max = rkBounds.Max();
+
+    // Leave the leaf alone if the new bounds still fit in it, unless the node shrank so much the leaf is now too loose
+    if (BoxContains(rLeaf.Min, rLeaf.Max, Min, Max))
+    {
+        CVector3f ShrinkMargin(gkLeafShrinkMargin, gkLeafShrinkMargin, gkLeafShrinkMargin);
+
+        if (BoxContains(Min - ShrinkMargin, Max + ShrinkMargin, rLeaf.Min, rLeaf.Max))
+            return false;
+    }
+
+    RemoveLeaf(LeafID);
+
+    CVector3f Margin(gkLeafMargin, gkLeafMargin, gkLeafMargin);
+    mNodes[LeafID].Min = Min - Margin;
+    mNodes[LeafID].Max = Max + Margin;
+
+    InsertLeaf(LeafID);
+    return true;
+}
+
+void CSceneNodeTree::Clear()
+{
+    mNodes.clear();
+    mRoot = -1;
+    mFreeList = -1;
+    mNumLeaves = 0;
+}
+
+void CSceneNodeTree::FrustumQuery(const CFrustumPlanes& rkFrustum, std::vector<CSceneNode*>& rOut) const
+{
+    if (mRoot == -1) return;
+
+    std::vector<uint32> Stack;
+    Stack.reserve(64);
+    Stack.push_back(mRoot);
+
+    while (!Stack.empty())
+    {
+        const SNode& rkNode = mNodes[Stack.back()];
+        Stack.pop_back();
+
+        if (!rkFrustum.BoxInFrustum(CAABox(rkNode.Min, rkNode.Max)))
+            continue;
+
+        if (rkNode.IsLeaf())
+            rOut.push_back(rkNode.pSceneNode);
+
+        else
+        {
+            Stack.push_back(rkNode.Children[0]);
+            Stack.push_back(rkNode.Children[1]);
+        }
+    }
+}
+
+void CSceneNodeTree::RayQuery(const CRay& rkRay, std::vector<CSceneNode*>& rOut) const
+{
+    if (mRoot == -1) return;
+
+    std::vector<uint32> Stack;
+    Stack.reserve(64);
+    Stack.push_back(mRoot);
+
+    while (!Stack.empty())
+    {
+        const SNode& rkNode = mNodes[Stack.back()];
+        Stack.pop_back();
+
+        if (!CAABox(rkNode.Min, rkNode.Max).IntersectsRay(rkRay).first)
+            continue;
+
+        if (rkNode.IsLeaf())
+            rOut.push_back(rkNode.pSceneNode);
+
+        else
+        {
+            Stack.push_back(rkNode.Children[0]);
+            Stack.push_back(rkNode.Children[1]);
+        }
+    }
+}
+
+// ************ PROTECTED ************
+uint32 CSceneNodeTree::AllocateNode()
+{
+    uint32 NodeIdx;
+
+    if (mFreeList == -1)
+    {
+        NodeIdx = mNodes.size();
+        mNodes.push_back(SNode());
+    }
+    else
+    {
+        NodeIdx = mFreeList;
+        mFreeList = mNodes[NodeIdx].Parent;
+    }
+
+    SNode& rNode = mNodes[NodeIdx];
+    rNode.Parent = -1;
+    rNode.Children[0] = -1;
+    rNode.Children[1] = -1;
+    rNode.Height = 0;
+    rNode.pSceneNode = nullptr;
+    return NodeIdx;
+}
+
+void CSceneNodeTree::FreeNode(uint32 NodeIdx)
+{
+    SNode& rNode = mNodes[NodeIdx];
+    rNode.Parent = mFreeList;
+    rNode.Height = -1;
+    rNode.pSceneNode = nullptr;
+    mFreeList = NodeIdx;
+}
+
+void CSceneNodeTree::InsertLeaf(uint32 LeafIdx)
+{
+    if (mRoot == -1)
+    {
+        mRoot = LeafIdx;
+        mNodes[LeafIdx].Parent = -1;
+        return;
+    }
+
+    // Walk down to the sibling that adds the least surface area to the tree
+    CVector3f LeafMin = mNodes[LeafIdx].Min;
+    CVector3f LeafMax = mNodes[LeafIdx].Max;
+    uint32 SiblingIdx = mRoot;
+
+    while (!mNodes[SiblingIdx].IsLeaf())
+    {
+        const SNode& rkNode = mNodes[SiblingIdx];
+        float Area = BoxArea(rkNode.Min, rkNode.Max);
+        float CombinedArea = BoxArea(BoxMin(rkNode.Min, LeafMin), BoxMax(rkNode.Max, LeafMax));
+
+        // Cost of making a new parent for this node and the leaf, and the cost every level below here pays for growing this node
+        float NewParentCost = 2.f * CombinedArea;
+        float InheritanceCost = 2.f * (CombinedArea - Area);
+        float ChildCosts[2];
+
+        for (uint32 iChild = 0; iChild < 2; iChild++)
+        {
+            const SNode& rkChild = mNodes[rkNode.Children[iChild]];
+            float ChildCombinedArea = BoxArea(BoxMin(rkChild.Min, LeafMin), BoxMax(rkChild.Max, LeafMax));
+
+            if (rkChild.IsLeaf())
+                ChildCosts[iChild] = ChildCombinedArea + InheritanceCost;
+            else
+                ChildCosts[iChild] = (ChildCombinedArea - BoxArea(rkChild.Min, rkChild.Max)) + InheritanceCost;
+        }
+
+        if (NewParentCost < ChildCosts[0] && NewParentCost < ChildCosts[1])
+            break;
+
+        SiblingIdx = (ChildCosts[0] < ChildCosts[1] ? rkNode.Children[0] : rkNode.Children[1]);
+    }
+
+    // Make a new parent for the sibling and the leaf
+    uint32 OldParentIdx = mNodes[SiblingIdx].Parent;
+    uint32 NewParentIdx = AllocateNode();
+
+    SNode& rNewParent = mNodes[NewParentIdx];
+    rNewParent.Parent = OldParentIdx;
+    rNewParent.Children[0] = SiblingIdx;
+    rNewParent.Children[1] = LeafIdx;
+    rNewParent.Min = BoxMin(mNodes[SiblingIdx].Min, LeafMin);
+    rNewParent.Max = BoxMax(mNodes[SiblingIdx].Max, LeafMax);
+    rNewParent.Height = mNodes[SiblingIdx].Height + 1;
+
+    mNodes[SiblingIdx].Parent = NewParentIdx;
+    mNodes[LeafIdx].Parent = NewParentIdx;
+
+    if (OldParentIdx != -1)
+        ReplaceChild(OldParentIdx, SiblingIdx, NewParentIdx);
+    else
+        mRoot = NewParentIdx;
+
+    RefitAncestors(OldParentIdx);
+}
+
+void CSceneNodeTree::RemoveLeaf(uint32 LeafIdx)
+{
+    if (LeafIdx == mRoot)
+    {
+        mRoot = -1;
+        return;
+    }
+
+    // The leaf's parent is removed and the leaf's sibling takes its place
+    uint32 ParentIdx = mNodes[LeafIdx].Parent;
+    uint32 GrandParentIdx = mNodes[ParentIdx].Parent;
+    const SNode& rkParent = mNodes[ParentIdx];
+    uint32 SiblingIdx = (rkParent.Children[0] == LeafIdx ? rkParent.Children[1] : rkParent.Children[0]);
+
+    mNodes[SiblingIdx].Parent = GrandParentIdx;
+    mNodes[LeafIdx].Parent = -1;
+
+    if (GrandParentIdx != -1)
+        ReplaceChild(GrandParentIdx, ParentIdx, SiblingIdx);
+    else
+        mRoot = SiblingIdx;
+
+    FreeNode(ParentIdx);
+    RefitAncestors(GrandParentIdx);
+}
+
+void CSceneNodeTree::RefitAncestors(uint32 NodeIdx)
+{
+    while (NodeIdx != -1)
+    {
+        NodeIdx = Balance(NodeIdx);
+        UpdateFromChildren(NodeIdx);
+        NodeIdx = mNodes[NodeIdx].Parent;
+    }
+}
+
+uint32 CSceneNodeTree::Balance(uint32 IdxA)
+{
+    // Rotates the taller child of A up into A's place if the children's heights differ by more than one.
+    // Of the taller child's children, the taller one stays with it and the other is handed down to A.
+    SNode& rA = mNodes[IdxA];
+    if (rA.IsLeaf() || rA.Height < 2) return IdxA;
+
+    int32 Balance = mNodes[rA.Children[1]].Height - mNodes[rA.Children[0]].Height;
+    if (Balance >= -1 && Balance <= 1) return IdxA;
+
+    uint32 TallSide = (Balance > 1 ? 1 : 0);
+    uint32 IdxUp = rA.Children[TallSide];
+    SNode& rUp = mNodes[IdxUp];
+
+    uint32 IdxUpChild0 = rUp.Children[0];
+    uint32 IdxUpChild1 = rUp.Children[1];
+    bool KeepFirst = (mNodes[IdxUpChild0].Height > mNodes[IdxUpChild1].Height);
+    uint32 IdxKeep = (KeepFirst ? IdxUpChild0 : IdxUpChild1);
+    uint32 IdxGive = (KeepFirst ? IdxUpChild1 : IdxUpChild0);
+
+    // Swap the rotated child into A's place
+    rUp.Parent = rA.Parent;
+    rA.Parent = IdxUp;
+
+    if (rUp.Parent != -1)
+        ReplaceChild(rUp.Parent, IdxA, IdxUp);
+    else
+        mRoot = IdxUp;
+
+    rUp.Children[0] = IdxA;
+    rUp.Children[1] = IdxKeep;
+    rA.Children[TallSide] = IdxGive;
+    mNodes[IdxGive].Parent = IdxA;
+
+    UpdateFromChildren(IdxA);
+    UpdateFromChildren(IdxUp);
+    return IdxUp;
+}
+
+void CSceneNodeTree::ReplaceChild(uint32 ParentIdx, uint32 OldChild, uint32 NewChild)
+{
+    SNode& rParent = mNodes[ParentIdx];
+
+    if (rParent.Children[0] == OldChild)
+        rParent.Children[0] = NewChild;
+    else
+    {
+        ASSERT(rParent.Children[1] == OldChild);
+        rParent.Children[1] = NewChild;
+    }
+}
+
+void CSceneNodeTree::UpdateFromChildren(uint32 NodeIdx)
+{
+    SNode& rNode = mNodes[NodeIdx];
+    const SNode& rkChild0 = mNodes[rNode.Children[0]];
+    const SNode& rkChild1 = mNodes[rNode.Children[1]];
+    rNode.Min = BoxMin(rkChild0.Min, rkChild1.Min);
+    rNode.Max = BoxMax(rkChild0.Max, rkChild1.Max);
+    rNode.Height = 1 + Math::Max(rkChild0.Height, rkChild1.Height);
+}
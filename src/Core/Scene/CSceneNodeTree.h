@@ -0,0 +1,67 @@
+#ifndef CSCENENODETREE_H
+#define CSCENENODETREE_H
+
+#include <Common/BasicTypes.h>
+#include <Common/Math/CAABox.h>
+#include <Common/Math/CFrustumPlanes.h>
+#include <Common/Math/CRay.h>
+#include <Common/Math/CVector3f.h>
+#include <vector>
+
+class CSceneNode;
+
+/**
+ * Dynamic AABB tree over scene nodes, used by CScene for frustum culling and ray picking.
+ * Each node is a leaf whose box is its bounds expanded by a margin, so small moves (like dragging
+ * a gizmo) don't touch the tree; a leaf is only reinserted once its node leaves the expanded box.
+ * Insertions pick the sibling that adds the least surface area, and the tree is rebalanced with
+ * rotations on the way back up, so queries stay logarithmic as nodes are added, moved and removed.
+ */
+class CSceneNodeTree
+{
+    struct SNode
+    {
+        CVector3f Min;
+        CVector3f Max;
+        uint32 Parent;      // Next free node for nodes on the free list
+        uint32 Children[2]; // -1 for leaves
+        int32 Height;       // 0 for leaves, -1 for free nodes
+        CSceneNode *pSceneNode;
+
+        inline bool IsLeaf() const { return Children[0] == -1; }
+    };
+
+    std::vector<SNode> mNodes;
+    uint32 mRoot;
+    uint32 mFreeList;
+    uint32 mNumLeaves;
+
+public:
+    CSceneNodeTree();
+
+    // Returns the leaf ID for the node, which is passed back to Move/Remove
+    uint32 Insert(CSceneNode *pSceneNode, const CAABox& rkBounds);
+    void Remove(uint32 LeafID);
+    // Returns whether the leaf had to be reinserted
+    bool Move(uint32 LeafID, const CAABox& rkBounds);
+    void Clear();
+
+    // Append every node whose leaf box passes the test. Leaf boxes are conservative, so callers still do their own tests.
+    void FrustumQuery(const CFrustumPlanes& rkFrustum, std::vector<CSceneNode*>& rOut) const;
+    void RayQuery(const CRay& rkRay, std::vector<CSceneNode*>& rOut) const;
+
+    inline uint32 NumLeaves() const     { return mNumLeaves; }
+    inline uint32 Height() const        { return (mRoot == -1 ? 0 : mNodes[mRoot].Height); }
+
+protected:
+    uint32 AllocateNode();
+    void FreeNode(uint32 NodeIdx);
+    void InsertLeaf(uint32 LeafIdx);
+    void RemoveLeaf(uint32 LeafIdx);
+    void RefitAncestors(uint32 NodeIdx);
+    uint32 Balance(uint32 NodeIdx);
+    void ReplaceChild(uint32 ParentIdx, uint32 OldChild, uint32 NewChild);
+    void UpdateFromChildren(uint32 NodeIdx);
+};
+
+#endif // CSCENENODETREE_H
@@ -1,5 +1,6 @@
 #include "CScriptNode.h"
 #include "CScene.h"
+#include "Core/GameProject/CAsyncLoader.h"
 #include "Core/GameProject/CResourceStore.h"
 #include "Core/Render/CDrawUtil.h"
 #include "Core/Render/CGraphics.h"
@@ -18,6 +19,7 @@ CScriptNode::CScriptNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent, CSc
     , mHasVolumePreview(false)
     , mpInstance(pInstance)
     , mpExtra(nullptr)
+    , mpStreamingAsset(nullptr)
 {
     ASSERT(pInstance);
 
@@ -43,6 +45,9 @@ CScriptNode::CScriptNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent, CSc
         SetDisplayAsset(mpInstance->DisplayAsset());
         mpCollisionNode->SetCollision(mpInstance->Collision());
 
+        if (mpInstance->DeferredDisplayAsset())
+            StreamDisplayAsset(mpInstance->DeferredDisplayAsset());
+
         // Create preview volume node
         mpVolumePreviewNode = new CModelNode(pScene, -1, this, nullptr);
 
@@ -79,6 +84,12 @@ CScriptNode::CScriptNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent, CSc
     mpExtra = CScriptExtra::CreateExtra(this);
 }
 
+CScriptNode::~CScriptNode()
+{
+    if (mpStreamingAsset)
+        mpStreamingAsset->ResourceStore()->AsyncLoader()->CancelCallbacks(this);
+}
+
 ENodeType CScriptNode::NodeType()
 {
     return ENodeType::Script;
@@ -344,6 +355,36 @@ void CScriptNode::RayAABoxIntersectTest(CRayCollisionTester& rTester, const SVie
         mAttachments[iAttach]->RayAABoxIntersectTest(rTester, rkViewInfo);
 }
 
+bool CScriptNode::SceneBounds(CAABox& rOutBounds) const
+{
+    // Script extras can render anything, and selected nodes draw their links and volume regardless of the view,
+    // so neither can be culled up front.
+    if (mpExtra || IsSelected())
+        return false;
+
+    rOutBounds = AABox();
+
+    if (!UsesModel())
+    {
+        CVector2f BillScale = BillboardScale();
+        float ScaleXY = (BillScale.X > BillScale.Y ? BillScale.X : BillScale.Y);
+
+        rOutBounds.ExpandBounds( CAABox(mPosition + CVector3f(-ScaleXY, -ScaleXY, -BillScale.Y),
+                                        mPosition + CVector3f( ScaleXY,  ScaleXY,  BillScale.Y)) );
+    }
+
+    if (mpInstance && mpInstance->Collision())
+        rOutBounds.ExpandBounds(mpCollisionNode->AABox());
+
+    for (uint32 iAttach = 0; iAttach < mAttachments.size(); iAttach++)
+    {
+        if (mAttachments[iAttach]->Model())
+            rOutBounds.ExpandBounds(mAttachments[iAttach]->AABox());
+    }
+
+    return true;
+}
+
 SRayIntersection CScriptNode::RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo)
 {
     FRenderOptions Options = rkViewInfo.pRenderer->RenderOptions();
@@ -758,6 +799,21 @@ void CScriptNode::SetDisplayAsset(CResource *pRes)
         mpExtra->DisplayAssetChanged(pRes);
 }
 
+void CScriptNode::StreamDisplayAsset(CResourceEntry *pEntry)
+{
+    // The node shows whatever the instance fell back on (usually its billboard) until the asset is loaded.
+    // The scene reprioritizes the request every tick based on where the node is relative to the camera.
+    mpStreamingAsset = pEntry;
+    pEntry->LoadAsync(0, this, [this](CResource*) { OnDisplayAssetStreamed(); });
+}
+
+void CScriptNode::OnDisplayAssetStreamed()
+{
+    mpStreamingAsset = nullptr;
+    mpInstance->EvaluateDisplayAsset();
+    SetDisplayAsset(mpInstance->DisplayAsset());
+}
+
 void CScriptNode::CalculateTransform(CTransform4f& rOut) const
 {
     CScriptTemplate *pTemp = Template();
@@ -26,6 +26,7 @@ class CScriptNode : public CSceneNode
     CModelNode *mpVolumePreviewNode;
 
     CLightParameters *mpLightParameters;
+    CResourceEntry *mpStreamingAsset; // Display asset that's being loaded in the background
 
     enum class EGameModeVisibility
     {
@@ -34,6 +35,7 @@ class CScriptNode : public CSceneNode
 
 public:
     CScriptNode(CScene *pScene, uint32 NodeID, CSceneNode *pParent = 0, CScriptObject *pObject = 0);
+    ~CScriptNode();
     ENodeType NodeType();
     void PostLoad();
     void OnTransformed();
@@ -41,6 +43,7 @@ public:
     void Draw(FRenderOptions Options, int ComponentIndex, ERenderCommand Command, const SViewInfo& rkViewInfo);
     void DrawSelection();
     void RayAABoxIntersectTest(CRayCollisionTester& rTester, const SViewInfo& rkViewInfo);
+    bool SceneBounds(CAABox& rOutBounds) const;
     SRayIntersection RayNodeIntersectTest(const CRay& rkRay, uint32 AssetID, const SViewInfo& rkViewInfo);
     bool AllowsRotate() const;
     bool AllowsScale() const;
@@ -72,9 +75,12 @@ public:
     inline uint32 NumAttachments() const                        { return mAttachments.size(); }
     inline CScriptAttachNode* Attachment(uint32 Index) const    { return mAttachments[Index]; }
     inline CResource* DisplayAsset() const                      { return mpDisplayAsset; }
+    inline CResourceEntry* StreamingAsset() const               { return mpStreamingAsset; }
 
 protected:
     void SetDisplayAsset(CResource *pRes);
+    void StreamDisplayAsset(CResourceEntry *pEntry);
+    void OnDisplayAssetStreamed();
     void CalculateTransform(CTransform4f& rOut) const;
 };
 
@@ -34,7 +34,7 @@ void CStaticNode::AddToRenderer(CRenderer *pRenderer, const SViewInfo& rkViewInf
     if (!rkViewInfo.ViewFrustum.BoxInFrustum(AABox())) return;
 
     if (!mpModel->IsTransparent())
-        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh);
+        pRenderer->AddMesh(this, -1, AABox(), false, ERenderCommand::DrawMesh, EDepthGroup::Midground, mpModel->GetMaterial()->StateSortKey());
 
     else
     {
@@ -0,0 +1,152 @@
+#ifndef TFLATHASHMAP_H
+#define TFLATHASHMAP_H
+
+#include <Common/BasicTypes.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Open addressing hash map for integer keys; the map counterpart to TFlatHashSet. Keys and values sit
+ * together in one flat array with linear probing, so a lookup is usually a single cache line. Keys can't
+ * be removed; to drop keys, Clear() the map and insert the remaining ones again.
+ */
+template<typename KeyType, typename ValueType>
+class TFlatHashMap
+{
+    static_assert(std::is_integral<KeyType>::value, "TFlatHashMap only supports integer keys");
+
+    struct SSlot
+    {
+        KeyType Key;
+        ValueType Value;
+    };
+
+    /** Slots; a slot with a zero key is empty, so the zero key is stored separately */
+    std::vector<SSlot> mSlots;
+    uint32 mMask;
+    uint32 mSize;
+    bool mHasZeroKey;
+    ValueType mZeroValue;
+
+    static inline uint32 HashKey(KeyType Key)
+    {
+        uint64 Value = (uint64) Key;
+        return (uint32) (((Value ^ (Value >> 32)) * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    void Rehash(uint32 NumSlots)
+    {
+        std::vector<SSlot> OldSlots;
+        OldSlots.swap(mSlots);
+        mSlots.resize(NumSlots, SSlot { 0, ValueType() });
+        mMask = NumSlots - 1;
+
+        for (const SSlot& rkSlot : OldSlots)
+        {
+            if (rkSlot.Key != 0)
+                InsertIntoSlots(rkSlot.Key, rkSlot.Value);
+        }
+    }
+
+    inline bool InsertIntoSlots(KeyType Key, const ValueType& rkValue)
+    {
+        uint32 Index = HashKey(Key) & mMask;
+
+        while (mSlots[Index].Key != 0)
+        {
+            if (mSlots[Index].Key == Key)
+            {
+                mSlots[Index].Value = rkValue;
+                return false;
+            }
+
+            Index = (Index + 1) & mMask;
+        }
+
+        mSlots[Index].Key = Key;
+        mSlots[Index].Value = rkValue;
+        return true;
+    }
+
+public:
+    TFlatHashMap()
+        : mMask(0)
+        , mSize(0)
+        , mHasZeroKey(false)
+        , mZeroValue()
+    {}
+
+    /** Makes room for NumKeys keys without rehashing; the table is kept at most half full */
+    void Reserve(uint32 NumKeys)
+    {
+        uint32 NumSlots = 16;
+        while (NumSlots < NumKeys * 2) NumSlots <<= 1;
+
+        if (NumSlots > mSlots.size())
+            Rehash(NumSlots);
+    }
+
+    /** Sets the value for a key; returns false if the key was already present (its value is replaced) */
+    bool Insert(KeyType Key, const ValueType& rkValue)
+    {
+        if (Key == 0)
+        {
+            bool WasPresent = mHasZeroKey;
+            mHasZeroKey = true;
+            mZeroValue = rkValue;
+            if (!WasPresent) mSize++;
+            return !WasPresent;
+        }
+
+        if ((mSize + 1) * 2 > mSlots.size())
+            Reserve(mSize + 1);
+
+        bool Inserted = InsertIntoSlots(Key, rkValue);
+        if (Inserted) mSize++;
+        return Inserted;
+    }
+
+    /** Returns a pointer to the value for a key, or nullptr if the key isn't in the map */
+    inline const ValueType* Find(KeyType Key) const
+    {
+        if (Key == 0)
+            return mHasZeroKey ? &mZeroValue : nullptr;
+
+        if (mSlots.empty())
+            return nullptr;
+
+        uint32 Index = HashKey(Key) & mMask;
+
+        while (true)
+        {
+            const SSlot& rkSlot = mSlots[Index];
+            if (rkSlot.Key == Key) return &rkSlot.Value;
+            if (rkSlot.Key == 0) return nullptr;
+            Index = (Index + 1) & mMask;
+        }
+    }
+
+    inline ValueType* Find(KeyType Key)
+    {
+        return const_cast<ValueType*>( static_cast<const TFlatHashMap*>(this)->Find(Key) );
+    }
+
+    inline bool Contains(KeyType Key) const
+    {
+        return Find(Key) != nullptr;
+    }
+
+    void Clear()
+    {
+        mSlots.clear();
+        mMask = 0;
+        mSize = 0;
+        mHasZeroKey = false;
+        mZeroValue = ValueType();
+    }
+
+    inline uint32 Size() const      { return mSize; }
+    inline bool IsEmpty() const     { return mSize == 0; }
+};
+
+#endif // TFLATHASHMAP_H
@@ -0,0 +1,127 @@
+#ifndef TFLATHASHSET_H
+#define TFLATHASHSET_H
+
+#include <Common/BasicTypes.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Open addressing hash set for integer keys such as IDs and hashes. Every key lives in one flat array with
+ * linear probing, so a lookup is usually a single cache line with no pointer chasing, unlike std::unordered_set.
+ * Keys can't be removed; the set is meant to be built once and then queried many times (lookups are safe to
+ * do from multiple threads as long as nothing is being inserted).
+ */
+template<typename KeyType>
+class TFlatHashSet
+{
+    static_assert(std::is_integral<KeyType>::value, "TFlatHashSet only supports integer keys");
+
+    /** Slots; a slot holding zero is empty, so the zero key is tracked separately */
+    std::vector<KeyType> mSlots;
+    uint32 mMask;
+    uint32 mSize;
+    bool mHasZeroKey;
+
+    static inline uint32 HashKey(KeyType Key)
+    {
+        uint64 Value = (uint64) Key;
+        return (uint32) (((Value ^ (Value >> 32)) * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    void Rehash(uint32 NumSlots)
+    {
+        std::vector<KeyType> OldSlots;
+        OldSlots.swap(mSlots);
+        mSlots.resize(NumSlots, 0);
+        mMask = NumSlots - 1;
+
+        for (KeyType Key : OldSlots)
+        {
+            if (Key != 0)
+                InsertIntoSlots(Key);
+        }
+    }
+
+    inline bool InsertIntoSlots(KeyType Key)
+    {
+        uint32 Index = HashKey(Key) & mMask;
+
+        while (mSlots[Index] != 0)
+        {
+            if (mSlots[Index] == Key) return false;
+            Index = (Index + 1) & mMask;
+        }
+
+        mSlots[Index] = Key;
+        return true;
+    }
+
+public:
+    TFlatHashSet()
+        : mMask(0)
+        , mSize(0)
+        , mHasZeroKey(false)
+    {}
+
+    /** Makes room for NumKeys keys without rehashing; the table is kept at most half full */
+    void Reserve(uint32 NumKeys)
+    {
+        uint32 NumSlots = 16;
+        while (NumSlots < NumKeys * 2) NumSlots <<= 1;
+
+        if (NumSlots > mSlots.size())
+            Rehash(NumSlots);
+    }
+
+    /** Adds a key to the set; returns false if it was already present */
+    bool Insert(KeyType Key)
+    {
+        if (Key == 0)
+        {
+            bool WasPresent = mHasZeroKey;
+            mHasZeroKey = true;
+            if (!WasPresent) mSize++;
+            return !WasPresent;
+        }
+
+        if ((mSize + 1) * 2 > mSlots.size())
+            Reserve(mSize + 1);
+
+        bool Inserted = InsertIntoSlots(Key);
+        if (Inserted) mSize++;
+        return Inserted;
+    }
+
+    /** Returns whether the key is in the set */
+    inline bool Contains(KeyType Key) const
+    {
+        if (Key == 0)
+            return mHasZeroKey;
+
+        if (mSlots.empty())
+            return false;
+
+        uint32 Index = HashKey(Key) & mMask;
+
+        while (true)
+        {
+            KeyType Slot = mSlots[Index];
+            if (Slot == Key) return true;
+            if (Slot == 0) return false;
+            Index = (Index + 1) & mMask;
+        }
+    }
+
+    void Clear()
+    {
+        mSlots.clear();
+        mMask = 0;
+        mSize = 0;
+        mHasZeroKey = false;
+    }
+
+    inline uint32 Size() const      { return mSize; }
+    inline bool IsEmpty() const     { return mSize == 0; }
+};
+
+#endif // TFLATHASHSET_H
@@ -9,7 +9,9 @@
 #include "Editor/WorldEditor/CWorldEditor.h"
 #include <Common/Macros.h>
 #include <Common/CTimer.h>
+#include <Core/GameProject/CAsyncLoader.h>
 #include <Core/GameProject/CGameProject.h>
+#include <Core/Resource/Script/NGameList.h>
 
 #include <QFuture>
 #include <QtConcurrent/QtConcurrentRun>
@@ -19,6 +21,7 @@ CEditorApplication::CEditorApplication(int& rArgc, char **ppArgv)
     , mpActiveProject(nullptr)
     , mpWorldEditor(nullptr)
     , mpProjectDialog(nullptr)
+    , mCookProfile(ECookProfile::Max)
 {
     mLastUpdate = CTimer::GlobalTime();
 
@@ -89,6 +92,10 @@ bool CEditorApplication::OpenProject(const QString& rkProjPath)
     if (mpActiveProject)
     {
         gpResourceStore = mpActiveProject->ResourceStore();
+
+        // Script templates are loaded on demand; get the rest of them loading while the user picks an area
+        NGameList::PreloadGameTemplate(mpActiveProject->Game());
+
         emit ActiveProjectChanged(mpActiveProject);
         return true;
     }
@@ -204,7 +211,7 @@ bool CEditorApplication::CookPackageList(QList<CPackage*> PackageList)
             {
                 CPackage *pPkg = PackageList[PkgIdx];
                 Dialog.SetTask(PkgIdx, "Cooking " + pPkg->Name() + ".pak...");
-                pPkg->Cook(&Dialog);
+                pPkg->Cook(&Dialog, mCookProfile);
             }
         });
 
@@ -266,6 +273,13 @@ void CEditorApplication::TickEditors()
     if (gpResourceStore)
         gpResourceStore->ConditionalSaveStore();
 
+    // Hand off any resources that finished loading in the background
+    if (gpEditorStore)
+        gpEditorStore->AsyncLoader()->ProcessCompletedLoads();
+
+    if (gpResourceStore)
+        gpResourceStore->AsyncLoader()->ProcessCompletedLoads();
+
     // Tick each editor window and redraw their viewports
     foreach(IEditor *pEditor, mEditorWindows)
     {
@@ -29,6 +29,8 @@ class CEditorApplication : public QApplication
     QTimer mRefreshTimer;
     double mLastUpdate;
 
+    ECookProfile mCookProfile;
+
 public:
     CEditorApplication(int& rArgc, char **ppArgv);
     ~CEditorApplication();
@@ -52,6 +54,9 @@ public:
     inline CWorldEditor* WorldEditor() const                { return mpWorldEditor; }
     inline CProjectSettingsDialog* ProjectDialog() const    { return mpProjectDialog; }
     inline EGame CurrentGame() const                        { return mpActiveProject ? mpActiveProject->Game() : EGame::Invalid; }
+    inline ECookProfile CookProfile() const                 { return mCookProfile; }
+
+    inline void SetCookProfile(ECookProfile Profile)        { mCookProfile = Profile; }
 
     inline void SetEditorTicksEnabled(bool Enabled)         { Enabled ? mRefreshTimer.start(gkTickFrequencyMS) : mRefreshTimer.stop(); }
     inline bool AreEditorTicksEnabled() const               { return mRefreshTimer.isActive(); }
@@ -161,6 +161,7 @@ void CGeneratePropertyNamesDialog::StartGeneration()
     Params.Prefix = TO_TSTRING( mpUI->PrefixLineEdit->text() );
     Params.Suffix = TO_TSTRING( mpUI->SuffixLineEdit->text() );
     Params.Casing = mpUI->CasingComboBox->currentEnum();
+    Params.Mode = (mIdPairs.isEmpty() ? ENameGenerationMode::Forward : ENameGenerationMode::MeetInTheMiddle);
     Params.ValidIdPairs = mIdPairs.toStdVector();
     Params.ExcludeAccuratelyNamedProperties = mpUI->UnnamedOnlyCheckBox->isChecked();
     Params.TestIntsAsChoices = mpUI->TestIntsAsChoicesCheckBox->isChecked();
@@ -24,7 +24,10 @@ CProjectSettingsDialog::CProjectSettingsDialog(QWidget *pParent)
 {
     mpUI->setupUi(this);
 
+    mpUI->CookProfileComboBox->setCurrentIndex((int) gpEdApp->CookProfile());
+
     connect(mpUI->GameNameLineEdit, SIGNAL(editingFinished()), this, SLOT(GameNameChanged()));
+    connect(mpUI->CookProfileComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(CookProfileChanged(int)));
     connect(mpUI->CookPackageButton, SIGNAL(clicked()), this, SLOT(CookPackage()));
     connect(mpUI->CookAllDirtyPackagesButton, SIGNAL(clicked(bool)), this, SLOT(CookAllDirtyPackages()));
     connect(mpUI->BuildIsoButton, SIGNAL(clicked(bool)), this, SLOT(BuildISO()));
@@ -112,6 +115,12 @@ void CProjectSettingsDialog::SetupPackagesList()
     }
 }
 
+void CProjectSettingsDialog::CookProfileChanged(int NewIndex)
+{
+    // Combo box items are in the same order as ECookProfile
+    gpEdApp->SetCookProfile( (ECookProfile) NewIndex );
+}
+
 void CProjectSettingsDialog::CookPackage()
 {
     uint32 PackageIdx = mpUI->PackagesList->currentRow();
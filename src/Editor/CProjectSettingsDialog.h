@@ -28,6 +28,7 @@ public slots:
     void ActiveProjectChanged(CGameProject *pProj);
     void GameNameChanged();
     void SetupPackagesList();
+    void CookProfileChanged(int NewIndex);
     void CookPackage();
     void CookAllDirtyPackages();
     void BuildISO();
@@ -791,8 +791,9 @@ void CModelEditorWindow::ConvertToTXTR()
     CTexture *pTex = CTextureDecoder::LoadDDS(InTextureFile, nullptr);
     TString OutName = TexFilename.GetFilePathWithoutExtension() + ".txtr";
 
-    if ((pTex->TexelFormat() != ETexelFormat::DXT1) || (pTex->NumMipMaps() > 1))
-        QMessageBox::warning(this, "Error", "Can't convert DDS to TXTR! Save your texture as a DXT1 DDS with no mipmaps, then try again.");
+    // DXT1 is repacked as-is; anything else is decoded to RGBA8 and encoded to CMPR with a generated mipmap chain
+    if (((pTex->TexelFormat() != ETexelFormat::DXT1) && (pTex->TexelFormat() != ETexelFormat::RGBA8)) || (pTex->NumMipMaps() > 1))
+        QMessageBox::warning(this, "Error", "Can't convert DDS to TXTR! Save your texture as a DDS with no mipmaps, then try again.");
 
     else
     {
@@ -11,6 +11,7 @@
 #include "Editor/Undo/ICreateDeleteDirectoryCommand.h"
 #include <Core/GameProject/AssetNameGeneration.h>
 #include <Core/GameProject/CAssetNameMap.h>
+#include <Core/GameProject/CResourceSearchIndex.h>
 
 #include <QCheckBox>
 #include <QFileDialog>
@@ -162,10 +163,15 @@ CResourceBrowser::CResourceBrowser(QWidget *pParent)
     connect(mpProxyModel, SIGNAL(modelReset()), mpUI->ResourceTableView, SLOT(resizeRowsToContents()));
     connect(mpFilterAllBox, SIGNAL(toggled(bool)), this, SLOT(OnFilterTypeBoxTicked(bool)));
     connect(gpEdApp, SIGNAL(ActiveProjectChanged(CGameProject*)), this, SLOT(UpdateStore()));
+    connect(&mSearchWatcher, SIGNAL(finished()), this, SLOT(OnSearchFinished()));
+
+    // Renamed resources need to be searched again; this is connected after the table model so it's updated first
+    connect(this, SIGNAL(ResourceMoved(CResourceEntry*,CVirtualDirectory*,TString)), this, SLOT(UpdateFilter()));
 }
 
 CResourceBrowser::~CResourceBrowser()
 {
+    mSearchWatcher.waitForFinished();
     delete mpUI;
 }
 
@@ -679,6 +685,8 @@ void CResourceBrowser::UpdateStore()
 
     if (mpStore != pNewStore)
     {
+        // Don't switch stores while the old store's search index is still being searched
+        mSearchWatcher.waitForFinished();
         mpStore = pNewStore;
 
         // Clear search
@@ -882,13 +890,34 @@ void CResourceBrowser::UpdateFilter()
     mSearching = !SearchText.isEmpty();
 
     UpdateDescriptionLabel();
-    mpProxyModel->SetSearchString( TO_TSTRING(mpUI->SearchBar->text()) );
+
+    // The filter is applied once the search finishes, so typing doesn't stall the UI on large stores
+    if (mSearching && mpStore)
+    {
+        mPendingSearchString = TO_TSTRING(SearchText);
+        mSearchWatcher.setFuture( QtConcurrent::run(mpStore->SearchIndex(), &CResourceSearchIndex::Search, mPendingSearchString) );
+        return;
+    }
+
+    mPendingSearchString = "";
+    mpProxyModel->SetSearchResults("", std::vector<uint64>());
     mpProxyModel->invalidate();
 
     // not sure why I need to do this here? but the resize mode seems to get reset otherwise
     mpUI->ResourceTableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
 }
 
+void CResourceBrowser::OnSearchFinished()
+{
+    // Discard results for a search string that has since been changed
+    if (mPendingSearchString.IsEmpty() || mPendingSearchString != TO_TSTRING(mpUI->SearchBar->text()))
+        return;
+
+    mpProxyModel->SetSearchResults(mPendingSearchString, mSearchWatcher.result());
+    mpProxyModel->invalidate();
+    mpUI->ResourceTableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+}
+
 void CResourceBrowser::UpdateUndoActionStates()
 {
     // Make sure that the undo actions are only enabled when the table view has focus.
@@ -6,6 +6,7 @@
 #include "CResourceTableModel.h"
 #include "CVirtualDirectoryModel.h"
 #include <QCheckBox>
+#include <QFutureWatcher>
 #include <QTimer>
 #include <QUndoStack>
 #include <QVBoxLayout>
@@ -29,6 +30,10 @@ class CResourceBrowser : public QWidget
     bool mAssetListMode;
     bool mSearching;
 
+    // Search results are looked up from the store's search index on a worker thread
+    QFutureWatcher< std::vector<uint64> > mSearchWatcher;
+    TString mPendingSearchString;
+
     // Type Filter
     QWidget *mpFilterBoxesContainerWidget;
     QVBoxLayout *mpFilterBoxesLayout;
@@ -105,6 +110,7 @@ public slots:
     void ResetTypeFilter();
     void OnFilterTypeBoxTicked(bool Checked);
     void UpdateFilter();
+    void OnSearchFinished();
 
     void UpdateUndoActionStates();
     void Undo();
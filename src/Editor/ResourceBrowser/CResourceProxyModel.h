@@ -4,6 +4,7 @@
 #include "CResourceTableModel.h"
 #include <QSet>
 #include <QSortFilterProxyModel>
+#include <vector>
 
 class CResourceProxyModel : public QSortFilterProxyModel
 {
@@ -21,9 +22,8 @@ private:
     ESortMode mSortMode;
     QSet<CResTypeInfo*> mTypeFilter;
 
-    uint64 mCompareID;
-    uint64 mCompareMask;
-    uint32 mCompareBitLength;
+    // IDs of the entries matching the search string, looked up from the store's search index
+    QSet<uint64> mSearchResults;
 
 public:
     explicit CResourceProxyModel(QObject *pParent = 0)
@@ -89,38 +89,8 @@ public:
             if (!pEntry)
                 return false;
 
-            bool HasNameMatch = pEntry->UppercaseName().Contains(mSearchString);
-
-            if (!HasNameMatch)
-            {
-                bool HasIDMatch = false;
-
-                if (mCompareBitLength > 0)
-                {
-                    uint32 IDBitLength = pEntry->ID().Length() * 8;
-
-                    if (mCompareBitLength <= IDBitLength)
-                    {
-                        uint64 ID = pEntry->ID().ToLongLong();
-                        uint32 MaxShift = IDBitLength - mCompareBitLength;
-
-                        for (uint32 Shift = 0; Shift <= MaxShift; Shift += 4)
-                        {
-                            uint64 ShiftCompare = mCompareID << Shift;
-                            uint64 Mask = mCompareMask << Shift;
-
-                            if ((ID & Mask) == ShiftCompare)
-                            {
-                                HasIDMatch = true;
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                if (!HasIDMatch)
-                    return false;
-            }
+            if (!mSearchResults.contains(pEntry->ID().ToLongLong()))
+                return false;
         }
 
         return true;
@@ -159,32 +129,14 @@ public:
     }
 
 public slots:
-    void SetSearchString(const TString& rkString)
+    void SetSearchResults(const TString& rkString, const std::vector<uint64>& rkResults)
     {
-        mSearchString = rkString.ToUpper();
-
-        // Check if this is an asset ID
-        TString IDString = rkString;
-        IDString.RemoveWhitespace();
-
-        if (IDString.StartsWith("0x"))
-            IDString = IDString.ChopFront(2);
-
-        if (IDString.Size() <= 16 && IDString.IsHexString())
-        {
-            mCompareBitLength = IDString.Size() * 4;
-            mCompareMask = ((uint64) 1 << mCompareBitLength) - 1;
-            mCompareID = IDString.ToInt64(16);
+        mSearchString = rkString;
+        mSearchResults.clear();
+        mSearchResults.reserve(rkResults.size());
 
-            if (mCompareMask == 0)
-                mCompareMask = -1;
-        }
-        else
-        {
-            mCompareID = -1;
-            mCompareMask = 0;
-            mCompareBitLength = 0;
-        }
+        for (uint64 ID : rkResults)
+            mSearchResults.insert(ID);
     }
 };
 
@@ -1,6 +1,7 @@
 #include "CResourceTableContextMenu.h"
 #include "CResourceBrowser.h"
 #include "Editor/CEditorApplication.h"
+#include <Core/GameProject/CPackage.h>
 #include <QClipboard>
 
 CResourceTableContextMenu::CResourceTableContextMenu(CResourceBrowser *pBrowser, QTableView *pView, CResourceTableModel *pModel, CResourceProxyModel *pProxy)
@@ -31,7 +32,9 @@ CResourceTableContextMenu::CResourceTableContextMenu(CResourceBrowser *pBrowser,
     mpRenameAction = addAction("Rename", this, SLOT(Rename()));
     mpSelectFolderAction = addAction("Select Folder", this, SLOT(SelectFolder()));
     mpShowReferencersAction = addAction("Show Referencers", this, SLOT(ShowReferencers()));
+    mpShowAllReferencersAction = addAction("Show All Referencers", this, SLOT(ShowAllReferencers()));
     mpShowDependenciesAction = addAction("Show Dependencies", this, SLOT(ShowDependencies()));
+    mpShowPackagesAction = addAction("Show Containing Packages", this, SLOT(ShowPackages()));
     mpDeleteAction = addAction("Delete", this, SLOT(Delete()));
     addSeparator();
     mpCopyNameAction = addAction("Copy Name", this, SLOT(CopyName()));
@@ -56,6 +59,8 @@ void CResourceTableContextMenu::ShowMenu(const QPoint& rkPos)
         mpSelectFolderAction->setVisible(mpModel->IsDisplayingAssetList());
         mpShowDependenciesAction->setVisible(IsRes);
         mpShowReferencersAction->setVisible(IsRes);
+        mpShowAllReferencersAction->setVisible(IsRes);
+        mpShowPackagesAction->setVisible(IsRes && mpEntry->Project() != nullptr);
         mpDeleteAction->setVisible(mpDirectory && mpDirectory->IsEmpty(true));
         mpCopyIDAction->setVisible(IsRes);
 
@@ -112,21 +117,31 @@ void CResourceTableContextMenu::SelectFolder()
 }
 
 void CResourceTableContextMenu::ShowReferencers()
+{
+    DisplayReferencers(false);
+}
+
+void CResourceTableContextMenu::ShowAllReferencers()
+{
+    DisplayReferencers(true);
+}
+
+void CResourceTableContextMenu::DisplayReferencers(bool Recursive)
 {
     ASSERT(mpEntry);
 
+    std::vector<CResourceEntry*> Referencers;
+    mpEntry->ResourceStore()->GetReferencers(mpEntry->ID(), Recursive, Referencers);
+
     QList<CResourceEntry*> EntryList;
 
-    for (CResourceIterator Iter(mpEntry->ResourceStore()); Iter; ++Iter)
-    {
-        if (Iter->Dependencies()->HasDependency(mpEntry->ID()))
-            EntryList << *Iter;
-    }
+    for (CResourceEntry *pReferencer : Referencers)
+        EntryList << pReferencer;
 
     if (!mpModel->IsDisplayingUserEntryList())
         mpBrowser->SetInspectedEntry(mpEntry);
 
-    QString ListDesc = QString("Referencers of \"%1\"").arg( TO_QSTRING(mpEntry->CookedAssetPath().GetFileName()) );
+    QString ListDesc = QString(Recursive ? "All referencers of \"%1\"" : "Referencers of \"%1\"").arg( TO_QSTRING(mpEntry->CookedAssetPath().GetFileName()) );
     mpModel->DisplayEntryList(EntryList, ListDesc);
     mpBrowser->ClearFilters();
 }
@@ -156,6 +171,30 @@ void CResourceTableContextMenu::ShowDependencies()
     mpBrowser->ClearFilters();
 }
 
+void CResourceTableContextMenu::ShowPackages()
+{
+    ASSERT(mpEntry);
+
+    std::vector<CPackage*> Packages;
+    mpEntry->ResourceStore()->GetPackagesContainingAsset(mpEntry->ID(), Packages);
+
+    QString FileName = TO_QSTRING(mpEntry->CookedAssetPath().GetFileName());
+    QString PackageText;
+
+    if (Packages.empty())
+        PackageText = QString("\"%1\" isn't in any packages.").arg(FileName);
+
+    else
+    {
+        PackageText = QString("\"%1\" is in the following packages:\n").arg(FileName);
+
+        for (CPackage *pPackage : Packages)
+            PackageText += "\n" + TO_QSTRING(pPackage->Name());
+    }
+
+    UICommon::InfoMsg(mpBrowser, "Containing Packages", PackageText);
+}
+
 void CResourceTableContextMenu::Delete()
 {
     ASSERT(mpDirectory && mpDirectory->IsEmpty(true));
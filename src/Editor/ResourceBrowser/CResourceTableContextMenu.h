@@ -29,6 +29,8 @@ class CResourceTableContextMenu : public QMenu
 
     QAction *mpRenameAction;
     QAction *mpShowReferencersAction;
+    QAction *mpShowAllReferencersAction;
+    QAction *mpShowPackagesAction;
     QAction *mpShowDependenciesAction;
     QAction *mpDeleteAction;
 
@@ -49,11 +51,16 @@ public slots:
     void Rename();
     void SelectFolder();
     void ShowReferencers();
+    void ShowAllReferencers();
     void ShowDependencies();
+    void ShowPackages();
     void Delete();
     void CopyName();
     void CopyPath();
     void CopyID();
+
+protected:
+    void DisplayReferencers(bool Recursive);
 };
 
 #endif // CRESOURCETABLECONTEXTMENU_H
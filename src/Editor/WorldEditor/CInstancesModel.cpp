@@ -575,9 +575,10 @@ void CInstancesModel::GenerateList()
 
         for (uint32 iTemp = 0; iTemp < NumTemplates; iTemp++)
         {
-            CScriptTemplate *pTemp = mpCurrentGame->TemplateByIndex(iTemp);
+            // Templates that haven't been loaded yet can't have any instances
+            CScriptTemplate *pTemp = mpCurrentGame->TemplateByIndex(iTemp, false);
 
-            if (pTemp->NumObjects() > 0)
+            if (pTemp && pTemp->NumObjects() > 0)
                 mTemplateList << pTemp;
         }
 
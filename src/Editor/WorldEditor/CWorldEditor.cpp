@@ -99,6 +99,11 @@ CWorldEditor::CWorldEditor(QWidget *parent)
 
     ChangeEditMode(eWEM_EditWorldInfo);
 
+    // Initialize render stats display
+    mpRenderStatsLabel = new QLabel(this);
+    mpRenderStatsLabel->setVisible(false);
+    ui->statusbar->addPermanentWidget(mpRenderStatsLabel);
+
     // Initialize actions
     addAction(ui->ActionIncrementGizmo);
     addAction(ui->ActionDecrementGizmo);
@@ -187,6 +192,7 @@ CWorldEditor::CWorldEditor(QWidget *parent)
     connect(ui->ActionDrawSky, SIGNAL(triggered()), this, SLOT(ToggleDrawSky()));
     connect(ui->ActionGameMode, SIGNAL(triggered()), this, SLOT(ToggleGameMode()));
     connect(ui->ActionDisableAlpha, SIGNAL(triggered()), this, SLOT(ToggleDisableAlpha()));
+    connect(ui->ActionShowRenderStats, SIGNAL(triggered()), this, SLOT(ToggleRenderStats()));
     connect(ui->ActionNoLighting, SIGNAL(triggered()), this, SLOT(SetNoLighting()));
     connect(ui->ActionBasicLighting, SIGNAL(triggered()), this, SLOT(SetBasicLighting()));
     connect(ui->ActionWorldLighting, SIGNAL(triggered()), this, SLOT(SetWorldLighting()));
@@ -266,10 +272,13 @@ bool CWorldEditor::SetArea(CWorld *pWorld, int AreaIndex)
     CResourceEntry *pAreaEntry = gpResourceStore->FindEntry(AreaID);
     ASSERT(pAreaEntry);
 
+    // Script display assets that aren't loaded yet are streamed in after the area is up
+    CScriptObject::SetDeferDisplayAssetLoads(true);
     mpArea = pAreaEntry->Load();
     ASSERT(mpArea);
     mpWorld->SetAreaLayerInfo(mpArea);
     mScene.SetActiveArea(mpWorld, mpArea);
+    CScriptObject::SetDeferDisplayAssetLoads(false);
 
     // Snap camera to new area
     CCamera *pCamera = &ui->MainViewport->Camera();
@@ -358,6 +367,12 @@ void CWorldEditor::EditorTick(float)
 {
     // Update new link line
     UpdateNewLinkLine();
+
+    // Load whatever's in front of the camera first
+    mScene.UpdateStreamingPriorities(ui->MainViewport->Camera());
+
+    if (ui->ActionShowRenderStats->isChecked())
+        UpdateRenderStats();
 }
 
 void CWorldEditor::NotifyNodeAboutToBeDeleted(CSceneNode *pNode)
@@ -800,6 +815,16 @@ void CWorldEditor::UpdateStatusBar()
         ui->statusbar->showMessage(StatusText);
 }
 
+void CWorldEditor::UpdateRenderStats()
+{
+    const CGraphics::SFrameStats& rkStats = ui->MainViewport->Renderer()->LastFrameStats();
+    QString StatsText = QString("Draw calls: %1 | Shader binds: %2 | Texture binds: %3")
+            .arg(rkStats.NumDrawCalls).arg(rkStats.NumShaderBinds).arg(rkStats.NumTextureBinds);
+
+    if (mpRenderStatsLabel->text() != StatsText)
+        mpRenderStatsLabel->setText(StatsText);
+}
+
 void CWorldEditor::UpdateGizmoUI()
 {
     // Update transform XYZ spin boxes
@@ -1295,6 +1320,13 @@ void CWorldEditor::ToggleDisableAlpha()
     ui->MainViewport->Renderer()->ToggleAlphaDisabled(ui->ActionDisableAlpha->isChecked());
 }
 
+void CWorldEditor::ToggleRenderStats()
+{
+    bool ShowStats = ui->ActionShowRenderStats->isChecked();
+    mpRenderStatsLabel->setVisible(ShowStats);
+    if (ShowStats) UpdateRenderStats();
+}
+
 void CWorldEditor::SetNoLighting()
 {
     CGraphics::sLightMode = CGraphics::ELightingMode::None;
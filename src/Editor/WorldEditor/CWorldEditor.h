@@ -26,6 +26,7 @@
 #include <QComboBox>
 #include <QDir>
 #include <QFile>
+#include <QLabel>
 #include <QList>
 #include <QMainWindow>
 #include <QTimer>
@@ -76,6 +77,7 @@ class CWorldEditor : public INodeEditor
     CPoiMapSidebar *mpPoiMapSidebar;
 
     QAction *mpPoiMapAction;
+    QLabel *mpRenderStatsLabel;
 
 public:
     explicit CWorldEditor(QWidget *parent = 0);
@@ -134,6 +136,7 @@ public slots:
     void UpdateOpenRecentActions();
     void UpdateWindowTitle();
     void UpdateStatusBar();
+    void UpdateRenderStats();
     void UpdateGizmoUI();
     void UpdateSelectionUI();
     void UpdateCursor();
@@ -171,6 +174,7 @@ private slots:
     void ToggleDrawSky();
     void ToggleGameMode();
     void ToggleDisableAlpha();
+    void ToggleRenderStats();
     void SetNoLighting();
     void SetBasicLighting();
     void SetWorldLighting();
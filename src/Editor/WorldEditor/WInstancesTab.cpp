@@ -304,8 +304,11 @@ void WInstancesTab::OnHideAllExceptTypeAction()
 
         for (uint32 iTemp = 0; iTemp < pGame->NumScriptTemplates(); iTemp++)
         {
-            CScriptTemplate *pTemplate = pGame->TemplateByIndex(iTemp);
-            pTemplate->SetVisible( pTemplate == mpMenuTemplate ? true : false );
+            // Templates that haven't been loaded yet have no instances to hide
+            CScriptTemplate *pTemplate = pGame->TemplateByIndex(iTemp, false);
+
+            if (pTemplate)
+                pTemplate->SetVisible( pTemplate == mpMenuTemplate ? true : false );
         }
 
         mpTypesModel->dataChanged( mpTypesModel->index(0, 2, TypeParent), mpTypesModel->index(mpTypesModel->rowCount(TypeParent) - 1, 2, TypeParent) );
@@ -334,7 +337,10 @@ void WInstancesTab::OnUnhideAllTypes()
         CGameTemplate *pGame = NGameList::GetGameTemplate(Game);
 
         for (uint32 iTemp = 0; iTemp < pGame->NumScriptTemplates(); iTemp++)
-            pGame->TemplateByIndex(iTemp)->SetVisible(true);
+        {
+            CScriptTemplate *pTemplate = pGame->TemplateByIndex(iTemp, false);
+            if (pTemplate) pTemplate->SetVisible(true);
+        }
 
         mpTypesModel->dataChanged( mpTypesModel->index(0, 2, TypeParent), mpTypesModel->index(mpTypesModel->rowCount(TypeParent) - 1, 2, TypeParent) );
     }
@@ -368,7 +374,10 @@ void WInstancesTab::OnUnhideAll()
         CGameTemplate *pGame = NGameList::GetGameTemplate(Game);
 
         for (uint32 iTemp = 0; iTemp < pGame->NumScriptTemplates(); iTemp++)
-            pGame->TemplateByIndex(iTemp)->SetVisible(true);
+        {
+            CScriptTemplate *pTemplate = pGame->TemplateByIndex(iTemp, false);
+            if (pTemplate) pTemplate->SetVisible(true);
+        }
 
         mpTypesModel->dataChanged( mpTypesModel->index(0, 2, TypesRoot), mpTypesModel->index(mpTypesModel->rowCount(TypesRoot) - 1, 2, TypesRoot) );
     }
@@ -3,6 +3,7 @@
 #include "UICommon.h"
 #include <Common/Log.h>
 
+#include <Core/NBenchmark.h>
 #include <Core/Resource/Script/NGameList.h>
 
 #include <QApplication>
@@ -50,6 +51,17 @@ public:
         if (!Initialized) QMessageBox::warning(0, "Error", "Couldn't open log file. Logging will not work for this session.");
         qInstallMessageHandler(QtLogRedirect);
 
+        // Run the Core benchmarks instead of the editor: --benchmark [project file]
+        // Results are written to the log; the exit code is nonzero if any benchmark gave mismatched results.
+        QStringList Args = App.arguments();
+        int BenchmarkArg = Args.indexOf("--benchmark");
+
+        if (BenchmarkArg != -1)
+        {
+            TString ProjectPath = (BenchmarkArg + 1 < Args.size() ? TO_TSTRING(Args[BenchmarkArg + 1]) : "");
+            return NBenchmark::RunAll(ProjectPath) ? 0 : 1;
+        }
+
         // Create editor resource store
         gpEditorStore = new CResourceStore("../resources/");
 